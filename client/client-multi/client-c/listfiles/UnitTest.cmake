@@ -30,11 +30,27 @@ configure_file("${CMAKE_CURRENT_SOURCE_DIR}/sonar-project.properties.in"
                "${CMAKE_CURRENT_SOURCE_DIR}/sonar-project.properties"
               )
 
-add_executable  (test_ext_log_storage_memory
-                    test/platform-impl/test_ext_log_storage_memory.c
+if(NOT KAA_WITH_FILE_LOG_STORAGE)
+    add_executable  (test_ext_log_storage_memory
+                        test/platform-impl/test_ext_log_storage_memory.c
+                        test/kaa_test_external.c
+                    )
+    target_link_libraries(test_ext_log_storage_memory kaac ${OPENSSL_LIBRARIES} ${CUNIT_LIB_NAME})
+endif()
+
+add_executable  (test_ext_log_storage_file
+                    test/platform-impl/test_ext_log_storage_file.c
+                    test/kaa_test_external.c
+                    ${KAA_SRC_FOLDER}/platform-impl/posix/ext_log_storage_file.c
+                )
+target_link_libraries(test_ext_log_storage_file kaac ${OPENSSL_LIBRARIES} ${CUNIT_LIB_NAME})
+
+add_executable  (test_posix_kaa_reactor
+                    test/platform-impl/test_posix_kaa_reactor.c
                     test/kaa_test_external.c
+                    ${KAA_SRC_FOLDER}/platform-impl/posix/posix_kaa_reactor.c
                 )
-target_link_libraries(test_ext_log_storage_memory kaac ${OPENSSL_LIBRARIES} ${CUNIT_LIB_NAME})
+target_link_libraries(test_posix_kaa_reactor kaac ${OPENSSL_LIBRARIES} ${CUNIT_LIB_NAME})
 
 add_executable  (test_ext_log_upload_strategy_by_volume
                     test/platform-impl/test_ext_log_upload_strategies.c
@@ -126,6 +142,12 @@ add_executable  (test_list
                 )
 target_link_libraries(test_list kaac ${OPENSSL_LIBRARIES} ${CUNIT_LIB_NAME})
 
+add_executable  (test_hash_table
+                    test/collections/test_kaa_hash_table.c
+                    test/kaa_test_external.c
+                )
+target_link_libraries(test_hash_table kaac ${OPENSSL_LIBRARIES} ${CUNIT_LIB_NAME})
+
 #add_executable  (test_channel_manager
 #                    test/test_kaa_channel_manager.c
 #                    test/kaa_test_external.c
@@ -144,6 +166,15 @@ add_executable  (test_kaatcp_request
                 )
 target_link_libraries(test_kaatcp_request kaac ${CUNIT_LIB_NAME})
 
+# kaatcp_compression.c is built only by the x86-64 platform listfile.
+if(KAA_PLATFORM STREQUAL "x86-64" AND NOT KAA_WITHOUT_TCP_CHANNEL AND NOT KAA_WITHOUT_TCP_COMPRESSION)
+    add_executable  (test_kaatcp_compression
+                        test/kaatcp/kaatcp_compression_test.c
+                        test/kaa_test_external.c
+                    )
+    target_link_libraries(test_kaatcp_compression kaac ${CUNIT_LIB_NAME})
+endif()
+
 add_executable  (test_kaa_tcp_channel_bootstrap
                     test/kaa_tcp_channel/test_kaa_tcp_channel_bootstrap.c
                     test/kaa_test_external.c
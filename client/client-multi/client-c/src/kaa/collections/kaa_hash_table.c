@@ -0,0 +1,258 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "kaa_hash_table.h"
+#include "../kaa_common.h"
+#include "../utilities/kaa_mem.h"
+
+#define KAA_HASH_TABLE_MIN_CAPACITY    8
+
+#define KAA_FNV_OFFSET_BASIS    2166136261U
+#define KAA_FNV_PRIME           16777619U
+
+typedef struct {
+    void        *data;
+    uint32_t    hash;
+} kaa_hash_table_slot_t;
+
+struct kaa_hash_table_t {
+    kaa_hash_table_slot_t       *slots;
+    size_t                      capacity;
+    size_t                      size;
+    kaa_hash_table_get_key      get_key;
+    kaa_hash_table_hash_key     hash;
+    kaa_hash_table_match_key    match;
+};
+
+static void destroy_data(void *data, deallocate_list_data deallocator)
+{
+    if (deallocator) {
+        (*deallocator)(data);
+    } else {
+        KAA_FREE(data);
+    }
+}
+
+/*
+ * The load factor is kept below 3/4, otherwise probe sequences get long.
+ */
+static bool is_overloaded(size_t size, size_t capacity)
+{
+    return size * 4 > capacity * 3;
+}
+
+static size_t find_slot(kaa_hash_table_t *table, const void *key, uint32_t hash)
+{
+    size_t mask = table->capacity - 1;
+    size_t index = hash & mask;
+
+    while (table->slots[index].data) {
+        if (table->slots[index].hash == hash
+                && table->match(key, table->get_key(table->slots[index].data))) {
+            break;
+        }
+        index = (index + 1) & mask;
+    }
+
+    return index;
+}
+
+static kaa_error_t resize(kaa_hash_table_t *table, size_t capacity)
+{
+    kaa_hash_table_slot_t *slots = (kaa_hash_table_slot_t *) KAA_CALLOC(capacity, sizeof(kaa_hash_table_slot_t));
+    KAA_RETURN_IF_NIL(slots, KAA_ERR_NOMEM);
+
+    size_t mask = capacity - 1;
+    size_t i = 0;
+    for (; i < table->capacity; ++i) {
+        if (table->slots[i].data) {
+            size_t index = table->slots[i].hash & mask;
+            while (slots[index].data) {
+                index = (index + 1) & mask;
+            }
+            slots[index] = table->slots[i];
+        }
+    }
+
+    KAA_FREE(table->slots);
+    table->slots = slots;
+    table->capacity = capacity;
+    return KAA_ERR_NONE;
+}
+
+kaa_hash_table_t *kaa_hash_table_create(size_t capacity
+                                      , kaa_hash_table_get_key get_key
+                                      , kaa_hash_table_hash_key hash
+                                      , kaa_hash_table_match_key match)
+{
+    KAA_RETURN_IF_NIL3(get_key, hash, match, NULL);
+
+    kaa_hash_table_t *table = (kaa_hash_table_t *) KAA_MALLOC(sizeof(kaa_hash_table_t));
+    KAA_RETURN_IF_NIL(table, NULL);
+
+    table->capacity = KAA_HASH_TABLE_MIN_CAPACITY;
+    while (is_overloaded(capacity, table->capacity)) {
+        table->capacity <<= 1;
+    }
+
+    table->slots = (kaa_hash_table_slot_t *) KAA_CALLOC(table->capacity, sizeof(kaa_hash_table_slot_t));
+    if (!table->slots) {
+        KAA_FREE(table);
+        return NULL;
+    }
+
+    table->size = 0;
+    table->get_key = get_key;
+    table->hash = hash;
+    table->match = match;
+    return table;
+}
+
+void kaa_hash_table_destroy(kaa_hash_table_t *table, deallocate_list_data deallocator)
+{
+    KAA_RETURN_IF_NIL(table, );
+    kaa_hash_table_clear(table, deallocator);
+    KAA_FREE(table->slots);
+    KAA_FREE(table);
+}
+
+void kaa_hash_table_clear(kaa_hash_table_t *table, deallocate_list_data deallocator)
+{
+    KAA_RETURN_IF_NIL(table, );
+
+    size_t i = 0;
+    for (; i < table->capacity && table->size; ++i) {
+        if (table->slots[i].data) {
+            destroy_data(table->slots[i].data, deallocator);
+            table->slots[i].data = NULL;
+            --table->size;
+        }
+    }
+}
+
+size_t kaa_hash_table_get_size(kaa_hash_table_t *table)
+{
+    KAA_RETURN_IF_NIL(table, 0);
+    return table->size;
+}
+
+kaa_error_t kaa_hash_table_insert(kaa_hash_table_t *table, void *data, deallocate_list_data deallocator)
+{
+    KAA_RETURN_IF_NIL2(table, data, KAA_ERR_BADPARAM);
+
+    const void *key = table->get_key(data);
+    uint32_t hash = table->hash(key);
+    size_t index = find_slot(table, key, hash);
+
+    if (table->slots[index].data) {
+        destroy_data(table->slots[index].data, deallocator);
+        table->slots[index].data = data;
+        return KAA_ERR_NONE;
+    }
+
+    if (is_overloaded(table->size + 1, table->capacity)) {
+        kaa_error_t error = resize(table, table->capacity << 1);
+        if (error) {
+            return error;
+        }
+        index = find_slot(table, key, hash);
+    }
+
+    table->slots[index].data = data;
+    table->slots[index].hash = hash;
+    ++table->size;
+    return KAA_ERR_NONE;
+}
+
+void *kaa_hash_table_find(kaa_hash_table_t *table, const void *key)
+{
+    KAA_RETURN_IF_NIL2(table, key, NULL);
+    return table->slots[find_slot(table, key, table->hash(key))].data;
+}
+
+kaa_error_t kaa_hash_table_remove(kaa_hash_table_t *table, const void *key, deallocate_list_data deallocator)
+{
+    KAA_RETURN_IF_NIL2(table, key, KAA_ERR_BADPARAM);
+
+    size_t index = find_slot(table, key, table->hash(key));
+    if (!table->slots[index].data) {
+        return KAA_ERR_NOT_FOUND;
+    }
+
+    destroy_data(table->slots[index].data, deallocator);
+    --table->size;
+
+    /*
+     * Shift back the following elements of the probe sequence which
+     * can't be found anymore once the slot becomes empty.
+     */
+    size_t mask = table->capacity - 1;
+    size_t next = index;
+    for (;;) {
+        next = (next + 1) & mask;
+        if (!table->slots[next].data) {
+            break;
+        }
+
+        size_t home = table->slots[next].hash & mask;
+        bool is_reachable = (index <= next) ? (index < home && home <= next) : (index < home || home <= next);
+        if (!is_reachable) {
+            table->slots[index] = table->slots[next];
+            index = next;
+        }
+    }
+
+    table->slots[index].data = NULL;
+    return KAA_ERR_NONE;
+}
+
+void kaa_hash_table_for_each(kaa_hash_table_t *table, process_data process, void *context)
+{
+    KAA_RETURN_IF_NIL2(table, process, );
+
+    size_t i = 0;
+    for (; i < table->capacity; ++i) {
+        if (table->slots[i].data) {
+            (*process)(table->slots[i].data, context);
+        }
+    }
+}
+
+uint32_t kaa_hash_table_bytes_hash(const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t *) data;
+    uint32_t hash = KAA_FNV_OFFSET_BASIS;
+    while (size--) {
+        hash ^= *bytes++;
+        hash *= KAA_FNV_PRIME;
+    }
+    return hash;
+}
+
+uint32_t kaa_hash_table_string_hash(const void *key)
+{
+    const char *str = (const char *) key;
+    return kaa_hash_table_bytes_hash(str, strlen(str));
+}
+
+bool kaa_hash_table_string_match(const void *key, const void *other_key)
+{
+    return strcmp((const char *) key, (const char *) other_key) == 0;
+}
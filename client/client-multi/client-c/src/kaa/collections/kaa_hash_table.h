@@ -0,0 +1,125 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file kaa_hash_table.h
+ * @brief Open-addressing hash table of pointers to user data.
+ *
+ * The key of an element is extracted from its data, so the table doesn't keep copies of keys.
+ * Collisions are resolved by linear probing, removed elements are backward-shifted, so the table
+ * has no tombstones and lookups stay short after many insertions and removals.
+ */
+
+#ifndef KAA_HASH_TABLE_H_
+#define KAA_HASH_TABLE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "kaa_list.h"
+#include "../kaa_error.h"
+
+typedef struct kaa_hash_table_t kaa_hash_table_t;
+
+/**
+ * @brief Returns the key of the element data.
+ */
+typedef const void *(*kaa_hash_table_get_key)(void *data);
+
+/**
+ * @brief Returns the key hash.
+ */
+typedef uint32_t (*kaa_hash_table_hash_key)(const void *key);
+
+/**
+ * @brief Return @b true if the keys are equal.
+ */
+typedef bool (*kaa_hash_table_match_key)(const void *key, const void *other_key);
+
+/**
+ * @brief Creates empty hash table.
+ * @param capacity  The expected number of elements. The table grows when needed.
+ * @return The hash table object.
+ * @retval NULL the key callbacks are @c NULL or there is not enough memory
+ */
+kaa_hash_table_t *kaa_hash_table_create(size_t capacity
+                                      , kaa_hash_table_get_key get_key
+                                      , kaa_hash_table_hash_key hash
+                                      , kaa_hash_table_match_key match);
+
+/**
+ * @brief Destroys the hash table and all elements.
+ */
+void kaa_hash_table_destroy(kaa_hash_table_t *table, deallocate_list_data deallocator);
+
+/**
+ * @brief Removes all elements from the hash table (which are destroyed), and leaving the table with a size of 0.
+ */
+void kaa_hash_table_clear(kaa_hash_table_t *table, deallocate_list_data deallocator);
+
+/**
+ * @brief Returns the number of elements in the hash table.
+ */
+size_t kaa_hash_table_get_size(kaa_hash_table_t *table);
+
+/**
+ * @brief Inserts a new element. An element with the same key is replaced and destroyed.
+ * @retval KAA_ERR_NONE the element was inserted
+ */
+kaa_error_t kaa_hash_table_insert(kaa_hash_table_t *table, void *data, deallocate_list_data deallocator);
+
+/**
+ * @brief Returns data of the element with the given key.
+ * @retval NULL no such element is found
+ */
+void *kaa_hash_table_find(kaa_hash_table_t *table, const void *key);
+
+/**
+ * @brief Removes from the hash table the element with the given key.
+ * @retval KAA_ERR_NONE element was found
+ */
+kaa_error_t kaa_hash_table_remove(kaa_hash_table_t *table, const void *key, deallocate_list_data deallocator);
+
+/**
+ * @brief Applies the function process to each of the elements in unspecified order.
+ * The table must not be modified by the function.
+ */
+void kaa_hash_table_for_each(kaa_hash_table_t *table, process_data process, void *context);
+
+/**
+ * @brief Calculates FNV-1a hash of the byte sequence.
+ */
+uint32_t kaa_hash_table_bytes_hash(const void *data, size_t size);
+
+/**
+ * @brief Key hash callback for null-terminated string keys.
+ */
+uint32_t kaa_hash_table_string_hash(const void *key);
+
+/**
+ * @brief Key match callback for null-terminated string keys.
+ */
+bool kaa_hash_table_string_match(const void *key, const void *other_key);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+#endif /* KAA_HASH_TABLE_H_ */
@@ -31,6 +31,7 @@
 # include "kaa_platform_common.h"
 # include "kaa_common_schema.h"
 # include "collections/kaa_list.h"
+# include "collections/kaa_hash_table.h"
 # include "utilities/kaa_mem.h"
 # include "utilities/kaa_log.h"
 # include "platform/ext_system_logger.h"
@@ -100,9 +101,9 @@ typedef struct {
 struct kaa_event_manager_t {
     sent_events_tuple_t         events_awaiting_response;
     kaa_list_t                 *pending_events;
-    kaa_list_t                 *event_callbacks;
-    kaa_list_t                 *transactions;
-    kaa_list_t                 *event_listeners_requests;
+    kaa_hash_table_t           *event_callbacks;            /* event_callback_pair_t by FQN */
+    kaa_hash_table_t           *transactions;               /* event_transaction_t by ID */
+    kaa_hash_table_t           *event_listeners_requests;   /* kaa_event_listeners_request_t by request ID */
     kaa_event_block_id          trx_counter;
     kaa_event_callback_t        global_event_callback;
     size_t                      event_sequence_number;
@@ -168,11 +169,19 @@ static kaa_event_listeners_request_t *create_event_listener_request(kaa_event_ma
     return result;
 }
 
-static bool find_listeners_request_by_id(void *request_p, void *context)
+static const void *get_listeners_request_id(void *request_p)
 {
-    kaa_event_listeners_request_t *request = (kaa_event_listeners_request_t *) request_p;
-    uint16_t *request_id = (uint16_t *) context;
-    return (request && request_id && ((*request_id) == request->request_id));
+    return &((kaa_event_listeners_request_t *) request_p)->request_id;
+}
+
+static uint32_t hash_listeners_request_id(const void *request_id)
+{
+    return kaa_hash_table_bytes_hash(request_id, sizeof(uint16_t));
+}
+
+static bool match_listeners_request_id(const void *request_id, const void *other_request_id)
+{
+    return *(const uint16_t *) request_id == *(const uint16_t *) other_request_id;
 }
 
 static void kaa_event_destroy(void* data)
@@ -213,16 +222,15 @@ static void kaa_event_destroy_callback_pair(void *pair_p)
     KAA_FREE(pair);
 }
 
-static kaa_event_callback_t find_event_callback(kaa_list_t *head, const char *fqn)
+static const void *get_event_callback_fqn(void *pair_p)
 {
-    kaa_list_node_t *it = kaa_list_begin(head);
-    while (it) {
-        event_callback_pair_t *pair = (event_callback_pair_t *) kaa_list_get_data(it);
-        if (strcmp(fqn, pair->fqn) == 0)
-            return pair->cb;
-        it = kaa_list_next(it);
-    }
-    return NULL;
+    return ((event_callback_pair_t *) pair_p)->fqn;
+}
+
+static kaa_event_callback_t find_event_callback(kaa_hash_table_t *callbacks, const char *fqn)
+{
+    event_callback_pair_t *pair = (event_callback_pair_t *) kaa_hash_table_find(callbacks, fqn);
+    return pair ? pair->cb : NULL;
 }
 
 static event_transaction_t *create_transaction(kaa_event_block_id id)
@@ -248,11 +256,19 @@ static void destroy_transaction(void *trx_p)
     KAA_FREE(trx);
 }
 
-static bool transaction_search_by_id_predicate(void *trx_p, void *context)
+static const void *get_transaction_id(void *trx_p)
 {
-    event_transaction_t *trx = (event_transaction_t *) trx_p;
-    kaa_event_block_id *matcher = (kaa_event_block_id *) context;
-    return (matcher && trx) ? ((*matcher) == trx->id) : false;
+    return &((event_transaction_t *) trx_p)->id;
+}
+
+static uint32_t hash_transaction_id(const void *trx_id)
+{
+    return kaa_hash_table_bytes_hash(trx_id, sizeof(kaa_event_block_id));
+}
+
+static bool match_transaction_id(const void *trx_id, const void *other_trx_id)
+{
+    return *(const kaa_event_block_id *) trx_id == *(const kaa_event_block_id *) other_trx_id;
 }
 
 void kaa_event_manager_destroy(kaa_event_manager_t *self)
@@ -260,9 +276,9 @@ void kaa_event_manager_destroy(kaa_event_manager_t *self)
     if (self) {
         kaa_list_destroy(self->pending_events, &kaa_event_destroy);
         kaa_list_destroy(self->events_awaiting_response.sent_events, &kaa_event_destroy);
-        kaa_list_destroy(self->event_callbacks, &kaa_event_destroy_callback_pair);
-        kaa_list_destroy(self->transactions, &destroy_transaction);
-        kaa_list_destroy(self->event_listeners_requests, &destroy_event_listener_request);
+        kaa_hash_table_destroy(self->event_callbacks, &kaa_event_destroy_callback_pair);
+        kaa_hash_table_destroy(self->transactions, &destroy_transaction);
+        kaa_hash_table_destroy(self->event_listeners_requests, &destroy_event_listener_request);
 
         if (self->event_source) {
             KAA_FREE((void*)self->event_source);
@@ -298,9 +314,15 @@ kaa_error_t kaa_event_manager_create(kaa_event_manager_t **event_manager_p
 
     (*event_manager_p)->pending_events = kaa_list_create();
     (*event_manager_p)->events_awaiting_response.sent_events = kaa_list_create();
-    (*event_manager_p)->event_callbacks = kaa_list_create();
-    (*event_manager_p)->transactions = kaa_list_create();
-    (*event_manager_p)->event_listeners_requests = kaa_list_create();
+    (*event_manager_p)->event_callbacks = kaa_hash_table_create(0, &get_event_callback_fqn
+                                                              , &kaa_hash_table_string_hash
+                                                              , &kaa_hash_table_string_match);
+    (*event_manager_p)->transactions = kaa_hash_table_create(0, &get_transaction_id
+                                                           , &hash_transaction_id
+                                                           , &match_transaction_id);
+    (*event_manager_p)->event_listeners_requests = kaa_hash_table_create(0, &get_listeners_request_id
+                                                                       , &hash_listeners_request_id
+                                                                       , &match_listeners_request_id);
 
     if (!(*event_manager_p)->pending_events || !(*event_manager_p)->events_awaiting_response.sent_events ||
         !(*event_manager_p)->event_callbacks || !(*event_manager_p)->transactions ||
@@ -454,6 +476,20 @@ static size_t kaa_event_list_get_request_size(kaa_list_t *events)
     return expected_size;
 }
 
+static void add_listeners_request_size(void *request_p, void *context)
+{
+    kaa_event_listeners_request_t *request = (kaa_event_listeners_request_t *) request_p;
+    size_t *expected_size = (size_t *) context;
+    if (!request->is_sent) {
+        *expected_size += sizeof(uint32_t); // request id + fqns count
+        *expected_size += sizeof(uint32_t) * request->fqns_count; // fqn length + reserved
+        size_t i = 0;
+        for (; i < request->fqns_count; ++i) {
+            *expected_size += kaa_aligned_size_get(request->fqns[i]->size);
+        }
+    }
+}
+
 static kaa_error_t kaa_event_request_get_size_no_header(kaa_event_manager_t *self, size_t *expected_size)
 {
     KAA_RETURN_IF_NIL2(self, expected_size, KAA_ERR_BADPARAM);
@@ -470,22 +506,10 @@ static kaa_error_t kaa_event_request_get_size_no_header(kaa_event_manager_t *sel
         }
     }
 
-    if (kaa_list_get_size(self->event_listeners_requests) > 0) {
+    if (kaa_hash_table_get_size(self->event_listeners_requests) > 0) {
         *expected_size += sizeof(uint32_t); // field id(0) + reserved + listeners count
 
-        kaa_list_node_t *it = kaa_list_begin(self->event_listeners_requests);
-        while (it) {
-            kaa_event_listeners_request_t *request = (kaa_event_listeners_request_t *) kaa_list_get_data(it);
-            if (!request->is_sent) {
-                *expected_size += sizeof(uint32_t); // request id + fqns count
-                *expected_size += sizeof(uint32_t) * request->fqns_count; // fqn length + reserved
-                int i = 0;
-                for (; i < request->fqns_count; ++i) {
-                    *expected_size += kaa_aligned_size_get(request->fqns[i]->size);
-                }
-            }
-            it = kaa_list_next(it);
-        }
+        kaa_hash_table_for_each(self->event_listeners_requests, &add_listeners_request_size, expected_size);
     }
     return KAA_ERR_NONE;
 }
@@ -594,38 +618,53 @@ static kaa_error_t kaa_event_list_serialize(kaa_event_manager_t *self, kaa_list_
     return KAA_ERR_NONE;
 }
 
-static kaa_error_t kaa_event_listeners_request_serialize(kaa_event_manager_t *self, kaa_platform_message_writer_t *writer, uint16_t *serialized_listeners_count)
+typedef struct {
+    kaa_event_manager_t             *self;
+    kaa_platform_message_writer_t   *writer;
+    uint16_t                        serialized_listeners_count;
+    kaa_error_t                     error;
+} listeners_request_serialization_context_t;
+
+static void serialize_listeners_request(void *request_p, void *context_p)
 {
-    kaa_list_node_t *it = kaa_list_begin(self->event_listeners_requests);
-    *serialized_listeners_count = 0;
-    while (it) {
-        kaa_event_listeners_request_t *request = (kaa_event_listeners_request_t *) kaa_list_get_data(it);
-        if (!request->is_sent) {
-            *((uint16_t *) writer->current) = KAA_HTONS(request->request_id);
-            writer->current += sizeof(uint16_t);
-            *((uint16_t *) writer->current) = KAA_HTONS((uint16_t) request->fqns_count);
-            writer->current += sizeof(uint16_t);
-            KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Going to serialize event listeners: request id '%u', fqn count '%u'"
-                        , request->request_id, request->fqns_count);
-            int i = 0;
-            for (; i < request->fqns_count; ++i) {
-                size_t fqn_length = request->fqns[i]->size;
-                *((uint16_t *) writer->current) = KAA_HTONS((uint16_t) fqn_length);
-                writer->current += sizeof(uint32_t); // fqn length + reserved
-                kaa_error_t error = kaa_platform_message_write_aligned(writer, request->fqns[i]->buffer, fqn_length);
-                if (error) {
-                    KAA_LOG_ERROR(self->logger, error, "Failed to write event listener request");
-                    *serialized_listeners_count = 0;
-                    return error;
-                }
-            }
+    kaa_event_listeners_request_t *request = (kaa_event_listeners_request_t *) request_p;
+    listeners_request_serialization_context_t *context = (listeners_request_serialization_context_t *) context_p;
+    kaa_platform_message_writer_t *writer = context->writer;
+
+    if (context->error || request->is_sent) {
+        return;
+    }
 
-            request->is_sent = true;
-            (*serialized_listeners_count)++;
+    *((uint16_t *) writer->current) = KAA_HTONS(request->request_id);
+    writer->current += sizeof(uint16_t);
+    *((uint16_t *) writer->current) = KAA_HTONS((uint16_t) request->fqns_count);
+    writer->current += sizeof(uint16_t);
+    KAA_LOG_TRACE(context->self->logger, KAA_ERR_NONE, "Going to serialize event listeners: request id '%u', fqn count '%u'"
+                , request->request_id, request->fqns_count);
+    size_t i = 0;
+    for (; i < request->fqns_count; ++i) {
+        size_t fqn_length = request->fqns[i]->size;
+        *((uint16_t *) writer->current) = KAA_HTONS((uint16_t) fqn_length);
+        writer->current += sizeof(uint32_t); // fqn length + reserved
+        kaa_error_t error = kaa_platform_message_write_aligned(writer, request->fqns[i]->buffer, fqn_length);
+        if (error) {
+            KAA_LOG_ERROR(context->self->logger, error, "Failed to write event listener request");
+            context->error = error;
+            return;
         }
-        it = kaa_list_next(it);
     }
-    return KAA_ERR_NONE;
+
+    request->is_sent = true;
+    context->serialized_listeners_count++;
+}
+
+static kaa_error_t kaa_event_listeners_request_serialize(kaa_event_manager_t *self, kaa_platform_message_writer_t *writer, uint16_t *serialized_listeners_count)
+{
+    listeners_request_serialization_context_t context = { self, writer, 0, KAA_ERR_NONE };
+    kaa_hash_table_for_each(self->event_listeners_requests, &serialize_listeners_request, &context);
+
+    *serialized_listeners_count = context.error ? 0 : context.serialized_listeners_count;
+    return context.error;
 }
 
 kaa_error_t kaa_event_request_serialize(kaa_event_manager_t *self, size_t request_id, kaa_platform_message_writer_t *writer)
@@ -683,7 +722,7 @@ kaa_error_t kaa_event_request_serialize(kaa_event_manager_t *self, size_t reques
                                                                        , self->pending_events);
         }
 
-        if (kaa_list_get_size(self->event_listeners_requests)) {
+        if (kaa_hash_table_get_size(self->event_listeners_requests)) {
             *((uint8_t *) writer->current) = EVENT_LISTENERS_FIELD;
             writer->current += sizeof(uint16_t); // field id + reserved
             char *listeners_count_p = writer->current; // Pointer to the listeners count. Will be filled in later
@@ -797,16 +836,14 @@ static kaa_error_t kaa_event_read_listeners_response(kaa_event_manager_t *self,
     KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Received %u event listener(s) on %u request"
                                                                 , listeners_count, request_id);
 
-    kaa_list_node_t *request_node = kaa_list_find_next(kaa_list_begin(self->event_listeners_requests)
-                                                     , &find_listeners_request_by_id
-                                                     , &request_id);
-    if (request_node) {
+    kaa_event_listeners_request_t *request =
+            (kaa_event_listeners_request_t *) kaa_hash_table_find(self->event_listeners_requests, &request_id);
+    if (request) {
         KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Found event listeners callback with request id %u", request_id);
         if (reader->current + (listeners_count * KAA_ENDPOINT_ID_LENGTH) > reader->end) {
             KAA_LOG_ERROR(self->logger, KAA_ERR_READ_FAILED, "Failed to read endpoint ids for request id %u", request_id);
             return KAA_ERR_READ_FAILED;
         }
-        kaa_event_listeners_request_t *request = (kaa_event_listeners_request_t *) kaa_list_get_data(request_node);
         if (listeners_result == EVENT_LISTENERS_SUCCESS) {
             request->callback.on_event_listeners(request->callback.context, (const kaa_endpoint_id *) reader->current, listeners_count);
             KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Success event listeners response for request id %u", request_id);
@@ -814,7 +851,7 @@ static kaa_error_t kaa_event_read_listeners_response(kaa_event_manager_t *self,
             request->callback.on_event_listeners_failed(request->callback.context);
             KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Failed to find event listeners, request id %u", request_id);
         }
-        kaa_list_remove_at(self->event_listeners_requests, request_node, &destroy_event_listener_request);
+        kaa_hash_table_remove(self->event_listeners_requests, &request_id, &destroy_event_listener_request);
     } else {
         KAA_LOG_WARN(self->logger, KAA_ERR_NOT_FOUND, "Failed to find event listeners callback with request id %u", request_id);
     }
@@ -944,10 +981,10 @@ kaa_error_t kaa_event_manager_find_event_listeners(kaa_event_manager_t *self, co
     kaa_event_listeners_request_t *subscriber = create_event_listener_request(self, fqns, fqns_count, callback);
     KAA_RETURN_IF_NIL(subscriber, KAA_ERR_NOMEM);
 
-    kaa_list_node_t *request_it = kaa_list_push_front(self->event_listeners_requests, subscriber);
-    if (!request_it) {
+    kaa_error_t error = kaa_hash_table_insert(self->event_listeners_requests, subscriber, &destroy_event_listener_request);
+    if (error) {
         destroy_event_listener_request(subscriber);
-        return KAA_ERR_NOMEM;
+        return error;
     }
 
     ++self->event_listeners_request_id;
@@ -980,18 +1017,10 @@ kaa_error_t kaa_event_manager_add_on_event_callback(kaa_event_manager_t *self, c
         KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Adding callback for events, fqn '%s'", fqn);
         event_callback_pair_t *pair = create_event_callback_pair(fqn, callback);
         KAA_RETURN_IF_NIL(pair, KAA_ERR_NOMEM);
-        kaa_list_node_t *it = kaa_list_begin(self->event_callbacks);
-        while (it) {
-            event_callback_pair_t *data = (event_callback_pair_t *) kaa_list_get_data(it);
-            if (strcmp(fqn, data->fqn) == 0) {
-                kaa_list_set_data_at(it, pair, &kaa_event_destroy_callback_pair);
-                return KAA_ERR_NONE;
-            }
-            it = kaa_list_next(it);
-        }
-        if (!kaa_list_push_back(self->event_callbacks, pair)) {
+        kaa_error_t error = kaa_hash_table_insert(self->event_callbacks, pair, &kaa_event_destroy_callback_pair);
+        if (error) {
             kaa_event_destroy_callback_pair(pair);
-            return KAA_ERR_NOMEM;
+            return error;
         }
     } else {
         KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Adding global event callback");
@@ -1008,9 +1037,10 @@ kaa_error_t kaa_event_create_transaction(kaa_event_manager_t *self, kaa_event_bl
     event_transaction_t *new_transaction = create_transaction(*trx_id);
     KAA_RETURN_IF_NIL(new_transaction, KAA_ERR_NOMEM);
 
-    if (!kaa_list_push_back(self->transactions, new_transaction)) {
+    kaa_error_t error = kaa_hash_table_insert(self->transactions, new_transaction, &destroy_transaction);
+    if (error) {
         destroy_transaction(new_transaction);
-        return KAA_ERR_NOMEM;
+        return error;
     }
 
     KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Creating new events batch, id %zu", *trx_id);
@@ -1025,9 +1055,8 @@ kaa_error_t kaa_event_finish_transaction(kaa_event_manager_t *self, kaa_event_bl
 
     KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Going to send events from event batch, id %zu", trx_id);
 
-    kaa_list_node_t *it = kaa_list_find_next(kaa_list_begin(self->transactions), &transaction_search_by_id_predicate, &trx_id);
-    if (it) {
-        event_transaction_t *trx = kaa_list_get_data(it);
+    event_transaction_t *trx = (event_transaction_t *) kaa_hash_table_find(self->transactions, &trx_id);
+    if (trx) {
         bool need_sync = false;
         if (kaa_get_max_log_level(self->logger) >= KAA_LOG_LEVEL_TRACE) {
             KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Events batch with id %zu has %zu events", trx_id, kaa_list_get_size(trx->events));
@@ -1036,7 +1065,7 @@ kaa_error_t kaa_event_finish_transaction(kaa_event_manager_t *self, kaa_event_bl
             self->pending_events = kaa_lists_merge(self->pending_events, trx->events);
             need_sync = true;
         }
-        kaa_list_remove_at(self->transactions, it, &destroy_transaction);
+        kaa_hash_table_remove(self->transactions, &trx_id, &destroy_transaction);
 
         kaa_transport_channel_interface_t *channel =
                 kaa_channel_manager_get_transport_channel(self->channel_manager, event_sync_services[0]);
@@ -1057,7 +1086,7 @@ kaa_error_t kaa_event_remove_transaction(kaa_event_manager_t *self, kaa_event_bl
 
     KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Going to remove events batch with id %zu", trx_id);
 
-    kaa_error_t error = kaa_list_remove_first(self->transactions, &transaction_search_by_id_predicate, &trx_id, &destroy_transaction);
+    kaa_error_t error = kaa_hash_table_remove(self->transactions, &trx_id, &destroy_transaction);
     if (error) {
         KAA_LOG_WARN(self->logger, error, "Events batch with id %zu was not created before", trx_id);
     }
@@ -1094,8 +1123,8 @@ kaa_error_t kaa_event_manager_add_event_to_transaction(kaa_event_manager_t *self
 
     KAA_RETURN_IF_NIL(fqn, KAA_ERR_EVENT_BAD_FQN);
 
-    kaa_list_node_t *it = kaa_list_find_next(kaa_list_begin(self->transactions), &transaction_search_by_id_predicate, &trx_id);
-    if (it) {
+    event_transaction_t *trx = (event_transaction_t *) kaa_hash_table_find(self->transactions, &trx_id);
+    if (trx) {
         /**
          * KAA_CALLOC is really needed there.
          */
@@ -1113,7 +1142,6 @@ kaa_error_t kaa_event_manager_add_event_to_transaction(kaa_event_manager_t *self
             return error;
         }
 
-        event_transaction_t *trx = kaa_list_get_data(it);
         if (!kaa_list_push_back(trx->events, event)) {
             kaa_event_destroy(event);
             return KAA_ERR_NOMEM;
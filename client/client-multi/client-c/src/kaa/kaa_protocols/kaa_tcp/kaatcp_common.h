@@ -45,6 +45,8 @@ extern "C" {
 #define KAA_CONNECT_FLAGS          0x02
 #define KAA_CONNECT_HEADER_LENGTH  18
 
+#define KAATCP_CONNACK_COMPRESSION_FLAG 0x01
+
 #define KAA_CONNECT_KEY_AES_RSA    0x11
 #define KAA_CONNECT_SIGNATURE_SHA1 0x01
 
@@ -111,6 +113,7 @@ typedef enum {
 
 typedef struct {
     uint16_t return_code;
+    uint8_t  flags;
 } kaatcp_connack_t;
 
 typedef enum {
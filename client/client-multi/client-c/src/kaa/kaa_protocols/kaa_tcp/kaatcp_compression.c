@@ -0,0 +1,179 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#include <stdint.h>
+#include <zlib.h>
+
+#include "kaatcp_compression.h"
+
+#include "../../kaa_common.h"
+#include "../../utilities/kaa_mem.h"
+
+
+
+static voidpf kaatcp_zalloc(voidpf opaque, uInt items, uInt size)
+{
+    (void) opaque;
+    return KAA_CALLOC(items, size);
+}
+
+
+
+static void kaatcp_zfree(voidpf opaque, voidpf address)
+{
+    (void) opaque;
+    KAA_FREE(address);
+}
+
+
+
+kaatcp_error_t kaatcp_compress(const char *data, size_t data_size
+                             , char **compressed, size_t *compressed_size)
+{
+    KAA_RETURN_IF_NIL4(data, data_size, compressed, compressed_size, KAATCP_ERR_BAD_PARAM);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    stream.zalloc = kaatcp_zalloc;
+    stream.zfree = kaatcp_zfree;
+
+    if (deflateInit(&stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        return KAATCP_ERR_NOMEM;
+    }
+
+    /*
+     * The result is of no use unless it is smaller than the payload.
+     */
+    size_t buffer_size = data_size - 1;
+    char *buffer = buffer_size ? (char *) KAA_MALLOC(buffer_size) : NULL;
+    if (!buffer) {
+        deflateEnd(&stream);
+        return buffer_size ? KAATCP_ERR_NOMEM : KAATCP_ERR_BUFFER_NOT_ENOUGH;
+    }
+
+    stream.next_in = (Bytef *) data;
+    stream.avail_in = (uInt) data_size;
+    stream.next_out = (Bytef *) buffer;
+    stream.avail_out = (uInt) buffer_size;
+
+    int result = deflate(&stream, Z_FINISH);
+    size_t total_out = stream.total_out;
+    deflateEnd(&stream);
+
+    if (result != Z_STREAM_END) {
+        KAA_FREE(buffer);
+        return result == Z_OK || result == Z_BUF_ERROR ? KAATCP_ERR_BUFFER_NOT_ENOUGH : KAATCP_ERR_INVALID_STATE;
+    }
+
+    *compressed = buffer;
+    *compressed_size = total_out;
+    return KAATCP_ERR_NONE;
+}
+
+
+
+kaatcp_error_t kaatcp_decompress(const char *data, size_t data_size
+                               , char **decompressed, size_t *decompressed_size)
+{
+    KAA_RETURN_IF_NIL4(data, data_size, decompressed, decompressed_size, KAATCP_ERR_BAD_PARAM);
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(z_stream));
+    stream.zalloc = kaatcp_zalloc;
+    stream.zfree = kaatcp_zfree;
+
+    if (inflateInit(&stream) != Z_OK) {
+        return KAATCP_ERR_NOMEM;
+    }
+
+    /*
+     * Repetitive payloads are usually compressed several times, start with a buffer of that size
+     * and double it until the whole payload fits.
+     */
+    size_t buffer_size = 4 * data_size;
+    if (buffer_size > KAATCP_MAX_DECOMPRESSED_SIZE) {
+        buffer_size = KAATCP_MAX_DECOMPRESSED_SIZE;
+    }
+
+    char *buffer = (char *) KAA_MALLOC(buffer_size);
+    if (!buffer) {
+        inflateEnd(&stream);
+        return KAATCP_ERR_NOMEM;
+    }
+
+    stream.next_in = (Bytef *) data;
+    stream.avail_in = (uInt) data_size;
+    stream.next_out = (Bytef *) buffer;
+    stream.avail_out = (uInt) buffer_size;
+
+    kaatcp_error_t error_code = KAATCP_ERR_NONE;
+
+    for (;;) {
+        int result = inflate(&stream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END) {
+            break;
+        }
+
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+            error_code = KAATCP_ERR_INVALID_PROTOCOL;
+            break;
+        }
+
+        if (stream.avail_out) {
+            /* The input is over, but the stream isn't finished. */
+            error_code = KAATCP_ERR_INVALID_PROTOCOL;
+            break;
+        }
+
+        if (buffer_size >= KAATCP_MAX_DECOMPRESSED_SIZE) {
+            error_code = KAATCP_ERR_BUFFER_NOT_ENOUGH;
+            break;
+        }
+
+        size_t new_buffer_size = 2 * buffer_size;
+        if (new_buffer_size > KAATCP_MAX_DECOMPRESSED_SIZE) {
+            new_buffer_size = KAATCP_MAX_DECOMPRESSED_SIZE;
+        }
+
+        char *new_buffer = (char *) KAA_MALLOC(new_buffer_size);
+        if (!new_buffer) {
+            error_code = KAATCP_ERR_NOMEM;
+            break;
+        }
+
+        memcpy(new_buffer, buffer, buffer_size);
+        KAA_FREE(buffer);
+
+        buffer = new_buffer;
+        stream.next_out = (Bytef *) (buffer + buffer_size);
+        stream.avail_out = (uInt) (new_buffer_size - buffer_size);
+        buffer_size = new_buffer_size;
+    }
+
+    size_t total_out = stream.total_out;
+    inflateEnd(&stream);
+
+    if (error_code) {
+        KAA_FREE(buffer);
+        return error_code;
+    }
+
+    *decompressed = buffer;
+    *decompressed_size = total_out;
+    return KAATCP_ERR_NONE;
+}
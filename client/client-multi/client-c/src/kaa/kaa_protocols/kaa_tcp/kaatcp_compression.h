@@ -0,0 +1,82 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file kaatcp_compression.h
+ * @brief Compression of KAASYNC message payloads.
+ *
+ * A payload is compressed into the zlib format (RFC 1950) and the KAASYNC message carries
+ * @link KAA_SYNC_ZIPPED_BIT @endlink. The compression is applied before encryption.
+ *
+ * The server announces that it accepts compressed payloads with
+ * @link KAATCP_CONNACK_COMPRESSION_FLAG @endlink in CONNACK. The endpoint may compress its
+ * requests for the rest of the session, the server may compress its responses once it has
+ * received a compressed request.
+ */
+
+#ifndef KAATCP_COMPRESSION_H_
+#define KAATCP_COMPRESSION_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include "kaatcp_common.h"
+
+/**
+ * Payloads smaller than the threshold are sent uncompressed.
+ */
+#ifndef KAATCP_COMPRESSION_THRESHOLD
+#define KAATCP_COMPRESSION_THRESHOLD    256
+#endif
+
+/**
+ * The maximum size of a decompressed payload.
+ */
+#ifndef KAATCP_MAX_DECOMPRESSED_SIZE
+#define KAATCP_MAX_DECOMPRESSED_SIZE    MAX_MESSAGE_LENGTH
+#endif
+
+/**
+ * @brief Compresses the payload.
+ *
+ * @param[in]   data            The payload to compress.
+ * @param[in]   data_size       The size of the payload.
+ * @param[out]  compressed      The compressed payload. Must be freed with KAA_FREE().
+ * @param[out]  compressed_size The size of the compressed payload.
+ *
+ * @return KAATCP_ERR_BUFFER_NOT_ENOUGH if the compressed payload isn't smaller than the original one,
+ * the payload should be sent uncompressed in that case.
+ */
+kaatcp_error_t kaatcp_compress(const char *data, size_t data_size
+                             , char **compressed, size_t *compressed_size);
+
+/**
+ * @brief Decompresses the payload.
+ *
+ * @param[in]   data                The compressed payload.
+ * @param[in]   data_size           The size of the compressed payload.
+ * @param[out]  decompressed        The decompressed payload. Must be freed with KAA_FREE().
+ * @param[out]  decompressed_size   The size of the decompressed payload.
+ */
+kaatcp_error_t kaatcp_decompress(const char *data, size_t data_size
+                               , char **decompressed, size_t *decompressed_size);
+
+#ifdef __cplusplus
+}      /* extern "C" */
+#endif
+#endif /* KAATCP_COMPRESSION_H_ */
@@ -35,7 +35,7 @@ static kaatcp_error_t kaatcp_parser_message_done(kaatcp_parser_t *parser)
     switch (parser->message_type) {
         case KAATCP_MESSAGE_CONNACK:
             if (parser->handlers.connack_handler) {
-                kaatcp_connack_t connack = { *(parser->payload + 1) };
+                kaatcp_connack_t connack = { *(parser->payload + 1), *parser->payload };
                 parser->handlers.connack_handler(parser->handlers.handlers_context, connack);
             }
             break;
@@ -21,30 +21,56 @@
 #include "../../platform/ext_log_storage.h"
 
 #include "../../kaa_common.h"
-#include "../../collections/kaa_list.h"
+#include "../../collections/kaa_hash_table.h"
 #include "../../utilities/kaa_mem.h"
 #include "../../utilities/kaa_log.h"
 
 #include <assert.h>
+#include <stddef.h>
 
 
 
+typedef struct ext_log_record_t ext_log_record_t;
+
+/*
+ * The record header and its data are allocated as a single block by
+ * ext_log_storage_allocate_log_record_buffer().
+ */
+struct ext_log_record_t {
+    ext_log_record_t   *prev;        /**< Previous record in the order of adding */
+    ext_log_record_t   *next;        /**< Next record in the order of adding */
+    ext_log_record_t   *chain_prev;  /**< Previous record in the unmarked queue or in the bucket */
+    ext_log_record_t   *chain_next;  /**< Next record in the unmarked queue or in the bucket */
+    size_t              size;        /**< Size of data */
+    uint16_t            bucket_id;   /**< Bucket ID */
+    bool                mark;        /**< Mark of this record. True means that record is marked */
+    char                data[];      /**< Serialized data */
+};
+
+#define LOG_RECORD_FROM_DATA(data_p) \
+    ((ext_log_record_t *)((char *)(data_p) - offsetof(ext_log_record_t, data)))
+
+typedef struct {
+    ext_log_record_t    *head;
+    ext_log_record_t    *tail;
+} ext_log_record_chain_t;
+
 typedef struct {
-    char       *data;       /**< Serialized data */
-    size_t      size;       /**< Size of data */
-    uint16_t    bucket_id;  /**< Bucket ID */
-    bool        mark;       /**< Mark of this record. True means that record is marked */
-} ext_log_record_t;
+    uint16_t                  id;
+    ext_log_record_chain_t    records;    /**< Marked records of the bucket in the order of writing */
+} ext_log_bucket_t;
 
 typedef struct {
-    kaa_list_t         *logs;                  /**< List of @link ext_log_record_t @endlink */
-    kaa_list_node_t    *first_unmarked;        /**< Pointer to the first unmarked record position (with zero bucket_id) */
-    size_t             max_storage_size;       /**< Max size of the log storage */
-    size_t             total_occupied_size;    /**< Volume occupied by all logs */
-    size_t             unmarked_occupied_size ;/**< Volume occupied by unmarked logs */
-    size_t             unmarked_record_count;  /**< Number of unmarked logs */
-    size_t             shrinked_size;          /**< Percent of elder logs to delete in case max log storage size will be exceeded. */
-    kaa_logger_t      *logger;                 /**< Logger instance */
+    ext_log_record_t         *oldest;                 /**< The first record in the order of adding */
+    ext_log_record_t         *newest;                 /**< The last record in the order of adding */
+    ext_log_record_chain_t    unmarked;               /**< Queue of unmarked records */
+    kaa_hash_table_t         *buckets;                /**< Buckets with marked records by ID */
+    size_t                   max_storage_size;       /**< Max size of the log storage */
+    size_t                   total_occupied_size;    /**< Volume occupied by all logs */
+    size_t                   unmarked_occupied_size ;/**< Volume occupied by unmarked logs */
+    size_t                   unmarked_record_count;  /**< Number of unmarked logs */
+    size_t                   shrinked_size;          /**< Percent of elder logs to delete in case max log storage size will be exceeded. */
+    kaa_logger_t            *logger;                 /**< Logger instance */
 } ext_log_storage_memory_t;
 
 
@@ -88,11 +114,81 @@ kaa_error_t ext_log_storage_destroy(void *context);
 
 
 
-static void log_record_destroy(void *record_p)
+static const void *get_bucket_id(void *bucket_p)
+{
+    return &((ext_log_bucket_t *)bucket_p)->id;
+}
+
+static uint32_t hash_bucket_id(const void *bucket_id)
+{
+    return kaa_hash_table_bytes_hash(bucket_id, sizeof(uint16_t));
+}
+
+static bool match_bucket_id(const void *bucket_id, const void *other_bucket_id)
+{
+    return *(const uint16_t *)bucket_id == *(const uint16_t *)other_bucket_id;
+}
+
+static void chain_push_back(ext_log_record_chain_t *chain, ext_log_record_t *record)
 {
-    KAA_RETURN_IF_NIL(record_p, );
-    KAA_FREE(((ext_log_record_t*)record_p)->data);
-    KAA_FREE(record_p);
+    record->chain_prev = chain->tail;
+    record->chain_next = NULL;
+    if (chain->tail) {
+        chain->tail->chain_next = record;
+    } else {
+        chain->head = record;
+    }
+    chain->tail = record;
+}
+
+static void chain_remove(ext_log_record_chain_t *chain, ext_log_record_t *record)
+{
+    if (record->chain_prev) {
+        record->chain_prev->chain_next = record->chain_next;
+    } else {
+        chain->head = record->chain_next;
+    }
+
+    if (record->chain_next) {
+        record->chain_next->chain_prev = record->chain_prev;
+    } else {
+        chain->tail = record->chain_prev;
+    }
+}
+
+/*
+ * Unlinks the record from the storage and destroys it.
+ */
+static void remove_record(ext_log_storage_memory_t *self, ext_log_record_t *record)
+{
+    if (record->prev) {
+        record->prev->next = record->next;
+    } else {
+        self->oldest = record->next;
+    }
+
+    if (record->next) {
+        record->next->prev = record->prev;
+    } else {
+        self->newest = record->prev;
+    }
+
+    if (record->mark) {
+        ext_log_bucket_t *bucket = kaa_hash_table_find(self->buckets, &record->bucket_id);
+        if (bucket) {
+            chain_remove(&bucket->records, record);
+            if (!bucket->records.head) {
+                kaa_hash_table_remove(self->buckets, &bucket->id, NULL);
+            }
+        }
+    } else {
+        chain_remove(&self->unmarked, record);
+        self->unmarked_occupied_size -= record->size;
+        --self->unmarked_record_count;
+    }
+
+    self->total_occupied_size -= record->size;
+    KAA_FREE(record);
 }
 
 
@@ -105,15 +201,18 @@ kaa_error_t ext_unlimited_log_storage_create(void **log_storage_context_p, kaa_l
     KAA_RETURN_IF_NIL(log_storage, KAA_ERR_NOMEM);
 
     log_storage->logger                 = logger;
-    log_storage->first_unmarked         = NULL;
+    log_storage->oldest                 = NULL;
+    log_storage->newest                 = NULL;
+    log_storage->unmarked.head          = NULL;
+    log_storage->unmarked.tail          = NULL;
     log_storage->max_storage_size       = 0;
     log_storage->total_occupied_size    = 0;
     log_storage->unmarked_occupied_size = 0;
     log_storage->unmarked_record_count  = 0;
     log_storage->shrinked_size          = 0;
 
-    log_storage->logs = kaa_list_create();
-    if (!log_storage->logs) {
+    log_storage->buckets = kaa_hash_table_create(0, &get_bucket_id, &hash_bucket_id, &match_bucket_id);
+    if (!log_storage->buckets) {
         ext_log_storage_destroy(log_storage);
         return KAA_ERR_NOMEM;
     }
@@ -154,9 +253,10 @@ kaa_error_t ext_log_storage_allocate_log_record_buffer(void *context, kaa_log_re
 {
     KAA_RETURN_IF_NIL2(record, record->size, KAA_ERR_BADPARAM);
 
-    record->data = (char *) KAA_MALLOC(record->size * sizeof(char));
-    KAA_RETURN_IF_NIL(record->data, KAA_ERR_NOMEM);
+    ext_log_record_t *log_record = (ext_log_record_t *) KAA_MALLOC(sizeof(ext_log_record_t) + record->size * sizeof(char));
+    KAA_RETURN_IF_NIL(log_record, KAA_ERR_NOMEM);
 
+    record->data = log_record->data;
     return KAA_ERR_NONE;
 }
 
@@ -168,27 +268,10 @@ static kaa_error_t shrink_to_size(void *context, size_t size)
     ext_log_storage_memory_t *self = (ext_log_storage_memory_t *)context;
     size_t removed_record_count = 0;
 
-    kaa_list_node_t *it = kaa_list_begin(self->logs);
-    while (it && self->total_occupied_size > size) {
+    while (self->oldest && self->total_occupied_size > size) {
         // May delete records already marked. C'est la vie...
-        ext_log_record_t *log_record = kaa_list_get_data(it);
-
-        self->total_occupied_size -= log_record->size;
+        remove_record(self, self->oldest);
         ++removed_record_count;
-
-        kaa_list_node_t *next_it = kaa_list_next(it);
-        if (!log_record->mark) {
-            self->unmarked_occupied_size -= log_record->size;
-            --self->unmarked_record_count;
-            self->first_unmarked = next_it;
-        }
-
-        kaa_list_remove_at(self->logs, it, &log_record_destroy);
-        it = next_it;
-    }
-
-    if (kaa_list_get_size(self->logs) > 0) {
-        self->first_unmarked = NULL;
     }
 
     KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "%zu records forcibly removed", removed_record_count);
@@ -200,7 +283,7 @@ static kaa_error_t shrink_to_size(void *context, size_t size)
 
 kaa_error_t ext_log_storage_add_log_record(void *context, kaa_log_record_t *record)
 {
-    KAA_RETURN_IF_NIL2(context, record, KAA_ERR_BADPARAM);
+    KAA_RETURN_IF_NIL3(context, record, record->data, KAA_ERR_BADPARAM);
     ext_log_storage_memory_t *self = (ext_log_storage_memory_t *)context;
 
     if (self->max_storage_size && (self->total_occupied_size + record->size) > self->max_storage_size) {
@@ -210,19 +293,23 @@ kaa_error_t ext_log_storage_add_log_record(void *context, kaa_log_record_t *reco
         shrink_to_size(self, self->shrinked_size);
     }
 
-    ext_log_record_t *new_record = KAA_MALLOC(sizeof(*new_record));
-    KAA_RETURN_IF_NIL(new_record, KAA_ERR_NOMEM);
+    ext_log_record_t *new_record = LOG_RECORD_FROM_DATA(record->data);
 
-    new_record->data = record->data;
     new_record->size = record->size;
     new_record->bucket_id = record->bucket_id;
     assert(record->bucket_id);
     new_record->mark = false;
 
-    if (!kaa_list_push_back(self->logs, new_record)) {
-        KAA_FREE(new_record);
-        return KAA_ERR_NOMEM;
+    new_record->prev = self->newest;
+    new_record->next = NULL;
+    if (self->newest) {
+        self->newest->next = new_record;
+    } else {
+        self->oldest = new_record;
     }
+    self->newest = new_record;
+
+    chain_push_back(&self->unmarked, new_record);
 
     self->total_occupied_size += new_record->size;
     self->unmarked_occupied_size += new_record->size;
@@ -240,24 +327,12 @@ kaa_error_t ext_log_storage_deallocate_log_record_buffer(void *context, kaa_log_
 {
     KAA_RETURN_IF_NIL2(record, record->data, KAA_ERR_BADPARAM);
 
-    KAA_FREE(record->data);
+    KAA_FREE(LOG_RECORD_FROM_DATA(record->data));
     record->data = NULL;
     return KAA_ERR_NONE;
 }
 
-static bool find_by_bucket_id(void *log_record_p, void *bucket_id_p)
-{
-    KAA_RETURN_IF_NIL2(log_record_p, bucket_id_p, false);
-    ext_log_record_t *record = log_record_p;
 
-    // Iterate only marked log records
-    return record->mark && record->bucket_id == *(uint16_t *)bucket_id_p;
-}
-
-static bool find_marked(void *log_record_p, void *mark)
-{
-    return ((ext_log_record_t *)log_record_p)->mark == *(bool *)mark;
-}
 
 kaa_error_t ext_log_storage_write_next_record(void *context
                                             , char *buffer
@@ -268,18 +343,12 @@ kaa_error_t ext_log_storage_write_next_record(void *context
     KAA_RETURN_IF_NIL4(context, buffer, buffer_len, record_len, KAA_ERR_BADPARAM);
     ext_log_storage_memory_t *self = context;
 
-    kaa_list_node_t *it = self->first_unmarked;
-    if (!it) {
-        bool mark = false;
-        it = kaa_list_find_next(kaa_list_begin(self->logs), find_marked, &mark);
-    }
-
-    if (!it) {
+    ext_log_record_t *record = self->unmarked.head;
+    if (!record) {
         *record_len = 0;
         return KAA_ERR_NOT_FOUND;
     }
 
-    ext_log_record_t *record = kaa_list_get_data(it);
     *record_len = record->size;
     if (*record_len > buffer_len)
         return KAA_ERR_INSUFFICIENT_BUFFER;
@@ -288,15 +357,31 @@ kaa_error_t ext_log_storage_write_next_record(void *context
     assert(record->bucket_id);
     assert(!record->mark);
 
+    ext_log_bucket_t *bucket = kaa_hash_table_find(self->buckets, &record->bucket_id);
+    if (!bucket) {
+        bucket = (ext_log_bucket_t *) KAA_MALLOC(sizeof(ext_log_bucket_t));
+        KAA_RETURN_IF_NIL(bucket, KAA_ERR_NOMEM);
+
+        bucket->id = record->bucket_id;
+        bucket->records.head = bucket->records.tail = NULL;
+
+        kaa_error_t error = kaa_hash_table_insert(self->buckets, bucket, NULL);
+        if (error) {
+            KAA_FREE(bucket);
+            return error;
+        }
+    }
+
     memcpy(buffer, record->data, record->size);
 
     if (bucket_id) {
         *bucket_id = record->bucket_id;
     }
 
+    chain_remove(&self->unmarked, record);
+    chain_push_back(&bucket->records, record);
     record->mark = true;
 
-    self->first_unmarked = kaa_list_next(it);
     self->unmarked_record_count--;
     self->unmarked_occupied_size -= record->size;
 
@@ -310,18 +395,17 @@ kaa_error_t ext_log_storage_remove_by_bucket_id(void *context, uint16_t bucket_i
     KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
     ext_log_storage_memory_t *self = context;
 
-    kaa_list_node_t *it = kaa_list_find_next(kaa_list_begin(self->logs), find_by_bucket_id, &bucket_id);
-    KAA_RETURN_IF_NIL(it, KAA_ERR_NOT_FOUND);
-
-    while (it) {
-        self->total_occupied_size -= ((ext_log_record_t *)kaa_list_get_data(it))->size;
-
-        it = kaa_list_remove_at(self->logs, it, &log_record_destroy);
-        it = kaa_list_find_next(it, &find_by_bucket_id, &bucket_id);
-    }
-
-    if (!kaa_list_get_size(self->logs)) {
-        self->first_unmarked = NULL;
+    ext_log_bucket_t *bucket = kaa_hash_table_find(self->buckets, &bucket_id);
+    KAA_RETURN_IF_NIL(bucket, KAA_ERR_NOT_FOUND);
+
+    /*
+     * The bucket is removed along with its last record.
+     */
+    ext_log_record_t *record = bucket->records.head;
+    while (record) {
+        ext_log_record_t *next = record->chain_next;
+        remove_record(self, record);
+        record = next;
     }
 
     return KAA_ERR_NONE;
@@ -334,20 +418,30 @@ kaa_error_t ext_log_storage_unmark_by_bucket_id(void *context, uint16_t bucket_i
     KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
     ext_log_storage_memory_t *self = context;
 
-    kaa_list_node_t *it = kaa_list_find_next(kaa_list_begin(self->logs), find_by_bucket_id, &bucket_id);
-    KAA_RETURN_IF_NIL(it, KAA_ERR_NOT_FOUND);
+    ext_log_bucket_t *bucket = kaa_hash_table_find(self->buckets, &bucket_id);
+    KAA_RETURN_IF_NIL(bucket, KAA_ERR_NOT_FOUND);
 
-    while (it) {
-        ext_log_record_t *log_record = kaa_list_get_data(it);
-
-        log_record->mark = false;
+    ext_log_record_t *record = bucket->records.head;
+    while (record) {
+        record->mark = false;
         self->unmarked_record_count++;
-        self->unmarked_occupied_size += log_record->size;
+        self->unmarked_occupied_size += record->size;
+        record = record->chain_next;
+    }
 
-        it = kaa_list_find_next(it, &find_by_bucket_id, &bucket_id);
+    /*
+     * Records of the bucket are older than ones which have never been written,
+     * so they go to the head of the unmarked queue.
+     */
+    bucket->records.tail->chain_next = self->unmarked.head;
+    if (self->unmarked.head) {
+        self->unmarked.head->chain_prev = bucket->records.tail;
+    } else {
+        self->unmarked.tail = bucket->records.tail;
     }
+    self->unmarked.head = bucket->records.head;
 
-    self->first_unmarked = NULL;
+    kaa_hash_table_remove(self->buckets, &bucket_id, NULL);
 
     return KAA_ERR_NONE;
 }
@@ -374,7 +468,15 @@ kaa_error_t ext_log_storage_destroy(void *context)
 {
     KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
     ext_log_storage_memory_t *self = context;
-    kaa_list_destroy(self->logs, &log_record_destroy);
+
+    ext_log_record_t *record = self->oldest;
+    while (record) {
+        ext_log_record_t *next = record->next;
+        KAA_FREE(record);
+        record = next;
+    }
+
+    kaa_hash_table_destroy(self->buckets, NULL);
     KAA_FREE(self);
     return KAA_ERR_NONE;
 }
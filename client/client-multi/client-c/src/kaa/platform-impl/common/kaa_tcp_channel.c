@@ -28,6 +28,9 @@
 #include "../../utilities/kaa_buffer.h"
 #include "../../utilities/kaa_log.h"
 #include "../../kaa_protocols/kaa_tcp/kaatcp.h"
+#ifdef KAA_TCP_COMPRESSION
+#include "../../kaa_protocols/kaa_tcp/kaatcp_compression.h"
+#endif
 #include "../../platform/ext_system_logger.h"
 #include "../../platform/time.h"
 #include "../../kaa_platform_common.h"
@@ -110,6 +113,7 @@ typedef struct {
     uint16_t                       message_id;
     kaa_tcp_keepalive_t            keepalive;
     kaa_tcp_encrypt_t              encryption;
+    bool                           is_compression_enabled;
 } kaa_tcp_channel_t;
 
 extern kaa_error_t kaa_context_set_status_registered(kaa_context_t *kaa_context, bool is_registered);
@@ -147,6 +151,9 @@ static kaa_error_t kaa_tcp_write_buffer(kaa_tcp_channel_t *self);
 static char* kaa_tcp_write_pending_services_allocator_fn(void *context, size_t buffer_size);
 static kaa_error_t kaa_tcp_channel_ping(kaa_tcp_channel_t *self);
 static kaa_error_t kaa_tcp_channel_disconnect_internal(kaa_tcp_channel_t *self, kaatcp_disconnect_reason_t return_code);
+#ifdef KAA_TCP_COMPRESSION
+static void kaa_tcp_channel_compress_sync(kaa_tcp_channel_t *self, char **sync_buffer, size_t *sync_size, bool *zipped);
+#endif
 
 
 
@@ -807,6 +814,22 @@ kaa_error_t kaa_tcp_channel_get_max_timeout(kaa_transport_channel_interface_t *s
     return KAA_ERR_NONE;
 }
 
+kaa_error_t kaa_tcp_channel_get_keepalive_time(kaa_transport_channel_interface_t *self
+                                             , kaa_time_t *keepalive_time)
+{
+    KAA_RETURN_IF_NIL3(self, self->context, keepalive_time, KAA_ERR_BADPARAM);
+
+    kaa_tcp_channel_t *tcp_channel = (kaa_tcp_channel_t *) self->context;
+
+    if (tcp_channel->channel_state == KAA_TCP_CHANNEL_AUTHORIZED) {
+        *keepalive_time = tcp_channel->keepalive.last_sent_keepalive + KAA_TCP_CHANNEL_PING_TIMEOUT;
+    } else {
+        *keepalive_time = KAA_TIME() + KAA_TCP_CHANNEL_PING_TIMEOUT;
+    }
+
+    return KAA_ERR_NONE;
+}
+
 kaa_error_t kaa_tcp_channel_check_keepalive(kaa_transport_channel_interface_t *self)
 {
     KAA_RETURN_IF_NIL2(self, self->context, KAA_ERR_BADPARAM);
@@ -934,6 +957,12 @@ void kaa_tcp_channel_connack_message_callback(void *context, kaatcp_connack_t me
             KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] successfully authorized"
                                                                                 , channel->access_point.id);
 
+#ifdef KAA_TCP_COMPRESSION
+            channel->is_compression_enabled = message.flags & KAATCP_CONNACK_COMPRESSION_FLAG;
+            KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] payload compression is %s"
+                    , channel->access_point.id, channel->is_compression_enabled ? "enabled" : "disabled");
+#endif
+
         channel->keepalive.last_receive_keepalive = KAA_TIME();
         channel->keepalive.last_sent_keepalive
                 = channel->keepalive.last_receive_keepalive;
@@ -984,6 +1013,31 @@ void kaa_tcp_channel_kaasync_message_callback(void *context, kaatcp_kaasync_t *m
     uint8_t zipped = message->sync_header.flags & KAA_SYNC_ZIPPED_BIT;
     uint8_t encrypted = message->sync_header.flags & KAA_SYNC_ENCRYPTED_BIT;
 
+#ifdef KAA_TCP_COMPRESSION
+    if (zipped && !encrypted) {
+        char *decompressed = NULL;
+        size_t decompressed_size = 0;
+
+        kaatcp_error_t parser_error_code = kaatcp_decompress(message->sync_request, message->sync_request_size
+                                                           , &decompressed, &decompressed_size);
+        if (parser_error_code) {
+            KAA_LOG_ERROR(channel->logger, KAA_ERR_TCPCHANNEL_PARSER_ERROR, "Kaa TCP channel [0x%08X] failed to decompress server sync"
+                                                                                    , channel->access_point.id);
+        } else {
+            KAA_LOG_TRACE(channel->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] decompressed server sync (%zu -> %zu bytes)"
+                            , channel->access_point.id, message->sync_request_size, decompressed_size);
+
+            /*
+             * The message owns the payload, so the decompressed one replaces it.
+             */
+            KAA_FREE(message->sync_request);
+            message->sync_request = decompressed;
+            message->sync_request_size = decompressed_size;
+            zipped = 0;
+        }
+    }
+#endif
+
     if (!zipped && !encrypted) {
         kaa_error_t error_code =
                 kaa_platform_protocol_process_server_sync(channel->transport_context.kaa_context->platform_protocol
@@ -1083,6 +1137,9 @@ kaa_error_t kaa_tcp_channel_authorize(kaa_tcp_channel_t *self)
     size_t buffer_size = 0;
     size_t request_size = 0;
 
+    /* Compression is negotiated anew for each session. */
+    self->is_compression_enabled = false;
+
     kaa_serialize_info_t serialize_info;
     serialize_info.services = self->supported_services;
     serialize_info.services_count = self->supported_service_count;
@@ -1509,6 +1566,12 @@ kaa_error_t kaa_tcp_channel_write_pending_services(kaa_tcp_channel_t *self
 
     kaa_tcp_channel_delete_pending_services(self, service, services_count);
 
+#ifdef KAA_TCP_COMPRESSION
+    if (!error_code) {
+        kaa_tcp_channel_compress_sync(self, &sync_buffer, &sync_size, &zipped);
+    }
+#endif
+
     if (!error_code) {
         kaa_buffer_get_free_space(self->out_buffer, &buffer_size);
         if ( buffer_size < (sync_size + sizeof(kaatcp_kaasync_header_t)) ) {
@@ -1606,6 +1669,38 @@ kaa_error_t kaa_tcp_write_buffer(kaa_tcp_channel_t *self)
 
 
 
+#ifdef KAA_TCP_COMPRESSION
+/*
+ * Replace the client sync with its compressed version if the server accepts it and it pays off.
+ */
+void kaa_tcp_channel_compress_sync(kaa_tcp_channel_t *self, char **sync_buffer, size_t *sync_size, bool *zipped)
+{
+    if (!self->is_compression_enabled || *sync_size < KAATCP_COMPRESSION_THRESHOLD) {
+        return;
+    }
+
+    char *compressed = NULL;
+    size_t compressed_size = 0;
+
+    kaatcp_error_t parser_error_code = kaatcp_compress(*sync_buffer, *sync_size, &compressed, &compressed_size);
+    if (parser_error_code) {
+        KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] client sync is sent uncompressed (error %d)"
+                                                                    , self->access_point.id, parser_error_code);
+        return;
+    }
+
+    KAA_LOG_TRACE(self->logger, KAA_ERR_NONE, "Kaa TCP channel [0x%08X] compressed client sync (%zu -> %zu bytes)"
+                                                    , self->access_point.id, *sync_size, compressed_size);
+
+    KAA_FREE(*sync_buffer);
+    *sync_buffer = compressed;
+    *sync_size = compressed_size;
+    *zipped = true;
+}
+#endif
+
+
+
 /*
  * Memory allocator for kaa_platform_protocol_serialize_client_sync() method.
  */
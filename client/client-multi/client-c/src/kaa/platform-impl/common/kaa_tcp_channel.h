@@ -22,6 +22,7 @@
 #include "../../platform/ext_transport_channel.h"
 #include "../../platform/defaults.h"
 #include "../../platform/ext_tcp_utils.h"
+#include "../../platform/time.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -127,6 +128,21 @@ kaa_error_t kaa_tcp_channel_get_max_timeout(kaa_transport_channel_interface_t *s
                                           , uint16_t *max_timeout);
 
 
+/**
+ * @brief Retrieves the time the next keepalive check is due.
+ * Lets the caller wait for the keepalive with a precision finer than
+ * @link kaa_tcp_channel_get_max_timeout @endlink gives.
+ *
+ * @param[in]   channel           The channel instance.
+ * @param[out]  keepalive_time    The time (as @c KAA_TIME() returns) the keepalive has to be checked,
+ *                                the full keepalive period from now if the channel is not authorized yet.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_tcp_channel_get_keepalive_time(kaa_transport_channel_interface_t *self
+                                             , kaa_time_t *keepalive_time);
+
+
 /**
  * @brief Checks whether a keepalive timeout occurred. If so, sends a
  * keepalive message to the server.
@@ -0,0 +1,1199 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Persistent log storage for POSIX platforms.
+ *
+ * Records are appended to preallocated segment files in the storage directory.
+ * Each record carries a checksum, so a record torn by a crash is detected and
+ * the segment is cut at it on the next start. Only the newest segment is
+ * appended to: once it is full, it is sealed, i.e. its record counters are
+ * saved in its header, and a new segment is started. Therefore recovery reads
+ * headers of sealed segments and scans records of the newest one only.
+ *
+ * Marks of records are kept in memory, so records which were being uploaded
+ * at the moment of a crash are uploaded again. Records of uploaded buckets
+ * are flagged as removed in place, and a sealed segment file is deleted as
+ * a whole once all its records are removed.
+ */
+
+#ifndef KAA_DISABLE_FEATURE_LOGGING
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../../platform/platform.h"
+
+#include "../../platform/ext_log_storage.h"
+
+#include "../../kaa_common.h"
+#include "../../collections/kaa_hash_table.h"
+#include "../../utilities/kaa_mem.h"
+#include "../../utilities/kaa_log.h"
+
+
+
+#define EXT_LOG_SEGMENT_MAGIC          0x4B4C5347U   /* "KLSG" */
+#define EXT_LOG_SEGMENT_VERSION        1
+#define EXT_LOG_SEGMENT_NAME_PREFIX    "kaa_log_"
+#define EXT_LOG_SEGMENT_NAME_SUFFIX    ".seg"
+
+#define EXT_LOG_RECORD_ALIGNMENT       4
+#define EXT_LOG_RECORD_REMOVED         0x01
+
+#define EXT_LOG_CRC32_POLYNOMIAL       0xEDB88320U
+
+/*
+ * Fields are stored in the host byte order, as the files never leave the device.
+ */
+typedef struct {
+    uint32_t    magic;
+    uint32_t    version;
+    uint32_t    sequence_number;
+    uint32_t    is_sealed;        /**< Non-zero if no more records are appended to the segment */
+    uint32_t    end;              /**< Offset past the last record */
+    uint32_t    record_count;     /**< Number of records */
+    uint32_t    removed_count;    /**< Number of records flagged as removed */
+    uint32_t    reserved;
+    uint64_t    data_size;        /**< Size of data of all records */
+    uint64_t    removed_size;     /**< Size of data of records flagged as removed */
+} ext_log_segment_header_t;
+
+/*
+ * The header is followed by data. A header with zero size marks the end of records.
+ */
+typedef struct {
+    uint32_t    size;             /**< Size of data */
+    uint32_t    checksum;         /**< CRC-32 of the size, the bucket ID and data */
+    uint16_t    bucket_id;        /**< Bucket ID */
+    uint8_t     flags;            /**< Record flags, not covered by the checksum */
+    uint8_t     reserved;
+} ext_log_record_header_t;
+
+#define LOG_RECORD_HEADER_FROM_DATA(data_p) \
+    ((ext_log_record_header_t *)((char *)(data_p) - sizeof(ext_log_record_header_t)))
+
+typedef struct ext_log_segment_t ext_log_segment_t;
+
+struct ext_log_segment_t {
+    ext_log_segment_t           *prev;
+    ext_log_segment_t           *next;
+    char                        *map;         /**< Read-only mapping of the segment file */
+    int                          fd;          /**< Segment file descriptor */
+    size_t                       size;        /**< Size of the segment file */
+    size_t                       ref_count;   /**< Number of marked and rolled back records of the segment */
+    size_t                       ref_size;    /**< Size of data of marked and rolled back records */
+    ext_log_segment_header_t     header;      /**< Up-to-date copy of the segment header */
+};
+
+typedef struct ext_log_record_ref_t ext_log_record_ref_t;
+
+/*
+ * References the record which has been written at least once.
+ */
+struct ext_log_record_ref_t {
+    ext_log_record_ref_t    *next;
+    ext_log_segment_t       *segment;     /**< Segment of the record, NULL if the segment was dropped */
+    uint32_t                 offset;      /**< Offset of the record header in the segment */
+    uint32_t                 size;        /**< Size of data */
+};
+
+typedef struct {
+    ext_log_record_ref_t    *head;
+    ext_log_record_ref_t    *tail;
+} ext_log_record_chain_t;
+
+typedef struct {
+    uint16_t                  id;
+    ext_log_record_chain_t    records;    /**< Marked records of the bucket in the order of writing */
+} ext_log_bucket_t;
+
+typedef struct {
+    char                     *directory;              /**< Directory of segment files */
+    ext_log_segment_t        *oldest;                 /**< The first segment in the order of creation */
+    ext_log_segment_t        *newest;                 /**< The segment records are appended to */
+    ext_log_segment_t        *read_segment;           /**< Segment of the next record which has never been written */
+    size_t                   read_offset;            /**< Offset of the next record which has never been written */
+    ext_log_record_chain_t    rolled_back;            /**< Unmarked records which have been written before */
+    kaa_hash_table_t         *buckets;                /**< Buckets with marked records by ID */
+    uint32_t                 next_sequence_number;   /**< Sequence number of the next segment */
+    size_t                   segment_size;           /**< Size of new segment files */
+    size_t                   segment_count;          /**< Number of segment files */
+    size_t                   max_segment_count;      /**< Max number of segment files, 0 if unlimited */
+    size_t                   shrinked_segment_count; /**< Number of segments left when the storage is full */
+    size_t                   unmarked_occupied_size; /**< Volume occupied by unmarked logs */
+    size_t                   unmarked_record_count;  /**< Number of unmarked logs */
+    kaa_logger_t            *logger;                 /**< Logger instance */
+} ext_log_storage_file_t;
+
+
+
+/**
+ * @brief Creates the instance of the file log storage.
+ *
+ * Records left in the @c directory by the previous run are recovered.
+ *
+ * @param[out]    log_storage_context_p    The pointer to the new storage instance.
+ * @param[in]     logger                   The logger.
+ * @param[in]     directory                The directory of segment files. Created if doesn't exist.
+ * @param[in]     segment_size             The size of segment files.
+ * @param[in]     max_storage_size         The maximum storage size, 0 if unlimited.
+ * @param[in]     percent_to_delete        The percentage of elder logs to delete if the maximum storage size is exceeded.
+ *
+ * @return    Error code.
+ */
+kaa_error_t ext_file_log_storage_create(void **log_storage_context_p
+                                      , kaa_logger_t *logger
+                                      , const char *directory
+                                      , size_t segment_size
+                                      , size_t max_storage_size
+                                      , size_t percent_to_delete);
+
+
+
+/**
+ * @brief Creates the size-unlimited instance of the file log storage in the default directory.
+ *
+ * @param[out]    log_storage_context_p    The pointer to the new storage instance.
+ * @param[in]     logger                   The logger.
+ *
+ * @return    Error code.
+ */
+kaa_error_t ext_unlimited_log_storage_create(void **log_storage_context_p, kaa_logger_t *logger);
+
+
+
+/**
+ * @brief Creates the size-limited instance of the file log storage in the default directory.
+ *
+ * @param[out]    log_storage_context_p    The pointer to the new storage instance.
+ * @param[in]     logger                   The logger.
+ * @param[in]     storage_size             The maximum storage size.
+ * @param[in]     percent_to_delete        The percentage of elder logs to delete if the maximum storage size.
+ *
+ * @return    Error code.
+ */
+kaa_error_t ext_limited_log_storage_create(void **log_storage_context_p
+                                         , kaa_logger_t *logger
+                                         , size_t storage_size
+                                         , size_t percent_to_delete);
+
+
+
+/**
+ * @brief Destroys the instance of the file log storage. Stored records are kept in files.
+ *
+ * @param[in]   context The log storage context.
+ * @return    Error code.
+ */
+kaa_error_t ext_log_storage_destroy(void *context);
+
+
+
+static uint32_t crc32_table[256];
+
+static void crc32_init(void)
+{
+    if (crc32_table[1]) {
+        return;
+    }
+
+    uint32_t i = 0;
+    for (; i < 256; ++i) {
+        uint32_t crc = i;
+        int bit = 0;
+        for (; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ EXT_LOG_CRC32_POLYNOMIAL : crc >> 1;
+        }
+        crc32_table[i] = crc;
+    }
+}
+
+static uint32_t crc32_update(uint32_t crc, const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t *) data;
+    crc = ~crc;
+    while (size--) {
+        crc = crc32_table[(crc ^ *bytes++) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+static uint32_t record_checksum(const ext_log_record_header_t *header, const char *data)
+{
+    uint32_t crc = crc32_update(0, &header->size, sizeof(header->size));
+    crc = crc32_update(crc, &header->bucket_id, sizeof(header->bucket_id));
+    return crc32_update(crc, data, header->size);
+}
+
+static size_t record_footprint(size_t size)
+{
+    size += sizeof(ext_log_record_header_t);
+    return (size + EXT_LOG_RECORD_ALIGNMENT - 1) & ~((size_t) EXT_LOG_RECORD_ALIGNMENT - 1);
+}
+
+static const ext_log_record_header_t *record_at(const ext_log_segment_t *segment, size_t offset)
+{
+    return (const ext_log_record_header_t *)(segment->map + offset);
+}
+
+static size_t live_record_count(const ext_log_segment_t *segment)
+{
+    return segment->header.record_count - segment->header.removed_count;
+}
+
+static size_t live_data_size(const ext_log_segment_t *segment)
+{
+    return segment->header.data_size - segment->header.removed_size;
+}
+
+
+
+static const void *get_bucket_id(void *bucket_p)
+{
+    return &((ext_log_bucket_t *)bucket_p)->id;
+}
+
+static uint32_t hash_bucket_id(const void *bucket_id)
+{
+    return kaa_hash_table_bytes_hash(bucket_id, sizeof(uint16_t));
+}
+
+static bool match_bucket_id(const void *bucket_id, const void *other_bucket_id)
+{
+    return *(const uint16_t *)bucket_id == *(const uint16_t *)other_bucket_id;
+}
+
+static void chain_push_back(ext_log_record_chain_t *chain, ext_log_record_ref_t *ref)
+{
+    ref->next = NULL;
+    if (chain->tail) {
+        chain->tail->next = ref;
+    } else {
+        chain->head = ref;
+    }
+    chain->tail = ref;
+}
+
+static void destroy_bucket(void *bucket_p)
+{
+    ext_log_bucket_t *bucket = (ext_log_bucket_t *)bucket_p;
+    ext_log_record_ref_t *ref = bucket->records.head;
+    while (ref) {
+        ext_log_record_ref_t *next = ref->next;
+        KAA_FREE(ref);
+        ref = next;
+    }
+    KAA_FREE(bucket);
+}
+
+
+
+static void make_segment_path(ext_log_storage_file_t *self, uint32_t sequence_number, char *path)
+{
+    snprintf(path, PATH_MAX, "%s/" EXT_LOG_SEGMENT_NAME_PREFIX "%08x" EXT_LOG_SEGMENT_NAME_SUFFIX
+           , self->directory, sequence_number);
+}
+
+static bool parse_segment_name(const char *name, uint32_t *sequence_number)
+{
+    size_t prefix_length = strlen(EXT_LOG_SEGMENT_NAME_PREFIX);
+    if (strncmp(name, EXT_LOG_SEGMENT_NAME_PREFIX, prefix_length)) {
+        return false;
+    }
+
+    char *suffix = NULL;
+    unsigned long value = strtoul(name + prefix_length, &suffix, 16);
+    if (suffix != name + prefix_length + 8 || strcmp(suffix, EXT_LOG_SEGMENT_NAME_SUFFIX)) {
+        return false;
+    }
+
+    *sequence_number = (uint32_t) value;
+    return true;
+}
+
+/*
+ * Makes creation and deletion of segment files durable.
+ */
+static void sync_directory(ext_log_storage_file_t *self)
+{
+    int fd = open(self->directory, O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+static kaa_error_t write_segment_header(ext_log_storage_file_t *self, ext_log_segment_t *segment)
+{
+    if (pwrite(segment->fd, &segment->header, sizeof(ext_log_segment_header_t), 0) != sizeof(ext_log_segment_header_t)) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_WRITE_FAILED, "Failed to write header of log segment %08x: %s"
+                    , segment->header.sequence_number, strerror(errno));
+        return KAA_ERR_WRITE_FAILED;
+    }
+    return KAA_ERR_NONE;
+}
+
+static void close_segment(ext_log_segment_t *segment)
+{
+    if (segment->map) {
+        munmap(segment->map, segment->size);
+        segment->map = NULL;
+    }
+    if (segment->fd >= 0) {
+        close(segment->fd);
+        segment->fd = -1;
+    }
+}
+
+static void link_segment(ext_log_storage_file_t *self, ext_log_segment_t *segment)
+{
+    ext_log_segment_t *prev = self->newest;
+    while (prev && prev->header.sequence_number > segment->header.sequence_number) {
+        prev = prev->prev;
+    }
+
+    segment->prev = prev;
+    segment->next = prev ? prev->next : self->oldest;
+    if (segment->next) {
+        segment->next->prev = segment;
+    } else {
+        self->newest = segment;
+    }
+    if (prev) {
+        prev->next = segment;
+    } else {
+        self->oldest = segment;
+    }
+    ++self->segment_count;
+}
+
+/*
+ * Deletes the segment file. The cursor of records which have never been written
+ * must have been moved off the segment.
+ */
+static void delete_segment(ext_log_storage_file_t *self, ext_log_segment_t *segment)
+{
+    if (segment->prev) {
+        segment->prev->next = segment->next;
+    } else {
+        self->oldest = segment->next;
+    }
+    if (segment->next) {
+        segment->next->prev = segment->prev;
+    } else {
+        self->newest = segment->prev;
+    }
+    --self->segment_count;
+
+    close_segment(segment);
+
+    char path[PATH_MAX];
+    make_segment_path(self, segment->header.sequence_number, path);
+    if (unlink(path)) {
+        KAA_LOG_WARN(self->logger, KAA_ERR_WRITE_FAILED, "Failed to delete log segment '%s': %s", path, strerror(errno));
+    }
+
+    KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Deleted log segment %08x", segment->header.sequence_number);
+    KAA_FREE(segment);
+}
+
+static void move_cursor_off(ext_log_storage_file_t *self, ext_log_segment_t *segment)
+{
+    if (self->read_segment == segment) {
+        self->read_segment = segment->next;
+        self->read_offset = sizeof(ext_log_segment_header_t);
+    }
+}
+
+/*
+ * Deletes the sealed segment once all its records are removed, otherwise saves its counters.
+ */
+static void release_segment(ext_log_storage_file_t *self, ext_log_segment_t *segment)
+{
+    if (segment->header.is_sealed && !segment->ref_count && !live_record_count(segment)) {
+        move_cursor_off(self, segment);
+        delete_segment(self, segment);
+    } else {
+        write_segment_header(self, segment);
+    }
+}
+
+static kaa_error_t map_segment(ext_log_storage_file_t *self, ext_log_segment_t *segment)
+{
+    segment->map = mmap(NULL, segment->size, PROT_READ, MAP_SHARED, segment->fd, 0);
+    if (segment->map == MAP_FAILED) {
+        segment->map = NULL;
+        KAA_LOG_ERROR(self->logger, KAA_ERR_READ_FAILED, "Failed to map log segment %08x: %s"
+                    , segment->header.sequence_number, strerror(errno));
+        return KAA_ERR_READ_FAILED;
+    }
+    return KAA_ERR_NONE;
+}
+
+static kaa_error_t create_segment(ext_log_storage_file_t *self)
+{
+    ext_log_segment_t *segment = (ext_log_segment_t *) KAA_CALLOC(1, sizeof(ext_log_segment_t));
+    KAA_RETURN_IF_NIL(segment, KAA_ERR_NOMEM);
+
+    segment->size = self->segment_size;
+    segment->header.magic = EXT_LOG_SEGMENT_MAGIC;
+    segment->header.version = EXT_LOG_SEGMENT_VERSION;
+    segment->header.sequence_number = self->next_sequence_number;
+    segment->header.end = sizeof(ext_log_segment_header_t);
+
+    char path[PATH_MAX];
+    make_segment_path(self, segment->header.sequence_number, path);
+
+    segment->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (segment->fd < 0) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_WRITE_FAILED, "Failed to create log segment '%s': %s", path, strerror(errno));
+        KAA_FREE(segment);
+        return KAA_ERR_WRITE_FAILED;
+    }
+
+    /*
+     * Preallocation keeps appends from changing the file size, so they need no metadata updates.
+     * Not every file system supports it, the file is extended by zeros then.
+     */
+    if (posix_fallocate(segment->fd, 0, segment->size) && ftruncate(segment->fd, segment->size)) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_WRITE_FAILED, "Failed to allocate log segment '%s': %s", path, strerror(errno));
+        close_segment(segment);
+        unlink(path);
+        KAA_FREE(segment);
+        return KAA_ERR_WRITE_FAILED;
+    }
+
+    kaa_error_t error = write_segment_header(self, segment);
+    if (!error) {
+        fdatasync(segment->fd);
+        error = map_segment(self, segment);
+    }
+    if (error) {
+        close_segment(segment);
+        unlink(path);
+        KAA_FREE(segment);
+        return error;
+    }
+
+    sync_directory(self);
+
+    ++self->next_sequence_number;
+    link_segment(self, segment);
+    if (!self->read_segment) {
+        self->read_segment = segment;
+        self->read_offset = sizeof(ext_log_segment_header_t);
+    }
+
+    KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Created log segment %08x", segment->header.sequence_number);
+    return KAA_ERR_NONE;
+}
+
+static kaa_error_t seal_segment(ext_log_storage_file_t *self, ext_log_segment_t *segment)
+{
+    segment->header.is_sealed = 1;
+    kaa_error_t error = write_segment_header(self, segment);
+    if (!error) {
+        fdatasync(segment->fd);
+    }
+    return error;
+}
+
+/*
+ * Counts records of a segment which hasn't been sealed and cuts the segment
+ * at the first record torn by a crash.
+ */
+static void scan_segment(ext_log_storage_file_t *self, ext_log_segment_t *segment)
+{
+    ext_log_segment_header_t *header = &segment->header;
+    header->record_count = header->removed_count = 0;
+    header->data_size = header->removed_size = 0;
+
+    size_t offset = sizeof(ext_log_segment_header_t);
+    while (segment->size - offset >= sizeof(ext_log_record_header_t)) {
+        const ext_log_record_header_t *record = record_at(segment, offset);
+        if (!record->size || record_footprint(record->size) > segment->size - offset
+                || record->checksum != record_checksum(record, (const char *)(record + 1))) {
+            break;
+        }
+
+        ++header->record_count;
+        header->data_size += record->size;
+        if (record->flags & EXT_LOG_RECORD_REMOVED) {
+            ++header->removed_count;
+            header->removed_size += record->size;
+        }
+        offset += record_footprint(record->size);
+    }
+    header->end = offset;
+
+    /*
+     * Remains of a torn record are overwritten, otherwise they may look like a valid
+     * continuation of records appended after it.
+     */
+    size_t dirty_end = segment->size;
+    while (dirty_end > offset && !segment->map[dirty_end - 1]) {
+        --dirty_end;
+    }
+    if (dirty_end > offset) {
+        KAA_LOG_WARN(self->logger, KAA_ERR_BADDATA, "Log segment %08x is cut at offset %zu"
+                   , header->sequence_number, offset);
+
+        char zeros[256] = { 0 };
+        while (offset < dirty_end) {
+            size_t chunk = dirty_end - offset < sizeof(zeros) ? dirty_end - offset : sizeof(zeros);
+            if (pwrite(segment->fd, zeros, chunk, offset) != (ssize_t) chunk) {
+                break;
+            }
+            offset += chunk;
+        }
+    }
+}
+
+static void open_segment(ext_log_storage_file_t *self, uint32_t sequence_number)
+{
+    char path[PATH_MAX];
+    make_segment_path(self, sequence_number, path);
+
+    ext_log_segment_t *segment = (ext_log_segment_t *) KAA_CALLOC(1, sizeof(ext_log_segment_t));
+    KAA_RETURN_IF_NIL(segment, );
+
+    struct stat file_stat;
+    segment->fd = open(path, O_RDWR);
+    if (segment->fd < 0 || fstat(segment->fd, &file_stat)) {
+        KAA_LOG_WARN(self->logger, KAA_ERR_READ_FAILED, "Failed to open log segment '%s': %s", path, strerror(errno));
+        close_segment(segment);
+        KAA_FREE(segment);
+        return;
+    }
+
+    segment->size = file_stat.st_size;
+    segment->header.sequence_number = sequence_number;
+    if (segment->size >= sizeof(ext_log_segment_header_t) && segment->size <= UINT32_MAX) {
+        if (map_segment(self, segment)) {
+            close_segment(segment);
+            KAA_FREE(segment);
+            return;
+        }
+        memcpy(&segment->header, segment->map, sizeof(ext_log_segment_header_t));
+    }
+
+    /*
+     * A segment without a valid header has been never written to.
+     */
+    if (segment->header.magic != EXT_LOG_SEGMENT_MAGIC || segment->header.version != EXT_LOG_SEGMENT_VERSION
+            || segment->header.sequence_number != sequence_number || segment->header.end > segment->size) {
+        KAA_LOG_WARN(self->logger, KAA_ERR_BADDATA, "Deleting invalid log segment '%s'", path);
+        close_segment(segment);
+        unlink(path);
+        KAA_FREE(segment);
+        return;
+    }
+
+    if (!segment->header.is_sealed) {
+        scan_segment(self, segment);
+    }
+
+    link_segment(self, segment);
+}
+
+static kaa_error_t recover_segments(ext_log_storage_file_t *self)
+{
+    DIR *dir = opendir(self->directory);
+    if (!dir) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_READ_FAILED, "Failed to open log storage directory '%s': %s"
+                    , self->directory, strerror(errno));
+        return KAA_ERR_READ_FAILED;
+    }
+
+    struct dirent *entry = NULL;
+    while ((entry = readdir(dir))) {
+        uint32_t sequence_number = 0;
+        if (parse_segment_name(entry->d_name, &sequence_number)) {
+            open_segment(self, sequence_number);
+        }
+    }
+    closedir(dir);
+
+    /*
+     * Only the newest segment may be continued, the rest are sealed if the
+     * crash happened in between. Segments without live records aren't needed.
+     */
+    ext_log_segment_t *segment = self->oldest;
+    while (segment) {
+        ext_log_segment_t *next = segment->next;
+        if (next && !segment->header.is_sealed) {
+            seal_segment(self, segment);
+        }
+
+        if (segment->header.is_sealed && !live_record_count(segment)) {
+            delete_segment(self, segment);
+        } else {
+            self->unmarked_record_count += live_record_count(segment);
+            self->unmarked_occupied_size += live_data_size(segment);
+        }
+        segment = next;
+    }
+
+    self->read_segment = self->oldest;
+    self->read_offset = sizeof(ext_log_segment_header_t);
+
+    if (self->newest) {
+        self->next_sequence_number = self->newest->header.sequence_number + 1;
+        KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Recovered %zu log records from %zu segments"
+                   , self->unmarked_record_count, self->segment_count);
+    }
+
+    if (!self->newest || self->newest->header.is_sealed) {
+        return create_segment(self);
+    }
+    return KAA_ERR_NONE;
+}
+
+static void forget_segment_records(void *bucket_p, void *segment)
+{
+    ext_log_record_ref_t *ref = ((ext_log_bucket_t *)bucket_p)->records.head;
+    for (; ref; ref = ref->next) {
+        if (ref->segment == segment) {
+            ref->segment = NULL;
+        }
+    }
+}
+
+/*
+ * Drops the oldest segment even if its records are marked. C'est la vie...
+ */
+static void drop_oldest_segment(ext_log_storage_file_t *self)
+{
+    ext_log_segment_t *segment = self->oldest;
+    size_t dropped_count = 0;
+
+    if (self->read_segment == segment) {
+        size_t offset = self->read_offset;
+        while (offset < segment->header.end) {
+            const ext_log_record_header_t *record = record_at(segment, offset);
+            if (!(record->flags & EXT_LOG_RECORD_REMOVED)) {
+                self->unmarked_occupied_size -= record->size;
+                --self->unmarked_record_count;
+                ++dropped_count;
+            }
+            offset += record_footprint(record->size);
+        }
+        move_cursor_off(self, segment);
+    }
+
+    ext_log_record_ref_t *prev = NULL;
+    ext_log_record_ref_t *ref = self->rolled_back.head;
+    while (ref) {
+        ext_log_record_ref_t *next = ref->next;
+        if (ref->segment == segment) {
+            if (prev) {
+                prev->next = next;
+            } else {
+                self->rolled_back.head = next;
+            }
+            if (self->rolled_back.tail == ref) {
+                self->rolled_back.tail = prev;
+            }
+
+            self->unmarked_occupied_size -= ref->size;
+            --self->unmarked_record_count;
+            --segment->ref_count;
+            segment->ref_size -= ref->size;
+            ++dropped_count;
+            KAA_FREE(ref);
+        } else {
+            prev = ref;
+        }
+        ref = next;
+    }
+
+    /*
+     * Marked records of the dropped segment stay in their buckets until the
+     * buckets are removed or unmarked.
+     */
+    if (segment->ref_count) {
+        kaa_hash_table_for_each(self->buckets, &forget_segment_records, segment);
+    }
+
+    KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "%zu records forcibly removed", dropped_count);
+    delete_segment(self, segment);
+}
+
+static kaa_error_t start_new_segment(ext_log_storage_file_t *self)
+{
+    ext_log_segment_t *full_segment = self->newest;
+    kaa_error_t error = seal_segment(self, full_segment);
+    KAA_RETURN_IF_ERR(error);
+
+    if (!full_segment->ref_count && !live_record_count(full_segment)) {
+        move_cursor_off(self, full_segment);
+        delete_segment(self, full_segment);
+    }
+
+    if (self->max_segment_count && self->segment_count >= self->max_segment_count) {
+        KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Log storage is full (%zu segments). Going to delete elder logs"
+                   , self->segment_count);
+
+        while (self->oldest && self->segment_count > self->shrinked_segment_count) {
+            drop_oldest_segment(self);
+        }
+    }
+
+    return create_segment(self);
+}
+
+/*
+ * Returns the next record which has never been written, skipping ones
+ * removed before the storage was recovered.
+ */
+static const ext_log_record_header_t *find_unread_record(ext_log_storage_file_t *self)
+{
+    while (self->read_segment) {
+        ext_log_segment_t *segment = self->read_segment;
+        while (self->read_offset < segment->header.end) {
+            const ext_log_record_header_t *record = record_at(segment, self->read_offset);
+            if (!(record->flags & EXT_LOG_RECORD_REMOVED)) {
+                return record;
+            }
+            self->read_offset += record_footprint(record->size);
+        }
+
+        if (!segment->next) {
+            break;
+        }
+        move_cursor_off(self, segment);
+
+        /*
+         * Live records of the sealed segment are referenced now, which fixes
+         * its counters if they weren't saved because of a crash.
+         */
+        segment->header.removed_count = segment->header.record_count - segment->ref_count;
+        segment->header.removed_size = segment->header.data_size - segment->ref_size;
+        if (!segment->ref_count) {
+            release_segment(self, segment);
+        }
+    }
+    return NULL;
+}
+
+
+
+kaa_error_t ext_file_log_storage_create(void **log_storage_context_p
+                                      , kaa_logger_t *logger
+                                      , const char *directory
+                                      , size_t segment_size
+                                      , size_t max_storage_size
+                                      , size_t percent_to_delete)
+{
+    KAA_RETURN_IF_NIL3(log_storage_context_p, logger, directory, KAA_ERR_BADPARAM);
+
+    segment_size &= ~((size_t) EXT_LOG_RECORD_ALIGNMENT - 1);
+    if (segment_size <= sizeof(ext_log_segment_header_t) + sizeof(ext_log_record_header_t) || segment_size > UINT32_MAX) {
+        KAA_LOG_WARN(logger, KAA_ERR_BADPARAM, "Failed to create log storage: bad segment size %zu", segment_size);
+        return KAA_ERR_BADPARAM;
+    }
+
+    if (percent_to_delete > 100) {
+        KAA_LOG_WARN(logger, KAA_ERR_BADPARAM, "Failed to create log storage: percentage of logs "
+                                                    "to remove is more than 100%% (%zu%%)", percent_to_delete);
+        return KAA_ERR_BADPARAM;
+    }
+
+    if (mkdir(directory, S_IRWXU) && errno != EEXIST) {
+        KAA_LOG_ERROR(logger, KAA_ERR_WRITE_FAILED, "Failed to create log storage directory '%s': %s"
+                    , directory, strerror(errno));
+        return KAA_ERR_WRITE_FAILED;
+    }
+
+    ext_log_storage_file_t *log_storage = (ext_log_storage_file_t *) KAA_CALLOC(1, sizeof(ext_log_storage_file_t));
+    KAA_RETURN_IF_NIL(log_storage, KAA_ERR_NOMEM);
+
+    log_storage->logger       = logger;
+    log_storage->segment_size = segment_size;
+
+    if (max_storage_size) {
+        log_storage->max_segment_count = max_storage_size / segment_size;
+        if (!log_storage->max_segment_count) {
+            log_storage->max_segment_count = 1;
+        }
+
+        /*
+         * At least one segment is dropped to free space for the new one.
+         */
+        log_storage->shrinked_segment_count = (log_storage->max_segment_count * (100 - percent_to_delete)) / 100;
+        if (log_storage->shrinked_segment_count >= log_storage->max_segment_count) {
+            log_storage->shrinked_segment_count = log_storage->max_segment_count - 1;
+        }
+    }
+
+    crc32_init();
+
+    log_storage->directory = (char *) KAA_MALLOC(strlen(directory) + 1);
+    log_storage->buckets = kaa_hash_table_create(0, &get_bucket_id, &hash_bucket_id, &match_bucket_id);
+    if (!log_storage->directory || !log_storage->buckets) {
+        ext_log_storage_destroy(log_storage);
+        return KAA_ERR_NOMEM;
+    }
+    strcpy(log_storage->directory, directory);
+
+    kaa_error_t error = recover_segments(log_storage);
+    if (error) {
+        ext_log_storage_destroy(log_storage);
+        return error;
+    }
+
+    *log_storage_context_p = (void *)log_storage;
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_unlimited_log_storage_create(void **log_storage_context_p, kaa_logger_t *logger)
+{
+    return ext_file_log_storage_create(log_storage_context_p, logger, KAA_LOG_STORAGE_DIRECTORY
+                                     , KAA_LOG_STORAGE_SEGMENT_SIZE, 0, 0);
+}
+
+
+
+kaa_error_t ext_limited_log_storage_create(void **log_storage_context_p
+                                         , kaa_logger_t *logger
+                                         , size_t storage_size
+                                         , size_t percent_to_delete)
+{
+    KAA_RETURN_IF_NIL2(storage_size, percent_to_delete, KAA_ERR_BADPARAM);
+    return ext_file_log_storage_create(log_storage_context_p, logger, KAA_LOG_STORAGE_DIRECTORY
+                                     , KAA_LOG_STORAGE_SEGMENT_SIZE, storage_size, percent_to_delete);
+}
+
+
+
+kaa_error_t ext_log_storage_allocate_log_record_buffer(void *context, kaa_log_record_t *record)
+{
+    KAA_RETURN_IF_NIL2(record, record->size, KAA_ERR_BADPARAM);
+
+    ext_log_record_header_t *header = (ext_log_record_header_t *) KAA_MALLOC(sizeof(ext_log_record_header_t) + record->size * sizeof(char));
+    KAA_RETURN_IF_NIL(header, KAA_ERR_NOMEM);
+
+    record->data = (char *)(header + 1);
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_deallocate_log_record_buffer(void *context, kaa_log_record_t *record)
+{
+    KAA_RETURN_IF_NIL2(record, record->data, KAA_ERR_BADPARAM);
+
+    KAA_FREE(LOG_RECORD_HEADER_FROM_DATA(record->data));
+    record->data = NULL;
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_add_log_record(void *context, kaa_log_record_t *record)
+{
+    KAA_RETURN_IF_NIL3(context, record, record->data, KAA_ERR_BADPARAM);
+    ext_log_storage_file_t *self = (ext_log_storage_file_t *)context;
+
+    size_t footprint = record_footprint(record->size);
+    if (footprint > self->segment_size - sizeof(ext_log_segment_header_t)) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_BADPARAM, "Log record of %zu bytes doesn't fit log segment of %zu bytes"
+                    , record->size, self->segment_size);
+        return KAA_ERR_BADPARAM;
+    }
+
+    /*
+     * The storage is left without an unsealed segment if the new one failed to be created.
+     */
+    kaa_error_t error = KAA_ERR_NONE;
+    if (!self->newest || self->newest->header.is_sealed) {
+        error = create_segment(self);
+    } else if (footprint > self->newest->size - self->newest->header.end) {
+        error = start_new_segment(self);
+    }
+    KAA_RETURN_IF_ERR(error);
+
+    ext_log_segment_t *segment = self->newest;
+
+    /*
+     * The header and data are written at once, a record torn by a crash is detected
+     * by the checksum.
+     */
+    ext_log_record_header_t *header = LOG_RECORD_HEADER_FROM_DATA(record->data);
+    header->size = record->size;
+    header->bucket_id = record->bucket_id;
+    header->flags = 0;
+    header->reserved = 0;
+    header->checksum = record_checksum(header, record->data);
+
+    size_t size = sizeof(ext_log_record_header_t) + record->size;
+    if (pwrite(segment->fd, header, size, segment->header.end) != (ssize_t) size) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_WRITE_FAILED, "Failed to write log record to segment %08x: %s"
+                    , segment->header.sequence_number, strerror(errno));
+        return KAA_ERR_WRITE_FAILED;
+    }
+
+    segment->header.end += footprint;
+    ++segment->header.record_count;
+    segment->header.data_size += record->size;
+
+    self->unmarked_occupied_size += record->size;
+    self->unmarked_record_count++;
+
+    KAA_FREE(header);
+    record->data = NULL;
+    record->size = 0;
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_write_next_record(void *context
+                                            , char *buffer
+                                            , size_t buffer_len
+                                            , uint16_t *bucket_id
+                                            , size_t *record_len)
+{
+    KAA_RETURN_IF_NIL4(context, buffer, buffer_len, record_len, KAA_ERR_BADPARAM);
+    ext_log_storage_file_t *self = context;
+
+    /*
+     * Rolled back records are older than ones which have never been written.
+     */
+    ext_log_record_ref_t *ref = self->rolled_back.head;
+    const ext_log_record_header_t *record = ref ? record_at(ref->segment, ref->offset) : find_unread_record(self);
+    if (!record) {
+        *record_len = 0;
+        return KAA_ERR_NOT_FOUND;
+    }
+
+    *record_len = record->size;
+    if (*record_len > buffer_len)
+        return KAA_ERR_INSUFFICIENT_BUFFER;
+
+    if (!ref) {
+        ref = (ext_log_record_ref_t *) KAA_MALLOC(sizeof(ext_log_record_ref_t));
+        KAA_RETURN_IF_NIL(ref, KAA_ERR_NOMEM);
+
+        ref->segment = self->read_segment;
+        ref->offset = self->read_offset;
+        ref->size = record->size;
+    }
+
+    ext_log_bucket_t *bucket = kaa_hash_table_find(self->buckets, &record->bucket_id);
+    if (!bucket) {
+        bucket = (ext_log_bucket_t *) KAA_MALLOC(sizeof(ext_log_bucket_t));
+        kaa_error_t error = bucket ? KAA_ERR_NONE : KAA_ERR_NOMEM;
+        if (bucket) {
+            bucket->id = record->bucket_id;
+            bucket->records.head = bucket->records.tail = NULL;
+            error = kaa_hash_table_insert(self->buckets, bucket, NULL);
+        }
+
+        if (error) {
+            KAA_FREE(bucket);
+            if (ref != self->rolled_back.head) {
+                KAA_FREE(ref);
+            }
+            return error;
+        }
+    }
+
+    if (ref == self->rolled_back.head) {
+        self->rolled_back.head = ref->next;
+        if (!self->rolled_back.head) {
+            self->rolled_back.tail = NULL;
+        }
+    } else {
+        ++ref->segment->ref_count;
+        ref->segment->ref_size += ref->size;
+        self->read_offset += record_footprint(record->size);
+    }
+
+    memcpy(buffer, record + 1, record->size);
+
+    if (bucket_id) {
+        *bucket_id = record->bucket_id;
+    }
+
+    chain_push_back(&bucket->records, ref);
+
+    self->unmarked_record_count--;
+    self->unmarked_occupied_size -= record->size;
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_remove_by_bucket_id(void *context, uint16_t bucket_id)
+{
+    KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
+    ext_log_storage_file_t *self = context;
+
+    ext_log_bucket_t *bucket = kaa_hash_table_find(self->buckets, &bucket_id);
+    KAA_RETURN_IF_NIL(bucket, KAA_ERR_NOT_FOUND);
+
+    /*
+     * Records of a bucket are mostly adjacent, so counters of a segment
+     * are saved once per a run of its records.
+     */
+    ext_log_segment_t *touched_segment = NULL;
+    ext_log_record_ref_t *ref = bucket->records.head;
+    while (ref) {
+        ext_log_record_ref_t *next = ref->next;
+        ext_log_segment_t *segment = ref->segment;
+
+        if (segment) {
+            if (segment != touched_segment) {
+                if (touched_segment) {
+                    release_segment(self, touched_segment);
+                }
+                touched_segment = segment;
+            }
+
+            uint8_t flags = EXT_LOG_RECORD_REMOVED;
+            if (pwrite(segment->fd, &flags, sizeof(flags), ref->offset + offsetof(ext_log_record_header_t, flags)) != sizeof(flags)) {
+                KAA_LOG_WARN(self->logger, KAA_ERR_WRITE_FAILED, "Failed to remove log record from segment %08x: %s"
+                           , segment->header.sequence_number, strerror(errno));
+            }
+
+            ++segment->header.removed_count;
+            segment->header.removed_size += ref->size;
+            --segment->ref_count;
+            segment->ref_size -= ref->size;
+        }
+
+        KAA_FREE(ref);
+        ref = next;
+    }
+
+    if (touched_segment) {
+        release_segment(self, touched_segment);
+    }
+
+    bucket->records.head = bucket->records.tail = NULL;
+    kaa_hash_table_remove(self->buckets, &bucket_id, NULL);
+
+    return KAA_ERR_NONE;
+}
+
+
+
+kaa_error_t ext_log_storage_unmark_by_bucket_id(void *context, uint16_t bucket_id)
+{
+    KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
+    ext_log_storage_file_t *self = context;
+
+    ext_log_bucket_t *bucket = kaa_hash_table_find(self->buckets, &bucket_id);
+    KAA_RETURN_IF_NIL(bucket, KAA_ERR_NOT_FOUND);
+
+    /*
+     * Records of the bucket are older than ones which have never been written,
+     * so they go to the head of the rolled back queue. Records of dropped
+     * segments are gone.
+     */
+    ext_log_record_chain_t records = { NULL, NULL };
+    ext_log_record_ref_t *ref = bucket->records.head;
+    while (ref) {
+        ext_log_record_ref_t *next = ref->next;
+        if (ref->segment) {
+            chain_push_back(&records, ref);
+            self->unmarked_record_count++;
+            self->unmarked_occupied_size += ref->size;
+        } else {
+            KAA_FREE(ref);
+        }
+        ref = next;
+    }
+
+    if (records.head) {
+        records.tail->next = self->rolled_back.head;
+        if (!self->rolled_back.head) {
+            self->rolled_back.tail = records.tail;
+        }
+        self->rolled_back.head = records.head;
+    }
+
+    kaa_hash_table_remove(self->buckets, &bucket_id, NULL);
+
+    return KAA_ERR_NONE;
+}
+
+
+
+size_t ext_log_storage_get_total_size(const void *context)
+{
+    KAA_RETURN_IF_NIL(context, 0);
+    return ((ext_log_storage_file_t *)context)->unmarked_occupied_size;
+}
+
+
+
+size_t ext_log_storage_get_records_count(const void *context)
+{
+    KAA_RETURN_IF_NIL(context, 0);
+    return ((ext_log_storage_file_t *)context)->unmarked_record_count;
+}
+
+
+
+kaa_error_t ext_log_storage_destroy(void *context)
+{
+    KAA_RETURN_IF_NIL(context, KAA_ERR_BADPARAM);
+    ext_log_storage_file_t *self = context;
+
+    kaa_hash_table_destroy(self->buckets, &destroy_bucket);
+
+    ext_log_record_ref_t *ref = self->rolled_back.head;
+    while (ref) {
+        ext_log_record_ref_t *next = ref->next;
+        KAA_FREE(ref);
+        ref = next;
+    }
+
+    /*
+     * The newest segment is left unsealed to be continued by the next run.
+     */
+    ext_log_segment_t *segment = self->oldest;
+    while (segment) {
+        ext_log_segment_t *next = segment->next;
+        write_segment_header(self, segment);
+        fdatasync(segment->fd);
+        close_segment(segment);
+        KAA_FREE(segment);
+        segment = next;
+    }
+
+    KAA_FREE(self->directory);
+    KAA_FREE(self);
+    return KAA_ERR_NONE;
+}
+
+#endif
@@ -33,4 +33,11 @@
 
 #define KAA_MAX_LOG_MESSAGE_LENGTH          512
 
+#define KAA_CLIENT_RETRY_PERIOD_MS          100
+
+#define KAA_REACTOR_MAX_EVENTS              64
+
+#define KAA_LOG_STORAGE_DIRECTORY           "kaa_logs"
+#define KAA_LOG_STORAGE_SEGMENT_SIZE        (64 * 1024)
+
 #endif /* POSIX_DEFAULTS_H_ */
@@ -22,6 +22,7 @@
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
+#include <time.h>
 
 #include "../../kaa.h"
 #include "../../kaa_error.h"
@@ -35,6 +36,7 @@
 #include "../../platform-impl/common/kaa_tcp_channel.h"
 #include "../../platform-impl/common/ext_log_upload_strategies.h"
 #include "../../platform-impl/posix/posix_kaa_failover_strategy.h"
+#include "../../platform-impl/posix/posix_kaa_reactor_client.h"
 #include "../../kaa_logging.h"
 #include "../../kaa_channel_manager.h"
 
@@ -112,6 +114,8 @@ static kaa_error_t kaa_client_init_channel(kaa_client_t *kaa_client, kaa_client_
 static kaa_error_t kaa_client_deinit_channel(kaa_client_t *kaa_client);
 static kaa_error_t on_kaa_tcp_channel_event(void *context, kaa_tcp_channel_event_t event_type, kaa_fd_t fd);
 
+typedef kaa_error_t (*kaa_client_process_channel_fn)(kaa_client_t *kaa_client);
+
 #ifndef KAA_DISABLE_FEATURE_LOGGING
 static kaa_error_t kaa_log_collector_init(kaa_client_t *kaa_client);
 #endif
@@ -197,6 +201,57 @@ static uint16_t get_poll_timeout(kaa_client_t *kaa_client)
     return select_timeout;
 }
 
+/*
+ * Processes the socket readiness of the connected channel. Checks keepalive
+ * if the socket is neither readable nor writable.
+ */
+static kaa_error_t kaa_client_process_channel_events(kaa_client_t *kaa_client, bool readable, bool writable)
+{
+    kaa_error_t error_code = KAA_ERR_NONE;
+    int channel_fd = 0;
+
+    kaa_tcp_channel_get_descriptor(&kaa_client->channel, &channel_fd);
+
+    if (!readable && !writable) {
+        error_code = kaa_tcp_channel_check_keepalive(&kaa_client->channel);
+    } else {
+        if (readable) {
+            KAA_LOG_TRACE(kaa_client->kaa_context->logger, KAA_ERR_NONE,
+                    "Processing IN event for the client socket %d", channel_fd);
+            error_code = kaa_tcp_channel_process_event(&kaa_client->channel, FD_READ);
+            if (error_code) {
+                KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code,
+                        "Failed to process IN event for the client socket %d", channel_fd);
+            }
+        }
+        if (writable) {
+            KAA_LOG_TRACE(kaa_client->kaa_context->logger, KAA_ERR_NONE,
+                    "Processing OUT event for the client socket %d", channel_fd);
+
+            error_code = kaa_tcp_channel_process_event(&kaa_client->channel, FD_WRITE);
+            if (error_code) {
+                KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code,
+                        "Failed to process OUT event for the client socket %d", channel_fd);
+            }
+        }
+    }
+
+    return error_code;
+}
+
+static void kaa_client_check_channel_closed(kaa_client_t *kaa_client, kaa_error_t error_code)
+{
+    if (kaa_client->channel_socket_closed) {
+        KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
+                "Channel [0x%08X] connection terminated", kaa_client->channel_id);
+
+        kaa_client->channel_state = KAA_CLIENT_CHANNEL_STATE_NOT_CONNECTED;
+        if (error_code != KAA_ERR_EVENT_NOT_ATTACHED) {
+            kaa_client_deinit_channel(kaa_client);
+        }
+    }
+}
+
 kaa_error_t kaa_client_process_channel_connected(kaa_client_t *kaa_client)
 {
     KAA_RETURN_IF_NIL(kaa_client, KAA_ERR_BADPARAM);
@@ -221,43 +276,19 @@ kaa_error_t kaa_client_process_channel_connected(kaa_client_t *kaa_client)
 
     int poll_result = select(channel_fd + 1, &read_fds, &write_fds, NULL, &select_tv);
     if (poll_result == 0) {
-        error_code = kaa_tcp_channel_check_keepalive(&kaa_client->channel);
+        error_code = kaa_client_process_channel_events(kaa_client, false, false);
     } else if (poll_result > 0) {
         if (channel_fd >= 0) {
-            if (FD_ISSET(channel_fd, &read_fds)) {
-                KAA_LOG_TRACE(kaa_client->kaa_context->logger, KAA_ERR_NONE,
-                        "Processing IN event for the client socket %d", channel_fd);
-                error_code = kaa_tcp_channel_process_event(&kaa_client->channel, FD_READ);
-                if (error_code) {
-                    KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code,
-                            "Failed to process IN event for the client socket %d", channel_fd);
-                }
-            }
-            if (FD_ISSET(channel_fd, &write_fds)) {
-                KAA_LOG_TRACE(kaa_client->kaa_context->logger, KAA_ERR_NONE,
-                        "Processing OUT event for the client socket %d", channel_fd);
-
-                error_code = kaa_tcp_channel_process_event(&kaa_client->channel, FD_WRITE);
-                if (error_code) {
-                    KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code,
-                            "Failed to process OUT event for the client socket %d", channel_fd);
-                }
-            }
+            error_code = kaa_client_process_channel_events(kaa_client
+                                                         , FD_ISSET(channel_fd, &read_fds)
+                                                         , FD_ISSET(channel_fd, &write_fds));
         }
     } else {
         KAA_LOG_ERROR(kaa_client->kaa_context->logger, KAA_ERR_BAD_STATE, "Failed to poll descriptors: %s", strerror(errno));
         error_code = KAA_ERR_BAD_STATE;
     }
 
-    if (kaa_client->channel_socket_closed) {
-        KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
-                "Channel [0x%08X] connection terminated", kaa_client->channel_id);
-
-        kaa_client->channel_state = KAA_CLIENT_CHANNEL_STATE_NOT_CONNECTED;
-        if (error_code != KAA_ERR_EVENT_NOT_ATTACHED) {
-            kaa_client_deinit_channel(kaa_client);
-        }
-    }
+    kaa_client_check_channel_closed(kaa_client, error_code);
 
     return error_code;
 }
@@ -277,6 +308,61 @@ kaa_error_t kaa_client_process_channel_disconnected(kaa_client_t *kaa_client)
     return error_code;
 }
 
+/*
+ * Runs one iteration of the client state machine. The connected channel is
+ * processed by the given function, which may wait for the socket events.
+ */
+static kaa_error_t kaa_client_process_state(kaa_client_t *kaa_client, kaa_client_process_channel_fn process_connected)
+{
+    kaa_error_t error_code = KAA_ERR_NONE;
+
+    if (kaa_client->external_process_fn) {
+        if ((KAA_TIME() - kaa_client->external_process_last_call) >= kaa_client->external_process_max_delay) {
+            kaa_client->external_process_fn(kaa_client->external_process_context);
+        }
+        kaa_client->external_process_last_call = KAA_TIME();
+    }
+
+    //Check Kaa channel is ready to transmit something
+    if (kaa_process_failover(kaa_client->kaa_context)) {
+        kaa_client->boostrap_complete = false;
+    } else {
+        if (kaa_client->channel_id > 0) {
+            if (kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_NOT_CONNECTED) {
+                error_code = kaa_client_process_channel_disconnected(kaa_client);
+            } else  if (kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_CONNECTED) {
+                error_code = process_connected(kaa_client);
+                if (error_code == KAA_ERR_TIMEOUT)
+                    kaa_client_deinit_channel(kaa_client);
+            }
+        } else {
+            //No initialized channels
+            if (kaa_client->boostrap_complete) {
+                KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
+                            "Channel [0x%08X] Boostrap complete, reinitializing to Operations ...", kaa_client->channel_id);
+                kaa_client->boostrap_complete = false;
+                kaa_client_deinit_channel(kaa_client);
+                error_code = kaa_client_init_channel(kaa_client, KAA_CLIENT_CHANNEL_TYPE_OPERATIONS);
+                if (error_code == KAA_ERR_BAD_STATE) {
+                    kaa_client_deinit_channel(kaa_client);
+                    kaa_client->boostrap_complete = false;
+                }
+            } else {
+                KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
+                            "Channel [0x%08X] Operations error, reinitializing to Bootstrap ...", kaa_client->channel_id);
+                kaa_client->boostrap_complete = true;
+                kaa_client_deinit_channel(kaa_client);
+                kaa_client_init_channel(kaa_client, KAA_CLIENT_CHANNEL_TYPE_BOOTSTRAP);
+            }
+        }
+    }
+#ifndef KAA_DISABLE_FEATURE_LOGGING
+    ext_log_upload_timeout(kaa_client->kaa_context->log_collector);
+#endif
+
+    return error_code;
+}
+
 kaa_error_t kaa_client_start(kaa_client_t *kaa_client
                            , external_process_fn external_process
                            , void *external_process_context
@@ -284,11 +370,8 @@ kaa_error_t kaa_client_start(kaa_client_t *kaa_client
 {
     KAA_RETURN_IF_NIL(kaa_client, KAA_ERR_BADPARAM);
 
-    kaa_error_t error_code = kaa_check_readiness(kaa_client->kaa_context);
-    if (error_code != KAA_ERR_NONE) {
-        KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code, "Cannot start Kaa client: Kaa context is not fully initialized");
-        return error_code;
-    }
+    kaa_error_t error_code = kaa_client_check_readiness(kaa_client);
+    KAA_RETURN_IF_ERR(error_code);
 
     kaa_client->external_process_fn = external_process;
     kaa_client->external_process_context = external_process_context;
@@ -298,49 +381,7 @@ kaa_error_t kaa_client_start(kaa_client_t *kaa_client
     KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE, "Starting Kaa client...");
 
     while (kaa_client->operate) {
-        if (kaa_client->external_process_fn) {
-            if ((KAA_TIME() - kaa_client->external_process_last_call) >= kaa_client->external_process_max_delay) {
-                kaa_client->external_process_fn(kaa_client->external_process_context);
-            }
-            kaa_client->external_process_last_call = KAA_TIME();
-        }
-
-        //Check Kaa channel is ready to transmit something
-        if (kaa_process_failover(kaa_client->kaa_context)) {
-            kaa_client->boostrap_complete = false;
-        } else {
-            if (kaa_client->channel_id > 0) {
-                if (kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_NOT_CONNECTED) {
-                    error_code = kaa_client_process_channel_disconnected(kaa_client);
-                } else  if (kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_CONNECTED) {
-                    error_code = kaa_client_process_channel_connected(kaa_client);
-                    if (error_code == KAA_ERR_TIMEOUT)
-                        kaa_client_deinit_channel(kaa_client);
-                }
-            } else {
-                //No initialized channels
-                if (kaa_client->boostrap_complete) {
-                    KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
-                                "Channel [0x%08X] Boostrap complete, reinitializing to Operations ...", kaa_client->channel_id);
-                    kaa_client->boostrap_complete = false;
-                    kaa_client_deinit_channel(kaa_client);
-                    error_code = kaa_client_init_channel(kaa_client, KAA_CLIENT_CHANNEL_TYPE_OPERATIONS);
-                    if (error_code == KAA_ERR_BAD_STATE) {
-                        kaa_client_deinit_channel(kaa_client);
-                        kaa_client->boostrap_complete = false;
-                    }
-                } else {
-                    KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE,
-                                "Channel [0x%08X] Operations error, reinitializing to Bootstrap ...", kaa_client->channel_id);
-                    kaa_client->boostrap_complete = true;
-                    kaa_client_deinit_channel(kaa_client);
-                    kaa_client_init_channel(kaa_client, KAA_CLIENT_CHANNEL_TYPE_BOOTSTRAP);
-            }
-        }
-      }
-#ifndef KAA_DISABLE_FEATURE_LOGGING
-      ext_log_upload_timeout(kaa_client->kaa_context->log_collector);
-#endif
+        error_code = kaa_client_process_state(kaa_client, &kaa_client_process_channel_connected);
     }
     KAA_LOG_INFO(kaa_client->kaa_context->logger, KAA_ERR_NONE, "Kaa client stopped");
 
@@ -356,6 +397,110 @@ kaa_error_t kaa_client_stop(kaa_client_t *kaa_client)
     return kaa_stop(kaa_client->kaa_context);
 }
 
+/*
+ * The functions below run the client in the reactor (posix_kaa_reactor.c)
+ * instead of kaa_client_start().
+ */
+
+kaa_error_t kaa_client_check_readiness(kaa_client_t *kaa_client)
+{
+    KAA_RETURN_IF_NIL(kaa_client, KAA_ERR_BADPARAM);
+
+    kaa_error_t error_code = kaa_check_readiness(kaa_client->kaa_context);
+    if (error_code != KAA_ERR_NONE) {
+        KAA_LOG_ERROR(kaa_client->kaa_context->logger, error_code, "Cannot start Kaa client: Kaa context is not fully initialized");
+    }
+    return error_code;
+}
+
+static kaa_error_t kaa_client_check_keepalive(kaa_client_t *kaa_client)
+{
+    kaa_error_t error_code = kaa_client_process_channel_events(kaa_client, false, false);
+    kaa_client_check_channel_closed(kaa_client, error_code);
+    return error_code;
+}
+
+kaa_error_t kaa_client_process_timeout(kaa_client_t *kaa_client)
+{
+    KAA_RETURN_IF_NIL(kaa_client, KAA_ERR_BADPARAM);
+    return kaa_client_process_state(kaa_client, &kaa_client_check_keepalive);
+}
+
+kaa_error_t kaa_client_process_channel_ready(kaa_client_t *kaa_client, bool readable, bool writable)
+{
+    KAA_RETURN_IF_NIL(kaa_client, KAA_ERR_BADPARAM);
+
+    if (!kaa_client->channel_id || kaa_client->channel_state != KAA_CLIENT_CHANNEL_STATE_CONNECTED) {
+        return KAA_ERR_NONE;
+    }
+
+    kaa_error_t error_code = kaa_client_process_channel_events(kaa_client, readable, writable);
+    kaa_client_check_channel_closed(kaa_client, error_code);
+    if (error_code == KAA_ERR_TIMEOUT) {
+        kaa_client_deinit_channel(kaa_client);
+    }
+    return error_code;
+}
+
+void kaa_client_get_channel_interest(kaa_client_t *kaa_client, kaa_fd_t *fd, bool *readable, bool *writable)
+{
+    *fd = -1;
+    *readable = *writable = false;
+
+    if (kaa_client->channel_id && kaa_client->channel_state == KAA_CLIENT_CHANNEL_STATE_CONNECTED) {
+        kaa_tcp_channel_get_descriptor(&kaa_client->channel, fd);
+        if (*fd >= 0) {
+            *readable = kaa_tcp_channel_is_ready(&kaa_client->channel, FD_READ);
+            *writable = kaa_tcp_channel_is_ready(&kaa_client->channel, FD_WRITE);
+        }
+    }
+}
+
+/*
+ * Returns the milliseconds left till the given KAA_TIME() second starts.
+ */
+static uint32_t get_ms_till(kaa_time_t deadline)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    if (deadline <= now.tv_sec) {
+        return 0;
+    }
+    return (uint32_t) (deadline - now.tv_sec) * 1000 - (uint32_t) (now.tv_nsec / 1000000);
+}
+
+/*
+ * Returns the time in milliseconds to run the client state machine again:
+ * the moment the keepalive or the external process is due, counted to the
+ * millisecond rather than in the whole seconds of get_poll_timeout().
+ * The client without connected channel is retried sooner.
+ */
+uint32_t kaa_client_get_timeout(kaa_client_t *kaa_client)
+{
+    if (!kaa_client->channel_id || kaa_client->channel_state != KAA_CLIENT_CHANNEL_STATE_CONNECTED) {
+        return KAA_CLIENT_RETRY_PERIOD_MS;
+    }
+
+    kaa_time_t deadline = KAA_TIME() + KAA_TCP_CHANNEL_PING_TIMEOUT;
+    kaa_tcp_channel_get_keepalive_time(&kaa_client->channel, &deadline);
+
+    if (kaa_client->external_process_fn && kaa_client->external_process_max_delay > 0) {
+        kaa_time_t external_deadline = kaa_client->external_process_last_call + kaa_client->external_process_max_delay;
+        if (deadline > external_deadline) {
+            deadline = external_deadline;
+        }
+    }
+
+    uint32_t timeout = get_ms_till(deadline);
+
+    if ((KAA_BOOTSTRAP_RESPONSE_PERIOD > 0) && (timeout > KAA_BOOTSTRAP_RESPONSE_PERIOD * 1000)) {
+        timeout = KAA_BOOTSTRAP_RESPONSE_PERIOD * 1000;
+    }
+
+    return timeout;
+}
+
 kaa_error_t kaa_client_init_channel(kaa_client_t *kaa_client, kaa_client_channel_type_t channel_type)
 {
     KAA_RETURN_IF_NIL(kaa_client, KAA_ERR_BADPARAM);
@@ -0,0 +1,436 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "posix_kaa_reactor.h"
+#include "posix_kaa_reactor_client.h"
+#include "../../kaa_common.h"
+#include "../../platform/defaults.h"
+#include "../../platform/sock.h"
+#include "../../collections/kaa_hash_table.h"
+#include "../../utilities/kaa_mem.h"
+#include "../../utilities/kaa_log.h"
+
+
+
+#define KAA_REACTOR_MIN_TIMER_CAPACITY    16
+
+typedef struct {
+    kaa_client_t    *client;
+    kaa_fd_t         fd;            /**< Descriptor registered in the epoll set, -1 if none */
+    uint32_t         events;        /**< Registered epoll events */
+    uint64_t         deadline;      /**< Time of the next client timeout in milliseconds */
+    size_t           timer_index;   /**< Position in the timer heap */
+} kaa_reactor_client_t;
+
+struct kaa_reactor_t {
+    int                       epoll_fd;
+    int                       wakeup_fd;        /**< Event descriptor to interrupt waiting */
+    kaa_hash_table_t         *clients;          /**< Registered clients by the client pointer */
+    kaa_reactor_client_t    **timers;           /**< Min-heap of clients by deadline */
+    size_t                    timer_capacity;
+    bool                      is_stopped;
+    kaa_logger_t             *logger;
+};
+
+
+
+static uint64_t get_time_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static const void *get_client_key(void *data)
+{
+    return &((kaa_reactor_client_t *) data)->client;
+}
+
+static uint32_t hash_client_key(const void *key)
+{
+    return kaa_hash_table_bytes_hash(key, sizeof(kaa_client_t *));
+}
+
+static bool match_client_key(const void *key, const void *other_key)
+{
+    return *(kaa_client_t * const *) key == *(kaa_client_t * const *) other_key;
+}
+
+
+
+static void timer_swap(kaa_reactor_t *self, size_t i, size_t j)
+{
+    kaa_reactor_client_t *entry = self->timers[i];
+    self->timers[i] = self->timers[j];
+    self->timers[j] = entry;
+    self->timers[i]->timer_index = i;
+    self->timers[j]->timer_index = j;
+}
+
+static void timer_sift_up(kaa_reactor_t *self, size_t index)
+{
+    while (index) {
+        size_t parent = (index - 1) / 2;
+        if (self->timers[parent]->deadline <= self->timers[index]->deadline) {
+            break;
+        }
+        timer_swap(self, parent, index);
+        index = parent;
+    }
+}
+
+static void timer_sift_down(kaa_reactor_t *self, size_t index, size_t size)
+{
+    for (;;) {
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        if (left < size && self->timers[left]->deadline < self->timers[smallest]->deadline) {
+            smallest = left;
+        }
+        if (right < size && self->timers[right]->deadline < self->timers[smallest]->deadline) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            break;
+        }
+        timer_swap(self, smallest, index);
+        index = smallest;
+    }
+}
+
+static kaa_error_t timer_push(kaa_reactor_t *self, kaa_reactor_client_t *entry, size_t size)
+{
+    if (size == self->timer_capacity) {
+        size_t new_capacity = self->timer_capacity ? self->timer_capacity * 2 : KAA_REACTOR_MIN_TIMER_CAPACITY;
+        kaa_reactor_client_t **timers = (kaa_reactor_client_t **) KAA_MALLOC(new_capacity * sizeof(kaa_reactor_client_t *));
+        KAA_RETURN_IF_NIL(timers, KAA_ERR_NOMEM);
+
+        if (self->timers) {
+            memcpy(timers, self->timers, size * sizeof(kaa_reactor_client_t *));
+            KAA_FREE(self->timers);
+        }
+        self->timers = timers;
+        self->timer_capacity = new_capacity;
+    }
+
+    self->timers[size] = entry;
+    entry->timer_index = size;
+    timer_sift_up(self, size);
+    return KAA_ERR_NONE;
+}
+
+static void timer_remove(kaa_reactor_t *self, kaa_reactor_client_t *entry, size_t size)
+{
+    size_t index = entry->timer_index;
+    size_t last = size - 1;
+    if (index != last) {
+        timer_swap(self, index, last);
+        kaa_reactor_client_t *moved = self->timers[index];
+        timer_sift_up(self, index);
+        timer_sift_down(self, moved->timer_index, last);
+    }
+    self->timers[last] = NULL;
+}
+
+/*
+ * The channel may close its socket and open a new one with the same number while
+ * it is processed, so the descriptor is re-armed every time instead of comparing it.
+ */
+static void update_interest(kaa_reactor_t *self, kaa_reactor_client_t *entry)
+{
+    kaa_fd_t fd = -1;
+    bool readable = false;
+    bool writable = false;
+    kaa_client_get_channel_interest(entry->client, &fd, &readable, &writable);
+
+    if (entry->fd >= 0 && entry->fd != fd) {
+        /* The old descriptor is usually closed already and removed from the set with it. */
+        epoll_ctl(self->epoll_fd, EPOLL_CTL_DEL, entry->fd, NULL);
+        entry->fd = -1;
+    }
+
+    if (fd < 0) {
+        return;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = (readable ? EPOLLIN : 0) | (writable ? EPOLLOUT : 0);
+    event.data.ptr = entry;
+
+    int result = epoll_ctl(self->epoll_fd, entry->fd == fd ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event);
+    if (result && errno == ENOENT) {
+        result = epoll_ctl(self->epoll_fd, EPOLL_CTL_ADD, fd, &event);
+    } else if (result && errno == EEXIST) {
+        result = epoll_ctl(self->epoll_fd, EPOLL_CTL_MOD, fd, &event);
+    }
+
+    if (result) {
+        KAA_LOG_ERROR(self->logger, KAA_ERR_BAD_STATE, "Failed to watch descriptor %d: %s", fd, strerror(errno));
+        entry->fd = -1;
+        return;
+    }
+
+    entry->fd = fd;
+    entry->events = event.events;
+}
+
+static void reschedule(kaa_reactor_t *self, kaa_reactor_client_t *entry, uint64_t deadline)
+{
+    uint64_t old_deadline = entry->deadline;
+    entry->deadline = deadline;
+    if (deadline < old_deadline) {
+        timer_sift_up(self, entry->timer_index);
+    } else if (deadline > old_deadline) {
+        timer_sift_down(self, entry->timer_index, kaa_hash_table_get_size(self->clients));
+    }
+}
+
+static uint64_t get_next_deadline(kaa_reactor_client_t *entry, uint64_t now)
+{
+    uint32_t timeout = kaa_client_get_timeout(entry->client);
+    return now + (timeout ? timeout : 1);
+}
+
+static void process_channel_event(kaa_reactor_t *self, kaa_reactor_client_t *entry, uint32_t events)
+{
+    bool failed = events & (EPOLLHUP | EPOLLERR);
+    /* Errors are delivered as the registered direction, so the channel notices them. */
+    bool writable = (events & EPOLLOUT) || (failed && (entry->events & EPOLLOUT));
+    bool readable = (events & EPOLLIN) || (failed && !writable);
+
+    kaa_client_process_channel_ready(entry->client, readable, writable);
+    update_interest(self, entry);
+
+    /* The channel may have been closed, so the client needs to be retried sooner. */
+    uint64_t deadline = get_next_deadline(entry, get_time_ms());
+    if (deadline < entry->deadline) {
+        reschedule(self, entry, deadline);
+    }
+}
+
+static void process_timeouts(kaa_reactor_t *self)
+{
+    uint64_t now = get_time_ms();
+    while (kaa_hash_table_get_size(self->clients) && self->timers[0]->deadline <= now) {
+        kaa_reactor_client_t *entry = self->timers[0];
+        kaa_client_process_timeout(entry->client);
+        update_interest(self, entry);
+        reschedule(self, entry, get_next_deadline(entry, now));
+    }
+}
+
+
+
+kaa_error_t kaa_reactor_create(kaa_reactor_t **reactor_p, kaa_logger_t *logger)
+{
+    KAA_RETURN_IF_NIL2(reactor_p, logger, KAA_ERR_BADPARAM);
+
+    kaa_reactor_t *self = (kaa_reactor_t *) KAA_CALLOC(1, sizeof(kaa_reactor_t));
+    KAA_RETURN_IF_NIL(self, KAA_ERR_NOMEM);
+
+    self->logger = logger;
+    self->epoll_fd = -1;
+    self->wakeup_fd = -1;
+
+    self->clients = kaa_hash_table_create(KAA_REACTOR_MIN_TIMER_CAPACITY
+                                        , &get_client_key
+                                        , &hash_client_key
+                                        , &match_client_key);
+    if (!self->clients) {
+        kaa_reactor_destroy(self);
+        return KAA_ERR_NOMEM;
+    }
+
+    self->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    self->wakeup_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (self->epoll_fd < 0 || self->wakeup_fd < 0) {
+        KAA_LOG_ERROR(logger, KAA_ERR_BAD_STATE, "Failed to create reactor descriptors: %s", strerror(errno));
+        kaa_reactor_destroy(self);
+        return KAA_ERR_BAD_STATE;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    if (epoll_ctl(self->epoll_fd, EPOLL_CTL_ADD, self->wakeup_fd, &event)) {
+        KAA_LOG_ERROR(logger, KAA_ERR_BAD_STATE, "Failed to watch reactor wakeup descriptor: %s", strerror(errno));
+        kaa_reactor_destroy(self);
+        return KAA_ERR_BAD_STATE;
+    }
+
+    *reactor_p = self;
+    return KAA_ERR_NONE;
+}
+
+void kaa_reactor_destroy(kaa_reactor_t *self)
+{
+    KAA_RETURN_IF_NIL(self, );
+
+    if (self->clients) {
+        kaa_hash_table_destroy(self->clients, NULL);
+    }
+    if (self->timers) {
+        KAA_FREE(self->timers);
+    }
+    if (self->epoll_fd >= 0) {
+        close(self->epoll_fd);
+    }
+    if (self->wakeup_fd >= 0) {
+        close(self->wakeup_fd);
+    }
+    KAA_FREE(self);
+}
+
+kaa_error_t kaa_reactor_add_client(kaa_reactor_t *self, kaa_client_t *kaa_client)
+{
+    KAA_RETURN_IF_NIL2(self, kaa_client, KAA_ERR_BADPARAM);
+
+    if (kaa_hash_table_find(self->clients, &kaa_client)) {
+        return KAA_ERR_ALREADY_EXISTS;
+    }
+
+    kaa_error_t error_code = kaa_client_check_readiness(kaa_client);
+    KAA_RETURN_IF_ERR(error_code);
+
+    kaa_reactor_client_t *entry = (kaa_reactor_client_t *) KAA_CALLOC(1, sizeof(kaa_reactor_client_t));
+    KAA_RETURN_IF_NIL(entry, KAA_ERR_NOMEM);
+
+    entry->client = kaa_client;
+    entry->fd = -1;
+    entry->deadline = get_time_ms();
+
+    size_t size = kaa_hash_table_get_size(self->clients);
+    error_code = timer_push(self, entry, size);
+    if (error_code) {
+        KAA_FREE(entry);
+        return error_code;
+    }
+
+    error_code = kaa_hash_table_insert(self->clients, entry, NULL);
+    if (error_code) {
+        timer_remove(self, entry, size + 1);
+        KAA_FREE(entry);
+        return error_code;
+    }
+
+    KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Added client %p to reactor", (void *) kaa_client);
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_reactor_remove_client(kaa_reactor_t *self, kaa_client_t *kaa_client)
+{
+    KAA_RETURN_IF_NIL2(self, kaa_client, KAA_ERR_BADPARAM);
+
+    kaa_reactor_client_t *entry = (kaa_reactor_client_t *) kaa_hash_table_find(self->clients, &kaa_client);
+    KAA_RETURN_IF_NIL(entry, KAA_ERR_NOT_FOUND);
+
+    if (entry->fd >= 0) {
+        epoll_ctl(self->epoll_fd, EPOLL_CTL_DEL, entry->fd, NULL);
+    }
+    timer_remove(self, entry, kaa_hash_table_get_size(self->clients));
+
+    KAA_LOG_DEBUG(self->logger, KAA_ERR_NONE, "Removed client %p from reactor", (void *) kaa_client);
+    return kaa_hash_table_remove(self->clients, &kaa_client, NULL);
+}
+
+size_t kaa_reactor_get_client_count(kaa_reactor_t *self)
+{
+    KAA_RETURN_IF_NIL(self, 0);
+    return kaa_hash_table_get_size(self->clients);
+}
+
+kaa_error_t kaa_reactor_process(kaa_reactor_t *self, int32_t max_wait_ms)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+
+    int timeout = max_wait_ms < 0 ? -1 : max_wait_ms;
+    if (kaa_hash_table_get_size(self->clients)) {
+        uint64_t now = get_time_ms();
+        uint64_t deadline = self->timers[0]->deadline;
+        uint64_t remaining = deadline > now ? deadline - now : 0;
+        if (remaining > INT32_MAX) {
+            remaining = INT32_MAX;
+        }
+        if (timeout < 0 || (uint64_t) timeout > remaining) {
+            timeout = (int) remaining;
+        }
+    }
+
+    struct epoll_event events[KAA_REACTOR_MAX_EVENTS];
+    int count = epoll_wait(self->epoll_fd, events, KAA_REACTOR_MAX_EVENTS, timeout);
+    if (count < 0) {
+        if (errno != EINTR) {
+            KAA_LOG_ERROR(self->logger, KAA_ERR_BAD_STATE, "Failed to wait for reactor events: %s", strerror(errno));
+            return KAA_ERR_BAD_STATE;
+        }
+        count = 0;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        kaa_reactor_client_t *entry = (kaa_reactor_client_t *) events[i].data.ptr;
+        if (!entry) {
+            uint64_t value;
+            ssize_t result = read(self->wakeup_fd, &value, sizeof(value));
+            (void) result;
+            self->is_stopped = true;
+            continue;
+        }
+        process_channel_event(self, entry, events[i].events);
+    }
+
+    process_timeouts(self);
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_reactor_run(kaa_reactor_t *self)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+
+    KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Starting reactor with %zu clients"
+            , kaa_hash_table_get_size(self->clients));
+
+    kaa_error_t error_code = KAA_ERR_NONE;
+    while (!error_code && !self->is_stopped) {
+        error_code = kaa_reactor_process(self, -1);
+    }
+    self->is_stopped = false;
+
+    KAA_LOG_INFO(self->logger, KAA_ERR_NONE, "Reactor stopped");
+    return error_code;
+}
+
+kaa_error_t kaa_reactor_stop(kaa_reactor_t *self)
+{
+    KAA_RETURN_IF_NIL(self, KAA_ERR_BADPARAM);
+
+    uint64_t value = 1;
+    if (write(self->wakeup_fd, &value, sizeof(value)) != (ssize_t) sizeof(value) && errno != EAGAIN) {
+        return KAA_ERR_BAD_STATE;
+    }
+    return KAA_ERR_NONE;
+}
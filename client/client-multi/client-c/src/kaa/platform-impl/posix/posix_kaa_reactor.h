@@ -0,0 +1,112 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file posix_kaa_reactor.h
+ * @brief Runs many Kaa clients in one thread.
+ *
+ * The reactor waits for socket events of all its clients with one epoll set and
+ * keeps their timeouts in one timer heap, so it replaces @link kaa_client_start @endlink
+ * loops of the clients. A reactor and its clients must be used from one thread,
+ * clients are spread among several threads by running a reactor per thread.
+ */
+
+#ifndef POSIX_KAA_REACTOR_H_
+#define POSIX_KAA_REACTOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../../kaa_error.h"
+#include "../../platform/kaa_client.h"
+#include "../../utilities/kaa_log.h"
+
+typedef struct kaa_reactor_t kaa_reactor_t;
+
+/**
+ * @brief Creates the reactor without clients.
+ *
+ * @param[out]  reactor_p   Pointer to return the address of the new reactor.
+ * @param[in]   logger      Logger of the reactor.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_reactor_create(kaa_reactor_t **reactor_p, kaa_logger_t *logger);
+
+/**
+ * @brief Destroys the reactor. Clients are removed from it, but not destroyed.
+ */
+void kaa_reactor_destroy(kaa_reactor_t *reactor);
+
+/**
+ * @brief Registers the client in the reactor. The client is processed at the next iteration.
+ *
+ * @return Error code.
+ * @retval KAA_ERR_ALREADY_EXISTS   the client has been already added
+ */
+kaa_error_t kaa_reactor_add_client(kaa_reactor_t *reactor, kaa_client_t *kaa_client);
+
+/**
+ * @brief Unregisters the client. Must not be called while the reactor processes clients.
+ *
+ * @return Error code.
+ * @retval KAA_ERR_NOT_FOUND    the client hasn't been added
+ */
+kaa_error_t kaa_reactor_remove_client(kaa_reactor_t *reactor, kaa_client_t *kaa_client);
+
+/**
+ * @brief Returns the number of registered clients.
+ */
+size_t kaa_reactor_get_client_count(kaa_reactor_t *reactor);
+
+/**
+ * @brief Runs one iteration of the reactor.
+ *
+ * Waits for socket events until the nearest client timeout, but no longer than
+ * @c max_wait_ms, then processes the ready clients and the clients with expired timeouts.
+ *
+ * @param[in]   reactor         The reactor.
+ * @param[in]   max_wait_ms     Maximum time to wait in milliseconds, negative to wait for the nearest timeout.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_reactor_process(kaa_reactor_t *reactor, int32_t max_wait_ms);
+
+/**
+ * @brief Runs the reactor until @link kaa_reactor_stop @endlink is called.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_reactor_run(kaa_reactor_t *reactor);
+
+/**
+ * @brief Stops the reactor.
+ *
+ * Safe to call from any thread and from signal handlers, the waiting reactor is woken up.
+ *
+ * @return Error code.
+ */
+kaa_error_t kaa_reactor_stop(kaa_reactor_t *reactor);
+
+#ifdef __cplusplus
+}      /* extern "C" */
+#endif
+
+#endif /* POSIX_KAA_REACTOR_H_ */
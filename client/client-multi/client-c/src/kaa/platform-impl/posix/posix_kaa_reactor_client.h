@@ -0,0 +1,75 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * @file posix_kaa_reactor_client.h
+ * @brief Private interface the reactor drives a POSIX Kaa client through.
+ *
+ * Implemented in posix_kaa_client.c, used by posix_kaa_reactor.c only.
+ */
+
+#ifndef POSIX_KAA_REACTOR_CLIENT_H_
+#define POSIX_KAA_REACTOR_CLIENT_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../../kaa_error.h"
+#include "../../platform/kaa_client.h"
+#include "../../platform/sock.h"
+
+
+
+/**
+ * @brief Checks the client can be run.
+ *
+ * @return Error code, @c KAA_ERR_NONE if the Kaa context is fully initialized.
+ */
+kaa_error_t kaa_client_check_readiness(kaa_client_t *kaa_client);
+
+/**
+ * @brief Runs one iteration of the client state machine without waiting for the socket events.
+ */
+kaa_error_t kaa_client_process_timeout(kaa_client_t *kaa_client);
+
+/**
+ * @brief Processes the socket readiness of the connected channel.
+ */
+kaa_error_t kaa_client_process_channel_ready(kaa_client_t *kaa_client, bool readable, bool writable);
+
+/**
+ * @brief Retrieves the descriptor of the connected channel and the events it waits for.
+ *
+ * @param[out]  fd          The channel descriptor, -1 if the channel is not connected.
+ * @param[out]  readable    Whether the channel waits for incoming data.
+ * @param[out]  writable    Whether the channel has data to send.
+ */
+void kaa_client_get_channel_interest(kaa_client_t *kaa_client, kaa_fd_t *fd, bool *readable, bool *writable);
+
+/**
+ * @brief Returns the time in milliseconds left till the client state machine has to run again.
+ */
+uint32_t kaa_client_get_timeout(kaa_client_t *kaa_client);
+
+#ifdef __cplusplus
+}      /* extern "C" */
+#endif
+
+#endif /* POSIX_KAA_REACTOR_CLIENT_H_ */
@@ -51,6 +51,7 @@ cSRCS_$(d) :=  utilities/kaa_log.c \
                avro_src/encoding_binary.c \
                avro_src/io.c \
                collections/kaa_list.c \
+               collections/kaa_hash_table.c \
                gen/kaa_configuration_gen.c \
                gen/kaa_logging_gen.c \
                gen/kaa_profile_gen.c \
@@ -0,0 +1,294 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "../kaa_test.h"
+#include "collections/kaa_list.h"
+#include "collections/kaa_hash_table.h"
+#include "utilities/kaa_log.h"
+#include "utilities/kaa_mem.h"
+
+#define TEST_FQN_MAX_LENGTH    32
+
+static kaa_logger_t *logger = NULL;
+
+typedef struct {
+    char     fqn[TEST_FQN_MAX_LENGTH];
+    int32_t  value;
+} test_hash_table_node_t;
+
+static size_t destroyed_node_count = 0;
+
+static const void *test_get_key(void *data)
+{
+    return ((test_hash_table_node_t *) data)->fqn;
+}
+
+/*
+ * Puts all keys into the same chain to exercise probing and backward shift on removal.
+ */
+static uint32_t test_colliding_hash(const void *key)
+{
+    return 7;
+}
+
+static void test_destroy_node(void *data)
+{
+    ++destroyed_node_count;
+    KAA_FREE(data);
+}
+
+static void test_sum_values(void *data, void *context)
+{
+    *(int32_t *) context += ((test_hash_table_node_t *) data)->value;
+}
+
+static bool test_match_fqn(void *data, void *context)
+{
+    return strcmp(((test_hash_table_node_t *) data)->fqn, (const char *) context) == 0;
+}
+
+static test_hash_table_node_t *test_create_node(size_t index, int32_t value)
+{
+    test_hash_table_node_t *node = (test_hash_table_node_t *) KAA_MALLOC(sizeof(test_hash_table_node_t));
+    if (node) {
+        snprintf(node->fqn, TEST_FQN_MAX_LENGTH, "org.kaaproject.event.Event%zu", index);
+        node->value = value;
+    }
+    return node;
+}
+
+static kaa_hash_table_t *test_create_table(kaa_hash_table_hash_key hash)
+{
+    return kaa_hash_table_create(0, &test_get_key, hash, &kaa_hash_table_string_match);
+}
+
+void test_hash_table_create()
+{
+    KAA_TRACE_IN(logger);
+
+    ASSERT_NULL(kaa_hash_table_create(0, NULL, &kaa_hash_table_string_hash, &kaa_hash_table_string_match));
+
+    kaa_hash_table_t *table = test_create_table(&kaa_hash_table_string_hash);
+    ASSERT_NOT_NULL(table);
+    ASSERT_EQUAL(kaa_hash_table_get_size(table), 0);
+    ASSERT_NULL(kaa_hash_table_find(table, "org.kaaproject.event.Event0"));
+    ASSERT_EQUAL(kaa_hash_table_remove(table, "org.kaaproject.event.Event0", NULL), KAA_ERR_NOT_FOUND);
+    ASSERT_EQUAL(kaa_hash_table_insert(table, NULL, NULL), KAA_ERR_BADPARAM);
+
+    kaa_hash_table_destroy(table, NULL);
+
+    KAA_TRACE_OUT(logger);
+}
+
+static void test_insert_find_remove(kaa_hash_table_hash_key hash)
+{
+    kaa_hash_table_t *table = test_create_table(hash);
+    ASSERT_NOT_NULL(table);
+
+    const size_t node_count = 100;
+    size_t i = 0;
+    for (; i < node_count; ++i) {
+        ASSERT_EQUAL(kaa_hash_table_insert(table, test_create_node(i, i), NULL), KAA_ERR_NONE);
+    }
+    ASSERT_EQUAL(kaa_hash_table_get_size(table), node_count);
+
+    test_hash_table_node_t *key_node = test_create_node(0, 0);
+    ASSERT_NOT_NULL(key_node);
+
+    for (i = 0; i < node_count; ++i) {
+        snprintf(key_node->fqn, TEST_FQN_MAX_LENGTH, "org.kaaproject.event.Event%zu", i);
+        test_hash_table_node_t *node = (test_hash_table_node_t *) kaa_hash_table_find(table, key_node->fqn);
+        ASSERT_NOT_NULL(node);
+        ASSERT_EQUAL(node->value, (int32_t) i);
+    }
+
+    /*
+     * Remove every other element, the rest must be still reachable.
+     */
+    destroyed_node_count = 0;
+    for (i = 0; i < node_count; i += 2) {
+        snprintf(key_node->fqn, TEST_FQN_MAX_LENGTH, "org.kaaproject.event.Event%zu", i);
+        ASSERT_EQUAL(kaa_hash_table_remove(table, key_node->fqn, &test_destroy_node), KAA_ERR_NONE);
+    }
+    ASSERT_EQUAL(destroyed_node_count, node_count / 2);
+    ASSERT_EQUAL(kaa_hash_table_get_size(table), node_count / 2);
+
+    for (i = 0; i < node_count; ++i) {
+        snprintf(key_node->fqn, TEST_FQN_MAX_LENGTH, "org.kaaproject.event.Event%zu", i);
+        test_hash_table_node_t *node = (test_hash_table_node_t *) kaa_hash_table_find(table, key_node->fqn);
+        if (i % 2) {
+            ASSERT_NOT_NULL(node);
+            ASSERT_EQUAL(node->value, (int32_t) i);
+        } else {
+            ASSERT_NULL(node);
+        }
+    }
+
+    KAA_FREE(key_node);
+
+    destroyed_node_count = 0;
+    kaa_hash_table_clear(table, &test_destroy_node);
+    ASSERT_EQUAL(destroyed_node_count, node_count / 2);
+    ASSERT_EQUAL(kaa_hash_table_get_size(table), 0);
+
+    kaa_hash_table_destroy(table, NULL);
+}
+
+void test_hash_table_insert_find_remove()
+{
+    KAA_TRACE_IN(logger);
+
+    test_insert_find_remove(&kaa_hash_table_string_hash);
+
+    KAA_TRACE_OUT(logger);
+}
+
+void test_hash_table_collisions()
+{
+    KAA_TRACE_IN(logger);
+
+    test_insert_find_remove(&test_colliding_hash);
+
+    KAA_TRACE_OUT(logger);
+}
+
+void test_hash_table_replace()
+{
+    KAA_TRACE_IN(logger);
+
+    kaa_hash_table_t *table = test_create_table(&kaa_hash_table_string_hash);
+    ASSERT_NOT_NULL(table);
+
+    destroyed_node_count = 0;
+    ASSERT_EQUAL(kaa_hash_table_insert(table, test_create_node(1, 1), &test_destroy_node), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_hash_table_insert(table, test_create_node(1, 2), &test_destroy_node), KAA_ERR_NONE);
+
+    ASSERT_EQUAL(destroyed_node_count, 1);
+    ASSERT_EQUAL(kaa_hash_table_get_size(table), 1);
+
+    test_hash_table_node_t *node = (test_hash_table_node_t *) kaa_hash_table_find(table, "org.kaaproject.event.Event1");
+    ASSERT_NOT_NULL(node);
+    ASSERT_EQUAL(node->value, 2);
+
+    kaa_hash_table_destroy(table, NULL);
+
+    KAA_TRACE_OUT(logger);
+}
+
+void test_hash_table_for_each()
+{
+    KAA_TRACE_IN(logger);
+
+    kaa_hash_table_t *table = test_create_table(&kaa_hash_table_string_hash);
+    ASSERT_NOT_NULL(table);
+
+    int32_t expected_sum = 0;
+    size_t i = 0;
+    for (; i < 50; ++i) {
+        ASSERT_EQUAL(kaa_hash_table_insert(table, test_create_node(i, i), NULL), KAA_ERR_NONE);
+        expected_sum += i;
+    }
+
+    int32_t sum = 0;
+    kaa_hash_table_for_each(table, &test_sum_values, &sum);
+    ASSERT_EQUAL(sum, expected_sum);
+
+    kaa_hash_table_destroy(table, NULL);
+
+    KAA_TRACE_OUT(logger);
+}
+
+/*
+ * Compares lookups by FQN in the hash table with the linear search over a list.
+ */
+void test_hash_table_benchmark()
+{
+    KAA_TRACE_IN(logger);
+
+    const size_t node_count = 500;
+    const size_t lookup_count = 100000;
+
+    kaa_hash_table_t *table = test_create_table(&kaa_hash_table_string_hash);
+    ASSERT_NOT_NULL(table);
+    kaa_list_t *list = kaa_list_create();
+    ASSERT_NOT_NULL(list);
+
+    size_t i = 0;
+    for (; i < node_count; ++i) {
+        ASSERT_EQUAL(kaa_hash_table_insert(table, test_create_node(i, i), NULL), KAA_ERR_NONE);
+        ASSERT_NOT_NULL(kaa_list_push_back(list, test_create_node(i, i)));
+    }
+
+    char fqn[TEST_FQN_MAX_LENGTH];
+    size_t found_count = 0;
+
+    clock_t start = clock();
+    for (i = 0; i < lookup_count; ++i) {
+        snprintf(fqn, TEST_FQN_MAX_LENGTH, "org.kaaproject.event.Event%zu", i % node_count);
+        found_count += kaa_hash_table_find(table, fqn) ? 1 : 0;
+    }
+    clock_t table_time = clock() - start;
+    ASSERT_EQUAL(found_count, lookup_count);
+
+    found_count = 0;
+    start = clock();
+    for (i = 0; i < lookup_count; ++i) {
+        snprintf(fqn, TEST_FQN_MAX_LENGTH, "org.kaaproject.event.Event%zu", i % node_count);
+        found_count += kaa_list_find_next(kaa_list_begin(list), &test_match_fqn, fqn) ? 1 : 0;
+    }
+    clock_t list_time = clock() - start;
+    ASSERT_EQUAL(found_count, lookup_count);
+
+    printf("%zu lookups among %zu FQNs: hash table %.2f ms, list %.2f ms\n", lookup_count, node_count
+         , 1000.0 * table_time / CLOCKS_PER_SEC, 1000.0 * list_time / CLOCKS_PER_SEC);
+
+    kaa_hash_table_destroy(table, NULL);
+    kaa_list_destroy(list, NULL);
+
+    KAA_TRACE_OUT(logger);
+}
+
+int test_init()
+{
+    kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
+    if (error || !logger)
+        return error;
+
+    return 0;
+}
+
+int test_deinit(void)
+{
+    kaa_log_destroy(logger);
+
+    return 0;
+}
+
+KAA_SUITE_MAIN(HashTable, test_init, test_deinit
+        ,
+        KAA_TEST_CASE(hash_table_create, test_hash_table_create)
+        KAA_TEST_CASE(hash_table_insert_find_remove, test_hash_table_insert_find_remove)
+        KAA_TEST_CASE(hash_table_collisions, test_hash_table_collisions)
+        KAA_TEST_CASE(hash_table_replace, test_hash_table_replace)
+        KAA_TEST_CASE(hash_table_for_each, test_hash_table_for_each)
+        KAA_TEST_CASE(hash_table_benchmark, test_hash_table_benchmark)
+)
@@ -35,6 +35,9 @@
 #include "platform/ext_tcp_utils.h"
 #include "platform-impl/common/kaa_tcp_channel.h"
 #include "kaa_protocols/kaa_tcp/kaatcp_request.h"
+#ifdef KAA_TCP_COMPRESSION
+#include "kaa_protocols/kaa_tcp/kaatcp_compression.h"
+#endif
 
 #define ACCESS_POINT_SOCKET_FD 5
 
@@ -55,6 +58,9 @@ typedef struct {
     bool        socket_disconnected_closed;
     bool        socket_disconnected_callback;
     bool        bootstrap_manager_on_access_point_failed;
+    bool        compression_scenario;
+    bool        kaasync_written;
+    bool        kaasync_compressed;
     kaa_fd_t    fd;
 } set_access_point_info_t;
 
@@ -74,6 +80,19 @@ static char KAASYNC_BOOTSTRAP[] = {0xF0, 0x13, 0x00, 0x06, 'K', 'a','a','t','c',
 
 static char *KAASYNC_BOOTSTRAP_MESSAGE = "Kaatcp";
 
+#ifdef KAA_TCP_COMPRESSION
+/* CONNACK with the compression flag set */
+static char CONNACK_COMPRESSION[] = {0x20, 0x02, KAATCP_CONNACK_COMPRESSION_FLAG, 0x01};
+
+#define COMPRESSIBLE_SYNC_SIZE 1024
+
+static char COMPRESSIBLE_SYNC[COMPRESSIBLE_SYNC_SIZE];
+
+/* KAASYNC response with the zipped payload, it is built by the test */
+static char KAASYNC_ZIPPED[128];
+static size_t KAASYNC_ZIPPED_SIZE = 0;
+#endif
+
 static char DISCONNECT_MESSAGE[] = {0xE0, 0x02, 0x00, 0x00};
 
 static char CONNECT_HEAD[] = {0x35, 0x46};
@@ -370,6 +389,88 @@ void test_bootstrap_sync_success(void)
     KAA_FREE(channel);
 }
 
+#ifdef KAA_TCP_COMPRESSION
+/*
+ * Test compression of KAASYNC payloads.
+ * 1. Set access point, check CONNECT and receive CONNACK which enables compression.
+ * 2. Sync services, check the KAASYNC request is zipped.
+ * 3. Receive zipped KAASYNC response, check it is processed.
+ */
+void test_operation_sync_compressed(void)
+{
+    KAA_TRACE_IN(logger);
+
+    kaa_error_t error_code;
+
+    kaa_transport_channel_interface_t *channel = NULL;
+    channel = KAA_CALLOC(1,sizeof(kaa_transport_channel_interface_t));
+
+    kaa_service_t operation_services[] = {KAA_SERVICE_PROFILE};
+
+    error_code = kaa_tcp_channel_create(channel,logger,operation_services,1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    //Prepare the server response: zipped payload which starts with the expected message
+    memset(COMPRESSIBLE_SYNC, 'K', COMPRESSIBLE_SYNC_SIZE);
+    memcpy(COMPRESSIBLE_SYNC, KAASYNC_BOOTSTRAP_MESSAGE, strlen(KAASYNC_BOOTSTRAP_MESSAGE));
+
+    char *compressed = NULL;
+    size_t compressed_size = 0;
+    kaatcp_error_t parser_error_code = kaatcp_compress(COMPRESSIBLE_SYNC, COMPRESSIBLE_SYNC_SIZE, &compressed, &compressed_size);
+    ASSERT_EQUAL(parser_error_code, KAATCP_ERR_NONE);
+
+    kaatcp_kaasync_t kaasync_response;
+    parser_error_code = kaatcp_fill_kaasync_message(compressed, compressed_size, 1, true, false, &kaasync_response);
+    ASSERT_EQUAL(parser_error_code, KAATCP_ERR_NONE);
+    KAASYNC_ZIPPED_SIZE = sizeof(KAASYNC_ZIPPED);
+    parser_error_code = kaatcp_get_request_kaasync(&kaasync_response, KAASYNC_ZIPPED, &KAASYNC_ZIPPED_SIZE);
+    ASSERT_EQUAL(parser_error_code, KAATCP_ERR_NONE);
+    KAA_FREE(compressed);
+
+    //The server doesn't set the request bit
+    KAASYNC_ZIPPED[KAASYNC_ZIPPED_SIZE - compressed_size - 1] &= ~KAA_SYNC_REQUEST_BIT;
+
+    test_set_access_point(channel);
+    access_point_test_info.compression_scenario = true;
+
+    //Connect and send CONNECT message
+    error_code = kaa_tcp_channel_process_event(channel,FD_WRITE);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(access_point_test_info.request_connect, true);
+
+    error_code = kaa_tcp_channel_process_event(channel,FD_WRITE);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(access_point_test_info.auth_packet_written, true);
+
+    //Read CONNACK message which enables compression
+    error_code = kaa_tcp_channel_process_event(channel,FD_READ);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(access_point_test_info.connack_read, true);
+
+    //Sync services, the request must be zipped
+    error_code = channel->sync_handler(channel->context, operation_services, 1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    CHECK_SOCKET_RW(channel,true,true);
+
+    error_code = kaa_tcp_channel_process_event(channel,FD_WRITE);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(access_point_test_info.kaasync_written, true);
+    ASSERT_EQUAL(access_point_test_info.kaasync_compressed, true);
+
+    //Read zipped KAASYNC message
+    error_code = kaa_tcp_channel_process_event(channel,FD_READ);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(access_point_test_info.kaasync_read, true);
+    ASSERT_EQUAL(access_point_test_info.kaasync_processed, true);
+
+    channel->destroy(channel->context);
+
+    KAA_TRACE_OUT(logger);
+
+    KAA_FREE(channel);
+}
+#endif
+
 /* Internal functions */
 
 void test_check_bootstrap_sync(kaa_transport_channel_interface_t *channel)
@@ -555,6 +656,16 @@ ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_read(kaa_fd_t fd, char *buff
     if (access_point_test_info.socket_connecting_error_scenario) {
         *bytes_read = 0;
         return KAA_TCP_SOCK_IO_ERROR;
+#ifdef KAA_TCP_COMPRESSION
+    } else if (access_point_test_info.compression_scenario && !access_point_test_info.connack_read) {
+        memcpy(buffer,CONNACK_COMPRESSION,sizeof(CONNACK_COMPRESSION));
+        *bytes_read = sizeof(CONNACK_COMPRESSION);
+        access_point_test_info.connack_read = true;
+    } else if (access_point_test_info.compression_scenario && !access_point_test_info.kaasync_read) {
+        memcpy(buffer,KAASYNC_ZIPPED,KAASYNC_ZIPPED_SIZE);
+        *bytes_read = KAASYNC_ZIPPED_SIZE;
+        access_point_test_info.kaasync_read = true;
+#endif
     } else if (!access_point_test_info.connack_read) {
         memcpy(buffer,CONNACK,sizeof(CONNACK));
         *bytes_read = sizeof(CONNACK);
@@ -588,6 +699,33 @@ ext_tcp_socket_io_errors_t ext_tcp_utils_tcp_socket_write(kaa_fd_t fd, const cha
                 return KAA_TCP_SOCK_IO_OK;
             }
         }
+#ifdef KAA_TCP_COMPRESSION
+    } else if (access_point_test_info.compression_scenario && !access_point_test_info.kaasync_written) {
+        //KAASYNC header, remaining length and the sync header
+        if ((uint8_t) buffer[0] != 0xF0) {
+            return KAA_TCP_SOCK_IO_ERROR;
+        }
+        size_t header_size = 1;
+        while (buffer[header_size++] & FIRST_BIT);
+
+        const char *payload = buffer + header_size + KAA_SYNC_HEADER_LENGTH;
+        size_t payload_size = buffer_size - header_size - KAA_SYNC_HEADER_LENGTH;
+        uint8_t flags = buffer[header_size + KAA_SYNC_HEADER_LENGTH - 1];
+
+        access_point_test_info.kaasync_written = true;
+        *bytes_written = buffer_size;
+
+        if (flags & KAA_SYNC_ZIPPED_BIT) {
+            char *decompressed = NULL;
+            size_t decompressed_size = 0;
+            if (!kaatcp_decompress(payload, payload_size, &decompressed, &decompressed_size)) {
+                access_point_test_info.kaasync_compressed = decompressed_size == COMPRESSIBLE_SYNC_SIZE
+                                        && !memcmp(decompressed, COMPRESSIBLE_SYNC, COMPRESSIBLE_SYNC_SIZE);
+                KAA_FREE(decompressed);
+            }
+        }
+        return KAA_TCP_SOCK_IO_OK;
+#endif
     } else if (!access_point_test_info.socket_disconnected_write) {
         if (buffer_size != sizeof(DISCONNECT_MESSAGE)) {
             return KAA_TCP_SOCK_IO_ERROR;
@@ -689,9 +827,22 @@ kaa_error_t kaa_platform_protocol_serialize_client_sync(kaa_platform_protocol_t
                                                       , char **buffer
                                                       , size_t *buffer_size)
 {
+#ifdef KAA_TCP_COMPRESSION
+    //After CONNACK the client sync is big enough to be compressed
+    if (access_point_test_info.compression_scenario && access_point_test_info.connack_read) {
+        char *alloc_buffer = info->allocator(info->allocator_context, COMPRESSIBLE_SYNC_SIZE);
+        if (alloc_buffer) {
+            memcpy(alloc_buffer, COMPRESSIBLE_SYNC, COMPRESSIBLE_SYNC_SIZE);
+            *buffer = alloc_buffer;
+            *buffer_size = COMPRESSIBLE_SYNC_SIZE;
+            return KAA_ERR_NONE;
+        }
+        return KAA_ERR_NOMEM;
+    }
+#endif
 
-    if (info->services_count == 1
-            && info->services[0] == KAA_SERVICE_BOOTSTRAP) {
+    if ((info->services_count == 1 && info->services[0] == KAA_SERVICE_BOOTSTRAP)
+            || access_point_test_info.compression_scenario) {
         if (info->allocator && info->allocator_context) {
             char *alloc_buffer = info->allocator(info->allocator_context, sizeof(CONNECT_PACK));
             if (alloc_buffer) {
@@ -808,4 +959,7 @@ KAA_SUITE_MAIN(Log, test_init, test_deinit,
         KAA_TEST_CASE(set_access_point_connecting_error, test_set_access_point_connecting_error)
         KAA_TEST_CASE(set_access_point_io_error, test_set_access_point_io_error)
         KAA_TEST_CASE(bootstrap_sync_success, test_bootstrap_sync_success)
+#ifdef KAA_TCP_COMPRESSION
+        KAA_TEST_CASE(operation_sync_compressed, test_operation_sync_compressed)
+#endif
         )
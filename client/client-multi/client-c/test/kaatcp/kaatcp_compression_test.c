@@ -0,0 +1,143 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "../kaa_test.h"
+
+#include "utilities/kaa_log.h"
+#include "utilities/kaa_mem.h"
+#include "kaa_protocols/kaa_tcp/kaatcp_compression.h"
+
+
+
+static kaa_logger_t *logger = NULL;
+
+
+
+static void fill_repetitive_payload(char *payload, size_t payload_size)
+{
+    const char *record = "{\"level\":\"INFO\",\"tag\":\"sensor\",\"value\":42}";
+    size_t record_size = strlen(record);
+
+    for (size_t i = 0; i < payload_size; ++i) {
+        payload[i] = record[i % record_size];
+    }
+}
+
+
+
+void test_kaatcp_compress_decompress(void)
+{
+    KAA_TRACE_IN(logger);
+
+    char payload[4096];
+    fill_repetitive_payload(payload, sizeof(payload));
+
+    char *compressed = NULL;
+    size_t compressed_size = 0;
+    kaatcp_error_t rval = kaatcp_compress(payload, sizeof(payload), &compressed, &compressed_size);
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+    ASSERT_NOT_NULL(compressed);
+    ASSERT_TRUE(compressed_size < sizeof(payload) / 10);
+
+    char *decompressed = NULL;
+    size_t decompressed_size = 0;
+    rval = kaatcp_decompress(compressed, compressed_size, &decompressed, &decompressed_size);
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+    ASSERT_EQUAL(decompressed_size, sizeof(payload));
+    ASSERT_EQUAL(memcmp(decompressed, payload, sizeof(payload)), 0);
+
+    KAA_FREE(compressed);
+    KAA_FREE(decompressed);
+
+    KAA_TRACE_OUT(logger);
+}
+
+void test_kaatcp_compress_incompressible(void)
+{
+    KAA_TRACE_IN(logger);
+
+    char payload[] = { 0x12, 0x7F, 0x01, (char) 0xA3 };
+
+    char *compressed = NULL;
+    size_t compressed_size = 0;
+    kaatcp_error_t rval = kaatcp_compress(payload, sizeof(payload), &compressed, &compressed_size);
+    ASSERT_EQUAL(rval, KAATCP_ERR_BUFFER_NOT_ENOUGH);
+    ASSERT_NULL(compressed);
+
+    rval = kaatcp_compress(NULL, sizeof(payload), &compressed, &compressed_size);
+    ASSERT_EQUAL(rval, KAATCP_ERR_BAD_PARAM);
+
+    KAA_TRACE_OUT(logger);
+}
+
+void test_kaatcp_decompress_corrupted(void)
+{
+    KAA_TRACE_IN(logger);
+
+    char payload[1024];
+    fill_repetitive_payload(payload, sizeof(payload));
+
+    char *compressed = NULL;
+    size_t compressed_size = 0;
+    kaatcp_error_t rval = kaatcp_compress(payload, sizeof(payload), &compressed, &compressed_size);
+    ASSERT_EQUAL(rval, KAATCP_ERR_NONE);
+
+    char *decompressed = NULL;
+    size_t decompressed_size = 0;
+
+    /* Truncated stream */
+    rval = kaatcp_decompress(compressed, compressed_size / 2, &decompressed, &decompressed_size);
+    ASSERT_EQUAL(rval, KAATCP_ERR_INVALID_PROTOCOL);
+    ASSERT_NULL(decompressed);
+
+    /* Not a zlib stream */
+    compressed[0] = 0x00;
+    rval = kaatcp_decompress(compressed, compressed_size, &decompressed, &decompressed_size);
+    ASSERT_EQUAL(rval, KAATCP_ERR_INVALID_PROTOCOL);
+    ASSERT_NULL(decompressed);
+
+    KAA_FREE(compressed);
+
+    KAA_TRACE_OUT(logger);
+}
+
+int test_init(void)
+{
+    kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
+    if (error || !logger) {
+        return error;
+    }
+
+    return 0;
+}
+
+int test_deinit(void)
+{
+    kaa_log_destroy(logger);
+    return 0;
+}
+
+KAA_SUITE_MAIN(Log, test_init, test_deinit
+       ,
+       KAA_TEST_CASE(kaatcp_compress_decompress, test_kaatcp_compress_decompress)
+       KAA_TEST_CASE(kaatcp_compress_incompressible, test_kaatcp_compress_incompressible)
+       KAA_TEST_CASE(kaatcp_decompress_corrupted, test_kaatcp_decompress_corrupted)
+)
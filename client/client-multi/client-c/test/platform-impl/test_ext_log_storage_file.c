@@ -0,0 +1,419 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../kaa_test.h"
+
+#include "kaa_common.h"
+#include "utilities/kaa_mem.h"
+#include "utilities/kaa_log.h"
+
+#include "platform/ext_log_storage.h"
+
+
+#define TEST_RECORD_BUCKET_ID    1
+#define TEST_SEGMENT_SIZE        256
+#define TEST_BUFFER_SIZE         64
+
+
+
+extern kaa_error_t ext_file_log_storage_create(void **log_storage_context_p
+                                             , kaa_logger_t *logger
+                                             , const char *directory
+                                             , size_t segment_size
+                                             , size_t max_storage_size
+                                             , size_t percent_to_delete);
+extern kaa_error_t ext_log_storage_destroy(void *context);
+
+
+
+static kaa_logger_t *logger = NULL;
+static char storage_directory[] = "/tmp/kaa_log_storage_XXXXXX";
+
+
+
+static void clear_storage_directory(void)
+{
+    DIR *dir = opendir(storage_directory);
+    ASSERT_NOT_NULL(dir);
+
+    char path[512];
+    struct dirent *entry = NULL;
+    while ((entry = readdir(dir))) {
+        if (entry->d_name[0] != '.') {
+            snprintf(path, sizeof(path), "%s/%s", storage_directory, entry->d_name);
+            unlink(path);
+        }
+    }
+    closedir(dir);
+}
+
+static size_t count_segment_files(void)
+{
+    DIR *dir = opendir(storage_directory);
+    ASSERT_NOT_NULL(dir);
+
+    size_t count = 0;
+    struct dirent *entry = NULL;
+    while ((entry = readdir(dir))) {
+        if (strstr(entry->d_name, ".seg")) {
+            ++count;
+        }
+    }
+    closedir(dir);
+    return count;
+}
+
+static void *create_storage(size_t max_storage_size, size_t percent_to_delete)
+{
+    void *storage = NULL;
+    kaa_error_t error_code = ext_file_log_storage_create(&storage, logger, storage_directory
+                                                       , TEST_SEGMENT_SIZE, max_storage_size, percent_to_delete);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_NOT_NULL(storage);
+    return storage;
+}
+
+static kaa_error_t add_log_record(void *storage,
+                                  const char *data,
+                                  uint16_t bucket_id)
+{
+    KAA_RETURN_IF_NIL2(storage, data, KAA_ERR_BADPARAM);
+    kaa_log_record_t record = { NULL, strlen(data), bucket_id };
+    kaa_error_t error_code = ext_log_storage_allocate_log_record_buffer(storage, &record);
+    KAA_RETURN_IF_ERR(error_code);
+    memcpy(record.data, data, record.size);
+    return ext_log_storage_add_log_record(storage, &record);
+}
+
+static void check_next_record(void *storage, const char *expected_data, uint16_t expected_bucket_id)
+{
+    char buffer[TEST_BUFFER_SIZE];
+    uint16_t bucket_id = 0;
+    size_t record_len = 0;
+
+    kaa_error_t error_code = ext_log_storage_write_next_record(storage, buffer, sizeof(buffer), &bucket_id, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    ASSERT_EQUAL(record_len, strlen(expected_data));
+    ASSERT_EQUAL(memcmp(buffer, expected_data, record_len), 0);
+    ASSERT_EQUAL(bucket_id, expected_bucket_id);
+}
+
+static void check_no_next_record(void *storage)
+{
+    char buffer[TEST_BUFFER_SIZE];
+    size_t record_len = 0;
+
+    kaa_error_t error_code = ext_log_storage_write_next_record(storage, buffer, sizeof(buffer), NULL, &record_len);
+    ASSERT_EQUAL(error_code, KAA_ERR_NOT_FOUND);
+    ASSERT_EQUAL(record_len, 0);
+}
+
+
+
+void test_create_storage(void)
+{
+    KAA_TRACE_IN(logger);
+
+    void *storage = NULL;
+    clear_storage_directory();
+
+    ASSERT_NOT_EQUAL(ext_file_log_storage_create(NULL, logger, storage_directory, TEST_SEGMENT_SIZE, 0, 0), KAA_ERR_NONE);
+    ASSERT_NOT_EQUAL(ext_file_log_storage_create(&storage, NULL, storage_directory, TEST_SEGMENT_SIZE, 0, 0), KAA_ERR_NONE);
+    ASSERT_NOT_EQUAL(ext_file_log_storage_create(&storage, logger, NULL, TEST_SEGMENT_SIZE, 0, 0), KAA_ERR_NONE);
+    ASSERT_NOT_EQUAL(ext_file_log_storage_create(&storage, logger, storage_directory, 16, 0, 0), KAA_ERR_NONE);
+    ASSERT_NOT_EQUAL(ext_file_log_storage_create(&storage, logger, storage_directory, TEST_SEGMENT_SIZE, 1024, 152), KAA_ERR_NONE);
+
+    storage = create_storage(0, 0);
+    ASSERT_EQUAL(count_segment_files(), 1);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 0);
+    ASSERT_EQUAL(ext_log_storage_get_total_size(storage), 0);
+    check_no_next_record(storage);
+
+    ext_log_storage_destroy(storage);
+
+    KAA_TRACE_OUT(logger);
+}
+
+
+
+void test_write_and_remove_records(void)
+{
+    KAA_TRACE_IN(logger);
+
+    clear_storage_directory();
+    void *storage = create_storage(0, 0);
+
+    ASSERT_EQUAL(add_log_record(storage, "first", TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "second", TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "third", TEST_RECORD_BUCKET_ID + 1), KAA_ERR_NONE);
+
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 3);
+    ASSERT_EQUAL(ext_log_storage_get_total_size(storage), strlen("firstsecondthird"));
+
+    char buffer[2];
+    size_t record_len = 0;
+    ASSERT_EQUAL(ext_log_storage_write_next_record(storage, buffer, sizeof(buffer), NULL, &record_len)
+               , KAA_ERR_INSUFFICIENT_BUFFER);
+    ASSERT_EQUAL(record_len, strlen("first"));
+
+    check_next_record(storage, "first", TEST_RECORD_BUCKET_ID);
+    check_next_record(storage, "second", TEST_RECORD_BUCKET_ID);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 1);
+    ASSERT_EQUAL(ext_log_storage_get_total_size(storage), strlen("third"));
+
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, TEST_RECORD_BUCKET_ID), KAA_ERR_NOT_FOUND);
+
+    check_next_record(storage, "third", TEST_RECORD_BUCKET_ID + 1);
+    check_no_next_record(storage);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 0);
+
+    ext_log_storage_destroy(storage);
+
+    KAA_TRACE_OUT(logger);
+}
+
+
+
+void test_unmark_by_bucket_id(void)
+{
+    KAA_TRACE_IN(logger);
+
+    clear_storage_directory();
+    void *storage = create_storage(0, 0);
+
+    ASSERT_EQUAL(add_log_record(storage, "first", TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "second", TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "third", TEST_RECORD_BUCKET_ID + 1), KAA_ERR_NONE);
+
+    check_next_record(storage, "first", TEST_RECORD_BUCKET_ID);
+    check_next_record(storage, "second", TEST_RECORD_BUCKET_ID);
+
+    ASSERT_EQUAL(ext_log_storage_unmark_by_bucket_id(storage, TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_unmark_by_bucket_id(storage, TEST_RECORD_BUCKET_ID), KAA_ERR_NOT_FOUND);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 3);
+
+    check_next_record(storage, "first", TEST_RECORD_BUCKET_ID);
+    check_next_record(storage, "second", TEST_RECORD_BUCKET_ID);
+    check_next_record(storage, "third", TEST_RECORD_BUCKET_ID + 1);
+    check_no_next_record(storage);
+
+    ext_log_storage_destroy(storage);
+
+    KAA_TRACE_OUT(logger);
+}
+
+
+
+void test_recover_records(void)
+{
+    KAA_TRACE_IN(logger);
+
+    clear_storage_directory();
+    void *storage = create_storage(0, 0);
+
+    char data[TEST_BUFFER_SIZE];
+    const size_t record_count = 30;
+    size_t i = 0;
+    for (; i < record_count; ++i) {
+        snprintf(data, sizeof(data), "record %zu", i);
+        ASSERT_EQUAL(add_log_record(storage, data, TEST_RECORD_BUCKET_ID + i / 10), KAA_ERR_NONE);
+    }
+    ASSERT_TRUE(count_segment_files() > 1);
+
+    /*
+     * The first bucket is uploaded, the second one is in flight when the storage goes down.
+     */
+    for (i = 0; i < 20; ++i) {
+        snprintf(data, sizeof(data), "record %zu", i);
+        check_next_record(storage, data, TEST_RECORD_BUCKET_ID + i / 10);
+    }
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+
+    ext_log_storage_destroy(storage);
+
+    storage = create_storage(0, 0);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 20);
+
+    for (i = 10; i < record_count; ++i) {
+        snprintf(data, sizeof(data), "record %zu", i);
+        check_next_record(storage, data, TEST_RECORD_BUCKET_ID + i / 10);
+    }
+    check_no_next_record(storage);
+
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, TEST_RECORD_BUCKET_ID + 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, TEST_RECORD_BUCKET_ID + 2), KAA_ERR_NONE);
+
+    /*
+     * Only the segment records are appended to is left.
+     */
+    ASSERT_EQUAL(count_segment_files(), 1);
+    ext_log_storage_destroy(storage);
+
+    storage = create_storage(0, 0);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 0);
+    check_no_next_record(storage);
+    ext_log_storage_destroy(storage);
+
+    KAA_TRACE_OUT(logger);
+}
+
+
+
+void test_recover_torn_record(void)
+{
+    KAA_TRACE_IN(logger);
+
+    clear_storage_directory();
+    void *storage = create_storage(0, 0);
+
+    ASSERT_EQUAL(add_log_record(storage, "first", TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+    ASSERT_EQUAL(add_log_record(storage, "second", TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+    ext_log_storage_destroy(storage);
+    ASSERT_EQUAL(count_segment_files(), 1);
+
+    /*
+     * Damages the last byte of the second record as if the crash interrupted its write.
+     */
+    DIR *dir = opendir(storage_directory);
+    ASSERT_NOT_NULL(dir);
+    char path[512] = { 0 };
+    struct dirent *entry = NULL;
+    while ((entry = readdir(dir))) {
+        if (strstr(entry->d_name, ".seg")) {
+            snprintf(path, sizeof(path), "%s/%s", storage_directory, entry->d_name);
+        }
+    }
+    closedir(dir);
+
+    int fd = open(path, O_RDWR);
+    ASSERT_TRUE(fd >= 0);
+    char segment[TEST_SEGMENT_SIZE];
+    ASSERT_EQUAL(pread(fd, segment, sizeof(segment), 0), TEST_SEGMENT_SIZE);
+    size_t offset = 0;
+    while (offset + strlen("second") <= sizeof(segment) && memcmp(segment + offset, "second", strlen("second"))) {
+        ++offset;
+    }
+    ASSERT_TRUE(offset + strlen("second") <= sizeof(segment));
+    ASSERT_EQUAL(pwrite(fd, "x", 1, offset + strlen("second") - 1), 1);
+    close(fd);
+
+    storage = create_storage(0, 0);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 1);
+
+    ASSERT_EQUAL(add_log_record(storage, "third", TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+    ext_log_storage_destroy(storage);
+
+    storage = create_storage(0, 0);
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 2);
+    check_next_record(storage, "first", TEST_RECORD_BUCKET_ID);
+    check_next_record(storage, "third", TEST_RECORD_BUCKET_ID);
+    check_no_next_record(storage);
+    ext_log_storage_destroy(storage);
+
+    KAA_TRACE_OUT(logger);
+}
+
+
+
+void test_drop_oldest_segments(void)
+{
+    KAA_TRACE_IN(logger);
+
+    clear_storage_directory();
+    void *storage = create_storage(4 * TEST_SEGMENT_SIZE, 50);
+
+    char data[TEST_BUFFER_SIZE];
+    const size_t record_count = 100;
+    size_t i = 0;
+    for (; i < record_count; ++i) {
+        snprintf(data, sizeof(data), "record %zu", i);
+        ASSERT_EQUAL(add_log_record(storage, data, TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+        ASSERT_TRUE(count_segment_files() <= 4);
+    }
+
+    /*
+     * The newest records are kept in the order of adding.
+     */
+    size_t left_count = ext_log_storage_get_records_count(storage);
+    ASSERT_TRUE(left_count > 0 && left_count < record_count);
+
+    for (i = record_count - left_count; i < record_count; ++i) {
+        snprintf(data, sizeof(data), "record %zu", i);
+        check_next_record(storage, data, TEST_RECORD_BUCKET_ID);
+    }
+    check_no_next_record(storage);
+
+    /*
+     * Marked records of dropped segments are forgotten.
+     */
+    for (i = 0; i < record_count; ++i) {
+        ASSERT_EQUAL(add_log_record(storage, "data", TEST_RECORD_BUCKET_ID + 1), KAA_ERR_NONE);
+    }
+    ASSERT_EQUAL(ext_log_storage_unmark_by_bucket_id(storage, TEST_RECORD_BUCKET_ID), KAA_ERR_NONE);
+    ASSERT_TRUE(ext_log_storage_get_records_count(storage) < left_count + record_count);
+
+    ext_log_storage_destroy(storage);
+
+    KAA_TRACE_OUT(logger);
+}
+
+
+
+int test_init(void)
+{
+    kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
+    if (error || !logger) {
+        return error;
+    }
+
+    if (!mkdtemp(storage_directory)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+
+
+int test_deinit(void)
+{
+    clear_storage_directory();
+    rmdir(storage_directory);
+
+    kaa_log_destroy(logger);
+
+    return 0;
+}
+
+
+
+KAA_SUITE_MAIN(FileLogStorage, test_init, test_deinit,
+        KAA_TEST_CASE(create_storage, test_create_storage)
+        KAA_TEST_CASE(write_and_remove_records, test_write_and_remove_records)
+        KAA_TEST_CASE(unmark_by_bucket_id, test_unmark_by_bucket_id)
+        KAA_TEST_CASE(recover_records, test_recover_records)
+        KAA_TEST_CASE(recover_torn_record, test_recover_torn_record)
+        KAA_TEST_CASE(drop_oldest_segments, test_drop_oldest_segments)
+)
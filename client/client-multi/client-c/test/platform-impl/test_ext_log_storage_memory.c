@@ -146,22 +146,16 @@ void test_allocate_log_record_buffer(void)
 
 
 
-static char* copy_data(const char* data, size_t data_size)
-{
-    KAA_RETURN_IF_NIL2(data, data_size, NULL);
-    char *new_data = (char *)KAA_MALLOC(data_size);
-    KAA_RETURN_IF_NIL(new_data, NULL);
-    memcpy(new_data, data, data_size);
-    return new_data;
-}
-
 static kaa_error_t add_log_record(void *storage,
                                   const char *data,
                                   size_t data_size,
                                   uint16_t bucket_id)
 {
     KAA_RETURN_IF_NIL3(storage, data, data_size, KAA_ERR_BADPARAM);
-    kaa_log_record_t record = { copy_data(data, data_size), data_size, bucket_id };
+    kaa_log_record_t record = { NULL, data_size, bucket_id };
+    kaa_error_t error_code = ext_log_storage_allocate_log_record_buffer(storage, &record);
+    KAA_RETURN_IF_ERR(error_code);
+    memcpy(record.data, data, data_size);
     return ext_log_storage_add_log_record(storage, &record);
 }
 
@@ -448,6 +442,106 @@ void test_shrink_to_size(void)
 
 
 
+void test_unmark_keeps_record_order(void)
+{
+    KAA_TRACE_IN(logger);
+
+    kaa_error_t error_code;
+    void *storage;
+
+    error_code = ext_unlimited_log_storage_create(&storage, logger);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    const char *records[] = { "DATA1", "DATA2", "DATA3" };
+    size_t data_size = strlen(records[0]);
+    size_t record_len = 0;
+    uint16_t bucket_id = 0;
+    char buffer[data_size];
+
+    size_t i;
+    for (i = 0; i < 3; ++i) {
+        error_code = add_log_record(storage, records[i], data_size, i < 2 ? 1 : 2);
+        ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    }
+
+    for (i = 0; i < 2; ++i) {
+        error_code = ext_log_storage_write_next_record(storage, buffer, data_size, &bucket_id, &record_len);
+        ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+        ASSERT_EQUAL(bucket_id, 1);
+    }
+
+    error_code = ext_log_storage_unmark_by_bucket_id(storage, 1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    error_code = ext_log_storage_unmark_by_bucket_id(storage, 1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NOT_FOUND);
+
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 3);
+    ASSERT_EQUAL(ext_log_storage_get_total_size(storage), 3 * data_size);
+
+    // Rolled back records are written again before the newer ones, in the original order
+    for (i = 0; i < 3; ++i) {
+        error_code = ext_log_storage_write_next_record(storage, buffer, data_size, &bucket_id, &record_len);
+        ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+        ASSERT_EQUAL(memcmp(buffer, records[i], data_size), 0);
+    }
+
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 1), KAA_ERR_NONE);
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 1), KAA_ERR_NOT_FOUND);
+    ASSERT_EQUAL(ext_log_storage_remove_by_bucket_id(storage, 2), KAA_ERR_NONE);
+
+    ext_log_storage_destroy(storage);
+
+    KAA_TRACE_OUT(logger);
+}
+
+
+
+void test_shrink_removes_marked_records(void)
+{
+    KAA_TRACE_IN(logger);
+
+    kaa_error_t error_code;
+    void *storage;
+
+    const char *data = "DATA";
+    size_t data_size = strlen("DATA");
+    size_t record_len = 0;
+    uint16_t bucket_id = 0;
+    char buffer[data_size];
+
+    error_code = ext_limited_log_storage_create(&storage, logger, 4 * data_size, 50);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    size_t i;
+    for (i = 0; i < 4; ++i) {
+        error_code = add_log_record(storage, data, data_size, 1);
+        ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    }
+
+    for (i = 0; i < 3; ++i) {
+        error_code = ext_log_storage_write_next_record(storage, buffer, data_size, &bucket_id, &record_len);
+        ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+    }
+
+    // Two eldest records of the bucket are removed to fit the new one
+    error_code = add_log_record(storage, data, data_size, 2);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 2);
+
+    error_code = ext_log_storage_unmark_by_bucket_id(storage, 1);
+    ASSERT_EQUAL(error_code, KAA_ERR_NONE);
+
+    ASSERT_EQUAL(ext_log_storage_get_records_count(storage), 3);
+    ASSERT_EQUAL(ext_log_storage_get_total_size(storage), 3 * data_size);
+
+    ext_log_storage_destroy(storage);
+
+    KAA_TRACE_OUT(logger);
+}
+
+
+
 int test_init(void)
 {
     kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
@@ -475,4 +569,6 @@ KAA_SUITE_MAIN(MetaExtension, test_init, test_deinit,
         KAA_TEST_CASE(remove_by_bucket_id, test_remove_by_bucket_id)
         KAA_TEST_CASE(unmark_by_bucket_id, test_unmark_by_bucket_id)
         KAA_TEST_CASE(shrink_to_size, test_shrink_to_size)
+        KAA_TEST_CASE(unmark_keeps_record_order, test_unmark_keeps_record_order)
+        KAA_TEST_CASE(shrink_removes_marked_records, test_shrink_removes_marked_records)
 )
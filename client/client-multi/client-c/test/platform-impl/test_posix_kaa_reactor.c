@@ -0,0 +1,388 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "../kaa_test.h"
+
+#include "kaa_common.h"
+#include "utilities/kaa_log.h"
+
+#include "platform-impl/posix/posix_kaa_reactor.h"
+#include "platform-impl/posix/posix_kaa_reactor_client.h"
+
+
+#define TEST_WAIT_TIMEOUT_MS    50
+#define TEST_TIMER_STEP_MS      20
+#define TEST_IDLE_TIMEOUT_MS    10000
+#define TEST_DEADLINE_MS        5000
+#define TEST_CLIENT_COUNT       3
+
+
+
+/*
+ * The reactor is linked against the fake clients below instead of the
+ * POSIX Kaa client, so the tests control the descriptor, the interest
+ * and the timeout the reactor sees.
+ */
+struct kaa_client_t {
+    kaa_fd_t    fd;
+    bool        readable;
+    bool        writable;
+    uint32_t    timeout;
+    uint32_t    next_timeout;       /**< Timeout the client switches to when its timeout is processed */
+    size_t      timeout_count;
+    size_t      ready_count;
+    bool        was_readable;
+    bool        was_writable;
+};
+
+static kaa_logger_t *logger = NULL;
+
+static kaa_client_t *timeout_order[TEST_CLIENT_COUNT];
+static size_t timeout_order_size = 0;
+
+
+
+kaa_error_t kaa_client_check_readiness(kaa_client_t *kaa_client)
+{
+    KAA_RETURN_IF_NIL(kaa_client, KAA_ERR_BADPARAM);
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_client_process_timeout(kaa_client_t *kaa_client)
+{
+    ++kaa_client->timeout_count;
+    kaa_client->timeout = kaa_client->next_timeout;
+
+    if (timeout_order_size < TEST_CLIENT_COUNT) {
+        timeout_order[timeout_order_size++] = kaa_client;
+    }
+    return KAA_ERR_NONE;
+}
+
+kaa_error_t kaa_client_process_channel_ready(kaa_client_t *kaa_client, bool readable, bool writable)
+{
+    ++kaa_client->ready_count;
+    kaa_client->was_readable = readable;
+    kaa_client->was_writable = writable;
+
+    if (readable) {
+        char buffer[16];
+        ssize_t result = read(kaa_client->fd, buffer, sizeof(buffer));
+        (void) result;
+    }
+    return KAA_ERR_NONE;
+}
+
+void kaa_client_get_channel_interest(kaa_client_t *kaa_client, kaa_fd_t *fd, bool *readable, bool *writable)
+{
+    *fd = kaa_client->fd;
+    *readable = kaa_client->readable;
+    *writable = kaa_client->writable;
+}
+
+uint32_t kaa_client_get_timeout(kaa_client_t *kaa_client)
+{
+    return kaa_client->timeout;
+}
+
+
+
+static void init_client(kaa_client_t *client, kaa_fd_t fd, uint32_t timeout)
+{
+    memset(client, 0, sizeof(kaa_client_t));
+    client->fd = fd;
+    client->readable = (fd >= 0);
+    client->timeout = timeout;
+    client->next_timeout = timeout;
+}
+
+
+
+static uint64_t get_time_ms(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+
+
+void test_create_reactor(void)
+{
+    KAA_TRACE_IN(logger);
+
+    kaa_reactor_t *reactor = NULL;
+    ASSERT_EQUAL(kaa_reactor_create(NULL, logger), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_reactor_create(&reactor, NULL), KAA_ERR_BADPARAM);
+
+    ASSERT_EQUAL(kaa_reactor_create(&reactor, logger), KAA_ERR_NONE);
+    ASSERT_NOT_NULL(reactor);
+    ASSERT_EQUAL(kaa_reactor_get_client_count(reactor), 0);
+
+    kaa_reactor_destroy(reactor);
+
+    KAA_TRACE_OUT(logger);
+}
+
+void test_bad_params(void)
+{
+    KAA_TRACE_IN(logger);
+
+    kaa_reactor_t *reactor = NULL;
+    ASSERT_EQUAL(kaa_reactor_create(&reactor, logger), KAA_ERR_NONE);
+
+    ASSERT_EQUAL(kaa_reactor_add_client(NULL, NULL), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_reactor_add_client(reactor, NULL), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_reactor_remove_client(reactor, NULL), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_reactor_remove_client(reactor, (kaa_client_t *) &reactor), KAA_ERR_NOT_FOUND);
+    ASSERT_EQUAL(kaa_reactor_process(NULL, 0), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_reactor_run(NULL), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_reactor_stop(NULL), KAA_ERR_BADPARAM);
+    ASSERT_EQUAL(kaa_reactor_get_client_count(NULL), 0);
+
+    kaa_reactor_destroy(reactor);
+
+    KAA_TRACE_OUT(logger);
+}
+
+void test_process_waits_for_timeout(void)
+{
+    KAA_TRACE_IN(logger);
+
+    kaa_reactor_t *reactor = NULL;
+    ASSERT_EQUAL(kaa_reactor_create(&reactor, logger), KAA_ERR_NONE);
+
+    uint64_t start = get_time_ms();
+    ASSERT_EQUAL(kaa_reactor_process(reactor, TEST_WAIT_TIMEOUT_MS), KAA_ERR_NONE);
+    ASSERT_TRUE(get_time_ms() - start >= TEST_WAIT_TIMEOUT_MS - 1);
+
+    kaa_reactor_destroy(reactor);
+
+    KAA_TRACE_OUT(logger);
+}
+
+void test_stop_wakes_reactor(void)
+{
+    KAA_TRACE_IN(logger);
+
+    kaa_reactor_t *reactor = NULL;
+    ASSERT_EQUAL(kaa_reactor_create(&reactor, logger), KAA_ERR_NONE);
+
+    /* Stop requested before the run isn't lost, so the run returns at once. */
+    ASSERT_EQUAL(kaa_reactor_stop(reactor), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_reactor_run(reactor), KAA_ERR_NONE);
+
+    /* The reactor can be run again after it has been stopped. */
+    ASSERT_EQUAL(kaa_reactor_stop(reactor), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_reactor_run(reactor), KAA_ERR_NONE);
+
+    kaa_reactor_destroy(reactor);
+
+    KAA_TRACE_OUT(logger);
+}
+
+
+void test_dispatch_channel_events(void)
+{
+    KAA_TRACE_IN(logger);
+
+    int sockets[2];
+    ASSERT_EQUAL(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+
+    kaa_reactor_t *reactor = NULL;
+    ASSERT_EQUAL(kaa_reactor_create(&reactor, logger), KAA_ERR_NONE);
+
+    kaa_client_t client;
+    init_client(&client, sockets[0], TEST_IDLE_TIMEOUT_MS);
+    ASSERT_EQUAL(kaa_reactor_add_client(reactor, &client), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_reactor_add_client(reactor, &client), KAA_ERR_ALREADY_EXISTS);
+    ASSERT_EQUAL(kaa_reactor_get_client_count(reactor), 1);
+
+    /* The new client is processed at once and its descriptor is watched after that. */
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 0), KAA_ERR_NONE);
+    ASSERT_EQUAL(client.timeout_count, 1);
+    ASSERT_EQUAL(client.ready_count, 0);
+
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 0), KAA_ERR_NONE);
+    ASSERT_EQUAL(client.ready_count, 0);
+
+    ASSERT_EQUAL(write(sockets[1], "x", 1), 1);
+    ASSERT_EQUAL(kaa_reactor_process(reactor, TEST_WAIT_TIMEOUT_MS), KAA_ERR_NONE);
+    ASSERT_EQUAL(client.ready_count, 1);
+    ASSERT_TRUE(client.was_readable);
+    ASSERT_FALSE(client.was_writable);
+    ASSERT_EQUAL(client.timeout_count, 1);
+
+    /* The data has been read, so nothing is dispatched any more. */
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 0), KAA_ERR_NONE);
+    ASSERT_EQUAL(client.ready_count, 1);
+
+    /* The removed client isn't dispatched. */
+    ASSERT_EQUAL(kaa_reactor_remove_client(reactor, &client), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_reactor_get_client_count(reactor), 0);
+    ASSERT_EQUAL(write(sockets[1], "x", 1), 1);
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 0), KAA_ERR_NONE);
+    ASSERT_EQUAL(client.ready_count, 1);
+
+    kaa_reactor_destroy(reactor);
+    close(sockets[0]);
+    close(sockets[1]);
+
+    KAA_TRACE_OUT(logger);
+}
+
+void test_interest_is_rearmed(void)
+{
+    KAA_TRACE_IN(logger);
+
+    int old_sockets[2];
+    int new_sockets[2];
+    ASSERT_EQUAL(socketpair(AF_UNIX, SOCK_STREAM, 0, old_sockets), 0);
+    ASSERT_EQUAL(socketpair(AF_UNIX, SOCK_STREAM, 0, new_sockets), 0);
+
+    kaa_reactor_t *reactor = NULL;
+    ASSERT_EQUAL(kaa_reactor_create(&reactor, logger), KAA_ERR_NONE);
+
+    kaa_client_t client;
+    init_client(&client, old_sockets[0], TEST_TIMER_STEP_MS);
+    ASSERT_EQUAL(kaa_reactor_add_client(reactor, &client), KAA_ERR_NONE);
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 0), KAA_ERR_NONE);
+    ASSERT_EQUAL(client.timeout_count, 1);
+
+    /* The channel reconnects and waits to send. The interest is re-read on the next timeout. */
+    client.fd = new_sockets[0];
+    client.readable = false;
+    client.writable = true;
+    client.next_timeout = TEST_IDLE_TIMEOUT_MS;
+
+    uint64_t deadline = get_time_ms() + TEST_DEADLINE_MS;
+    while (client.timeout_count < 2 && get_time_ms() < deadline) {
+        ASSERT_EQUAL(kaa_reactor_process(reactor, TEST_WAIT_TIMEOUT_MS), KAA_ERR_NONE);
+    }
+    ASSERT_EQUAL(client.timeout_count, 2);
+
+    /* Data on the old descriptor doesn't reach the client, the new one is writable. */
+    ASSERT_EQUAL(write(old_sockets[1], "x", 1), 1);
+    size_t ready_count = client.ready_count;
+    ASSERT_EQUAL(kaa_reactor_process(reactor, TEST_WAIT_TIMEOUT_MS), KAA_ERR_NONE);
+    ASSERT_EQUAL(client.ready_count, ready_count + 1);
+    ASSERT_FALSE(client.was_readable);
+    ASSERT_TRUE(client.was_writable);
+
+    /* The channel is closed. The descriptor is dropped after the next event. */
+    client.fd = -1;
+    client.writable = false;
+    ASSERT_EQUAL(kaa_reactor_process(reactor, TEST_WAIT_TIMEOUT_MS), KAA_ERR_NONE);
+    ready_count = client.ready_count;
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 0), KAA_ERR_NONE);
+    ASSERT_EQUAL(client.ready_count, ready_count);
+
+    kaa_reactor_destroy(reactor);
+    close(old_sockets[0]);
+    close(old_sockets[1]);
+    close(new_sockets[0]);
+    close(new_sockets[1]);
+
+    KAA_TRACE_OUT(logger);
+}
+
+void test_timeouts_in_deadline_order(void)
+{
+    KAA_TRACE_IN(logger);
+
+    kaa_reactor_t *reactor = NULL;
+    ASSERT_EQUAL(kaa_reactor_create(&reactor, logger), KAA_ERR_NONE);
+
+    /* Added in an order that differs from the order of their deadlines. */
+    kaa_client_t clients[TEST_CLIENT_COUNT];
+    init_client(&clients[0], -1, 3 * TEST_TIMER_STEP_MS);
+    init_client(&clients[1], -1, TEST_TIMER_STEP_MS);
+    init_client(&clients[2], -1, 2 * TEST_TIMER_STEP_MS);
+
+    for (size_t i = 0; i < TEST_CLIENT_COUNT; ++i) {
+        ASSERT_EQUAL(kaa_reactor_add_client(reactor, &clients[i]), KAA_ERR_NONE);
+    }
+
+    ASSERT_EQUAL(kaa_reactor_process(reactor, 0), KAA_ERR_NONE);
+    ASSERT_EQUAL(timeout_order_size, TEST_CLIENT_COUNT);
+
+    /* Each client is due once more, then it idles. */
+    timeout_order_size = 0;
+    for (size_t i = 0; i < TEST_CLIENT_COUNT; ++i) {
+        clients[i].next_timeout = TEST_IDLE_TIMEOUT_MS;
+    }
+
+    uint64_t start = get_time_ms();
+    uint64_t deadline = start + TEST_DEADLINE_MS;
+    while (timeout_order_size < TEST_CLIENT_COUNT && get_time_ms() < deadline) {
+        ASSERT_EQUAL(kaa_reactor_process(reactor, -1), KAA_ERR_NONE);
+    }
+
+    ASSERT_EQUAL(timeout_order_size, TEST_CLIENT_COUNT);
+    ASSERT_EQUAL(timeout_order[0], &clients[1]);
+    ASSERT_EQUAL(timeout_order[1], &clients[2]);
+    ASSERT_EQUAL(timeout_order[2], &clients[0]);
+    ASSERT_TRUE(get_time_ms() - start >= 3 * TEST_TIMER_STEP_MS - 1);
+
+    for (size_t i = 0; i < TEST_CLIENT_COUNT; ++i) {
+        ASSERT_EQUAL(clients[i].timeout_count, 2);
+        ASSERT_EQUAL(kaa_reactor_remove_client(reactor, &clients[i]), KAA_ERR_NONE);
+    }
+
+    kaa_reactor_destroy(reactor);
+
+    KAA_TRACE_OUT(logger);
+}
+
+
+
+int test_init(void)
+{
+    kaa_error_t error = kaa_log_create(&logger, KAA_MAX_LOG_MESSAGE_LENGTH, KAA_MAX_LOG_LEVEL, NULL);
+    if (error || !logger) {
+        return error;
+    }
+
+    return 0;
+}
+
+
+
+int test_deinit(void)
+{
+    kaa_log_destroy(logger);
+
+    return 0;
+}
+
+
+
+KAA_SUITE_MAIN(PosixReactor, test_init, test_deinit,
+        KAA_TEST_CASE(create_reactor, test_create_reactor)
+        KAA_TEST_CASE(bad_params, test_bad_params)
+        KAA_TEST_CASE(process_waits_for_timeout, test_process_waits_for_timeout)
+        KAA_TEST_CASE(stop_wakes_reactor, test_stop_wakes_reactor)
+        KAA_TEST_CASE(dispatch_channel_events, test_dispatch_channel_events)
+        KAA_TEST_CASE(interest_is_rearmed, test_interest_is_rearmed)
+        KAA_TEST_CASE(timeouts_in_deadline_order, test_timeouts_in_deadline_order)
+)
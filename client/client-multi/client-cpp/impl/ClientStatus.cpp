@@ -16,11 +16,19 @@
 
 #include "kaa/ClientStatus.hpp"
 
+#include <cstdio>
 #include <fstream>
-#include <iomanip>
+#include <iterator>
 #include <string>
 #include <sstream>
 
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "kaa/logging/Log.hpp"
 #include "kaa/common/UuidGenerator.hpp"
 #include "kaa/KaaClientProperties.hpp"
@@ -28,6 +36,9 @@
 
 namespace kaa {
 
+/*
+ * The values identify parameters in the binary state file, so new parameters must be appended only.
+ */
 enum class ClientParameterT {
     EVENT_SEQUENCE_NUMBER,
     IS_REGISTERED,
@@ -45,7 +56,8 @@ enum class ClientParameterT {
 class IPersistentParameter {
 public:
     virtual ~IPersistentParameter() {}
-    virtual void save(std::ostream &os) = 0;
+    virtual const std::string& encode() = 0;
+    virtual bool decode(const std::string &encodedValue) = 0;
     virtual void read(const std::string &strValue) = 0;
     virtual boost::any getValue() const = 0;
     virtual void setValue(boost::any v) = 0;
@@ -79,21 +91,6 @@ const bool                  ClientStatus::endpointDefaultAttachStatus_  = false;
 const std::string           ClientStatus::endpointKeyHashDefault_;
 const bool                  ClientStatus::isProfileResyncNeededDefault_ = false;
 
-static std::string convertToByteArrayString(const std::string & str)
-{
-    const std::uint8_t * bytes = reinterpret_cast<const std::uint8_t *>(str.data());
-    std::size_t length = str.length();
-
-    std::stringstream ss;
-    for (std::size_t i = 0; i < length; ++i) {
-        if (i != 0) {
-            ss << " ";
-        }
-        ss << std::setw(2) << std::setfill('0') << std::hex << (int)bytes[i];
-    }
-    return ss.str();
-}
-
 static std::string convertFromByteArrayString(const std::string & str)
 {
     std::string input = str;
@@ -107,85 +104,269 @@ static std::string convertFromByteArrayString(const std::string & str)
     return output.str();
 }
 
+/*
+ * The binary state file starts with the signature and the format version followed by records:
+ * | record type (1 byte) | value length (4 bytes) | value |
+ * Numbers are stored in big-endian byte order. Records of unknown types are skipped.
+ */
+static const std::string STATE_FILE_SIGNATURE("KAAS");
+static const std::uint8_t STATE_FILE_VERSION = 1;
+static const std::uint8_t TOPIC_STATES_RECORD = 0xFF;
+static const std::size_t RECORD_HEADER_SIZE = 5;
+
+template<typename T>
+static void encodeInteger(std::string& out, T value)
+{
+    typedef typename std::make_unsigned<T>::type UnsignedT;
+    UnsignedT unsignedValue = static_cast<UnsignedT>(value);
+    for (std::size_t i = sizeof(T); i > 0; --i) {
+        out.push_back(static_cast<char>((unsignedValue >> (8 * (i - 1))) & 0xFF));
+    }
+}
+
+static void encodeString(std::string& out, const std::string& value)
+{
+    encodeInteger<std::uint32_t>(out, value.size());
+    out.append(value);
+}
+
+static bool syncFile(std::FILE *file)
+{
+#ifdef _WIN32
+    return !_commit(_fileno(file));
+#else
+    return !fsync(fileno(file));
+#endif
+}
+
+/*
+ * Makes a rename within the directory durable. Windows has no way to sync a directory.
+ */
+static void syncParentDirectory(const std::string& filename)
+{
+#ifndef _WIN32
+    auto separatorPos = filename.find_last_of('/');
+    std::string directory = (separatorPos == std::string::npos) ? "." : filename.substr(0, separatorPos ? separatorPos : 1);
+
+    int fd = open(directory.c_str(), O_RDONLY);
+    if (fd != -1) {
+        fsync(fd);
+        close(fd);
+    }
+#endif
+}
+
+/*
+ * Reads values from an encoded buffer, each method returns false if there isn't enough data.
+ */
+class StateDecoder {
+public:
+    StateDecoder(const std::string& data, std::size_t offset = 0) : data_(data), offset_(offset) {}
+
+    template<typename T>
+    bool readInteger(T& value)
+    {
+        if (data_.size() - offset_ < sizeof(T)) {
+            return false;
+        }
+
+        typename std::make_unsigned<T>::type unsignedValue = 0;
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            unsignedValue = (unsignedValue << 8) | static_cast<std::uint8_t>(data_[offset_++]);
+        }
+
+        value = static_cast<T>(unsignedValue);
+        return true;
+    }
+
+    bool readString(std::string& value)
+    {
+        std::uint32_t size = 0;
+        if (!readInteger(size) || data_.size() - offset_ < size) {
+            return false;
+        }
+
+        value.assign(data_, offset_, size);
+        offset_ += size;
+        return true;
+    }
+
+    bool readBytes(std::string& value, std::size_t size)
+    {
+        if (data_.size() - offset_ < size) {
+            return false;
+        }
+
+        value.assign(data_, offset_, size);
+        offset_ += size;
+        return true;
+    }
+
+    std::size_t getRemainingSize() const { return data_.size() - offset_; }
+    bool isEnd() const { return offset_ == data_.size(); }
+
+private:
+    const std::string& data_;
+    std::size_t offset_;
+};
+
 template <typename T>
 class ClientParameter : public IPersistentParameter {
 public:
-    ClientParameter(const std::string& name, const T& v) : attributeName_(name) {
+    ClientParameter(const std::string& name, const T& v) : attributeName_(name), isChanged_(true) {
         value_ = v;
     }
-    void save(std::ostream &os);
+    const std::string& encode()
+    {
+        if (isChanged_) {
+            encodedValue_.clear();
+            encodeValue(encodedValue_);
+            isChanged_ = false;
+        }
+        return encodedValue_;
+    }
+    bool decode(const std::string &encodedValue)
+    {
+        StateDecoder decoder(encodedValue);
+        T value;
+        if (!decodeValue(decoder, value) || !decoder.isEnd()) {
+            return false;
+        }
+        setValue(value);
+        return true;
+    }
     void read(const std::string &strValue);
     boost::any getValue() const { return value_; }
-    void setValue(boost::any v) { value_ = boost::any_cast<const T&>(v); }
+    void setValue(boost::any v) { value_ = boost::any_cast<const T&>(v); isChanged_ = true; }
+private:
+    void encodeValue(std::string& out) const;
+    static bool decodeValue(StateDecoder& decoder, T& value);
 private:
     std::string attributeName_;
     T value_;
+
+    std::string encodedValue_;
+    bool isChanged_;
 };
 
 template<>
-void ClientParameter<std::int32_t>::save(std::ostream &os)
+void ClientParameter<std::int32_t>::encodeValue(std::string& out) const
+{
+    encodeInteger(out, value_);
+}
+
+template<>
+bool ClientParameter<std::int32_t>::decodeValue(StateDecoder& decoder, std::int32_t& value)
 {
-    os << attributeName_ << "=" << value_ << std::endl;
+    return decoder.readInteger(value);
 }
 
 template<>
-void ClientParameter<bool>::save(std::ostream &os) {
-    os << attributeName_ << "=" << value_ << std::endl;
+void ClientParameter<bool>::encodeValue(std::string& out) const
+{
+    encodeInteger<std::uint8_t>(out, value_ ? 1 : 0);
 }
 
 template<>
-void ClientParameter<std::string>::save(std::ostream &os) {
-    if (!value_.empty()) {
-        os << attributeName_ << "=" << value_ << std::endl;
+bool ClientParameter<bool>::decodeValue(StateDecoder& decoder, bool& value)
+{
+    std::uint8_t byte = 0;
+    if (!decoder.readInteger(byte)) {
+        return false;
     }
+    value = byte;
+    return true;
 }
 
 template<>
-void ClientParameter<Topics>::save(std::ostream &os)
+void ClientParameter<std::string>::encodeValue(std::string& out) const
 {
-    if (value_.begin() != value_.end()) {
-        os << attributeName_ << "=";
-        for (auto it = value_.begin(); it != value_.end(); ++it) {
-            if (it != value_.begin()) {
-                os << ",";
-            }
+    out.append(value_);
+}
 
-            os << "[" << it->id << ","
-                      << convertToByteArrayString(it->name) << ","
-                      << (it->subscriptionType == SubscriptionType::MANDATORY_SUBSCRIPTION ? "m" : "v")
-                      << "]";
-        }
-        os << std::endl;
+template<>
+bool ClientParameter<std::string>::decodeValue(StateDecoder& decoder, std::string& value)
+{
+    return decoder.readBytes(value, decoder.getRemainingSize());
+}
+
+template<>
+void ClientParameter<HashDigest>::encodeValue(std::string& out) const
+{
+    out.append(value_.begin(), value_.end());
+}
+
+template<>
+bool ClientParameter<HashDigest>::decodeValue(StateDecoder& decoder, HashDigest& value)
+{
+    std::string bytes;
+    if (!decoder.readBytes(bytes, decoder.getRemainingSize())) {
+        return false;
     }
+    value.assign(bytes.begin(), bytes.end());
+    return true;
 }
 
 template<>
-void ClientParameter<AttachedEndpoints>::save(std::ostream &os)
+void ClientParameter<Topics>::encodeValue(std::string& out) const
 {
-    if (value_.begin() != value_.end()) {
-        os << attributeName_ << "=";
-        for (auto it = value_.begin(); it != value_.end(); ++it) {
-            if (it != value_.begin()) {
-                os << ",";
-            }
+    encodeInteger<std::uint32_t>(out, value_.size());
+    for (const auto& topic : value_) {
+        encodeInteger(out, topic.id);
+        encodeInteger<std::uint8_t>(out, topic.subscriptionType == SubscriptionType::MANDATORY_SUBSCRIPTION ? 0 : 1);
+        encodeString(out, topic.name);
+    }
+}
 
-            os << "[" << convertToByteArrayString(it->second) << ","
-                      << convertToByteArrayString(it->second) << "]";
+template<>
+bool ClientParameter<Topics>::decodeValue(StateDecoder& decoder, Topics& value)
+{
+    std::uint32_t count = 0;
+    if (!decoder.readInteger(count)) {
+        return false;
+    }
+
+    value.clear();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        Topic topic;
+        std::uint8_t subscriptionType = 0;
+        if (!decoder.readInteger(topic.id) || !decoder.readInteger(subscriptionType) || !decoder.readString(topic.name)) {
+            return false;
         }
-        os << std::endl;
+        topic.subscriptionType = (subscriptionType ? SubscriptionType::OPTIONAL_SUBSCRIPTION : SubscriptionType::MANDATORY_SUBSCRIPTION);
+        value.push_back(topic);
+    }
+    return true;
+}
+
+template<>
+void ClientParameter<AttachedEndpoints>::encodeValue(std::string& out) const
+{
+    encodeInteger<std::uint32_t>(out, value_.size());
+    for (const auto& endpoint : value_) {
+        encodeString(out, endpoint.first);
+        encodeString(out, endpoint.second);
     }
 }
 
 template<>
-void ClientParameter<HashDigest>::save(std::ostream &os)
+bool ClientParameter<AttachedEndpoints>::decodeValue(StateDecoder& decoder, AttachedEndpoints& value)
 {
-    if (!value_.empty()) {
-        os << attributeName_ << "=";
-        for (auto it = value_.begin(); it != value_.end(); ++it) {
-            os << std::setw(2) << std::setfill('0')  << std::hex << (int)*it;
+    std::uint32_t count = 0;
+    if (!decoder.readInteger(count)) {
+        return false;
+    }
+
+    value.clear();
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::string token;
+        std::string hash;
+        if (!decoder.readString(token) || !decoder.readString(hash)) {
+            return false;
         }
-        os << std::dec << std::setw(1) << std::endl;
+        value.insert(std::make_pair(token, hash));
     }
+    return true;
 }
 
 template<typename T>
@@ -303,7 +484,10 @@ void ClientParameter<HashDigest>::read(const std::string &strValue)
   ClientStatus::ClientStatus(IKaaClientContext& context)
       : filename_(context.getProperties().getStateFileName()),
         isSDKPropertiesForUpdated_(false), hasUpdate_(false),
-        context_(context)
+        context_(context),
+        savePeriod_(context.getProperties().getStateSavePeriod()),
+        hasPendingState_(false),
+        saveTimer_("Client status save timer")
 {
     auto eventSeqNumberTokenParamToken = parameterToToken_.left.find(ClientParameterT::EVENT_SEQUENCE_NUMBER);
     if (eventSeqNumberTokenParamToken != parameterToToken_.left.end()) {
@@ -379,6 +563,19 @@ void ClientParameter<HashDigest>::read(const std::string &strValue)
     checkSDKPropertiesForUpdates();
 }
 
+ClientStatus::~ClientStatus()
+{
+    saveTimer_.stop();
+
+    /*
+     * Only a write postponed by save() is completed. Nothing is written if the state file is up to date.
+     */
+    KAA_MUTEX_UNIQUE_DECLARE(lock, saveGuard_);
+    if (hasPendingState_) {
+        writeStateFile();
+    }
+}
+
 void ClientStatus::checkSDKPropertiesForUpdates()
 {
     HashDigest truePropertiesHash = getPropertiesHash();
@@ -520,7 +717,79 @@ void ClientStatus::setEndpointAttachStatus(bool isAttached)
 
 void ClientStatus::read()
 {
-    std::ifstream stateFile(filename_);
+    std::ifstream stateFile(filename_, std::ios::binary);
+    if (!stateFile.good()) {
+        return;
+    }
+
+    std::string image((std::istreambuf_iterator<char>(stateFile)), std::istreambuf_iterator<char>());
+
+    if (!image.compare(0, STATE_FILE_SIGNATURE.size(), STATE_FILE_SIGNATURE)) {
+        if (!readBinary(image)) {
+            KAA_LOG_WARN(boost::format("State file '%1%' is corrupted, the rest of it is ignored") % filename_);
+        }
+    } else {
+        KAA_LOG_INFO(boost::format("Migrating text state file '%1%' to the binary format") % filename_);
+
+        std::istringstream textStateFile(image);
+        readText(textStateFile);
+
+        /*
+         * Rewrite the file in the binary format on the next save.
+         */
+        hasUpdate_ = true;
+    }
+
+    KAA_LOG_DEBUG(boost::format("Read topic list hash: %1%") % getTopicListHash());
+}
+
+bool ClientStatus::readBinary(const std::string& image)
+{
+    StateDecoder decoder(image, STATE_FILE_SIGNATURE.size());
+
+    std::uint8_t version = 0;
+    if (!decoder.readInteger(version) || version != STATE_FILE_VERSION) {
+        KAA_LOG_WARN(boost::format("Unsupported state file version %1%") % (int)version);
+        return false;
+    }
+
+    while (!decoder.isEnd()) {
+        std::uint8_t recordType = 0;
+        std::string value;
+        if (!decoder.readInteger(recordType) || !decoder.readString(value)) {
+            return false;
+        }
+
+        if (recordType == TOPIC_STATES_RECORD) {
+            StateDecoder statesDecoder(value);
+            std::uint32_t count = 0;
+            if (!statesDecoder.readInteger(count)) {
+                return false;
+            }
+
+            topicStates_.clear();
+            for (std::uint32_t i = 0; i < count; ++i) {
+                std::int64_t topicId = 0;
+                std::int32_t sqn = 0;
+                if (!statesDecoder.readInteger(topicId) || !statesDecoder.readInteger(sqn)) {
+                    return false;
+                }
+                topicStates_.insert(std::make_pair(topicId, sqn));
+            }
+            continue;
+        }
+
+        auto it = parameters_.find(static_cast<ClientParameterT>(recordType));
+        if (it != parameters_.end() && !it->second->decode(value)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void ClientStatus::readText(std::istream& stateFile)
+{
     std::string value;
     std::string token;
 
@@ -549,10 +818,36 @@ void ClientStatus::read()
             }
         }
     }
+}
 
-    KAA_LOG_DEBUG(boost::format("Read topic list hash: %1%") % getTopicListHash());
+std::string ClientStatus::encodeState()
+{
+    std::string image(STATE_FILE_SIGNATURE);
+    encodeInteger(image, STATE_FILE_VERSION);
+
+    /*
+     * Topic states may be changed in place through getTopicStates(), so they are always re-encoded.
+     */
+    encodeInteger(image, TOPIC_STATES_RECORD);
+    encodeInteger<std::uint32_t>(image, sizeof(std::uint32_t) +
+                                 topicStates_.size() * (sizeof(std::int64_t) + sizeof(std::int32_t)));
+    encodeInteger<std::uint32_t>(image, topicStates_.size());
+    for (const auto& state : topicStates_) {
+        encodeInteger(image, state.first);
+        encodeInteger(image, state.second);
+    }
 
-    stateFile.close();
+    /*
+     * Unchanged parameters keep their encoded values from the previous save.
+     */
+    for (auto& parameter : parameters_) {
+        const std::string& value = parameter.second->encode();
+        image.reserve(image.size() + RECORD_HEADER_SIZE + value.size());
+        encodeInteger(image, static_cast<std::uint8_t>(parameter.first));
+        encodeString(image, value);
+    }
+
+    return image;
 }
 
 void ClientStatus::save()
@@ -561,26 +856,91 @@ void ClientStatus::save()
         return;
     }
 
-    std::ofstream stateFile(filename_);
+    KAA_MUTEX_UNIQUE_DECLARE(lock, saveGuard_);
 
-    /* Save topic list hash */
-    if (stateFile.good()) {
-        KAA_LOG_DEBUG("Persisting topic states");
-        stateFile << "topic_states=";
-        for (auto &subscription : topicStates_) {
-             stateFile << subscription.first << ' ' << subscription.second << ' ';
-        }
-        stateFile << std::endl;
+    pendingState_ = encodeState();
+    hasPendingState_ = true;
+    hasUpdate_ = false;
+
+    auto sinceLastSave = std::chrono::steady_clock::now() - lastSaveTime_;
+    if (savePeriod_.count() && sinceLastSave < savePeriod_) {
+        KAA_LOG_TRACE("Postponing state file write");
+        saveTimer_.start(std::chrono::duration_cast<std::chrono::milliseconds>(savePeriod_ - sinceLastSave),
+                         [this]
+                         {
+                             /*
+                              * Only the state encoded by the last save() is written, the parameters
+                              * may be being changed by other threads.
+                              */
+                             KAA_MUTEX_UNIQUE_DECLARE(timerLock, saveGuard_);
+                             if (hasPendingState_) {
+                                 writeStateFile();
+                             }
+                         });
+        return;
+    }
+
+    writeStateFile();
+}
+
+void ClientStatus::flush()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, saveGuard_);
+
+    if (hasUpdate_) {
+        pendingState_ = encodeState();
+        hasPendingState_ = true;
+        hasUpdate_ = false;
     }
 
-    /* Save other parameters */
-    for (auto parameter : parameters_) {
-        parameter.second->save(stateFile);
+    if (hasPendingState_) {
+        writeStateFile();
     }
+}
 
-    stateFile.close();
+void ClientStatus::writeStateFile()
+{
+    const std::string tmpFilename = filename_ + ".tmp";
 
-    hasUpdate_ = false;
+    KAA_LOG_DEBUG(boost::format("Persisting client state (%1% bytes)") % pendingState_.size());
+
+    /*
+     * The temporary file is synced before the rename, otherwise a crash may leave an empty state file.
+     */
+    std::FILE *stateFile = std::fopen(tmpFilename.c_str(), "wb");
+    bool isWritten = stateFile
+                  && std::fwrite(pendingState_.data(), 1, pendingState_.size(), stateFile) == pendingState_.size()
+                  && !std::fflush(stateFile)
+                  && syncFile(stateFile);
+
+    if (stateFile) {
+        isWritten = !std::fclose(stateFile) && isWritten;
+    }
+
+    if (!isWritten) {
+        KAA_LOG_ERROR(boost::format("Failed to write state file '%1%'") % tmpFilename);
+        std::remove(tmpFilename.c_str());
+        return;
+    }
+
+#ifdef _WIN32
+    /*
+     * Unlike POSIX, Windows doesn't replace an existing file on rename.
+     */
+    std::remove(filename_.c_str());
+#endif
+
+    if (std::rename(tmpFilename.c_str(), filename_.c_str())) {
+        KAA_LOG_ERROR(boost::format("Failed to replace state file '%1%'") % filename_);
+        std::remove(tmpFilename.c_str());
+        return;
+    }
+
+    syncParentDirectory(filename_);
+
+    lastSaveTime_ = std::chrono::steady_clock::now();
+    hasPendingState_ = false;
+    pendingState_.clear();
 }
 
 std::int32_t ClientStatus::getEventSequenceNumber() const
@@ -139,6 +139,7 @@ void KaaClient::stop()
             try {
                 channelManager_->shutdown();
                 status_->save();
+                status_->flush();
                 stateListener_->onStopped();
             } catch (std::exception& e) {
                 stateListener_->onStopFailure(KaaException(e));
@@ -157,6 +158,7 @@ void KaaClient::pause()
         {
             try {
                 status_->save();
+                status_->flush();
                 channelManager_->pause();
                 stateListener_->onPaused();
             } catch (std::exception& e) {
@@ -553,6 +555,16 @@ RecordFuture KaaClient::addLogRecord(const KaaUserLogRecord& record)
 #endif
 }
 
+std::vector<RecordFuture> KaaClient::addLogRecords(const std::vector<KaaUserLogRecord>& records)
+{
+#ifdef KAA_USE_LOGGING
+    checkClientState(State::STARTED, "Kaa client isn't started");
+    return logCollector_->addLogRecords(records);
+#else
+    throw KaaException("Failed to add log records. Logging subsystem is disabled");
+#endif
+}
+
 void KaaClient::setLogDeliveryListener(ILogDeliveryListenerPtr listener)
 {
 #ifdef KAA_USE_LOGGING
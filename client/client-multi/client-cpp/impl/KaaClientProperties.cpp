@@ -32,6 +32,8 @@ namespace kaa {
 
 const std::string KaaClientProperties::PROP_WORKING_DIR = "kaa.work_dir";
 const std::string KaaClientProperties::PROP_STATE_FILE = "kaa.state.file";
+const std::string KaaClientProperties::PROP_STATE_SAVE_PERIOD = "kaa.state.save_period";
+const std::string KaaClientProperties::PROP_SYNC_COALESCING_WINDOW = "kaa.sync.coalescing_window";
 const std::string KaaClientProperties::PROP_PUB_KEY_FILE = "kaa.keys.public";
 const std::string KaaClientProperties::PROP_PRIV_KEY_FILE = "kaa.keys.private";
 const std::string KaaClientProperties::PROP_LOGS_DB = "kaa.logs.db_file";
@@ -41,6 +43,8 @@ const std::string KaaClientProperties::PROP_LOG_FILE_NAME = "kaa.log.file.name";
 
 const std::string KaaClientProperties::DEFAULT_WORKING_DIR = std::string(".") + &FILE_SEPARATOR;
 const std::string KaaClientProperties::DEFAULT_STATE_FILE = CLIENT_STATUS_FILE_LOCATION;
+const std::string KaaClientProperties::DEFAULT_STATE_SAVE_PERIOD = "0";
+const std::string KaaClientProperties::DEFAULT_SYNC_COALESCING_WINDOW = "0";
 const std::string KaaClientProperties::DEFAULT_PUB_KEY_FILE = CLIENT_PUB_KEY_LOCATION;
 const std::string KaaClientProperties::DEFAULT_PRIV_KEY_FILE = CLIENT_PRIV_KEY_LOCATION;
 const std::string KaaClientProperties::DEFAULT_LOGS_DB = "logs.db";
@@ -83,6 +87,8 @@ void KaaClientProperties::initByDefaults()
     properties_.clear();
     properties_.insert(std::make_pair(PROP_WORKING_DIR, DEFAULT_WORKING_DIR));
     properties_.insert(std::make_pair(PROP_STATE_FILE, DEFAULT_STATE_FILE));
+    properties_.insert(std::make_pair(PROP_STATE_SAVE_PERIOD, DEFAULT_STATE_SAVE_PERIOD));
+    properties_.insert(std::make_pair(PROP_SYNC_COALESCING_WINDOW, DEFAULT_SYNC_COALESCING_WINDOW));
     properties_.insert(std::make_pair(PROP_PUB_KEY_FILE, DEFAULT_PUB_KEY_FILE));
     properties_.insert(std::make_pair(PROP_PRIV_KEY_FILE, DEFAULT_PRIV_KEY_FILE));
     properties_.insert(std::make_pair(PROP_LOGS_DB, DEFAULT_LOGS_DB));
@@ -121,6 +127,16 @@ void KaaClientProperties::setStateFileName(const std::string& fileName)
     setProperty(PROP_STATE_FILE, fileName);
 }
 
+void KaaClientProperties::setStateSavePeriod(std::size_t period)
+{
+    setProperty(PROP_STATE_SAVE_PERIOD, std::to_string(period));
+}
+
+void KaaClientProperties::setSyncCoalescingWindow(std::size_t window)
+{
+    setProperty(PROP_SYNC_COALESCING_WINDOW, std::to_string(window));
+}
+
 void KaaClientProperties::setPublicKeyFileName(const std::string& fileName)
 {
     checkEmptyness(fileName, "Empty value of public key file name");
@@ -25,6 +25,8 @@
 #include "kaa/KaaDefaults.hpp"
 #include "kaa/logging/Log.hpp"
 #include "kaa/logging/LoggingUtils.hpp"
+#include "kaa/context/IExecutorContext.hpp"
+#include "kaa/utils/IThreadPool.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
@@ -33,6 +35,14 @@ void BootstrapManager::setFailoverStrategy(IFailoverStrategyPtr strategy) {
     failoverStrategy_ = strategy;
 }
 
+void BootstrapManager::retryOperationsServerList()
+{
+    /*
+     * The request may block on the network, so it isn't made on the timer thread.
+     */
+    context_.getExecutorContext().getLifeCycleExecutor().add([this] { receiveOperationsServerList(); });
+}
+
 void BootstrapManager::receiveOperationsServerList()
 {
     if (bootstrapTransport_ != nullptr) {
@@ -89,7 +99,7 @@ void BootstrapManager::useNextOperationsServer(const TransportProtocolId& protoc
                     KAA_LOG_WARN(boost::format("Attempt to receive operations server list will be made in %1% secs "
                             "according to failover strategy decision.") % period);
                     retryTimer_.stop();
-                    retryTimer_.start(period, [&] { receiveOperationsServerList(); });
+                    retryTimer_.start(period, [&] { retryOperationsServerList(); });
                     break;
                 }
                 case FailoverStrategyAction::STOP_APP:
@@ -151,7 +161,7 @@ void BootstrapManager::onServerListUpdated(const std::vector<ProtocolMetaData>&
             KAA_LOG_WARN(boost::format("Attempt to receive operations server list will be made in %1% secs "
                                        "according to failover strategy decision.") % period);
             retryTimer_.stop();
-            retryTimer_.start(period, [&] { receiveOperationsServerList(); });
+            retryTimer_.start(period, [&] { retryOperationsServerList(); });
             break;
         }
         case FailoverStrategyAction::USE_NEXT_BOOTSTRAP:
@@ -18,15 +18,20 @@
 
 #include <sstream>
 
+#include "kaa/KaaClientProperties.hpp"
 #include "kaa/logging/Log.hpp"
 #include "kaa/logging/LoggingUtils.hpp"
+#include "kaa/context/IExecutorContext.hpp"
+#include "kaa/utils/IThreadPool.hpp"
 #include "kaa/bootstrap/IBootstrapManager.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
 
 KaaChannelManager::KaaChannelManager(IBootstrapManager& manager, const BootstrapServers& servers, IKaaClientContext &context)
-    : bootstrapManager_(manager), retryTimer_("KaaChannelManager retryTimer"), isShutdown_(false), isPaused_(false), bsTransportId_(0,0), context_(context)
+    : bootstrapManager_(manager), retryTimer_("KaaChannelManager retryTimer"), isShutdown_(false), isPaused_(false),
+      syncWindow_(context.getProperties().getSyncCoalescingWindow()), latencyCriticalTypes_({ TransportType::BOOTSTRAP }),
+      syncTimer_("KaaChannelManager syncTimer"), bsTransportId_(0,0), context_(context)
 {
     for (const auto& connectionInfo : servers) {
         auto& list = bootstrapServers_[connectionInfo->getTransportId()];
@@ -94,7 +99,13 @@ void KaaChannelManager::onServerFailed(ITransportConnectionInfoPtr connectionInf
                      retryTimer_.stop();
                      retryTimer_.start(period, [&]
                          {
-                             onTransportConnectionInfoUpdated(getNextBootstrapServer(bsTransportId_, true));
+                             /*
+                              * Switching the server may block, so it isn't done on the timer thread.
+                              */
+                             context_.getExecutorContext().getLifeCycleExecutor().add([this]
+                                 {
+                                     onTransportConnectionInfoUpdated(getNextBootstrapServer(bsTransportId_, true));
+                                 });
                          });
                      break;
                  }
@@ -347,6 +358,117 @@ IDataChannelPtr KaaChannelManager::getChannelByTransportType(TransportType type)
     return channel;
 }
 
+static void syncChannel(IDataChannelPtr channel, const std::set<TransportType>& types)
+{
+    if (types.size() == 1) {
+        channel->sync(*types.begin());
+    } else {
+        channel->sync(types);
+    }
+}
+
+void KaaChannelManager::sync(TransportType type)
+{
+    IDataChannelPtr channel = getChannelByTransportType(type);
+    if (!channel) {
+        throw KaaException("Cannot find appropriate channel");
+    }
+
+    if (!syncWindow_.count()) {
+        channel->sync(type);
+        return;
+    }
+
+    std::set<TransportType> types = { type };
+
+    {
+        KAA_MUTEX_LOCKING("pendingSyncGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(pendingSyncLock, pendingSyncGuard_);
+        KAA_MUTEX_LOCKED("pendingSyncGuard_");
+
+        if (isShutdown_) {
+            KAA_LOG_WARN(boost::format("Can't sync transport type %1%. Channel manager is down")
+                                % LoggingUtils::TransportTypeToString(type));
+            return;
+        }
+
+        if (latencyCriticalTypes_.find(type) == latencyCriticalTypes_.end()) {
+            if (pendingSyncTypes_.empty()) {
+                syncTimer_.start(syncWindow_, [this]
+                    {
+                        /*
+                         * A channel may send the request synchronously, so it isn't done on the timer thread.
+                         */
+                        context_.getExecutorContext().getApiExecutor().add([this] { syncPendingTypes(); });
+                    });
+            }
+
+            KAA_LOG_TRACE(boost::format("Sync of transport type %1% is delayed for %2% ms")
+                                % LoggingUtils::TransportTypeToString(type) % syncWindow_.count());
+            pendingSyncTypes_.insert(type);
+            return;
+        }
+
+        /*
+         * Types waiting for the same channel are sent along with the latency-critical one.
+         */
+        for (auto it = pendingSyncTypes_.begin(); it != pendingSyncTypes_.end();) {
+            if (getChannelByTransportType(*it) == channel) {
+                types.insert(*it);
+                it = pendingSyncTypes_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    syncChannel(channel, types);
+}
+
+void KaaChannelManager::syncPendingTypes()
+{
+    std::set<TransportType> pendingSyncTypes;
+
+    {
+        KAA_MUTEX_LOCKING("pendingSyncGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(pendingSyncLock, pendingSyncGuard_);
+        KAA_MUTEX_LOCKED("pendingSyncGuard_");
+
+        if (isShutdown_) {
+            return;
+        }
+
+        pendingSyncTypes.swap(pendingSyncTypes_);
+    }
+
+    /*
+     * Channels are looked up again, as they may have been replaced within the window.
+     */
+    std::map<IDataChannelPtr, std::set<TransportType>> channelTypes;
+    for (auto type : pendingSyncTypes) {
+        IDataChannelPtr channel = getChannelByTransportType(type);
+        if (channel) {
+            channelTypes[channel].insert(type);
+        } else {
+            KAA_LOG_WARN(boost::format("Can't sync transport type %1%. Channel is not found")
+                                % LoggingUtils::TransportTypeToString(type));
+        }
+    }
+
+    for (const auto& channelInfo : channelTypes) {
+        syncChannel(channelInfo.first, channelInfo.second);
+    }
+}
+
+void KaaChannelManager::setLatencyCriticalTypes(const std::set<TransportType>& types)
+{
+    KAA_MUTEX_LOCKING("pendingSyncGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(pendingSyncLock, pendingSyncGuard_);
+    KAA_MUTEX_LOCKED("pendingSyncGuard_");
+
+    latencyCriticalTypes_ = types;
+}
+
 IDataChannelPtr KaaChannelManager::getChannel(const std::string& channelId)
 {
     KAA_MUTEX_LOCKING("channelGuard_");
@@ -439,7 +561,18 @@ void KaaChannelManager::setConnectivityChecker(ConnectivityCheckerPtr checker) {
 void KaaChannelManager::doShutdown()
 {
     if (!isShutdown_) {
-        isShutdown_ = true;
+        {
+            KAA_MUTEX_LOCKING("pendingSyncGuard_");
+            KAA_MUTEX_UNIQUE_DECLARE(pendingSyncLock, pendingSyncGuard_);
+            KAA_MUTEX_LOCKED("pendingSyncGuard_");
+
+            /*
+             * Set under the guard, so a concurrent sync() can't arm the timer after it is stopped.
+             */
+            isShutdown_ = true;
+            syncTimer_.stop();
+            pendingSyncTypes_.clear();
+        }
 
         KAA_MUTEX_LOCKING("mappedChannelGuard_");
         KAA_R_MUTEX_UNIQUE_DECLARE(mappedChannelLock, mappedChannelGuard_);
@@ -205,13 +205,16 @@ std::vector<std::uint8_t> SyncDataProcessor::compileRequest(const std::map<Trans
         }
     }
 
-    std::vector<std::uint8_t> encodedData;
-    requestConverter_.toByteArray(request, encodedData);
+    /*
+     * The request is encoded into the per-thread pooled buffer, so the only allocation
+     * is the exactly sized result.
+     */
+    const auto& encodedData = AvroByteArrayConverter<SyncRequest>::getThreadLocalConverter().toPooledByteArray(request);
 
-    return encodedData;
+    return std::vector<std::uint8_t>(encodedData.begin(), encodedData.end());
 }
 
-DemultiplexerReturnCode SyncDataProcessor::processResponse(const std::vector<std::uint8_t> &response)
+DemultiplexerReturnCode SyncDataProcessor::processResponse(const ByteArrayView& response)
 {
     if (response.empty()) {
         return DemultiplexerReturnCode::FAILURE;
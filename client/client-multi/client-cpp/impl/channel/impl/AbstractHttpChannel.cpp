@@ -18,6 +18,7 @@
 
 #include "kaa/channel/impl/AbstractHttpChannel.hpp"
 #include "kaa/common/exception/HttpTransportException.hpp"
+#include "kaa/logging/LoggingUtils.hpp"
 
 namespace kaa {
 
@@ -58,9 +59,7 @@ void AbstractHttpChannel::processTypes(const std::map<TransportType, ChannelDire
         KAA_MUTEX_UNLOCKED("channelGuard_");
 
         if (!processedResponse.empty()) {
-            demultiplexer_->processResponse(
-                    std::vector<std::uint8_t>(reinterpret_cast<const std::uint8_t *>(processedResponse.data()),
-                                              reinterpret_cast<const std::uint8_t *>(processedResponse.data() + processedResponse.size())));
+            demultiplexer_->processResponse(ByteArrayView(processedResponse));
         }
     } catch (HttpTransportException& e) {
         switch (e.getHttpStatusCode()) {
@@ -102,24 +101,40 @@ void AbstractHttpChannel::onServerFailed()
 
 void AbstractHttpChannel::sync(TransportType type)
 {
+    sync(std::set<TransportType>({ type }));
+}
+
+
+void AbstractHttpChannel::sync(const std::set<TransportType>& types)
+{
+    std::map<TransportType, ChannelDirection> syncTypes;
     const auto& supportedTypes = getSupportedTransportTypes();
-    auto it = supportedTypes.find(type);
-    if (it != supportedTypes.end() && (it->second == ChannelDirection::UP || it->second == ChannelDirection::BIDIRECTIONAL)) {
-        KAA_MUTEX_LOCKING("channelGuard_");
-        KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
-        KAA_MUTEX_LOCKED("channelGuard_");
-        if (currentServer_) {
-            processTypes(std::map<TransportType, ChannelDirection>({ { type, it->second } })
-#ifdef KAA_THREADSAFE
-                       , lock
-#endif
-                        );
+    for (auto type : types) {
+        auto it = supportedTypes.find(type);
+        if (it != supportedTypes.end() && (it->second == ChannelDirection::UP || it->second == ChannelDirection::BIDIRECTIONAL)) {
+            syncTypes.insert(*it);
         } else {
-            lastConnectionFailed_ = true;
-            KAA_LOG_WARN(boost::format("Can't sync channel %1%. Server is null") % getId());
+            KAA_LOG_ERROR(boost::format("Unsupported transport type %1% for channel %2%")
+                                % LoggingUtils::TransportTypeToString(type) % getId());
         }
+    }
+
+    if (syncTypes.empty()) {
+        return;
+    }
+
+    KAA_MUTEX_LOCKING("channelGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    KAA_MUTEX_LOCKED("channelGuard_");
+    if (currentServer_) {
+        processTypes(syncTypes
+#ifdef KAA_THREADSAFE
+                   , lock
+#endif
+                    );
     } else {
-        KAA_LOG_ERROR(boost::format("Unsupported transport type for channel %1%") % getId());
+        lastConnectionFailed_ = true;
+        KAA_LOG_WARN(boost::format("Can't sync channel %1%. Server is null") % getId());
     }
 }
 
@@ -119,9 +119,7 @@ void DefaultOperationLongPollChannel::executeTask()
         KAA_MUTEX_UNLOCKING("channelGuard_");
         KAA_UNLOCK(lockInternal);
         KAA_MUTEX_UNLOCKED("channelGuard_");
-        demultiplexer_->processResponse(
-                std::vector<std::uint8_t>(reinterpret_cast<const std::uint8_t *>(processedResponse.data()),
-                                            reinterpret_cast<const std::uint8_t *>(processedResponse.data() + processedResponse.size())));
+        demultiplexer_->processResponse(ByteArrayView(processedResponse));
 
         KAA_MUTEX_LOCKING("conditionMutex_");
         KAA_MUTEX_UNIQUE_DECLARE(conditionLock, conditionMutex_);
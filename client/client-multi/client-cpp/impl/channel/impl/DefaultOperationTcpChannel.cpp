@@ -35,7 +35,6 @@
 #include "kaa/kaatcp/KaaSyncRequest.hpp"
 #include "kaa/kaatcp/PingRequest.hpp"
 #include "kaa/kaatcp/DisconnectMessage.hpp"
-#include "kaa/http/HttpUtils.hpp"
 #include "kaa/IKaaClientStateStorage.hpp"
 
 namespace kaa {
@@ -44,6 +43,7 @@ const std::uint16_t DefaultOperationTcpChannel::CHANNEL_TIMEOUT = 200;
 const std::uint16_t DefaultOperationTcpChannel::PING_TIMEOUT = CHANNEL_TIMEOUT / 2;
 const std::uint16_t DefaultOperationTcpChannel::CONN_ACK_TIMEOUT = 20;
 const std::uint16_t DefaultOperationTcpChannel::RECONNECT_TIMEOUT = 5; // sec
+const std::uint16_t DefaultOperationTcpChannel::CONNECT_TIMEOUT = 10; // sec
 
 const std::uint32_t DefaultOperationTcpChannel::KAA_PLATFORM_PROTOCOL_AVRO_ID = 0xf291f2d4;
 
@@ -61,9 +61,10 @@ const std::map<TransportType, ChannelDirection> DefaultOperationTcpChannel::SUPP
 
 DefaultOperationTcpChannel::DefaultOperationTcpChannel(IKaaChannelManager *channelManager, const KeyPair& clientKeys, IKaaClientContext &context)
     : clientKeys_(clientKeys), work_(io_), socketWork_(socketIo_),/*sock_(io_), */pingTimer_(io_), connAckTimer_(io_)/*, reconnectTimer_(io_)*/
+    , connectTimer_(socketIo_), resolver_(socketIo_)
     , retryTimer_("DefaultOperationTcpChannel retryTimer")
-    , firstStart_(true), isConnected_(false), isFirstResponseReceived_(false), isPendingSyncRequest_(false)
-    , isShutdown_(false), isPaused_(false), isFailoverInProgress_(false), multiplexer_(nullptr), demultiplexer_(nullptr)
+    , firstStart_(true), isConnected_(false), isConnecting_(false), connectionId_(0), isFirstResponseReceived_(false), isPendingSyncRequest_(false)
+    , isShutdown_(false), isPaused_(false), isFailoverInProgress_(false), isCompressionEnabled_(false), multiplexer_(nullptr), demultiplexer_(nullptr)
     , channelManager_(channelManager), responsePorcessor(context), context_(context)
 {
     responsePorcessor.registerConnackReceiver(std::bind(&DefaultOperationTcpChannel::onConnack, this, std::placeholders::_1));
@@ -84,8 +85,18 @@ void DefaultOperationTcpChannel::onConnack(const ConnackMessage& message)
     KAA_LOG_DEBUG(boost::format("Channel \"%1%\". Connack (result=%2%) response received") % getId() % message.getMessage());
 
     switch (message.getReturnCode()) {
-    case ConnackReturnCode::ACCEPTED:
+    case ConnackReturnCode::ACCEPTED: {
+#ifdef KAA_USE_TCP_COMPRESSION
+        KAA_MUTEX_LOCKING("channelGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+        KAA_MUTEX_LOCKED("channelGuard_");
+
+        isCompressionEnabled_ = message.isCompressionSupported();
+        KAA_LOG_DEBUG(boost::format("Channel \"%1%\". Payload compression is %2%")
+                                        % getId() % (isCompressionEnabled_ ? "enabled" : "disabled"));
+#endif
         break;
+    }
     case ConnackReturnCode::REFUSE_BAD_CREDENTIALS:
         KAA_LOG_WARN(boost::format("Channel \"%1%\". Connack result: bad credentials. Going to re-register... ") % getId());
         context_.getStatus().setRegistered(false);
@@ -114,9 +125,25 @@ void DefaultOperationTcpChannel::onKaaSync(const KaaSyncResponse& message)
     KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
     KAA_MUTEX_LOCKED("channelGuard_");
 
-    std::string decodedResposne;
+    /*
+     * The decoded response refers to the decoder buffer, so the decoder is kept alive
+     * until the response is processed even if the server is changed meanwhile.
+     */
+    std::shared_ptr<RsaEncoderDecoder> encDec = encDec_;
+    ByteArrayView decodedResponse;
     try {
-        decodedResposne = encDec_->decodeData(encodedResponse.data(), encodedResponse.size());
+        decodedResponse = encDec->decodeDataToBuffer(encodedResponse.data(), encodedResponse.size());
+
+        if (message.isZipped()) {
+#ifdef KAA_USE_TCP_COMPRESSION
+            /*
+             * Only the socket thread decompresses, so the view stays valid until the response is processed.
+             */
+            decodedResponse = compressor_.decompress(decodedResponse.data(), decodedResponse.size());
+#else
+            throw KaaException("Compressed KaaSync payloads are not supported");
+#endif
+        }
     } catch (const std::exception& e) {
         KAA_MUTEX_UNLOCKING("channelGuard_");
         KAA_UNLOCK(lock);
@@ -130,9 +157,7 @@ void DefaultOperationTcpChannel::onKaaSync(const KaaSyncResponse& message)
     KAA_UNLOCK(lock);
     KAA_MUTEX_UNLOCKED("channelGuard_");
 
-    auto returnCode = demultiplexer_->processResponse(
-                                            std::vector<std::uint8_t>(reinterpret_cast<const std::uint8_t *>(decodedResposne.data()),
-                                                    reinterpret_cast<const std::uint8_t *>(decodedResposne.data() + decodedResposne.size())));
+    auto returnCode = demultiplexer_->processResponse(decodedResponse);
 
     if (returnCode == DemultiplexerReturnCode::REDIRECT) {
         throw TransportRedirectException(boost::format("Channel \"%1%\". Redirect response received") % getId());
@@ -183,35 +208,83 @@ void DefaultOperationTcpChannel::onPingResponse()
 
 void DefaultOperationTcpChannel::openConnection()
 {
-    if (isConnected_) {
+    KAA_MUTEX_LOCKING("channelGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    KAA_MUTEX_LOCKED("channelGuard_");
+
+    if (isConnected_ || isConnecting_) {
         KAA_LOG_DEBUG(boost::format("Channel \"%1%\". Connection is already opened. Ignoring.") % getId());
         return;
     }
-    boost::asio::ip::tcp::endpoint ep;
-    try {
-        ep = HttpUtils::getEndpoint(currentServer_->getHost(), currentServer_->getPort());
-    } catch (std::exception& e) {
-        KAA_LOG_ERROR(boost::format("Channel \"%1%\". Connection to endpoint failed: %2%") % getId() % e.what());
-        onServerFailed();
+
+    isConnecting_ = true;
+
+    /*
+     * Resolving, connecting and sending CONNECT are done asynchronously on the socket thread,
+     * so the caller's thread is never blocked by the network.
+     */
+    socketIo_.post(std::bind(&DefaultOperationTcpChannel::resolveServer, this, ++connectionId_));
+}
+
+void DefaultOperationTcpChannel::resolveServer(std::size_t connectionId)
+{
+    if (!isConnectionPending(connectionId)) {
+        return;
     }
-    boost::system::error_code errorCode;
+
+    KAA_LOG_DEBUG(boost::format("Channel \"%1%\". Connecting to %2%:%3%")
+                    % getId() % currentServer_->getHost() % currentServer_->getPort());
+
     responseBuffer_.reset(new boost::asio::streambuf());
     sock_.reset(new boost::asio::ip::tcp::socket(socketIo_));
-    sock_->open(ep.protocol(), errorCode);
-    if (errorCode) {
-        KAA_LOG_ERROR(boost::format("Channel \"%1%\". Failed to open socket: %2%") % getId() % errorCode.message());
-        onServerFailed();
+
+    connectTimer_.expires_from_now(boost::posix_time::seconds(CONNECT_TIMEOUT));
+    connectTimer_.async_wait(std::bind(&DefaultOperationTcpChannel::onConnectTimeout, this,
+                                       std::placeholders::_1, connectionId));
+
+    boost::asio::ip::tcp::resolver::query query(currentServer_->getHost(),
+                                                std::to_string(currentServer_->getPort()),
+                                                boost::asio::ip::resolver_query_base::numeric_service);
+
+    resolver_.async_resolve(query, std::bind(&DefaultOperationTcpChannel::onResolve, this,
+                                             std::placeholders::_1, std::placeholders::_2, connectionId));
+}
+
+void DefaultOperationTcpChannel::onResolve(const boost::system::error_code& err,
+                                           boost::asio::ip::tcp::resolver::iterator endpoints,
+                                           std::size_t connectionId)
+{
+    if (!isConnectionPending(connectionId)) {
         return;
     }
-    sock_->connect(ep, errorCode);
-    if (errorCode) {
-        KAA_LOG_ERROR(boost::format(
-                        "Channel \"%1%\". Failed to connect to %2%:%3% socket: %4%")
-                        % getId() % ep.address().to_string() % ep.port()
-                        % errorCode.message());
-        onServerFailed();
+
+    if (err) {
+        onConnectionFailed(connectionId, (boost::format("Failed to resolve %1%:%2%: %3%")
+                                            % currentServer_->getHost() % currentServer_->getPort() % err.message()).str());
+        return;
+    }
+
+    boost::asio::async_connect(*sock_, endpoints, std::bind(&DefaultOperationTcpChannel::onConnect, this,
+                                                            std::placeholders::_1, std::placeholders::_2, connectionId));
+}
+
+void DefaultOperationTcpChannel::onConnect(const boost::system::error_code& err,
+                                           boost::asio::ip::tcp::resolver::iterator endpoint,
+                                           std::size_t connectionId)
+{
+    if (!isConnectionPending(connectionId)) {
         return;
     }
+
+    if (err) {
+        onConnectionFailed(connectionId, (boost::format("Failed to connect to %1%:%2%: %3%")
+                                            % currentServer_->getHost() % currentServer_->getPort() % err.message()).str());
+        return;
+    }
+
+    KAA_LOG_DEBUG(boost::format("Channel \"%1%\". Connected to %2%:%3%")
+                    % getId() % endpoint->endpoint().address().to_string() % endpoint->endpoint().port());
+
     KAA_MUTEX_LOCKING("channelGuard_");
     KAA_LOCK(channelGuard_);
     KAA_MUTEX_LOCKED("channelGuard_");
@@ -220,12 +293,86 @@ void DefaultOperationTcpChannel::openConnection()
     KAA_UNLOCK(channelGuard_);
     KAA_MUTEX_UNLOCKED("channelGuard_");
 
-    sendConnect();
+    sendConnect(connectionId);
     setConnAckTimer();
     readFromSocket();
     setTimer();
 }
 
+void DefaultOperationTcpChannel::onConnectSent(const boost::system::error_code& err, std::size_t connectionId)
+{
+    if (!isConnectionPending(connectionId)) {
+        return;
+    }
+
+    if (err) {
+        onConnectionFailed(connectionId, (boost::format("Failed to send CONNECT message: %1%") % err.message()).str());
+        return;
+    }
+
+    KAA_MUTEX_LOCKING("channelGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    KAA_MUTEX_LOCKED("channelGuard_");
+
+    if (connectionId == connectionId_) {
+        isConnecting_ = false;
+        connectTimer_.cancel();
+    }
+}
+
+void DefaultOperationTcpChannel::onConnectTimeout(const boost::system::error_code& err, std::size_t connectionId)
+{
+    if (!err) {
+        onConnectionFailed(connectionId, (boost::format("Connection timeout (%1% sec)") % CONNECT_TIMEOUT).str());
+    } else if (err != boost::asio::error::operation_aborted) {
+        KAA_LOG_ERROR(boost::format("Channel \"%1%\". Failed to process connection timeout: %2%") % getId() % err.message());
+    }
+}
+
+bool DefaultOperationTcpChannel::isConnectionPending(std::size_t connectionId)
+{
+    KAA_MUTEX_LOCKING("channelGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    KAA_MUTEX_LOCKED("channelGuard_");
+    return isConnecting_ && connectionId == connectionId_;
+}
+
+void DefaultOperationTcpChannel::onConnectionFailed(std::size_t connectionId, const std::string& reason)
+{
+    KAA_MUTEX_LOCKING("channelGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
+    KAA_MUTEX_LOCKED("channelGuard_");
+
+    /*
+     * Only the first failure of the current connection attempt is processed. Operations which are
+     * aborted because of it complete with errors too and are ignored here.
+     */
+    if (!isConnecting_ || connectionId != connectionId_) {
+        return;
+    }
+
+    isConnecting_ = false;
+
+    boost::system::error_code errorCode;
+    connectTimer_.cancel(errorCode);
+    resolver_.cancel();
+
+    /*
+     * Close the socket even if it's connected: a CONNECT message stuck in the socket
+     * would block the DISCONNECT one.
+     */
+    if (sock_) {
+        sock_->close(errorCode);
+    }
+
+    KAA_MUTEX_UNLOCKING("channelGuard_");
+    KAA_UNLOCK(lock);
+    KAA_MUTEX_UNLOCKED("channelGuard_");
+
+    KAA_LOG_ERROR(boost::format("Channel \"%1%\". %2%") % getId() % reason);
+    onServerFailed();
+}
+
 void DefaultOperationTcpChannel::closeConnection()
 {
     KAA_MUTEX_LOCKING("channelGuard_");
@@ -234,6 +381,7 @@ void DefaultOperationTcpChannel::closeConnection()
     bool wasConnected = isConnected_;
     isFirstResponseReceived_ = false;
     isConnected_ = false;
+    isConnecting_ = false;
     isPendingSyncRequest_ = false;
     KAA_MUTEX_UNLOCKING("channelGuard_");
     KAA_UNLOCK(lock);
@@ -310,21 +458,50 @@ boost::system::error_code DefaultOperationTcpChannel::sendKaaSync(const std::map
     KAA_MUTEX_LOCKED("channelGuard_");
     KAA_LOG_DEBUG(boost::format("Channel \"%1%\". Sending KAASYNC message") % getId());
     const auto& requestBody = multiplexer_->compileRequest(transportTypes);
-    const auto& requestEncoded = encDec_->encodeData(requestBody.data(), requestBody.size());
-    return sendData(KaaSyncRequest(false, true, 0, requestEncoded, KaaSyncMessageType::SYNC));
+    ByteArrayView request(requestBody);
+
+    bool isZipped = false;
+#ifdef KAA_USE_TCP_COMPRESSION
+    if (isCompressionEnabled_ && request.size() >= KaaTcpCommon::KAA_SYNC_COMPRESSION_THRESHOLD) {
+        ByteArrayView compressedRequest = compressor_.compress(request.data(), request.size());
+        if (!compressedRequest.empty()) {
+            KAA_LOG_TRACE(boost::format("Channel \"%1%\". Compressed KAASYNC payload %2% -> %3% bytes")
+                                                % getId() % request.size() % compressedRequest.size());
+            request = compressedRequest;
+            isZipped = true;
+        }
+    }
+#endif
+
+    encDec_->encodeData(request.data(), request.size(), encodeBuffer_);
+    return sendData(KaaSyncRequest(isZipped, true, 0, encodeBuffer_, KaaSyncMessageType::SYNC));
 }
 
-boost::system::error_code DefaultOperationTcpChannel::sendConnect()
+void DefaultOperationTcpChannel::sendConnect(std::size_t connectionId)
 {
     KAA_MUTEX_LOCKING("channelGuard_");
     KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
     KAA_MUTEX_LOCKED("channelGuard_");
     KAA_LOG_DEBUG(boost::format("Channel \"%1%\". Sending CONNECT message") % getId());
+
+    /*
+     * Compression is negotiated anew for each session.
+     */
+    isCompressionEnabled_ = false;
     const auto& requestBody = multiplexer_->compileRequest(getSupportedTransportTypes());
-    const auto& requestEncoded = encDec_->encodeData(requestBody.data(), requestBody.size());
+    encDec_->encodeData(requestBody.data(), requestBody.size(), encodeBuffer_);
     const auto& sessionKey = encDec_->getEncodedSessionKey();
-    const auto& signature = encDec_->signData(sessionKey.data(), sessionKey.size());
-    return sendData(ConnectMessage(CHANNEL_TIMEOUT, KAA_PLATFORM_PROTOCOL_AVRO_ID, signature, sessionKey, requestEncoded));
+    const auto& signature = encDec_->getSessionKeySignature();
+
+    /*
+     * The message must outlive the asynchronous write.
+     */
+    connectRequest_ = ConnectMessage(CHANNEL_TIMEOUT, KAA_PLATFORM_PROTOCOL_AVRO_ID, signature, sessionKey, encodeBuffer_).getRawMessage();
+
+    KAA_LOG_TRACE(boost::format("Channel \"%1%\". Sending message size=%2%") % getId() % connectRequest_.size());
+    boost::asio::async_write(*sock_, boost::asio::buffer(connectRequest_),
+                             std::bind(&DefaultOperationTcpChannel::onConnectSent, this,
+                                       std::placeholders::_1, connectionId));
 }
 
 boost::system::error_code DefaultOperationTcpChannel::sendDisconnect()
@@ -375,21 +552,22 @@ void DefaultOperationTcpChannel::onReadEvent(const boost::system::error_code& er
         KAA_LOG_TRACE(boost::format("Channel \"%1%\". onReadEvent err %2%") % getId() % err);
     }
     if (!err) {
-        std::ostringstream responseStream;
-        responseStream << responseBuffer_.get();
-        const auto& responseStr = responseStream.str();
+        const std::size_t receivedSize = responseBuffer_->size();
         try {
-            if (responseStr.empty()) {
+            if (!receivedSize) {
                  KAA_LOG_ERROR(boost::format("Channel \"%1%\". No data read from socket.") % getId());
                  std::this_thread::sleep_for(std::chrono::milliseconds(50));
                  //onServerFailed();
             } else {
-                responsePorcessor.processResponseBuffer(responseStr.data(), responseStr.size());
+                responsePorcessor.processResponseBuffers(responseBuffer_->data());
             }
+            responseBuffer_->consume(receivedSize);
         } catch (const TransportRedirectException& exception) {
+            responseBuffer_->consume(receivedSize);
             KAA_LOG_INFO(boost::format("Channel \"%1%\". Redirect response received.") % getId());
             return;
         } catch (const KaaException& exception) {
+            responseBuffer_->consume(receivedSize);
             KAA_LOG_ERROR(boost::format("Channel \"%1%\". Failed to process response buffer, reason: %2%") % getId() % exception.what());
             onServerFailed();
         }
@@ -519,6 +697,11 @@ void DefaultOperationTcpChannel::setServer(ITransportConnectionInfoPtr server)
 }
 
 void DefaultOperationTcpChannel::sync(TransportType type)
+{
+    sync(std::set<TransportType>({ type }));
+}
+
+void DefaultOperationTcpChannel::sync(const std::set<TransportType>& types)
 {
     KAA_MUTEX_LOCKING("channelGuard_");
     KAA_MUTEX_UNIQUE_DECLARE(lock, channelGuard_);
@@ -531,37 +714,40 @@ void DefaultOperationTcpChannel::sync(TransportType type)
         KAA_LOG_WARN(boost::format("Can't sync channel %1%. Channel is paused") % getId());
         return;
     }
-    const auto& types = getSupportedTransportTypes();
-    auto it = types.find(type);
-    if (it != types.end() && (it->second == ChannelDirection::UP || it->second == ChannelDirection::BIDIRECTIONAL)) {
-        if (currentServer_) {
-            if (isFirstResponseReceived_) {
-                KAA_MUTEX_UNLOCKING("channelGuard_");
-                KAA_UNLOCK(lock);
-                KAA_MUTEX_UNLOCKED("channelGuard_");
-
-                std::map<TransportType, ChannelDirection> types;
-                types.insert(std::make_pair(type, it->second));
-                for (auto typeIt = types.begin(); typeIt != types.end(); ++typeIt) {
-                    if (typeIt->first != type) {
-                        types.insert(std::make_pair(typeIt->first, ChannelDirection::DOWN));
-                    }
-                }
-
-                boost::system::error_code errorCode = sendKaaSync(types);
-                if (errorCode) {
-                    KAA_LOG_ERROR(boost::format("Channel \"%1%\". Failed to sync: %2%") % getId() % errorCode.message());
-                    onServerFailed();
-                }
-            } else {
-                KAA_LOG_DEBUG(boost::format("Can't sync channel %1%. Waiting for CONNACK message + KAASYNC message") % getId());
-                isPendingSyncRequest_ = true;
+
+    std::map<TransportType, ChannelDirection> syncTypes;
+    const auto& supportedTypes = getSupportedTransportTypes();
+    for (auto type : types) {
+        auto it = supportedTypes.find(type);
+        if (it != supportedTypes.end() && (it->second == ChannelDirection::UP || it->second == ChannelDirection::BIDIRECTIONAL)) {
+            syncTypes.insert(*it);
+        } else {
+            KAA_LOG_ERROR(boost::format("Unsupported transport type %1% for channel %2%")
+                                % LoggingUtils::TransportTypeToString(type) % getId());
+        }
+    }
+
+    if (syncTypes.empty()) {
+        return;
+    }
+
+    if (currentServer_) {
+        if (isFirstResponseReceived_) {
+            KAA_MUTEX_UNLOCKING("channelGuard_");
+            KAA_UNLOCK(lock);
+            KAA_MUTEX_UNLOCKED("channelGuard_");
+
+            boost::system::error_code errorCode = sendKaaSync(syncTypes);
+            if (errorCode) {
+                KAA_LOG_ERROR(boost::format("Channel \"%1%\". Failed to sync: %2%") % getId() % errorCode.message());
+                onServerFailed();
             }
         } else {
-            KAA_LOG_DEBUG(boost::format("Can't sync channel %1%. Server is null") % getId());
+            KAA_LOG_DEBUG(boost::format("Can't sync channel %1%. Waiting for CONNACK message + KAASYNC message") % getId());
+            isPendingSyncRequest_ = true;
         }
     } else {
-        KAA_LOG_ERROR(boost::format("Unsupported transport type for channel %1%") % getId());
+        KAA_LOG_DEBUG(boost::format("Can't sync channel %1%. Server is null") % getId());
     }
 }
 
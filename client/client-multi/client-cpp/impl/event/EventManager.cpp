@@ -39,12 +39,31 @@ void EventManager::registerEventFamily(IEventFamily* eventFamily)
         auto it = eventFamilies_.insert(eventFamily);
         if (!it.second) {
             KAA_LOG_WARN("Failed to register event family: already exists");
+        } else {
+            rebuildEventFamilyIndex();
         }
     } else {
         KAA_LOG_WARN("Failed to register event family: bad input data");
     }
 }
 
+void EventManager::rebuildEventFamilyIndex()
+{
+    eventFamilyIndex_.clear();
+
+    for (auto* family : eventFamilies_) {
+        for (const auto& fqn : family->getSupportedEventClassFQNs()) {
+            auto& families = eventFamilyIndex_[fqn];
+            if (std::find(families.begin(), families.end(), family) == families.end()) {
+                families.push_back(family);
+            }
+        }
+    }
+
+    KAA_LOG_TRACE(boost::format("Rebuilt event family index: %1% families, %2% event FQNs")
+                                            % eventFamilies_.size() % eventFamilyIndex_.size());
+}
+
 void EventManager::produceEvent(const std::string& fqn, const std::vector<std::uint8_t>& data,
                                 const std::string& target, TransactionIdPtr trxId)
 {
@@ -126,42 +145,62 @@ bool EventManager::hasPendingListenerRequests() const
     return !eventListenersRequests_.empty();
 }
 
-void EventManager::onEventFromServer(const std::string& eventClassFQN, const std::vector<std::uint8_t>& data,
-                                     const std::string& source)
+void EventManager::onEventFromServer(const Event& event)
 {
-    if (eventClassFQN.empty()) {
+    if (event.eventClassFQN.empty()) {
         KAA_LOG_WARN("Failed to process incoming event: bad input data");
         return;
     }
 
-    bool isProcessed = false;
+    auto it = eventFamilyIndex_.find(event.eventClassFQN);
+    if (it == eventFamilyIndex_.end()) {
+        KAA_LOG_WARN(boost::format("Event '%1%' wasn't processed: could not find appropriate family") % event.eventClassFQN);
+        return;
+    }
 
-    for (auto* family : eventFamilies_) {
-        const auto& list = family->getSupportedEventClassFQNs();
-        auto it = std::find(list.begin(), list.end(), eventClassFQN);
-        if (it != list.end()) {
-            KAA_LOG_TRACE(boost::format("Processing event for %1%") % eventClassFQN);
-            family->onGenericEvent(eventClassFQN, data, source);
-            isProcessed = true;
-        }
+    std::string source;
+    if (!event.source.is_null()) {
+        source = event.source.get_string();
     }
 
-    if (!isProcessed) {
-        KAA_LOG_WARN(boost::format("Event '%1%' wasn't processed: could not find appropriate family") % eventClassFQN);
+    KAA_LOG_TRACE(boost::format("Processing event for %1%") % event.eventClassFQN);
+
+    for (auto* family : it->second) {
+        family->onGenericEvent(event.eventClassFQN, event.eventData, source);
     }
 }
 
 void EventManager::onEventsReceived(const EventSyncResponse::events_t& eventResponse)
 {
-    auto events = eventResponse.get_array();
-    std::sort(events.begin(), events.end(),
-              [&events](const Event& l, const Event& r) -> bool {return l.seqNum < r.seqNum;});
-    for (const auto& event : events) {
-        std::string source;
-        if (!event.source.is_null()) {
-            source = event.source.get_string();
+    /*
+     * The generated union accessor returns the array by value, it is the only copy of events made here.
+     */
+    const auto& events = eventResponse.get_array();
+
+    auto isOrdered = [](const Event& l, const Event& r) -> bool { return l.seqNum < r.seqNum; };
+
+    /*
+     * The server usually sends events already ordered by sequence number, otherwise
+     * only pointers to the events are sorted.
+     */
+    if (std::is_sorted(events.begin(), events.end(), isOrdered)) {
+        for (const auto& event : events) {
+            onEventFromServer(event);
         }
-        onEventFromServer(event.eventClassFQN, event.eventData, source);
+        return;
+    }
+
+    std::vector<const Event *> orderedEvents;
+    orderedEvents.reserve(events.size());
+    for (const auto& event : events) {
+        orderedEvents.push_back(&event);
+    }
+
+    std::sort(orderedEvents.begin(), orderedEvents.end(),
+              [&isOrdered](const Event *l, const Event *r) -> bool { return isOrdered(*l, *r); });
+
+    for (const auto *event : orderedEvents) {
+        onEventFromServer(*event);
     }
 }
 
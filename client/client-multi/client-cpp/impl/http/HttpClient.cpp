@@ -20,6 +20,12 @@
     defined(KAA_DEFAULT_OPERATION_HTTP_CHANNEL) || \
     defined(KAA_DEFAULT_LONG_POLL_CHANNEL)
 
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
 #include "kaa/logging/Log.hpp"
 #include "kaa/transport/TransportException.hpp"
 #include "kaa/http/HttpUtils.hpp"
@@ -27,12 +33,215 @@
 
 namespace kaa {
 
-void HttpClient::checkError(const boost::system::error_code& code)
+const std::uint32_t HttpClient::DEFAULT_IDLE_TIMEOUT_MS;
+
+namespace {
+
+typedef boost::asio::ip::tcp::socket Socket;
+
+const char * const LINE_END = "\r\n";
+const char * const HEADER_END = "\r\n\r\n";
+const std::size_t STATUS_CODE_OFFSET = 9;
+
+/*
+ * The response as read from the socket. Bytes received after the header
+ * are kept in the stream buffer until the body is read.
+ */
+struct RawResponse {
+    boost::asio::streambuf buffer_;
+    std::string header_;
+    SharedBody body_;
+    bool isKeepAlive_ = false;
+};
+
+bool equalsIgnoreCase(const std::string& left, const std::string& right)
+{
+    return left.size() == right.size() &&
+           std::equal(left.begin(), left.end(), right.begin(), [](char l, char r)
+                   { return std::tolower(static_cast<unsigned char>(l)) == std::tolower(static_cast<unsigned char>(r)); });
+}
+
+std::string getHeaderField(const std::string& header, const std::string& name)
+{
+    std::size_t lineStart = header.find(LINE_END) + 2;
+    std::size_t lineEnd = 0;
+    while ((lineEnd = header.find(LINE_END, lineStart)) != std::string::npos && lineEnd != lineStart) {
+        std::size_t sep = header.find(':', lineStart);
+        if (sep < lineEnd && equalsIgnoreCase(header.substr(lineStart, sep - lineStart), name)) {
+            std::size_t valueStart = header.find_first_not_of(" \t", sep + 1);
+            return valueStart < lineEnd ? header.substr(valueStart, lineEnd - valueStart) : std::string();
+        }
+        lineStart = lineEnd + 2;
+    }
+    return std::string();
+}
+
+boost::system::error_code makeProtocolError()
+{
+    return boost::system::errc::make_error_code(boost::system::errc::protocol_error);
+}
+
+/*
+ * Moves size bytes to dest, first the buffered ones, then the remaining ones directly from the socket.
+ */
+boost::system::error_code readBody(Socket& socket, boost::asio::streambuf& buffer, std::uint8_t *dest, std::size_t size)
+{
+    std::size_t buffered = std::min(buffer.size(), size);
+    std::memcpy(dest, boost::asio::buffer_cast<const std::uint8_t *>(buffer.data()), buffered);
+    buffer.consume(buffered);
+
+    boost::system::error_code errorCode;
+    if (buffered < size) {
+        boost::asio::read(socket, boost::asio::buffer(dest + buffered, size - buffered), errorCode);
+    }
+    return errorCode;
+}
+
+boost::system::error_code readLine(Socket& socket, boost::asio::streambuf& buffer, std::string& line)
+{
+    boost::system::error_code errorCode;
+    std::size_t size = boost::asio::read_until(socket, buffer, LINE_END, errorCode);
+    if (!errorCode) {
+        line.assign(boost::asio::buffer_cast<const char *>(buffer.data()), size - 2);
+        buffer.consume(size);
+    }
+    return errorCode;
+}
+
+boost::system::error_code readChunkedBody(Socket& socket, RawResponse& response)
 {
-    if (code && code != boost::asio::error::eof) {
-        if (sock_.is_open()) {
-            doSocketClose();
+    std::vector<std::uint8_t> body;
+    std::string line;
+    boost::system::error_code errorCode;
+
+    for (;;) {
+        if ((errorCode = readLine(socket, response.buffer_, line))) {
+            return errorCode;
+        }
+
+        char *sizeEnd = nullptr;
+        std::size_t chunkSize = std::strtoul(line.c_str(), &sizeEnd, 16);
+        if (sizeEnd == line.c_str()) {
+            return makeProtocolError();
+        }
+        if (!chunkSize) {
+            break;
+        }
+
+        std::size_t offset = body.size();
+        body.resize(offset + chunkSize);
+        if ((errorCode = readBody(socket, response.buffer_, body.data() + offset, chunkSize)) ||
+            (errorCode = readLine(socket, response.buffer_, line))) {
+            return errorCode;
+        }
+    }
+
+    /*
+     * Trailer fields are skipped up to the empty line.
+     */
+    do {
+        if ((errorCode = readLine(socket, response.buffer_, line))) {
+            return errorCode;
+        }
+    } while (!line.empty());
+
+    response.body_.second = body.size();
+    if (!body.empty()) {
+        response.body_.first.reset(new std::uint8_t[body.size()]);
+        std::memcpy(response.body_.first.get(), body.data(), body.size());
+    }
+    return errorCode;
+}
+
+boost::system::error_code readResponse(Socket& socket, RawResponse& response)
+{
+    boost::system::error_code errorCode;
+    int statusCode = 0;
+
+    /*
+     * Interim (1xx) responses precede the final one.
+     */
+    do {
+        std::size_t size = boost::asio::read_until(socket, response.buffer_, HEADER_END, errorCode);
+        if (errorCode) {
+            return errorCode;
+        }
+
+        response.header_.assign(boost::asio::buffer_cast<const char *>(response.buffer_.data()), size);
+        response.buffer_.consume(size);
+        if (response.header_.compare(0, 5, "HTTP/") || response.header_.size() < STATUS_CODE_OFFSET + 3) {
+            return makeProtocolError();
+        }
+        statusCode = std::atoi(response.header_.c_str() + STATUS_CODE_OFFSET);
+    } while (statusCode >= 100 && statusCode < 200);
+
+    const std::string& connection = getHeaderField(response.header_, "Connection");
+    bool isKeepAlive = response.header_.compare(0, 8, "HTTP/1.0")
+                        ? !equalsIgnoreCase(connection, "close")
+                        : equalsIgnoreCase(connection, "keep-alive");
+
+    const std::string& contentLength = getHeaderField(response.header_, "Content-Length");
+    if (statusCode == 204 || statusCode == 304) {
+        response.body_.second = 0;
+    } else if (equalsIgnoreCase(getHeaderField(response.header_, "Transfer-Encoding"), "chunked")) {
+        errorCode = readChunkedBody(socket, response);
+    } else if (!contentLength.empty()) {
+        std::size_t size = std::strtoul(contentLength.c_str(), nullptr, 10);
+        response.body_.second = size;
+        if (size) {
+            response.body_.first.reset(new std::uint8_t[size]);
+            errorCode = readBody(socket, response.buffer_, response.body_.first.get(), size);
+        }
+    } else {
+        /*
+         * The body is delimited by the end of the connection.
+         */
+        boost::asio::read(socket, response.buffer_, boost::asio::transfer_all(), errorCode);
+        if (errorCode == boost::asio::error::eof) {
+            errorCode.clear();
         }
+        std::size_t size = response.buffer_.size();
+        response.body_.second = size;
+        if (size) {
+            response.body_.first.reset(new std::uint8_t[size]);
+            readBody(socket, response.buffer_, response.body_.first.get(), size);
+        }
+        isKeepAlive = false;
+    }
+
+    /*
+     * Requests aren't pipelined, so unexpected bytes mean the connection can't be trusted.
+     */
+    response.isKeepAlive_ = isKeepAlive && !errorCode && !response.buffer_.size();
+    return errorCode;
+}
+
+/*
+ * The server may have closed the pooled connection meanwhile, which is seen as a pending EOF.
+ */
+bool isConnectionAlive(Socket& socket)
+{
+    boost::system::error_code errorCode;
+    socket.non_blocking(true, errorCode);
+    if (errorCode) {
+        return false;
+    }
+
+    std::uint8_t byte = 0;
+    socket.read_some(boost::asio::buffer(&byte, 1), errorCode);
+    bool isAlive = (errorCode == boost::asio::error::would_block);
+
+    socket.non_blocking(false, errorCode);
+    return isAlive && !errorCode;
+}
+
+}
+
+void HttpClient::checkError(const boost::system::error_code& code, Socket& socket)
+{
+    if (code) {
+        releaseConnection(std::string(), SocketPtr(), false);
+        doSocketClose(socket);
         throw TransportException(code);
     }
 }
@@ -43,42 +252,144 @@ std::shared_ptr<IHttpResponse> HttpClient::sendRequest(const IHttpRequest& reque
     KAA_MUTEX_UNIQUE_DECLARE(httpClientGuardLock, httpClientGuard_);
     KAA_MUTEX_LOCKED("httpClientGuard_");
 
-    if (sock_.is_open()) {
-        doSocketClose();
-    }
     KAA_LOG_INFO(boost::format("Sending request to the server %1%:%2%") % request.getHost() % request.getPort());
+    const std::string& server = request.getHost() + ":" + std::to_string(request.getPort());
+    const auto& buffers = request.getRequestBuffers();
+
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(connectionsLock, connectionsGuard_);
+        isAborted_ = false;
+    }
+
+    for (;;) {
+        SocketPtr socket = takeIdleConnection(server);
+        bool isReused = static_cast<bool>(socket);
+        if (!isReused) {
+            socket = openConnection(request);
+        }
+
+        RawResponse response;
+        boost::system::error_code errorCode;
+        boost::asio::write(*socket, buffers, errorCode);
+
+        /*
+         * Once the request is written the server may have processed it, so only
+         * a failed write is retried. Other errors are left to the failover path.
+         */
+        if (errorCode && isReused) {
+            KAA_MUTEX_UNIQUE_DECLARE(connectionsLock, connectionsGuard_);
+            if (!isAborted_) {
+                KAA_LOG_DEBUG(boost::format("Connection to the server %1% was closed by the server, reconnecting") % server);
+                activeConnection_.reset();
+                doSocketClose(*socket);
+                continue;
+            }
+        }
+        if (!errorCode) {
+            errorCode = readResponse(*socket, response);
+        }
+        checkError(errorCode, *socket);
+
+        KAA_LOG_INFO(boost::format("Response from server %1%:%2% successfully received") % request.getHost() % request.getPort());
+        releaseConnection(server, socket, response.isKeepAlive_);
+        return std::shared_ptr<IHttpResponse>(new HttpResponse(response.header_, response.body_));
+    }
+}
+
+HttpClient::SocketPtr HttpClient::takeIdleConnection(const std::string& server)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(connectionsLock, connectionsGuard_);
+
+    const auto now = std::chrono::steady_clock::now();
+    for (auto it = idleConnections_.begin(); it != idleConnections_.end();) {
+        if (now - it->second.lastUsed_ >= idleTimeout_) {
+            KAA_LOG_DEBUG(boost::format("Evicting idle connection to the server %1%") % it->first);
+            doSocketClose(*it->second.socket_);
+            it = idleConnections_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    auto it = idleConnections_.find(server);
+    if (it == idleConnections_.end()) {
+        return SocketPtr();
+    }
+
+    SocketPtr socket = it->second.socket_;
+    idleConnections_.erase(it);
+    if (!isConnectionAlive(*socket)) {
+        KAA_LOG_DEBUG(boost::format("Idle connection to the server %1% was closed by the server") % server);
+        doSocketClose(*socket);
+        return SocketPtr();
+    }
+
+    activeConnection_ = socket;
+    return socket;
+}
+
+HttpClient::SocketPtr HttpClient::openConnection(const IHttpRequest& request)
+{
     const auto& ep = HttpUtils::getEndpoint(request.getHost(), request.getPort());
-    const auto& data = request.getRequestData();
+    SocketPtr socket(new Socket(io_));
     boost::system::error_code errorCode;
-    sock_.open(ep.protocol(), errorCode);
-    checkError(errorCode);
-    sock_.connect(ep, errorCode);
-    checkError(errorCode);
-    boost::asio::write(sock_, boost::asio::buffer(data.data(), data.size()), errorCode);
-    checkError(errorCode);
-    std::ostringstream responseStream;
-    boost::asio::streambuf responseBuf;
-    while (boost::asio::read(sock_, responseBuf, boost::asio::transfer_at_least(1), errorCode)) {
-        responseStream << &responseBuf;
-    }
-    checkError(errorCode);
-    const std::string& responseStr = responseStream.str();
-    KAA_LOG_INFO(boost::format("Response from server %1%:%2% successfully received") % request.getHost() % request.getPort());
-    doSocketClose();
-    return std::shared_ptr<IHttpResponse>(new HttpResponse(responseStr));
+    socket->open(ep.protocol(), errorCode);
+    checkError(errorCode, *socket);
+
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(connectionsLock, connectionsGuard_);
+        activeConnection_ = socket;
+    }
+
+    socket->connect(ep, errorCode);
+    checkError(errorCode, *socket);
+    return socket;
+}
+
+void HttpClient::releaseConnection(const std::string& server, SocketPtr socket, bool isReusable)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(connectionsLock, connectionsGuard_);
+    activeConnection_.reset();
+    if (!socket) {
+        return;
+    }
+
+    if (isReusable && !isAborted_) {
+        IdleConnection& connection = idleConnections_[server];
+        if (connection.socket_) {
+            doSocketClose(*connection.socket_);
+        }
+        connection.socket_ = socket;
+        connection.lastUsed_ = std::chrono::steady_clock::now();
+    } else {
+        doSocketClose(*socket);
+    }
 }
 
 void HttpClient::closeConnection()
 {
-    doSocketClose();
+    KAA_MUTEX_UNIQUE_DECLARE(connectionsLock, connectionsGuard_);
+    if (activeConnection_) {
+        /*
+         * Only shut down the socket: it wakes up the sending thread, which closes it itself.
+         */
+        isAborted_ = true;
+        boost::system::error_code errorCode;
+        activeConnection_->shutdown(boost::asio::ip::tcp::socket::shutdown_both, errorCode);
+    }
+
+    for (auto& connection : idleConnections_) {
+        doSocketClose(*connection.second.socket_);
+    }
+    idleConnections_.clear();
 }
 
-void HttpClient::doSocketClose()
+void HttpClient::doSocketClose(Socket& socket)
 {
     KAA_LOG_INFO("Closing socket connection...");
     boost::system::error_code errorCode;
-    sock_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, errorCode);
-    sock_.close(errorCode);
+    socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, errorCode);
+    socket.close(errorCode);
 }
 
 }
@@ -43,6 +43,14 @@ HttpResponse::HttpResponse(const std::string& data) : statusCode_(0)
     parseResponse(data.c_str(), data.length());
 }
 
+HttpResponse::HttpResponse(const std::string& header, const SharedBody& body) : body_(body), statusCode_(0)
+{
+    if (header.length() < HTTP_VERSION_OFFSET + 5) {
+        throw KaaException("Empty response was given");
+    }
+    parseHeader(header.c_str());
+}
+
 std::string HttpResponse::getHeaderField(const std::string& name) const
 {
     auto it = header_.find(name);
@@ -59,7 +67,7 @@ int HttpResponse::getStatusCode() const
     return statusCode_;
 }
 
-void HttpResponse::parseResponse(const char *data, std::size_t len)
+const char *HttpResponse::parseHeader(const char *data)
 {
     const char *cursor = data;
     cursor += HTTP_VERSION_OFFSET;
@@ -67,20 +75,24 @@ void HttpResponse::parseResponse(const char *data, std::size_t len)
     statusCode_ = static_cast<int>(std::strtol(code.c_str(), nullptr, 10));
     cursor = strstr(data, "\r\n") + 2;
 
-    bool headerProcessed = false;
-    while (!headerProcessed) {
+    while (strncmp(cursor, "\r\n", 2)) {
         auto sep = strchr(cursor, ':');
+        auto end = sep ? strstr(sep, "\r\n") : nullptr;
+        if (!end) {
+            throw KaaException("Malformed response header was given");
+        }
         std::string name(cursor, sep - cursor);
         cursor = sep + 2;
-        auto end = strstr(cursor, "\r\n");
         std::string value(cursor, end - cursor);
         cursor = end + 2;
         header_.insert(std::make_pair(name, value));
-        if (strstr(cursor, "\r\n") == cursor) {
-            cursor += 2;
-            headerProcessed = true;
-        }
     }
+    return cursor + 2;
+}
+
+void HttpResponse::parseResponse(const char *data, std::size_t len)
+{
+    const char *cursor = parseHeader(data);
     auto it = header_.find("Content-Length");
     if (it != header_.end()) {
         auto len = std::strtol(it->second.c_str(), nullptr, 10);
@@ -28,10 +28,12 @@
 namespace kaa {
 
 const std::string MultipartPostHttpRequest::BOUNDARY = "----Sanj56fD843koI0";
+const std::string MultipartPostHttpRequest::BODY_END = "--" + BOUNDARY + "--\r\n\r\n";
+const std::string MultipartPostHttpRequest::LINE_END = "\r\n";
 
 MultipartPostHttpRequest::MultipartPostHttpRequest(const HttpUrl& url, IKaaClientContext &context) : url_(url),context_(context)
 {
-
+    updateHeader();
 }
 
 MultipartPostHttpRequest::~MultipartPostHttpRequest()
@@ -51,55 +53,83 @@ uint16_t MultipartPostHttpRequest::getPort() const
 
 std::string MultipartPostHttpRequest::getRequestData() const
 {
-    std::ostringstream stream;
-    stream << "POST " << url_.getUri() << " HTTP/1.1\r\n";
+    const auto& buffers = getRequestBuffers();
+    std::string data;
+    data.reserve(boost::asio::buffer_size(buffers));
+    for (const auto& buffer : buffers) {
+        data.append(boost::asio::buffer_cast<const char *>(buffer), boost::asio::buffer_size(buffer));
+    }
+    return data;
+}
 
+std::vector<boost::asio::const_buffer> MultipartPostHttpRequest::getRequestBuffers() const
+{
     KAA_LOG_TRACE(boost::format("Executing request POST %1% HTTP/1.1") % url_.getUri());
 
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.reserve(3 * bodyFields_.size() + 2);
+    buffers.push_back(boost::asio::buffer(header_));
+
+    for (auto it = bodyFields_.begin(); it != bodyFields_.end(); ++it) {
+        buffers.push_back(boost::asio::buffer(it->second.header_));
+        buffers.push_back(boost::asio::buffer(it->second.data_, it->second.size_));
+        buffers.push_back(boost::asio::buffer(LINE_END));
+    }
+    buffers.push_back(boost::asio::buffer(BODY_END));
+
+    return buffers;
+}
+
+std::string MultipartPostHttpRequest::makeBodyFieldHeader(const std::string& name)
+{
+    std::ostringstream fieldStream;
+    fieldStream << "--" << BOUNDARY << "\r\n";
+    fieldStream << "Content-Disposition: form-data; name=\"" << name << "\"\r\n\r\n";
+    return fieldStream.str();
+}
+
+void MultipartPostHttpRequest::updateHeader()
+{
+    std::size_t bodySize = BODY_END.size();
+    for (auto it = bodyFields_.begin(); it != bodyFields_.end(); ++it) {
+        bodySize += it->second.header_.size() + it->second.size_ + LINE_END.size();
+    }
+
+    std::ostringstream stream;
+    stream << "POST " << url_.getUri() << " HTTP/1.1\r\n";
     stream << "Accept: */*\r\n";
     stream << "Content-Type: multipart/form-data; boundary=" << BOUNDARY << "\r\n";
     stream << "Host: " << url_.getHost() << "\r\n";
     for (auto it = headerFields_.begin(); it != headerFields_.end(); ++it) {
         stream << it->first << ": " << it->second << "\r\n";
     }
-    stream << "Connection: Close\r\n";
-    std::ostringstream bodyStream;
-    for (auto it = bodyFields_.begin(); it != bodyFields_.end(); ++it) {
-        bodyStream << "--" << BOUNDARY << "\r\n";
-        bodyStream << "Content-Disposition: form-data; name=\"" << it->first << "\"\r\n\r\n";
-        const std::vector<std::uint8_t>& body = it->second;
-        bodyStream.write(reinterpret_cast<const char *>(body.data()), body.size());
-        bodyStream << "\r\n";
-    }
-    bodyStream << "--" << BOUNDARY << "--\r\n\r\n";
-    const std::string& body = bodyStream.str();
-    stream << "Content-Length: " << body.length() << "\r\n";
+    stream << "Connection: keep-alive\r\n";
+    stream << "Content-Length: " << bodySize << "\r\n";
     stream << "\r\n";
-    if (body.length() > 0) {
-        stream << body << "\r\n\r\n";
-    }
-
-    return stream.str();
+    header_ = stream.str();
 }
 
 void MultipartPostHttpRequest::setHeaderField(const std::string& name, const std::string& value)
 {
     headerFields_.insert(std::make_pair(name, value));
+    updateHeader();
 }
 
 void MultipartPostHttpRequest::removeHeaderField(const std::string& name)
 {
     headerFields_.erase(name);
+    updateHeader();
 }
 
 void MultipartPostHttpRequest::setBodyField(const std::string& name, const std::vector<std::uint8_t>& value)
 {
-    bodyFields_.insert(std::make_pair(name, value));
+    setBodyField(name, std::make_shared<const std::vector<std::uint8_t>>(value));
 }
 
 void MultipartPostHttpRequest::removeBodyField(const std::string& name)
 {
     bodyFields_.erase(name);
+    updateHeader();
 }
 
 }
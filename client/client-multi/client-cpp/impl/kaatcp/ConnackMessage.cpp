@@ -15,12 +15,14 @@
  */
 
 #include "kaa/kaatcp/ConnackMessage.hpp"
+#include "kaa/kaatcp/KaaTcpCommon.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 #include <boost/format.hpp>
 
 namespace kaa {
 
-ConnackMessage::ConnackMessage(const char *payload, std::uint16_t size) : returnCode_(ConnackReturnCode::UNKNOWN)
+ConnackMessage::ConnackMessage(const char *payload, std::uint16_t size)
+    : returnCode_(ConnackReturnCode::UNKNOWN), isCompressionSupported_(false)
 {
     parseMessage(payload, size);
 }
@@ -54,10 +56,12 @@ std::string ConnackMessage::getMessage() const
 
 void ConnackMessage::parseMessage(const char *payload, std::uint16_t size)
 {
-    if (!payload || !size) {
+    if (!payload || size < 2) {
         throw KaaException("Bad Connack payload data");
     }
 
+    isCompressionSupported_ = (*payload) & KaaTcpCommon::KAA_CONNACK_COMPRESSION_FLAG;
+
     int code = *(payload + 1);
     if (code < (int)ConnackReturnCode::UNKNOWN || code > (int)ConnackReturnCode::REFUSE_NO_AUTH) {
         throw KaaException(boost::format("Bad Connack return code: %1%") % code);
@@ -0,0 +1,125 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "kaa/kaatcp/KaaSyncCompressor.hpp"
+
+#include <algorithm>
+
+#include <zlib.h>
+
+#include "kaa/kaatcp/KaaTcpCommon.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+struct ZlibStreams {
+    z_stream    deflateStream_;
+    z_stream    inflateStream_;
+};
+
+KaaSyncCompressor::KaaSyncCompressor()
+    : streams_(new ZlibStreams())
+{
+    if (deflateInit(&streams_->deflateStream_, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        throw KaaException("Failed to initialize KaaSync compressor");
+    }
+
+    if (inflateInit(&streams_->inflateStream_) != Z_OK) {
+        deflateEnd(&streams_->deflateStream_);
+        throw KaaException("Failed to initialize KaaSync decompressor");
+    }
+}
+
+KaaSyncCompressor::~KaaSyncCompressor()
+{
+    deflateEnd(&streams_->deflateStream_);
+    inflateEnd(&streams_->inflateStream_);
+}
+
+ByteArrayView KaaSyncCompressor::compress(const std::uint8_t *data, std::size_t size)
+{
+    if (!data || size < 2) {
+        return ByteArrayView();
+    }
+
+    z_stream& stream = streams_->deflateStream_;
+    deflateReset(&stream);
+
+    /*
+     * The result is of no use unless it is smaller than the payload.
+     */
+    compressBuffer_.resize(size - 1);
+
+    stream.next_in = const_cast<Bytef *>(data);
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = compressBuffer_.data();
+    stream.avail_out = static_cast<uInt>(compressBuffer_.size());
+
+    if (deflate(&stream, Z_FINISH) != Z_STREAM_END) {
+        return ByteArrayView();
+    }
+
+    return ByteArrayView(compressBuffer_.data(), stream.total_out);
+}
+
+ByteArrayView KaaSyncCompressor::decompress(const std::uint8_t *data, std::size_t size)
+{
+    if (!data || !size) {
+        throw KaaException("Failed to decompress KaaSync payload: no data");
+    }
+
+    z_stream& stream = streams_->inflateStream_;
+    inflateReset(&stream);
+
+    /*
+     * Repetitive payloads are usually compressed several times, start with a buffer of that size
+     * and double it until the whole payload fits.
+     */
+    std::size_t maxSize = KaaTcpCommon::MAX_MESSAGE_LENGTH;
+    std::size_t bufferSize = std::min(std::max(decompressBuffer_.capacity(), 4 * size), maxSize);
+    decompressBuffer_.resize(bufferSize);
+
+    stream.next_in = const_cast<Bytef *>(data);
+    stream.avail_in = static_cast<uInt>(size);
+    stream.next_out = decompressBuffer_.data();
+    stream.avail_out = static_cast<uInt>(decompressBuffer_.size());
+
+    for (;;) {
+        int result = inflate(&stream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END) {
+            break;
+        }
+
+        if ((result != Z_OK && result != Z_BUF_ERROR) || stream.avail_out) {
+            throw KaaException(boost::format("Failed to decompress KaaSync payload: %1%")
+                                                % (stream.msg ? stream.msg : "unexpected end of data"));
+        }
+
+        if (decompressBuffer_.size() >= maxSize) {
+            throw KaaException("Failed to decompress KaaSync payload: payload is too big");
+        }
+
+        std::size_t usedSize = decompressBuffer_.size();
+        decompressBuffer_.resize(std::min(2 * usedSize, maxSize));
+
+        stream.next_out = decompressBuffer_.data() + usedSize;
+        stream.avail_out = static_cast<uInt>(decompressBuffer_.size() - usedSize);
+    }
+
+    return ByteArrayView(decompressBuffer_.data(), stream.total_out);
+}
+
+} /* namespace kaa */
@@ -48,7 +48,7 @@ void KaaSyncResponse::parseMessage(const char * payload, std::uint32_t size)
     if (!size) {
         throw KaaException("No payload in KaaSyncResponse");
     }
-    payload_.assign((const std::uint8_t*) payload, (const std::uint8_t*) payload + size);
+    payload_ = ByteArrayView(payload, size);
 }
 
 }
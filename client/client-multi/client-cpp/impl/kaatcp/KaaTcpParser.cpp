@@ -21,11 +21,25 @@
 
 namespace kaa {
 
-void KaaTcpParser::onMessageDone()
+void KaaTcpParser::onMessageDone(const char *payload)
 {
     KAA_LOG_DEBUG("KaaTcp: payload is fully received");
-    messages_.push_back(std::make_pair(messageType_, std::make_pair(messagePayload_, messageLength_)));
+
+    KaaTcpMessageType messageType = messageType_;
+    std::uint32_t messageLength = messageLength_;
+
     resetParser();
+
+    if (messageHandler_) {
+        messageHandler_(messageType, payload, messageLength);
+    } else {
+        boost::shared_array<char> messagePayload;
+        if (messageLength) {
+            messagePayload.reset(new char[messageLength]);
+            std::copy(payload, payload + messageLength, messagePayload.get());
+        }
+        messages_.push_back(std::make_pair(messageType, std::make_pair(messagePayload, messageLength)));
+    }
 }
 
 void KaaTcpParser::processByte(char byte)
@@ -42,10 +56,10 @@ void KaaTcpParser::processByte(char byte)
             if (!((std::uint8_t)byte & KaaTcpCommon::FIRST_BIT)) {
                 KAA_LOG_DEBUG(boost::format("KaaTcp: retrieved message's size %1%") % (std::uint32_t) messageLength_);
                 if (messageLength_) {
-                    messagePayload_.reset(new char[messageLength_]);
+                    payloadBuffer_.clear();
                     state_ = KaaTcpParserState::PROCESSING_PAYLOAD;
                 } else {
-                    onMessageDone();
+                    onMessageDone(nullptr);
                 }
             }
             break;
@@ -73,13 +87,28 @@ void KaaTcpParser::parseBuffer(const char *buffer, std::uint32_t size)
         if (state_ == KaaTcpParserState::PROCESSING_PAYLOAD) {
             std::uint32_t remainingSize = messageLength_ - processedPayloadLength_;
             std::uint32_t bufferRemainingSize = buffer + size - cursor;
+
+            if (!processedPayloadLength_ && bufferRemainingSize >= messageLength_) {
+                /*
+                 * The whole payload is in the buffer, so it is passed as is.
+                 */
+                const char *payload = cursor;
+                cursor += messageLength_;
+                KAA_LOG_DEBUG(boost::format("KaaTcp: processed payload. Remaining buffer size is %1%") % ((buffer + size) - cursor));
+                onMessageDone(payload);
+                continue;
+            }
+
+            /*
+             * The payload is split between several buffers, it is assembled in the reusable buffer.
+             */
             std::uint32_t bytesToRead = (remainingSize > bufferRemainingSize) ? bufferRemainingSize : remainingSize;
-            std::copy(cursor, cursor + bytesToRead, messagePayload_.get() + processedPayloadLength_);
+            payloadBuffer_.insert(payloadBuffer_.end(), cursor, cursor + bytesToRead);
             cursor += bytesToRead;
             processedPayloadLength_ += bytesToRead;
             KAA_LOG_DEBUG(boost::format("KaaTcp: processed payload. Remaining buffer size is %1%") % ((buffer + size) - cursor));
             if (messageLength_ == processedPayloadLength_) {
-                onMessageDone();
+                onMessageDone(payloadBuffer_.data());
             }
         } else {
             processByte(*(cursor++));
@@ -89,15 +118,14 @@ void KaaTcpParser::parseBuffer(const char *buffer, std::uint32_t size)
 
 MessageRecordList KaaTcpParser::releaseMessages()
 {
-    MessageRecordList result = messages_;
-    messages_.clear();
+    MessageRecordList result;
+    result.swap(messages_);
     return result;
 }
 
 void KaaTcpParser::resetParser()
 {
     state_ = KaaTcpParserState::NONE;
-    messagePayload_.reset();
     messageLength_ = 0;
     processedPayloadLength_ = 0;
     messageType_ = KaaTcpMessageType::MESSAGE_UNKNOWN;
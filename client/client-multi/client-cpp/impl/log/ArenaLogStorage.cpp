@@ -0,0 +1,318 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "kaa/log/ArenaLogStorage.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/logging/Log.hpp"
+#include "kaa/log/LogRecord.hpp"
+#include "kaa/IKaaClientContext.hpp"
+
+namespace kaa {
+
+ArenaLogStorage::ArenaLogStorage(IKaaClientContext &context, std::size_t bucketSize,
+                                 std::size_t bucketRecordCount, std::size_t chunkSize)
+    : maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount), chunkSize_(chunkSize), context_(context)
+{
+    KAA_LOG_INFO(boost::format("Going to use unlimited arena storage. Bucket: max_size %1% bytes, "
+                               "max_record_count %2%. Chunk size %3% bytes")
+                                    % maxBucketSize_ % maxBucketRecordCount_ % chunkSize_);
+    addNewBucket();
+}
+
+ArenaLogStorage::ArenaLogStorage(IKaaClientContext &context,
+                                 std::size_t maxOccupiedSize, float percentToDelete,
+                                 std::size_t bucketSize, std::size_t bucketRecordCount, std::size_t chunkSize)
+    : maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount), chunkSize_(chunkSize), context_(context)
+{
+    if (0.0 >= percentToDelete || percentToDelete > 100.0) {
+        KAA_LOG_ERROR(boost::format("Failed to create limited arena log storage: max_size %1% bytes, percentToDelete %2%%%")
+                                                                            % maxOccupiedSize % percentToDelete);
+        throw KaaException("Percent should be in 0-100 range");
+    }
+
+    KAA_LOG_INFO(boost::format("Going to use limited arena storage: max_size %1% bytes, percentToDelete %2%%%. "
+                               "Bucket: max_size %3% bytes, max_record_count %4%. Chunk size %5% bytes")
+                                    % maxOccupiedSize % percentToDelete % maxBucketSize_ % maxBucketRecordCount_ % chunkSize_);
+
+    maxOccupiedSize_ = maxOccupiedSize;
+    shrinkedSize_ = ((float) maxOccupiedSize_ * (100.0 - percentToDelete)) / 100.0;
+
+    addNewBucket();
+}
+
+BucketInfo ArenaLogStorage::addLogRecord(LogRecord&& record)
+{
+    KAA_MUTEX_LOCKING("arenaLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, arenaLogStorageGuard_);
+    KAA_MUTEX_LOCKED("arenaLogStorageGuard_");
+
+    return storeLogRecord(std::move(record));
+}
+
+void ArenaLogStorage::addLogRecords(std::list<LogRecord>& records, std::vector<BucketInfo>& bucketInfos)
+{
+    KAA_MUTEX_LOCKING("arenaLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, arenaLogStorageGuard_);
+    KAA_MUTEX_LOCKED("arenaLogStorageGuard_");
+
+    while (!records.empty()) {
+        bucketInfos.push_back(storeLogRecord(std::move(records.front())));
+        records.pop_front();
+    }
+}
+
+BucketInfo ArenaLogStorage::storeLogRecord(LogRecord&& record)
+{
+    auto recordSize = record.getSize();
+    if (recordSize > maxBucketSize_) {
+        KAA_LOG_WARN(boost::format("Failed to add log record: record_size %1%B, max_bucket_size %2%B")
+                                                                    % recordSize % maxBucketSize_);
+        throw KaaException("Too big log record");
+    }
+
+    if (maxOccupiedSize_ && ((totalOccupiedSize_ + recordSize) > maxOccupiedSize_)) {
+        KAA_LOG_INFO(boost::format("Log storage is full (occupied %1%, max %2%). Going to delete elder logs")
+                                                                        % totalOccupiedSize_ % maxOccupiedSize_);
+        shrinkToSize(shrinkedSize_);
+    }
+
+    if (checkBucketOverflow(record)) {
+        addNewBucket();
+    }
+
+    internalAddLogRecord(std::move(record));
+
+    KAA_LOG_TRACE(boost::format("Added log record (%1% bytes). Non-used records: count %2%, occupied size %3% bytes")
+                                                     % recordSize % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
+
+    return BucketInfo(currentBucketId_, buckets_.back().recordCount_);
+}
+
+LogBucket ArenaLogStorage::getNextBucket()
+{
+    KAA_MUTEX_LOCKING("arenaLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, arenaLogStorageGuard_);
+    KAA_MUTEX_LOCKED("arenaLogStorageGuard_");
+
+    std::size_t totalRecordCount = 0;
+    for (auto& internalBucket : buckets_) {
+        if (internalBucket.state_ == ArenaLogStorage::BucketState::FREE && internalBucket.recordCount_) {
+            internalBucket.state_ = ArenaLogStorage::BucketState::IN_USE;
+
+            unmarkedRecordCount_ -= internalBucket.recordCount_;
+            occupiedSizeOfUnmarkedRecords_ -= internalBucket.occupiedSize_;
+
+            if (!unmarkedRecordCount_) {
+                addNewBucket();
+            }
+
+            KAA_LOG_INFO(boost::format("Create log bucket: id %1%, size %2%, %3% record(s) in %4% chunk(s). "
+                                       "Non-used records: count %5%, occupied size %6% bytes")
+                            % internalBucket.bucketId_ % internalBucket.occupiedSize_ % internalBucket.recordCount_
+                            % internalBucket.chunks_.size() % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
+
+            /*
+             * Chunks already hold length-prefixed records, so they are copied as is into one buffer.
+             * Chunks are kept until the bucket is removed, so a rolled back bucket is packed again.
+             */
+            return LogBucket(internalBucket.bucketId_, packRecords(internalBucket), internalBucket.recordCount_);
+        } else {
+            totalRecordCount += internalBucket.recordCount_;
+        }
+    }
+
+    KAA_LOG_TRACE(boost::format("No free log buckets found: total_log_count %1%, total_occupied_size %2%")
+                                                                    % totalRecordCount % totalOccupiedSize_);
+
+    return LogBucket();
+}
+
+void ArenaLogStorage::removeBucket(std::int32_t bucketId)
+{
+    KAA_MUTEX_LOCKING("arenaLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, arenaLogStorageGuard_);
+    KAA_MUTEX_LOCKED("arenaLogStorageGuard_");
+
+    bool found = false;
+    buckets_.remove_if([&] (const ArenaLogStorage::InternalBucket& bucket)
+                        {
+                             if (bucket.bucketId_ == bucketId) {
+                                 totalOccupiedSize_ -= bucket.occupiedSize_;
+                                 KAA_LOG_TRACE(boost::format("Log bucket %1% removed (%2% records, %3% chunks). "
+                                                             "Non-used records: count %4%, occupied size %5% bytes")
+                                                             % bucketId % bucket.recordCount_ % bucket.chunks_.size()
+                                                             % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
+                                 found = true;
+                                 return true;
+                             }
+                             return false;
+                        });
+
+    if (!found) {
+        KAA_LOG_WARN(boost::format("Failed to remove log bucket %1%: not found") % bucketId);
+    }
+}
+
+void ArenaLogStorage::rollbackBucket(std::int32_t bucketId)
+{
+    KAA_MUTEX_LOCKING("arenaLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, arenaLogStorageGuard_);
+    KAA_MUTEX_LOCKED("arenaLogStorageGuard_");
+
+    auto it = std::find_if(buckets_.begin(), buckets_.end(), [&bucketId] (const ArenaLogStorage::InternalBucket& bucket)
+            {
+                 return bucket.bucketId_ == bucketId;
+            });
+
+    if (it != buckets_.end()) {
+        it->state_ = ArenaLogStorage::BucketState::FREE;
+        occupiedSizeOfUnmarkedRecords_ += it->occupiedSize_;
+        unmarkedRecordCount_ += it->recordCount_;
+
+        KAA_LOG_DEBUG(boost::format("Rollback log bucket %1% (%2% records). Non-used records: count %3%, occupied size %4% bytes")
+                                            % bucketId % it->recordCount_ % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
+    } else {
+        KAA_LOG_WARN(boost::format("Failed to rollback log bucket %1%: not found") % bucketId);
+    }
+}
+
+void ArenaLogStorage::shrinkToSize(std::size_t newSize)
+{
+    if (!newSize) {
+        unmarkedRecordCount_ = 0;
+        totalOccupiedSize_ = occupiedSizeOfUnmarkedRecords_ = 0;
+        buckets_.clear();
+        addNewBucket();
+
+        KAA_LOG_INFO("All log records removed");
+
+        return;
+    }
+
+    size_t recordCount = 0;
+    while (totalOccupiedSize_ > newSize) {
+        auto& theOldestBucket = buckets_.front();
+
+        if (totalOccupiedSize_ - theOldestBucket.occupiedSize_ >= newSize) {
+            KAA_LOG_INFO(boost::format("Removing log bucket %1% (%2% records, %3% bytes)")
+                                    % theOldestBucket.bucketId_ % theOldestBucket.recordCount_ % theOldestBucket.occupiedSize_);
+
+            totalOccupiedSize_ -= theOldestBucket.occupiedSize_;
+            recordCount += theOldestBucket.recordCount_;
+
+            if (theOldestBucket.state_ == ArenaLogStorage::BucketState::FREE) {
+                unmarkedRecordCount_ -= theOldestBucket.recordCount_;
+                occupiedSizeOfUnmarkedRecords_ -= theOldestBucket.occupiedSize_;
+            }
+
+            buckets_.pop_front();
+
+            if (buckets_.empty()) {
+                addNewBucket();
+            }
+        } else {
+            while (totalOccupiedSize_ > newSize) {
+                auto removedSize = removeOldestRecord(theOldestBucket);
+
+                if (theOldestBucket.state_ == ArenaLogStorage::BucketState::FREE) {
+                    --unmarkedRecordCount_;
+                    occupiedSizeOfUnmarkedRecords_ -= removedSize;
+                }
+
+                totalOccupiedSize_ -= removedSize;
+                ++recordCount;
+            }
+        }
+    }
+
+    KAA_LOG_INFO(boost::format("%1% log records removed") % recordCount);
+}
+
+std::size_t ArenaLogStorage::getConsumedVolume()
+{
+    KAA_MUTEX_LOCKING("arenaLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, arenaLogStorageGuard_);
+    KAA_MUTEX_LOCKED("arenaLogStorageGuard_");
+    return occupiedSizeOfUnmarkedRecords_;
+}
+
+std::size_t ArenaLogStorage::getRecordsCount()
+{
+    KAA_MUTEX_LOCKING("arenaLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, arenaLogStorageGuard_);
+    KAA_MUTEX_LOCKED("arenaLogStorageGuard_");
+    return unmarkedRecordCount_;
+}
+
+void ArenaLogStorage::internalAddLogRecord(LogRecord&& record)
+{
+    const RecordLength recordSize = record.getSize();
+    const std::size_t requiredSize = sizeof(RecordLength) + recordSize;
+
+    auto& currentBucket = buckets_.back();
+    if (currentBucket.chunks_.empty() ||
+            currentBucket.chunks_.back().capacity_ - currentBucket.chunks_.back().end_ < requiredSize) {
+        currentBucket.chunks_.emplace_back(std::max(chunkSize_, requiredSize));
+    }
+
+    auto& chunk = currentBucket.chunks_.back();
+    std::memcpy(chunk.data_.get() + chunk.end_, &recordSize, sizeof(RecordLength));
+    std::memcpy(chunk.data_.get() + chunk.end_ + sizeof(RecordLength), record.getData().data(), recordSize);
+    chunk.end_ += requiredSize;
+
+    totalOccupiedSize_ += recordSize;
+    occupiedSizeOfUnmarkedRecords_ += recordSize;
+    ++unmarkedRecordCount_;
+
+    currentBucket.occupiedSize_ += recordSize;
+    ++currentBucket.recordCount_;
+}
+
+std::size_t ArenaLogStorage::removeOldestRecord(InternalBucket& bucket)
+{
+    auto& chunk = bucket.chunks_.front();
+
+    RecordLength recordSize = 0;
+    std::memcpy(&recordSize, chunk.data_.get() + chunk.begin_, sizeof(RecordLength));
+    chunk.begin_ += sizeof(RecordLength) + recordSize;
+
+    if (chunk.begin_ == chunk.end_) {
+        bucket.chunks_.pop_front();
+    }
+
+    bucket.occupiedSize_ -= recordSize;
+    --bucket.recordCount_;
+
+    return recordSize;
+}
+
+PackedLogRecordsPtr ArenaLogStorage::packRecords(const InternalBucket& bucket)
+{
+    std::shared_ptr<std::vector<std::uint8_t>> records = std::make_shared<std::vector<std::uint8_t>>();
+    records->reserve(bucket.occupiedSize_ + bucket.recordCount_ * sizeof(RecordLength));
+
+    for (const auto& chunk : bucket.chunks_) {
+        records->insert(records->end(), chunk.data_.get() + chunk.begin_, chunk.data_.get() + chunk.end_);
+    }
+
+    return records;
+}
+
+}  // namespace kaa
@@ -69,7 +69,13 @@ void LogCollector::startLogUploadCheckTimer()
     logUploadCheckTimer_.stop();
     logUploadCheckTimer_.start(uploadStrategy_->getLogUploadCheckPeriod(),[this]
     {
-        processLogUploadDecision(uploadStrategy_->isUploadNeeded(storage_->getStatus()));
+        /*
+         * The upload may block on the network, so it isn't made on the timer thread.
+         */
+        context_.getExecutorContext().getApiExecutor().add([this]
+            {
+                processLogUploadDecision(uploadStrategy_->isUploadNeeded(storage_->getStatus()));
+            });
     });
 }
 
@@ -123,6 +129,83 @@ RecordFuture LogCollector::addLogRecord(const KaaUserLogRecord& record)
     return RecordFuture(promisePtr->get_future());
 }
 
+std::vector<RecordFuture> LogCollector::addLogRecords(const std::vector<KaaUserLogRecord>& records)
+{
+    std::vector<RecordFuture> recordFutures;
+    if (records.empty()) {
+        return recordFutures;
+    }
+
+    recordFutures.reserve(records.size());
+
+    auto recordDeliveryInfos = std::make_shared<std::vector<RecordDeliveryInfo>>();
+    recordDeliveryInfos->reserve(records.size());
+
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        auto promisePtr = std::make_shared<std::promise<RecordInfo>>();
+        recordDeliveryInfos->emplace_back(promisePtr, RecordInfo());
+        recordFutures.emplace_back(promisePtr->get_future());
+    }
+
+    auto userRecords = std::make_shared<std::vector<KaaUserLogRecord>>(records);
+
+    context_.getExecutorContext().getApiExecutor().add([this, userRecords, recordDeliveryInfos] ()
+            {
+                std::list<LogRecord> logRecords;
+                std::list<RecordDeliveryInfo> pendingDeliveryInfos;
+
+                for (std::size_t i = 0; i < userRecords->size(); ++i) {
+                    const auto& recordDeliveryInfo = (*recordDeliveryInfos)[i];
+                    try {
+                        logRecords.emplace_back((*userRecords)[i]);
+                        pendingDeliveryInfos.push_back(recordDeliveryInfo);
+                    } catch (...) {
+                        try {
+                            KAA_LOG_WARN("Failed to encode log record");
+                            recordDeliveryInfo.deliveryFuture_->set_exception(std::current_exception());
+                        } catch(...) {}
+                    }
+                }
+
+                std::vector<BucketInfo> bucketInfos;
+                bucketInfos.reserve(logRecords.size());
+
+                /*
+                 * If the storage fails to add a record, the record is left the first one,
+                 * so it is reported as failed and the rest of the batch is added again.
+                 */
+                while (!logRecords.empty()) {
+                    std::size_t addedRecordCount = bucketInfos.size();
+                    std::exception_ptr error;
+
+                    try {
+                        storage_->addLogRecords(logRecords, bucketInfos);
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+
+                    for (std::size_t i = addedRecordCount; i < bucketInfos.size(); ++i) {
+                        updateBucketInfo(bucketInfos[i], pendingDeliveryInfos.front());
+                        pendingDeliveryInfos.pop_front();
+                    }
+
+                    if (error && !logRecords.empty()) {
+                        try {
+                            KAA_LOG_WARN("Failed to add log record");
+                            pendingDeliveryInfos.front().deliveryFuture_->set_exception(error);
+                        } catch(...) {}
+
+                        pendingDeliveryInfos.pop_front();
+                        logRecords.pop_front();
+                    }
+                }
+
+                processLogUploadDecision(uploadStrategy_->isUploadNeeded(storage_->getStatus()));
+            });
+
+    return recordFutures;
+}
+
 void LogCollector::processLogUploadDecision(LogUploadStrategyDecision decision)
 {
     switch (decision) {
@@ -265,22 +348,35 @@ std::shared_ptr<LogSyncRequest> LogCollector::getLogUploadRequest()
     }
 
     LogBucket bucket = storage_->getNextBucket();
-    if (bucket.getRecords().empty()) {
+    std::size_t recordCount = bucket.getRecordCount();
+    if (!recordCount) {
         KAA_LOG_TRACE("No logs to send");
         return request;
     }
 
-    KAA_LOG_TRACE(boost::format("Sending %1% log records") % bucket.getRecords().size());
+    KAA_LOG_TRACE(boost::format("Sending %1% log records") % recordCount);
 
     request.reset(new LogSyncRequest);
     request->requestId = bucket.getBucketId();
 
     std::vector<LogEntry> logsToSend;
-    logsToSend.resize(bucket.getRecords().size());
+    logsToSend.resize(recordCount);
 
     std::size_t i = 0;
-    for (auto& record : bucket.getRecords()) {
-        logsToSend[i++].data = std::move(record.getRvalueData());
+    if (bucket.isShared() || bucket.isPacked()) {
+        /*
+         * The storage keeps records until they are delivered or rolled back, or packs them into
+         * one buffer, and the generated log entry owns its data, so the encoded data is copied
+         * directly into the request.
+         */
+        bucket.forEachRecord([&logsToSend, &i] (const std::uint8_t *data, std::size_t size)
+                {
+                    logsToSend[i++].data.assign(data, data + size);
+                });
+    } else {
+        for (auto& record : bucket.takeRecords()) {
+            logsToSend[i++].data = std::move(record.getRvalueData());
+        }
     }
 
     request->logEntries.set_array(std::move(logsToSend));
@@ -360,7 +456,10 @@ void LogCollector::retryLogUpload(std::size_t delay)
     KAA_LOG_INFO(boost::format("Schedule log upload with %u second(s) delay ...") % delay);
 
     scheduledUploadTimer_.stop();
-    scheduledUploadTimer_.start(delay, [&] { doSync(); });
+    scheduledUploadTimer_.start(delay, [&]
+        {
+            context_.getExecutorContext().getApiExecutor().add([this] { doSync(); });
+        });
 }
 
 void LogCollector::switchAccessPoint()
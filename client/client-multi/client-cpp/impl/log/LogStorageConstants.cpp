@@ -20,6 +20,7 @@ namespace kaa {
 
 const std::size_t LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE;
 const std::size_t LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT;
+const std::size_t LogStorageConstants::DEFAULT_ARENA_CHUNK_SIZE;
 
 const std::string LogStorageConstants::DEFAULT_LOG_DB_STORAGE = "logs.db";
 
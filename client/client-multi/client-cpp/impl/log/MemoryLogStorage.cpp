@@ -55,6 +55,27 @@ MemoryLogStorage::MemoryLogStorage(IKaaClientContext &context,
 }
 
 BucketInfo MemoryLogStorage::addLogRecord(LogRecord&& record)
+{
+    KAA_MUTEX_LOCKING("memoryLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
+    KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
+
+    return storeLogRecord(std::move(record));
+}
+
+void MemoryLogStorage::addLogRecords(std::list<LogRecord>& records, std::vector<BucketInfo>& bucketInfos)
+{
+    KAA_MUTEX_LOCKING("memoryLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
+    KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
+
+    while (!records.empty()) {
+        bucketInfos.push_back(storeLogRecord(std::move(records.front())));
+        records.pop_front();
+    }
+}
+
+BucketInfo MemoryLogStorage::storeLogRecord(LogRecord&& record)
 {
     auto recordSize = record.getSize();
     if (recordSize > maxBucketSize_) {
@@ -63,10 +84,6 @@ BucketInfo MemoryLogStorage::addLogRecord(LogRecord&& record)
         throw KaaException("Too big log record");
     }
 
-    KAA_MUTEX_LOCKING("memoryLogStorageGuard_");
-    KAA_MUTEX_UNIQUE_DECLARE(logsLock, memoryLogStorageGuard_);
-    KAA_MUTEX_LOCKED("memoryLogStorageGuard_");
-
     if (maxOccupiedSize_ && ((totalOccupiedSize_ + record.getSize()) > maxOccupiedSize_)) {
         KAA_LOG_INFO(boost::format("Log storage is full (occupied %1%, max %2%). Going to delete elder logs")
                                                                         % totalOccupiedSize_ % maxOccupiedSize_);
@@ -82,7 +99,7 @@ BucketInfo MemoryLogStorage::addLogRecord(LogRecord&& record)
     KAA_LOG_TRACE(boost::format("Added log record (%1% bytes). Non-used records: count %2%, occupied size %3% bytes")
                                                      % recordSize % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
 
-    return BucketInfo(currentBucketId_, buckets_.back().logs_.size());
+    return BucketInfo(currentBucketId_, buckets_.back().logs_->size());
 }
 
 LogBucket MemoryLogStorage::getNextBucket()
@@ -93,10 +110,10 @@ LogBucket MemoryLogStorage::getNextBucket()
 
     std::size_t totalRecordCount = 0;
     for (auto& internalBucket : buckets_) {
-        if (internalBucket.state_ == MemoryLogStorage::BucketState::FREE && !internalBucket.logs_.empty()) {
+        if (internalBucket.state_ == MemoryLogStorage::BucketState::FREE && !internalBucket.logs_->empty()) {
             internalBucket.state_ = MemoryLogStorage::BucketState::IN_USE;
 
-            unmarkedRecordCount_ -= internalBucket.logs_.size();
+            unmarkedRecordCount_ -= internalBucket.logs_->size();
             occupiedSizeOfUnmarkedRecords_ -= internalBucket.occupiedSize_;
 
             if (!unmarkedRecordCount_) {
@@ -105,12 +122,12 @@ LogBucket MemoryLogStorage::getNextBucket()
 
             KAA_LOG_INFO(boost::format("Create log bucket: id %1%, size %2%, %3% record(s). "
                                        "Non-used records: count %4%, occupied size %5% bytes")
-                            % internalBucket.bucketId_ % internalBucket.occupiedSize_ % internalBucket.logs_.size()
+                            % internalBucket.bucketId_ % internalBucket.occupiedSize_ % internalBucket.logs_->size()
                             % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
 
             return LogBucket(internalBucket.bucketId_, internalBucket.logs_);
         } else {
-            totalRecordCount += internalBucket.logs_.size();
+            totalRecordCount += internalBucket.logs_->size();
         }
     }
 
@@ -133,7 +150,7 @@ void MemoryLogStorage::removeBucket(std::int32_t bucketId)
                                  totalOccupiedSize_ -= bucket.occupiedSize_;
                                  KAA_LOG_TRACE(boost::format("Log bucket %1% removed (%2% records). "
                                                              "Non-used records: count %3%, occupied size %4% bytes")
-                                                             % bucketId % bucket.logs_.size() % unmarkedRecordCount_
+                                                             % bucketId % bucket.logs_->size() % unmarkedRecordCount_
                                                              % occupiedSizeOfUnmarkedRecords_);
                                  found = true;
                                  return true;
@@ -160,10 +177,10 @@ void MemoryLogStorage::rollbackBucket(std::int32_t bucketId)
     if (it != buckets_.end()) {
         it->state_ = MemoryLogStorage::BucketState::FREE;
         occupiedSizeOfUnmarkedRecords_ += it->occupiedSize_;
-        unmarkedRecordCount_ += it->logs_.size();
+        unmarkedRecordCount_ += it->logs_->size();
 
         KAA_LOG_DEBUG(boost::format("Rollback log bucket %1% (%2% records). Non-used records: count %3%, occupied size %4% bytes")
-                                            % bucketId % it->logs_.size() % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
+                                            % bucketId % it->logs_->size() % unmarkedRecordCount_ % occupiedSizeOfUnmarkedRecords_);
     } else {
         KAA_LOG_WARN(boost::format("Failed to rollback log bucket %1%: not found") % bucketId);
     }
@@ -189,13 +206,13 @@ void MemoryLogStorage::shrinkToSize(std::size_t newSize)
 
         if (totalOccupiedSize_ - theOldestBucket.occupiedSize_ >= newSize) {
             KAA_LOG_INFO(boost::format("Removing in-use log bucket %1% (%2% records, %3% bytes)")
-                                    % theOldestBucket.bucketId_ % theOldestBucket.logs_.size() % theOldestBucket.occupiedSize_);
+                                    % theOldestBucket.bucketId_ % theOldestBucket.logs_->size() % theOldestBucket.occupiedSize_);
 
             totalOccupiedSize_ -= theOldestBucket.occupiedSize_;
-            recordCount += theOldestBucket.logs_.size();
+            recordCount += theOldestBucket.logs_->size();
 
             if (theOldestBucket.state_ == MemoryLogStorage::BucketState::FREE) {
-                unmarkedRecordCount_ -= theOldestBucket.logs_.size();
+                unmarkedRecordCount_ -= theOldestBucket.logs_->size();
                 occupiedSizeOfUnmarkedRecords_ -= theOldestBucket.occupiedSize_;
             }
 
@@ -205,8 +222,9 @@ void MemoryLogStorage::shrinkToSize(std::size_t newSize)
                 addNewBucket();
             }
         } else {
+            auto& theOldestLogs = theOldestBucket.getWritableLogs();
             while (totalOccupiedSize_ > newSize) {
-                const auto& theOldestRecord = theOldestBucket.logs_.front();
+                const auto& theOldestRecord = theOldestLogs.front();
 
                 if (theOldestBucket.state_ == MemoryLogStorage::BucketState::FREE) {
                     --unmarkedRecordCount_;
@@ -214,7 +232,8 @@ void MemoryLogStorage::shrinkToSize(std::size_t newSize)
                 }
 
                 totalOccupiedSize_ -= theOldestRecord.getSize();
-                theOldestBucket.logs_.pop_front();
+                theOldestBucket.occupiedSize_ -= theOldestRecord.getSize();
+                theOldestLogs.pop_front();
 
                 ++recordCount;
             }
@@ -250,7 +269,7 @@ void MemoryLogStorage::internalAddLogRecord(LogRecord&& record)
 
     auto& currentBucket  = buckets_.back();
     currentBucket.occupiedSize_ += recordSize;
-    currentBucket.logs_.push_back(std::move(record));
+    currentBucket.getWritableLogs().push_back(std::move(record));
 }
 
 }  // namespace kaa
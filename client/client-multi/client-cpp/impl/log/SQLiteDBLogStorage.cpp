@@ -18,6 +18,9 @@
 
 #include <kaa/log/SQLiteDBLogStorage.hpp>
 
+#include <algorithm>
+#include <tuple>
+
 #include <kaa/logging/Log.hpp>
 #include <kaa/log/LogRecord.hpp>
 #include <kaa/common/exception/KaaException.hpp>
@@ -123,6 +126,13 @@
      KAA_BUCKETS_SIZE_IN_BYTES_FIELD_NAME " = " KAA_BUCKETS_SIZE_IN_BYTES_FIELD_NAME "+ ? " \
     "WHERE " KAA_BUCKETS_OUTER_BUCKET_ID_FIELD_NAME " = ?;"
 
+#define KAA_BEGIN_TRANSACTION     "BEGIN TRANSACTION;"
+#define KAA_COMMIT_TRANSACTION    "COMMIT TRANSACTION;"
+
+#define KAA_SAVEPOINT                "SAVEPOINT ADD_RECORDS;"
+#define KAA_ROLLBACK_TO_SAVEPOINT    "ROLLBACK TO SAVEPOINT ADD_RECORDS;"
+#define KAA_RELEASE_SAVEPOINT        "RELEASE SAVEPOINT ADD_RECORDS;"
+
 /*
  * OPTIMIZATION OPTIONS.
  */
@@ -130,6 +140,7 @@
 #define KAA_COUNT_CHANGES_OPTION          "PRAGMA count_changes=OFF"
 #define KAA_MEMORY_JOURNAL_MODE_OPTION    "PRAGMA journal_mode=MEMORY"
 #define KAA_MEMORY_TEMP_STORE_OPTION      "PRAGMA temp_store=MEMORY"
+#define KAA_WAL_JOURNAL_MODE_OPTION       "PRAGMA journal_mode=WAL"
 
 namespace kaa {
 
@@ -161,10 +172,37 @@ public:
 
     sqlite3_stmt *getStatement() { return stmt_; }
 
+    void reset()
+    {
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+    }
+
 private:
     sqlite3_stmt *stmt_ = nullptr;
 };
 
+/*
+ * Resets a cached statement on leaving the scope, so that it neither keeps
+ * old bindings nor holds the database lock until the next use.
+ */
+class SQLiteStatementResetter {
+public:
+    explicit SQLiteStatementResetter(SQLiteStatement& stmt) : stmt_(stmt) {}
+    ~SQLiteStatementResetter() { stmt_.reset(); }
+
+private:
+    SQLiteStatement& stmt_;
+};
+
+static void executeStatement(SQLiteStatement& stmt, const std::string& errorMessage)
+{
+    SQLiteStatementResetter resetter(stmt);
+
+    int errorCode = sqlite3_step(stmt.getStatement());
+    throwIfError(errorCode, SQLITE_DONE, (boost::format("%s (error %d)") % errorMessage % errorCode).str());
+}
+
 SQLiteDBLogStorage::SQLiteDBLogStorage(IKaaClientContext &context, std::size_t bucketSize, std::size_t bucketRecordCount)
     : dbName_(context.getProperties().getLogsDatabaseFileName()),
       maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount),
@@ -175,14 +213,28 @@ SQLiteDBLogStorage::SQLiteDBLogStorage(IKaaClientContext &context, std::size_t b
 
 SQLiteDBLogStorage::SQLiteDBLogStorage(IKaaClientContext &context,
                                        const std::string& dbName, int optimizationMask,
-                                       std::size_t bucketSize, std::size_t bucketRecordCount)
-    : dbName_(dbName), maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount), context_(context)
+                                       std::size_t bucketSize, std::size_t bucketRecordCount,
+                                       const SQLiteTransactionOptions& transactionOptions)
+    : dbName_(dbName), maxBucketSize_(bucketSize), maxBucketRecordCount_(bucketRecordCount),
+      transactionOptions_(transactionOptions), context_(context)
 {
     init(optimizationMask);
 }
 
 SQLiteDBLogStorage::~SQLiteDBLogStorage()
 {
+    /*
+     * Waits for the commit callback if it is being executed.
+     */
+    commitTimer_.reset();
+
+    try {
+        commitTransaction();
+    } catch (std::exception& e) {
+        KAA_LOG_ERROR(boost::format("Failed to commit %u pending log record(s): %s") % transactionRecordCount_ % e.what());
+    }
+
+    finalizeStatements();
     closeDBConnection();
 }
 
@@ -206,12 +258,18 @@ void SQLiteDBLogStorage::init(int optimizationMask)
         }
     }
 
+    prepareStatements();
+
     if (totalRecordCount_ > 0) {
         markBucketsAsFree();
     } else {
         addNextBucket();
     }
 
+    if (transactionOptions_.maxDurationMs_) {
+        commitTimer_.reset(new KaaTimer<void ()>("SQLiteDBLogStorage commitTimer"));
+    }
+
     KAA_LOG_INFO(boost::format("%li log records in database (%li bytes total size)") % totalRecordCount_ % consumedMemory_);
 }
 
@@ -289,6 +347,10 @@ void SQLiteDBLogStorage::applyOptimization(int mask)
         sqlite3_exec(db_, KAA_COUNT_CHANGES_OPTION, nullptr, nullptr, nullptr);
         KAA_LOG_INFO(boost::format("Applied '%s' optimization") % KAA_COUNT_CHANGES_OPTION);
     }
+    if (mask & SQLiteOptimizationOptions::SQLITE_WAL_JOURNAL_MODE) {
+        sqlite3_exec(db_, KAA_WAL_JOURNAL_MODE_OPTION, nullptr, nullptr, nullptr);
+        KAA_LOG_INFO(boost::format("Applied '%s' optimization") % KAA_WAL_JOURNAL_MODE_OPTION);
+    }
 }
 
 void SQLiteDBLogStorage::markBucketsAsFree()
@@ -307,12 +369,12 @@ void SQLiteDBLogStorage::markBucketsAsFree()
 
 void SQLiteDBLogStorage::markBucketAsInUse(std::int32_t id)
 {
-    SQLiteStatement stmt(db_, KAA_MARK_BUCKET_AS_IN_USE);
+    SQLiteStatementResetter resetter(*markBucketAsInUseStmt_);
 
-    int errorCode = sqlite3_bind_int64(stmt.getStatement(), 1, id);
+    int errorCode = sqlite3_bind_int64(markBucketAsInUseStmt_->getStatement(), 1, id);
     throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
 
-    errorCode = sqlite3_step(stmt.getStatement());
+    errorCode = sqlite3_step(markBucketAsInUseStmt_->getStatement());
     throwIfError(errorCode, SQLITE_DONE, (boost::format("(error %d)") % errorCode).str());
 
     KAA_LOG_TRACE(boost::format("Mark bucket as in use, id %1%") % id);
@@ -336,7 +398,227 @@ void SQLiteDBLogStorage::closeDBConnection()
     }
 }
 
+void SQLiteDBLogStorage::prepareStatements()
+{
+    beginTransactionStmt_.reset(new SQLiteStatement(db_, KAA_BEGIN_TRANSACTION));
+    commitTransactionStmt_.reset(new SQLiteStatement(db_, KAA_COMMIT_TRANSACTION));
+    savepointStmt_.reset(new SQLiteStatement(db_, KAA_SAVEPOINT));
+    rollbackToSavepointStmt_.reset(new SQLiteStatement(db_, KAA_ROLLBACK_TO_SAVEPOINT));
+    releaseSavepointStmt_.reset(new SQLiteStatement(db_, KAA_RELEASE_SAVEPOINT));
+    insertRecordStmt_.reset(new SQLiteStatement(db_, KAA_INSERT_NEW_RECORD_IN_BUCKET));
+    updateBucketInfoStmt_.reset(new SQLiteStatement(db_, KAA_UPDATE_BUCKET_INFO));
+    insertBucketStmt_.reset(new SQLiteStatement(db_, KAA_INSERT_NEW_BUCKET));
+    getOldestBucketStmt_.reset(new SQLiteStatement(db_, KAA_GET_THE_OLDEST_BUCKET));
+    selectBucketRecordsStmt_.reset(new SQLiteStatement(db_, KAA_SELECT_BUCKET_RECORDS));
+    markBucketAsInUseStmt_.reset(new SQLiteStatement(db_, KAA_MARK_BUCKET_AS_IN_USE));
+    markBucketAsFreeStmt_.reset(new SQLiteStatement(db_, KAA_MARK_BUCKET_AS_FREE));
+    deleteBucketStmt_.reset(new SQLiteStatement(db_, KAA_DELETE_BUCKET));
+    deleteBucketRecordsStmt_.reset(new SQLiteStatement(db_, KAA_DELETE_BUCKET_RECORDS));
+
+    KAA_LOG_TRACE("Prepared log database statements");
+}
+
+void SQLiteDBLogStorage::finalizeStatements()
+{
+    /*
+     * All statements must be finalized before the connection is closed.
+     */
+    beginTransactionStmt_.reset();
+    commitTransactionStmt_.reset();
+    savepointStmt_.reset();
+    rollbackToSavepointStmt_.reset();
+    releaseSavepointStmt_.reset();
+    insertRecordStmt_.reset();
+    updateBucketInfoStmt_.reset();
+    insertBucketStmt_.reset();
+    getOldestBucketStmt_.reset();
+    selectBucketRecordsStmt_.reset();
+    markBucketAsInUseStmt_.reset();
+    markBucketAsFreeStmt_.reset();
+    deleteBucketStmt_.reset();
+    deleteBucketRecordsStmt_.reset();
+}
+
+void SQLiteDBLogStorage::beginTransactionIfNeeded()
+{
+    if (isTransactionActive_) {
+        return;
+    }
+
+    SQLiteStatementResetter resetter(*beginTransactionStmt_);
+
+    int errorCode = sqlite3_step(beginTransactionStmt_->getStatement());
+    throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to begin transaction (error %d)") % errorCode).str());
+
+    isTransactionActive_ = true;
+    transactionRecordCount_ = transactionSize_ = 0;
+    transactionStartTime_ = std::chrono::steady_clock::now();
+
+    if (commitTimer_) {
+        commitTimer_->stop();
+        commitTimer_->start(std::chrono::milliseconds(transactionOptions_.maxDurationMs_), [this] { onCommitTimer(); });
+    }
+}
+
+void SQLiteDBLogStorage::commitTransaction()
+{
+    if (!isTransactionActive_) {
+        return;
+    }
+
+    SQLiteStatementResetter resetter(*commitTransactionStmt_);
+
+    int errorCode = sqlite3_step(commitTransactionStmt_->getStatement());
+
+    /*
+     * On some errors SQLite rolls the transaction back itself, on others (e.g. SQLITE_BUSY) it stays open.
+     */
+    isTransactionActive_ = !sqlite3_get_autocommit(db_);
+    throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to commit transaction (error %d)") % errorCode).str());
+
+    if (commitTimer_) {
+        commitTimer_->stop();
+    }
+
+    KAA_LOG_TRACE(boost::format("Committed %u log record(s) (%u bytes)") % transactionRecordCount_ % transactionSize_);
+}
+
+void SQLiteDBLogStorage::commitTransactionIfLimitsReached()
+{
+    if (!isTransactionActive_) {
+        return;
+    }
+
+    bool isRecordCountReached = transactionOptions_.maxRecordCount_ &&
+                                transactionRecordCount_ >= transactionOptions_.maxRecordCount_;
+    bool isSizeReached = transactionOptions_.maxSize_ && transactionSize_ >= transactionOptions_.maxSize_;
+    bool isDurationReached = transactionOptions_.maxDurationMs_ &&
+                             std::chrono::steady_clock::now() - transactionStartTime_ >=
+                                     std::chrono::milliseconds(transactionOptions_.maxDurationMs_);
+
+    if (isRecordCountReached || isSizeReached || isDurationReached) {
+        commitTransaction();
+    }
+}
+
+void SQLiteDBLogStorage::commitExpiredTransaction()
+{
+    try {
+        commitTransactionIfLimitsReached();
+    } catch (std::exception& e) {
+        KAA_LOG_ERROR(boost::format("Failed to commit %u log record(s): %s") % transactionRecordCount_ % e.what());
+    }
+}
+
+void SQLiteDBLogStorage::onCommitTimer()
+{
+    KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
+    KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
+
+    commitExpiredTransaction();
+
+    /*
+     * The timer may have fired a bit early or the commit may have failed, so it is restarted for what is left.
+     */
+    if (isTransactionActive_) {
+        auto maxDuration = std::chrono::milliseconds(transactionOptions_.maxDurationMs_);
+        auto remaining = maxDuration - std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                std::chrono::steady_clock::now() - transactionStartTime_);
+        commitTimer_->start(remaining.count() > 0 ? remaining : maxDuration, [this] { onCommitTimer(); });
+    }
+}
+
+void SQLiteDBLogStorage::storeInSavepoint(const std::function<void ()>& store)
+{
+    auto counters = std::tie(currentBucketId_, currentBucketSize_, currentBucketRecordCount_,
+                             unmarkedRecordCount_, totalRecordCount_, consumedMemory_,
+                             transactionRecordCount_, transactionSize_);
+    const std::tuple<std::int32_t, std::size_t, std::size_t, std::size_t,
+                     std::size_t, std::size_t, std::size_t, std::size_t> savedCounters = counters;
+
+    executeStatement(*savepointStmt_, "Failed to set savepoint");
+
+    try {
+        store();
+        executeStatement(*releaseSavepointStmt_, "Failed to release savepoint");
+    } catch (...) {
+        /*
+         * Neither rows nor counters of partly stored records are left.
+         */
+        counters = savedCounters;
+
+        try {
+            executeStatement(*rollbackToSavepointStmt_, "Failed to roll back to savepoint");
+            executeStatement(*releaseSavepointStmt_, "Failed to release savepoint");
+        } catch (std::exception& e) {
+            KAA_LOG_ERROR(boost::format("Failed to undo partly stored log records: %s") % e.what());
+        }
+
+        /*
+         * On some errors SQLite rolls the whole transaction back itself.
+         */
+        isTransactionActive_ = !sqlite3_get_autocommit(db_);
+        throw;
+    }
+}
+
 BucketInfo SQLiteDBLogStorage::addLogRecord(LogRecord&& record)
+{
+    KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
+    KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
+
+    checkRecordSize(record);
+
+    BucketInfo bucketInfo;
+
+    beginTransactionIfNeeded();
+    storeInSavepoint([&] { bucketInfo = storeLogRecord(record); });
+    commitTransactionIfLimitsReached();
+
+    return bucketInfo;
+}
+
+void SQLiteDBLogStorage::addLogRecords(std::list<LogRecord>& records, std::vector<BucketInfo>& bucketInfos)
+{
+    KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
+    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
+    KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
+
+    /*
+     * Records up to the first too big one are written in one savepoint of the transaction, so a failure
+     * leaves none of them. The too big record is left the first in the list.
+     */
+    auto tooBigRecord = std::find_if(records.begin(), records.end(),
+                                     [this] (const LogRecord& record) { return record.getSize() > maxBucketSize_; });
+
+    if (tooBigRecord != records.begin()) {
+        std::size_t bucketInfoCount = bucketInfos.size();
+
+        beginTransactionIfNeeded();
+
+        try {
+            storeInSavepoint([&] {
+                for (auto it = records.begin(); it != tooBigRecord; ++it) {
+                    bucketInfos.push_back(storeLogRecord(*it));
+                }
+            });
+        } catch (...) {
+            bucketInfos.erase(bucketInfos.begin() + bucketInfoCount, bucketInfos.end());
+            throw;
+        }
+
+        records.erase(records.begin(), tooBigRecord);
+        commitTransactionIfLimitsReached();
+    }
+
+    if (!records.empty()) {
+        checkRecordSize(records.front());
+    }
+}
+
+void SQLiteDBLogStorage::checkRecordSize(const LogRecord& record) const
 {
     auto recordSize = record.getSize();
     if (recordSize > maxBucketSize_) {
@@ -344,36 +626,41 @@ BucketInfo SQLiteDBLogStorage::addLogRecord(LogRecord&& record)
                                                                         % recordSize % maxBucketSize_);
         throw KaaException("Too big log record");
     }
+}
 
+BucketInfo SQLiteDBLogStorage::storeLogRecord(const LogRecord& record)
+{
     if (checkBucketOverflow(record)) {
         addNextBucket();
     }
 
-    SQLiteStatement insertStmt(db_, KAA_INSERT_NEW_RECORD_IN_BUCKET);
+    {
+        SQLiteStatementResetter resetter(*insertRecordStmt_);
+        sqlite3_stmt *insertStmt = insertRecordStmt_->getStatement();
 
-    int errorCode = sqlite3_bind_int(insertStmt.getStatement(), 1, currentBucketId_);
-    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind record's bucket id (error %d)") % errorCode).str());
+        int errorCode = sqlite3_bind_int(insertStmt, 1, currentBucketId_);
+        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind record's bucket id (error %d)") % errorCode).str());
 
-    errorCode = sqlite3_bind_blob(insertStmt.getStatement(), 2, record.getData().data(), record.getSize(), SQLITE_STATIC);
-    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind record data (error %d)") % errorCode).str());
-
-    SQLiteStatement updateBucketInfoStmt(db_, KAA_UPDATE_BUCKET_INFO);
+        errorCode = sqlite3_bind_blob(insertStmt, 2, record.getData().data(), record.getSize(), SQLITE_STATIC);
+        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind record data (error %d)") % errorCode).str());
 
-    errorCode = sqlite3_bind_int(updateBucketInfoStmt.getStatement(), 1, record.getSize());
-    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind record size (error %d)") % errorCode).str());
+        errorCode = sqlite3_step(insertStmt);
+        throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql insert query (error %d)") % errorCode).str());
+    }
 
-    errorCode = sqlite3_bind_int(updateBucketInfoStmt.getStatement(), 2, currentBucketId_);
-    throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+    {
+        SQLiteStatementResetter resetter(*updateBucketInfoStmt_);
+        sqlite3_stmt *updateBucketInfoStmt = updateBucketInfoStmt_->getStatement();
 
-    KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
-    KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
-    KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
+        int errorCode = sqlite3_bind_int(updateBucketInfoStmt, 1, record.getSize());
+        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind record size (error %d)") % errorCode).str());
 
-    errorCode = sqlite3_step(insertStmt.getStatement());
-    throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql insert query (error %d)") % errorCode).str());
+        errorCode = sqlite3_bind_int(updateBucketInfoStmt, 2, currentBucketId_);
+        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
 
-    errorCode = sqlite3_step(updateBucketInfoStmt.getStatement());
-    throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql insert query (error %d)") % errorCode).str());
+        errorCode = sqlite3_step(updateBucketInfoStmt);
+        throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql insert query (error %d)") % errorCode).str());
+    }
 
     ++unmarkedRecordCount_;
     ++totalRecordCount_;
@@ -382,6 +669,9 @@ BucketInfo SQLiteDBLogStorage::addLogRecord(LogRecord&& record)
     ++currentBucketRecordCount_;
     currentBucketSize_ += record.getSize();
 
+    ++transactionRecordCount_;
+    transactionSize_ += record.getSize();
+
     KAA_LOG_TRACE(boost::format("Added log record (%u bytes). Total: %u, unmarked: %u, consumedMemory: %u")
                             % record.getSize() % totalRecordCount_ % unmarkedRecordCount_ % consumedMemory_);
 
@@ -391,35 +681,47 @@ BucketInfo SQLiteDBLogStorage::addLogRecord(LogRecord&& record)
 LogBucket SQLiteDBLogStorage::getNextBucket()
 {
     try {
-        SQLiteStatement getOldestBucketStmt(db_, KAA_GET_THE_OLDEST_BUCKET);
-
         KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
         KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
         KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
 
-        int errorCode = sqlite3_step(getOldestBucketStmt.getStatement());
-        if (errorCode != SQLITE_ROW) {
-            KAA_LOG_DEBUG(boost::format("Failed to find unused bucket, error %1%") % errorCode);
-        }
+        commitTransaction();
 
-        std::int32_t bucketId = sqlite3_column_int64(getOldestBucketStmt.getStatement(), 1);
-        std::size_t bucketSizeInRecords = sqlite3_column_int64(getOldestBucketStmt.getStatement(), 2);
-        std::size_t bucketSizeInBytes = sqlite3_column_int64(getOldestBucketStmt.getStatement(), 3);
+        std::int32_t bucketId = 0;
+        std::size_t bucketSizeInRecords = 0;
+        std::size_t bucketSizeInBytes = 0;
 
-        SQLiteStatement getBucketLogsStmt(db_, KAA_SELECT_BUCKET_RECORDS);
+        {
+            SQLiteStatementResetter resetter(*getOldestBucketStmt_);
+            sqlite3_stmt *getOldestBucketStmt = getOldestBucketStmt_->getStatement();
 
-        errorCode = sqlite3_bind_int(getBucketLogsStmt.getStatement(), 1, bucketId);
-        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind record data (error %d)") % errorCode).str());
+            int errorCode = sqlite3_step(getOldestBucketStmt);
+            if (errorCode != SQLITE_ROW) {
+                KAA_LOG_DEBUG(boost::format("Failed to find unused bucket, error %1%") % errorCode);
+            }
+
+            bucketId = sqlite3_column_int64(getOldestBucketStmt, 1);
+            bucketSizeInRecords = sqlite3_column_int64(getOldestBucketStmt, 2);
+            bucketSizeInBytes = sqlite3_column_int64(getOldestBucketStmt, 3);
+        }
 
         std::list<LogRecord> records;
 
-        while (SQLITE_ROW == (errorCode = sqlite3_step(getBucketLogsStmt.getStatement()))) {
-            const void *recordData = sqlite3_column_blob(getBucketLogsStmt.getStatement(), 0);
-            int recordDataSize = sqlite3_column_bytes(getBucketLogsStmt.getStatement(), 0);
-            records.emplace_back(reinterpret_cast<const std::uint8_t *>(recordData), recordDataSize);
-        }
+        {
+            SQLiteStatementResetter resetter(*selectBucketRecordsStmt_);
+            sqlite3_stmt *getBucketLogsStmt = selectBucketRecordsStmt_->getStatement();
 
-        throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql select query (error %d)") % errorCode).str());
+            int errorCode = sqlite3_bind_int(getBucketLogsStmt, 1, bucketId);
+            throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind record data (error %d)") % errorCode).str());
+
+            while (SQLITE_ROW == (errorCode = sqlite3_step(getBucketLogsStmt))) {
+                const void *recordData = sqlite3_column_blob(getBucketLogsStmt, 0);
+                int recordDataSize = sqlite3_column_bytes(getBucketLogsStmt, 0);
+                records.emplace_back(reinterpret_cast<const std::uint8_t *>(recordData), recordDataSize);
+            }
+
+            throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql select query (error %d)") % errorCode).str());
+        }
 
         markBucketAsInUse(bucketId);
 
@@ -447,25 +749,31 @@ LogBucket SQLiteDBLogStorage::getNextBucket()
 void SQLiteDBLogStorage::removeBucket(std::int32_t bucketId)
 {
     try {
-        SQLiteStatement deleteBucketStmt(db_, KAA_DELETE_BUCKET);
+        KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
+        KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
+        KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
 
-        int errorCode = sqlite3_bind_int64(deleteBucketStmt.getStatement(), 1, bucketId);
-        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+        commitTransaction();
 
-        SQLiteStatement deleteBucketRecordsStmt(db_, KAA_DELETE_BUCKET_RECORDS);
+        {
+            SQLiteStatementResetter resetter(*deleteBucketStmt_);
 
-        errorCode = sqlite3_bind_int64(deleteBucketRecordsStmt.getStatement(), 1, bucketId);
-        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+            int errorCode = sqlite3_bind_int64(deleteBucketStmt_->getStatement(), 1, bucketId);
+            throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
 
-        KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
-        KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
-        KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
+            errorCode = sqlite3_step(deleteBucketStmt_->getStatement());
+            throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql delete query (error %d)") % errorCode).str());
+        }
 
-        errorCode = sqlite3_step(deleteBucketStmt.getStatement());
-        throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql delete query (error %d)") % errorCode).str());
+        {
+            SQLiteStatementResetter resetter(*deleteBucketRecordsStmt_);
 
-        errorCode = sqlite3_step(deleteBucketRecordsStmt.getStatement());
-        throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql delete query (error %d)") % errorCode).str());
+            int errorCode = sqlite3_bind_int64(deleteBucketRecordsStmt_->getStatement(), 1, bucketId);
+            throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+
+            errorCode = sqlite3_step(deleteBucketRecordsStmt_->getStatement());
+            throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql delete query (error %d)") % errorCode).str());
+        }
 
         int removedRecordsCount = sqlite3_changes(db_);
         totalRecordCount_ -= removedRecordsCount;
@@ -482,18 +790,21 @@ void SQLiteDBLogStorage::removeBucket(std::int32_t bucketId)
 void SQLiteDBLogStorage::rollbackBucket(std::int32_t bucketId)
 {
     try {
-        int errorCode = SQLITE_OK;
-        SQLiteStatement stmt(db_, KAA_MARK_BUCKET_AS_FREE);
-
-        errorCode = sqlite3_bind_int64(stmt.getStatement(), 1, bucketId);
-        throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
-
         KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
         KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
         KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
 
-        errorCode = sqlite3_step(stmt.getStatement());
-        throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql update query (error %d)") % errorCode).str());
+        commitTransaction();
+
+        {
+            SQLiteStatementResetter resetter(*markBucketAsFreeStmt_);
+
+            int errorCode = sqlite3_bind_int64(markBucketAsFreeStmt_->getStatement(), 1, bucketId);
+            throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind bucket id (error %d)") % errorCode).str());
+
+            errorCode = sqlite3_step(markBucketAsFreeStmt_->getStatement());
+            throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql update query (error %d)") % errorCode).str());
+        }
 
         auto it = consumedMemoryStorage_.find(bucketId);
         if (it != consumedMemoryStorage_.end()) {
@@ -516,6 +827,12 @@ std::size_t SQLiteDBLogStorage::getRecordsCount()
     KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
     KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
     KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
+
+    /*
+     * The storage status is polled by the upload strategy on each check,
+     * so the time limit of the pending transaction is enforced here too.
+     */
+    commitExpiredTransaction();
     return unmarkedRecordCount_;
 }
 
@@ -524,6 +841,8 @@ std::size_t SQLiteDBLogStorage::getConsumedVolume()
     KAA_MUTEX_LOCKING("sqliteLogStorageGuard_");
     KAA_MUTEX_UNIQUE_DECLARE(storageGuardLock, sqliteLogStorageGuard_);
     KAA_MUTEX_LOCKED("sqliteLogStorageGuard_");
+
+    commitExpiredTransaction();
     return consumedMemory_;
 }
 
@@ -532,12 +851,12 @@ void SQLiteDBLogStorage::addNextBucket()
     currentBucketId_++;
     currentBucketSize_ = currentBucketRecordCount_ = 0;
 
-    SQLiteStatement insertStmt(db_, KAA_INSERT_NEW_BUCKET);
+    SQLiteStatementResetter resetter(*insertBucketStmt_);
 
-    int errorCode = sqlite3_bind_int(insertStmt.getStatement(), 1, currentBucketId_);
+    int errorCode = sqlite3_bind_int(insertBucketStmt_->getStatement(), 1, currentBucketId_);
     throwIfError(errorCode, SQLITE_OK, (boost::format("Failed to bind record data (error %d)") % errorCode).str());
 
-    errorCode = sqlite3_step(insertStmt.getStatement());
+    errorCode = sqlite3_step(insertBucketStmt_->getStatement());
     throwIfError(errorCode, SQLITE_DONE, (boost::format("Failed to execute sql insert query (error %d)") % errorCode).str());
 
     KAA_LOG_INFO(boost::format("Add new bucket, id %1%") % currentBucketId_);
@@ -0,0 +1,156 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include "kaa/logging/AsyncLogger.hpp"
+
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+const std::size_t AsyncLogger::DEFAULT_CAPACITY;
+
+/*
+ * The number of attempts to find a message before the idle writer goes to sleep.
+ */
+static const std::size_t IDLE_SPIN_COUNT = 64;
+
+AsyncLogger::AsyncLogger(LoggerPtr logger, std::size_t capacity, OverflowPolicy policy)
+    : logger_(logger), policy_(policy), records_(capacity), pushedCount_(0), droppedCount_(0),
+      writtenCount_(0), isRun_(true), isWriterSleeping_(false)
+{
+    if (!logger_) {
+        throw KaaException("Failed to create async logger: no target logger");
+    }
+
+    if (!capacity) {
+        throw KaaException("Failed to create async logger with zero queue capacity");
+    }
+
+    writer_ = std::thread([this] { processRecords(); });
+}
+
+AsyncLogger::~AsyncLogger()
+{
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(writerLock, writerGuard_);
+        isRun_ = false;
+    }
+
+    KAA_CONDITION_NOTIFY(onNewRecord_);
+
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+void AsyncLogger::log(LogLevel level, const char *message) const
+{
+    Record record{level, message};
+
+    if (policy_ == OverflowPolicy::DROP) {
+        if (!records_.push(std::move(record))) {
+            ++droppedCount_;
+            notifyWriter();
+            return;
+        }
+    } else {
+        while (!records_.push(std::move(record))) {
+            notifyWriter();
+            std::this_thread::yield();
+        }
+    }
+
+    ++pushedCount_;
+    notifyWriter();
+}
+
+bool AsyncLogger::isEnabled(LogLevel level) const
+{
+    return logger_->isEnabled(level);
+}
+
+void AsyncLogger::flush()
+{
+    const std::size_t pushedCount = pushedCount_;
+
+    KAA_MUTEX_UNIQUE_DECLARE(writerLock, writerGuard_);
+    KAA_CONDITION_WAIT_PRED(onRecordsWritten_, writerLock,
+                            [&] { return !isRun_ || writtenCount_ >= pushedCount; });
+}
+
+void AsyncLogger::notifyWriter() const
+{
+    if (isWriterSleeping_) {
+        /*
+         * Taking the lock guarantees that the writer either hasn't checked its wait condition yet
+         * or already waits for the notification.
+         */
+        { KAA_MUTEX_UNIQUE_DECLARE(writerLock, writerGuard_); }
+        KAA_CONDITION_NOTIFY(onNewRecord_);
+    }
+}
+
+bool AsyncLogger::writeRecords()
+{
+    Record record;
+    bool isWritten = false;
+
+    while (records_.pop(record)) {
+        try {
+            logger_->log(record.level_, record.message_.c_str());
+        } catch (...) {}
+
+        ++writtenCount_;
+        isWritten = true;
+    }
+
+    if (isWritten) {
+        { KAA_MUTEX_UNIQUE_DECLARE(writerLock, writerGuard_); }
+        KAA_CONDITION_NOTIFY_ALL(onRecordsWritten_);
+    }
+
+    return isWritten;
+}
+
+void AsyncLogger::processRecords()
+{
+    std::size_t spinCount = 0;
+
+    while (isRun_) {
+        if (writeRecords()) {
+            spinCount = 0;
+            continue;
+        }
+
+        if (spinCount++ < IDLE_SPIN_COUNT) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        spinCount = 0;
+
+        KAA_MUTEX_UNIQUE_DECLARE(writerLock, writerGuard_);
+        isWriterSleeping_ = true;
+        KAA_CONDITION_WAIT_PRED(onNewRecord_, writerLock,
+                                [this] { return !isRun_ || pushedCount_ != writtenCount_; });
+        isWriterSleeping_ = false;
+    }
+
+    writeRecords();
+}
+
+} /* namespace kaa */
@@ -33,7 +33,7 @@
 
 namespace kaa {
 
-DefaultLogger::DefaultLogger(const std::string& clientId, const std::string& logFileName): clientId_(clientId), pSink_(new text_sink)
+DefaultLogger::DefaultLogger(const std::string& clientId, const std::string& logFileName): clientId_(clientId), level_(LogLevel::KAA_TRACE), pSink_(new text_sink)
 {
     text_sink::locked_backend_ptr pBackend = pSink_->locked_backend();
     boost::shared_ptr< std::ostream > consoleStream(&std::clog, [](const void *)->void const {});
@@ -58,6 +58,10 @@ DefaultLogger::DefaultLogger(const std::string& clientId, const std::string& log
 
 void DefaultLogger::log(LogLevel level, const char *message) const
 {
+    if (!isEnabled(level)) {
+        return;
+    }
+
     BOOST_LOG_SCOPED_THREAD_TAG("id", clientId_.c_str());
     BOOST_LOG_STREAM_WITH_PARAMS(boost::log::trivial::logger::get(),
                                 (boost::log::keywords::severity = (boost::log::trivial::severity_level)level)) << message;
@@ -18,16 +18,22 @@
 
 #if KAA_LOG_LEVEL > KAA_LOG_LEVEL_NONE
 
+#include <cstring>
+#include <string>
 #include <boost/format.hpp>
 
 namespace kaa {
 
-static const char * const KAA_LOG_FMT = "[%1%:%2%]:\t%3%";
-
 void kaa_log_message(const ILogger & logger, LogLevel level, const char *message, const char *file, size_t lineno)
 {
-    boost::format logline = boost::format(KAA_LOG_FMT) % file % lineno % message;
-    logger.log(level, logline.str().c_str());
+    /*
+     * "[file:line]:\tmessage", appended without one more formatting pass over the message.
+     */
+    const std::string line = std::to_string(lineno);
+    std::string logline;
+    logline.reserve(std::strlen(file) + line.size() + std::strlen(message) + 5);
+    logline.append(1, '[').append(file).append(1, ':').append(line).append("]:\t").append(message);
+    logger.log(level, logline.c_str());
 }
 
 void kaa_log_message(const ILogger & logger, LogLevel level, const std::string &message, const char *file, size_t lineno)
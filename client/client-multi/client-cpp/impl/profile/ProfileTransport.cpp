@@ -42,8 +42,13 @@ ProfileSyncRequestPtr ProfileTransport::createProfileRequest()
     ProfileSyncRequestPtr request;
 
     if (profileManager_) {
-        auto encodedProfile = profileManager_->getSerializedProfile();
-        HashDigest newHash = EndpointObjectHash(encodedProfile).getHashDigest();
+        /*
+         * The profile and its hash are cached by the profile manager, so nothing is serialized
+         * if the profile is up to date. They are taken together to match each other.
+         */
+        auto profileWithHash = profileManager_->getSerializedProfileWithHash();
+        const auto& encodedProfile = profileWithHash.first;
+        const auto& newHash = profileWithHash.second;
 
         if (context_.getStatus().isProfileResyncNeeded()
                 || !context_.getStatus().isRegistered() || isProfileOutDated(newHash))
@@ -15,17 +15,17 @@
  */
 
 #include "kaa/security/RsaEncoderDecoder.hpp"
-#include <botan/pubkey.h>
 #include <botan/pkcs8.h>
-#include <botan/pipe.h>
-#include <botan/key_filt.h>
-#include <sstream>
 
 #include "kaa/logging/Log.hpp"
 #include "kaa/logging/LoggingUtils.hpp"
+#include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
 
+static const char * const SESSION_CIPHER = "AES-128/ECB/PKCS7";
+static const char * const SIGNATURE_PADDING = "EMSA3(SHA-1)";
+
 RsaEncoderDecoder::RsaEncoderDecoder(const PublicKey& pubKey,
         const PrivateKey& privKey,
         const PublicKey& remoteKey, IKaaClientContext &context)
@@ -44,55 +44,111 @@ RsaEncoderDecoder::RsaEncoderDecoder(const PublicKey& pubKey,
     if (!privKey.empty()) {
         Botan::DataSource_Memory privMem(privKey);
         privKey_.reset(Botan::PKCS8::load_key(privMem, rng_));
+        signer_.reset(new Botan::PK_Signer(*privKey_, SIGNATURE_PADDING));
     }
 
     if (!remoteKey.empty()) {
         Botan::DataSource_Memory remoteMem(remoteKey);
         remoteKey_.reset(Botan::X509::load_key(remoteMem));
+        verifier_.reset(new Botan::PK_Verifier(*remoteKey_, SIGNATURE_PADDING));
     }
 
     KAA_LOG_TRACE(boost::format("RemotePublicKey: %1%") % ( remoteKey_ ? LoggingUtils::ByteArrayToString(
             remoteKey_->x509_subject_public_key().data(), remoteKey_->x509_subject_public_key().size()) : "empty"));
+
+    encryptor_.reset(Botan::get_cipher_mode(SESSION_CIPHER, Botan::ENCRYPTION));
+    decryptor_.reset(Botan::get_cipher_mode(SESSION_CIPHER, Botan::DECRYPTION));
+    if (!encryptor_ || !decryptor_) {
+        throw KaaException(boost::format("Failed to create %1% cipher") % SESSION_CIPHER);
+    }
+
+    encryptor_->set_key(sessionKey_);
+    decryptor_->set_key(sessionKey_);
+}
+
+const EncodedSessionKey& RsaEncoderDecoder::encodeSessionKey()
+{
+    /*
+     * Must be called under sessionKeyGuard_.
+     */
+    if (encodedSessionKey_.empty()) {
+        Botan::PK_Encryptor_EME enc(*remoteKey_, "EME-PKCS1-v1_5");
+        auto &&v = enc.encrypt(sessionKey_.bits_of(), rng_);
+        encodedSessionKey_.assign(v.begin(), v.end());
+    }
+    return encodedSessionKey_;
 }
 
 EncodedSessionKey RsaEncoderDecoder::getEncodedSessionKey()
 {
-    Botan::PK_Encryptor_EME enc(*remoteKey_, "EME-PKCS1-v1_5");
-    auto &&v = enc.encrypt(sessionKey_.bits_of(), rng_);
-    return Botan::secure_vector<std::uint8_t>(v.begin(), v.end());
+    KAA_MUTEX_UNIQUE_DECLARE(lock, sessionKeyGuard_);
+    return encodeSessionKey();
+}
+
+Signature RsaEncoderDecoder::getSessionKeySignature()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, sessionKeyGuard_);
+    if (sessionKeySignature_.empty()) {
+        const EncodedSessionKey& encodedSessionKey = encodeSessionKey();
+        sessionKeySignature_ = signData(encodedSessionKey.data(), encodedSessionKey.size());
+    }
+    return sessionKeySignature_;
+}
+
+void RsaEncoderDecoder::processData(Botan::Cipher_Mode& cipher, const std::uint8_t *data, std::size_t size, CipherBuffer& dest)
+{
+    /*
+     * ECB needs no IV, so the cipher is just restarted. It encrypts (decrypts) and pads (unpads) the buffer in place.
+     */
+    dest.assign(data, data + size);
+    cipher.start();
+    cipher.finish(dest);
 }
 
-std::string RsaEncoderDecoder::cipherPipe(const std::uint8_t *data, std::size_t size, Botan::Cipher_Dir dir)
+void RsaEncoderDecoder::encodeData(const std::uint8_t *data, std::size_t size, CipherBuffer& dest)
 {
-    Botan::Pipe pipe(Botan::get_cipher("AES-128/ECB/PKCS7", sessionKey_, dir));
-    std::ostringstream stream;
-    pipe.process_msg(data, size);
-    stream << pipe;
-    return stream.str();
+    KAA_MUTEX_UNIQUE_DECLARE(lock, encryptorGuard_);
+    processData(*encryptor_, data, size, dest);
+}
+
+void RsaEncoderDecoder::decodeData(const std::uint8_t *data, std::size_t size, CipherBuffer& dest)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, decryptorGuard_);
+    processData(*decryptor_, data, size, dest);
 }
 
 std::string RsaEncoderDecoder::encodeData(const std::uint8_t *data, std::size_t size)
 {
-    return cipherPipe(data, size, Botan::ENCRYPTION);
+    KAA_MUTEX_UNIQUE_DECLARE(lock, encryptorGuard_);
+    processData(*encryptor_, data, size, encodeBuffer_);
+    return std::string(reinterpret_cast<const char *>(encodeBuffer_.data()), encodeBuffer_.size());
 }
 
 std::string RsaEncoderDecoder::decodeData(const std::uint8_t *data, std::size_t size)
 {
-    return cipherPipe(data, size, Botan::DECRYPTION);
+    KAA_MUTEX_UNIQUE_DECLARE(lock, decryptorGuard_);
+    processData(*decryptor_, data, size, decodeBuffer_);
+    return std::string(reinterpret_cast<const char *>(decodeBuffer_.data()), decodeBuffer_.size());
+}
+
+ByteArrayView RsaEncoderDecoder::decodeDataToBuffer(const std::uint8_t *data, std::size_t size)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(lock, decryptorGuard_);
+    processData(*decryptor_, data, size, decodeBuffer_);
+    return ByteArrayView(decodeBuffer_.data(), decodeBuffer_.size());
 }
 
 Signature RsaEncoderDecoder::signData(const std::uint8_t *data, std::size_t size)
 {
-    Botan::PK_Signer signer(*privKey_, "EMSA3(SHA-1)");
-    auto &&sgn = signer.sign_message(data, size, rng_);
+    KAA_MUTEX_UNIQUE_DECLARE(lock, signerGuard_);
+    auto &&sgn = signer_->sign_message(data, size, rng_);
     return Botan::secure_vector<std::uint8_t>(sgn.begin(), sgn.end());
 }
 
 bool RsaEncoderDecoder::verifySignature(const std::uint8_t *data, std::size_t len, const std::uint8_t *sig, std::size_t sigLen)
 {
-    Botan::PK_Verifier verifier(*remoteKey_, "EMSA3(SHA-1)");
-    return verifier.verify_message(data, len, sig, sigLen);
+    KAA_MUTEX_UNIQUE_DECLARE(lock, verifierGuard_);
+    return verifier_->verify_message(data, len, sig, sigLen);
 }
 
 }
-
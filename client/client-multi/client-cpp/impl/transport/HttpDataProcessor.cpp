@@ -60,21 +60,19 @@ std::string HttpDataProcessor::retrieveBootstrapResponse(const IHttpResponse& re
 std::shared_ptr<IHttpRequest> HttpDataProcessor::createHttpRequest(const HttpUrl& url, const std::vector<std::uint8_t>& data, bool sign)
 {
     std::shared_ptr<MultipartPostHttpRequest> post(new MultipartPostHttpRequest(url, context_));
-    const EncodedSessionKey& encodedSessionKey = encDec_->getEncodedSessionKey();
-    const std::string& bodyEncoded = encDec_->encodeData(data.data(), data.size());
 
-    if (sign) {
-        const Signature& clientSignature =
-                encDec_->signData(reinterpret_cast<const std::uint8_t *>(
-                        encodedSessionKey.data()), encodedSessionKey.size());
+    /*
+     * The request shares the encrypted data instead of copying it.
+     */
+    std::shared_ptr<CipherBuffer> bodyEncoded(new CipherBuffer);
+    encDec_->encodeData(data.data(), data.size(), *bodyEncoded);
 
-        post->setBodyField("signature", std::vector<std::uint8_t>(
-                                        clientSignature.data(),
-                                        clientSignature.data()+clientSignature.size()));
+    if (sign) {
+        post->setBodyField("signature", std::make_shared<Signature>(encDec_->getSessionKeySignature()));
     }
 
-    post->setBodyField("requestKey", std::vector<std::uint8_t>(encodedSessionKey.begin(), encodedSessionKey.end()));
-    post->setBodyField("requestData", std::vector<std::uint8_t>(bodyEncoded.begin(), bodyEncoded.end()));
+    post->setBodyField("requestKey", std::make_shared<EncodedSessionKey>(encDec_->getEncodedSessionKey()));
+    post->setBodyField("requestData", bodyEncoded);
 
     return post;
 }
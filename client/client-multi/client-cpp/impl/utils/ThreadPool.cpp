@@ -97,7 +97,10 @@ void ThreadPool::awaitTermination(std::size_t seconds)
 
     if (isRun_) {
         shutdownTimer_.reset(new KaaTimer<void()>("Thread pool shutdown timer"));
-        shutdownTimer_->start(seconds, [this] () { stop(true); } );
+        /*
+         * Runs on a timer thread, so it must not wait for the workers. They are joined on destruction.
+         */
+        shutdownTimer_->start(seconds, [this] () { interrupt(); } );
     }
 }
 
@@ -118,6 +121,18 @@ void ThreadPool::start()
     }
 }
 
+void ThreadPool::interrupt()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPoolGuard_);
+
+    tasks_.clear();
+    isRun_ = false;
+
+    KAA_UNLOCK(tasksLock);
+
+    onNewTask_.notify_all();
+}
+
 void ThreadPool::stop(bool force)
 {
     KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPoolGuard_);
@@ -0,0 +1,312 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "kaa/utils/TimerWheel.hpp"
+
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+const TimerWheel::TimerId TimerWheel::INVALID_TIMER_ID;
+const std::size_t TimerWheel::TICK_DURATION_MS;
+const std::size_t TimerWheel::SLOT_BITS;
+const std::size_t TimerWheel::SLOT_COUNT;
+const std::size_t TimerWheel::LEVEL_COUNT;
+const std::size_t TimerWheel::DEFAULT_DISPATCHER_COUNT;
+
+static const std::uint64_t SLOT_MASK = TimerWheel::SLOT_COUNT - 1;
+static const std::uint64_t MAX_TICK_DELTA = (static_cast<std::uint64_t>(1) << (TimerWheel::SLOT_BITS * TimerWheel::LEVEL_COUNT)) - 1;
+
+TimerWheel::TimerWheel(std::size_t dispatcherCount)
+    : dispatcherCount_(dispatcherCount), startTime_(std::chrono::steady_clock::now())
+    , state_(std::make_shared<DispatcherState>())
+{
+    if (!dispatcherCount_) {
+        throw KaaException("Failed to create timer wheel without dispatcher threads");
+    }
+}
+
+TimerWheel::~TimerWheel()
+{
+    stopThreads();
+}
+
+TimerWheel& TimerWheel::getInstance()
+{
+    /*
+     * Leaked on purpose. A function-static instance may be destroyed before static or global clients
+     * whose timers still refer to it, and exit() called from a callback would join its own thread.
+     * The threads end with the process.
+     */
+    static TimerWheel *timerWheel = new TimerWheel();
+    return *timerWheel;
+}
+
+TimerWheel::TimerId TimerWheel::schedule(std::chrono::milliseconds delay, const TimerCallback& callback)
+{
+    if (!callback) {
+        throw KaaException("Bad timer callback");
+    }
+
+    std::unique_lock<std::mutex> wheelLock(state_->wheelGuard_);
+
+    if (!state_->isRun_) {
+        startThreads();
+    }
+
+    std::uint64_t now = getCurrentTick();
+    if (timers_.empty() && currentTick_ < now) {
+        /*
+         * All slots are empty, so the wheel may skip the ticks it has been idle for.
+         */
+        currentTick_ = now;
+    }
+
+    std::uint64_t delayMs = delay.count() > 0 ? static_cast<std::uint64_t>(delay.count()) : 0;
+
+    TimerSlot newEntry;
+    newEntry.push_back({ ++lastTimerId_,
+                         toTick(std::chrono::steady_clock::now() + std::chrono::milliseconds(delayMs), true),
+                         callback });
+
+    TimerId timerId = newEntry.front().id_;
+    place(newEntry, newEntry.begin());
+
+    onWheelChange_.notify_one();
+
+    return timerId;
+}
+
+bool TimerWheel::cancel(TimerId timerId)
+{
+    std::unique_lock<std::mutex> wheelLock(state_->wheelGuard_);
+
+    auto it = timers_.find(timerId);
+    if (it == timers_.end()) {
+        return false;
+    }
+
+    wheel_[it->second.level_][it->second.slot_].erase(it->second.entry_);
+    timers_.erase(it);
+
+    return true;
+}
+
+std::size_t TimerWheel::getPendingTimerCount()
+{
+    std::unique_lock<std::mutex> wheelLock(state_->wheelGuard_);
+    return timers_.size();
+}
+
+std::size_t TimerWheel::getThreadCount()
+{
+    std::unique_lock<std::mutex> wheelLock(state_->wheelGuard_);
+    return (timerThread_.joinable() ? 1 : 0) + dispatcherThreads_.size();
+}
+
+void TimerWheel::startThreads()
+{
+    state_->isRun_ = true;
+
+    timerThread_ = std::thread([this] { runTimer(); });
+
+    auto state = state_;
+    for (std::size_t i = 0; i < dispatcherCount_; ++i) {
+        dispatcherThreads_.push_back(std::thread([state] { runDispatcher(state); }));
+    }
+}
+
+void TimerWheel::stopThreads()
+{
+    std::unique_lock<std::mutex> wheelLock(state_->wheelGuard_);
+
+    if (!state_->isRun_) {
+        return;
+    }
+
+    state_->isRun_ = false;
+    onWheelChange_.notify_all();
+    state_->onExpiredCallback_.notify_all();
+
+    wheelLock.unlock();
+
+    timerThread_.join();
+    for (auto& dispatcher : dispatcherThreads_) {
+        if (dispatcher.get_id() == std::this_thread::get_id()) {
+            /*
+             * The wheel is destroyed from one of its callbacks, a thread can't join itself.
+             */
+            dispatcher.detach();
+        } else {
+            dispatcher.join();
+        }
+    }
+}
+
+void TimerWheel::runTimer()
+{
+    std::unique_lock<std::mutex> wheelLock(state_->wheelGuard_);
+
+    while (state_->isRun_) {
+        if (timers_.empty()) {
+            onWheelChange_.wait(wheelLock);
+            continue;
+        }
+
+        std::uint64_t now = getCurrentTick();
+        while (currentTick_ <= now) {
+            processTick();
+        }
+
+        if (!state_->expiredCallbacks_.empty()) {
+            state_->onExpiredCallback_.notify_all();
+        }
+
+        if (!timers_.empty()) {
+            onWheelChange_.wait_until(wheelLock,
+                                      startTime_ + std::chrono::milliseconds(getNextWakeupTick() * TICK_DURATION_MS));
+        }
+    }
+}
+
+void TimerWheel::runDispatcher(const std::shared_ptr<DispatcherState>& state)
+{
+    std::unique_lock<std::mutex> wheelLock(state->wheelGuard_);
+
+    while (state->isRun_) {
+        if (state->expiredCallbacks_.empty()) {
+            state->onExpiredCallback_.wait(wheelLock);
+            continue;
+        }
+
+        auto callback = std::move(state->expiredCallbacks_.front());
+        state->expiredCallbacks_.pop_front();
+
+        wheelLock.unlock();
+
+        try {
+            callback();
+        } catch (...) {}
+
+        wheelLock.lock();
+    }
+}
+
+std::uint64_t TimerWheel::getCurrentTick() const
+{
+    return toTick(std::chrono::steady_clock::now(), false);
+}
+
+std::uint64_t TimerWheel::toTick(std::chrono::steady_clock::time_point timePoint, bool isRoundUp) const
+{
+    const std::uint64_t tickDurationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                std::chrono::milliseconds(TICK_DURATION_MS)).count();
+
+    std::uint64_t elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(timePoint - startTime_).count();
+    return (elapsedNs + (isRoundUp ? tickDurationNs - 1 : 0)) / tickDurationNs;
+}
+
+void TimerWheel::place(TimerSlot& source, TimerSlot::iterator entry)
+{
+    std::uint64_t expiryTick = entry->expiryTick_ > currentTick_ ? entry->expiryTick_ : currentTick_;
+
+    if (expiryTick - currentTick_ > MAX_TICK_DELTA) {
+        /*
+         * The timer is out of the wheel range. It is parked in the farthest slot
+         * and placed again once that slot is cascaded.
+         */
+        expiryTick = currentTick_ + MAX_TICK_DELTA;
+    }
+
+    std::uint64_t delta = expiryTick - currentTick_;
+
+    std::size_t level = 0;
+    while (level + 1 < LEVEL_COUNT && (delta >> (SLOT_BITS * (level + 1)))) {
+        ++level;
+    }
+
+    std::size_t slot = (expiryTick >> (SLOT_BITS * level)) & SLOT_MASK;
+
+    auto& destination = wheel_[level][slot];
+    destination.splice(destination.end(), source, entry);
+
+    auto& location = timers_[entry->id_];
+    location.level_ = level;
+    location.slot_ = slot;
+    location.entry_ = entry;
+}
+
+void TimerWheel::cascade(std::size_t level)
+{
+    std::size_t slot = (currentTick_ >> (SLOT_BITS * level)) & SLOT_MASK;
+
+    TimerSlot entries;
+    entries.splice(entries.end(), wheel_[level][slot]);
+
+    while (!entries.empty()) {
+        place(entries, entries.begin());
+    }
+}
+
+void TimerWheel::processTick()
+{
+    std::size_t slot = currentTick_ & SLOT_MASK;
+
+    /*
+     * Each time the lower level turns around, timers of the next slot of the upper level are
+     * redistributed among lower levels.
+     */
+    for (std::size_t level = 1; level < LEVEL_COUNT; ++level) {
+        if ((currentTick_ >> (SLOT_BITS * (level - 1))) & SLOT_MASK) {
+            break;
+        }
+        cascade(level);
+    }
+
+    TimerSlot entries;
+    entries.splice(entries.end(), wheel_[0][slot]);
+
+    while (!entries.empty()) {
+        auto entry = entries.begin();
+        if (entry->expiryTick_ > currentTick_) {
+            place(entries, entry);
+        } else {
+            timers_.erase(entry->id_);
+            state_->expiredCallbacks_.push_back(std::move(entry->callback_));
+            entries.pop_front();
+        }
+    }
+
+    ++currentTick_;
+}
+
+std::uint64_t TimerWheel::getNextWakeupTick() const
+{
+    std::size_t slot = currentTick_ & SLOT_MASK;
+
+    for (std::size_t i = slot; i < SLOT_COUNT; ++i) {
+        if (!wheel_[0][i].empty()) {
+            return currentTick_ + (i - slot);
+        }
+    }
+
+    /*
+     * Wake up at the next turn of the lowest level to cascade upper levels.
+     */
+    return (currentTick_ | SLOT_MASK) + 1;
+}
+
+} /* namespace kaa */
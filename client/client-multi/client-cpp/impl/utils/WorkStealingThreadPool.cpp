@@ -0,0 +1,273 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "kaa/utils/WorkStealingThreadPool.hpp"
+
+#include "kaa/logging/Log.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+
+namespace kaa {
+
+const std::size_t WorkStealingThreadPool::DEFAULT_WORKER_NUMBER;
+const std::size_t WorkStealingThreadPool::DEFAULT_QUEUE_CAPACITY;
+
+/*
+ * The number of attempts to find a task before an idle worker goes to sleep.
+ */
+static const std::size_t IDLE_SPIN_COUNT = 64;
+
+/*
+ * The pool and the worker index of the current thread, if it is a worker.
+ */
+static kaa_thread_local WorkStealingThreadPool *currentThreadPool = nullptr;
+static kaa_thread_local std::size_t currentWorkerIndex = 0;
+
+class StealingWorker {
+public:
+    StealingWorker(WorkStealingThreadPool& threadPool, std::size_t workerIndex)
+        : threadPool_(threadPool), workerIndex_(workerIndex) {}
+    void operator() ();
+
+private:
+    WorkStealingThreadPool& threadPool_;
+    const std::size_t workerIndex_;
+};
+
+void StealingWorker::operator ()()
+{
+    currentThreadPool = &threadPool_;
+    currentWorkerIndex = workerIndex_;
+
+    ThreadPoolTask task;
+    std::size_t spinCount = 0;
+
+    while (threadPool_.isRun_) {
+        if (threadPool_.takeTask(workerIndex_, task)) {
+            --threadPool_.pendingTaskCount_;
+            spinCount = 0;
+
+            try {
+                task();
+            } catch (...) {}
+
+            task = nullptr;
+            continue;
+        }
+
+        if (spinCount++ < IDLE_SPIN_COUNT) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        spinCount = 0;
+
+        KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPool_.threadPoolGuard_);
+
+        /*
+         * The idle counter is incremented before the pending task counter is checked, while WorkStealingThreadPool::add()
+         * does that in reverse order. So either the worker sees a new task or the producer sees the idle worker.
+         */
+        ++threadPool_.idleWorkerCount_;
+
+        while (threadPool_.isRun_ && threadPool_.pendingTaskCount_ <= 0 && !threadPool_.isPendingShutdown_) {
+            KAA_CONDITION_WAIT(threadPool_.onNewTask_, tasksLock);
+        }
+
+        --threadPool_.idleWorkerCount_;
+
+        if (threadPool_.isPendingShutdown_ && threadPool_.pendingTaskCount_ <= 0) {
+            return;
+        }
+    }
+}
+
+WorkStealingThreadPool::WorkStealingThreadPool(std::size_t workerCount, std::size_t queueCapacity)
+    : workerCount_(workerCount), isStarted_(false), isRun_(true), isPendingShutdown_(false),
+      pendingTaskCount_(0), idleWorkerCount_(0), nextQueueIndex_(0), overflowTaskCount_(0)
+{
+    if (!workerCount_) {
+        throw KaaException(boost::format("Failed to create thread pool with %u workers ") % workerCount_);
+    }
+
+    if (!queueCapacity) {
+        throw KaaException("Failed to create thread pool with zero queue capacity");
+    }
+
+    for (std::size_t i = 0; i < workerCount_; ++i) {
+        queues_.emplace_back(new TaskQueue(queueCapacity));
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+    stop(!shutdownTimer_);
+}
+
+void WorkStealingThreadPool::add(const ThreadPoolTask& task)
+{
+    if (!task) {
+        throw KaaException("Failed to add task to thread pool: empty callback");
+    }
+
+    if (isPendingShutdown_) {
+        throw KaaException("Failed to add task to thread pool: pending shutdown");
+    }
+
+    if (!isStarted_) {
+        KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPoolGuard_);
+        if (!isStarted_) {
+            start();
+        }
+    }
+
+    bool isAdded = false;
+
+    /*
+     * Once a task has overflowed, the following ones go to the overflow list too, otherwise
+     * a pool with one worker might execute them out of order.
+     */
+    if (!overflowTaskCount_) {
+        if (currentThreadPool == this) {
+            isAdded = queues_[currentWorkerIndex]->push(task);
+        }
+
+        std::size_t queueIndex = nextQueueIndex_.fetch_add(1, std::memory_order_relaxed);
+        for (std::size_t i = 0; !isAdded && i < workerCount_; ++i) {
+            isAdded = queues_[(queueIndex + i) % workerCount_]->push(task);
+        }
+    }
+
+    if (!isAdded) {
+        KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPoolGuard_);
+        overflowTasks_.push_back(task);
+        ++overflowTaskCount_;
+    }
+
+    onTaskAdded();
+}
+
+void WorkStealingThreadPool::onTaskAdded()
+{
+    ++pendingTaskCount_;
+
+    if (idleWorkerCount_) {
+        KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPoolGuard_);
+        KAA_CONDITION_NOTIFY(onNewTask_);
+    }
+}
+
+bool WorkStealingThreadPool::takeTask(std::size_t workerIndex, ThreadPoolTask& task)
+{
+    if (queues_[workerIndex]->pop(task)) {
+        return true;
+    }
+
+    if (overflowTaskCount_) {
+        KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPoolGuard_);
+        if (!overflowTasks_.empty()) {
+            task = std::move(overflowTasks_.front());
+            overflowTasks_.pop_front();
+            --overflowTaskCount_;
+            return true;
+        }
+    }
+
+    for (std::size_t i = 1; i < workerCount_; ++i) {
+        if (queues_[(workerIndex + i) % workerCount_]->pop(task)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void WorkStealingThreadPool::awaitTermination(std::size_t seconds)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPoolGuard_);
+
+    if (isRun_) {
+        shutdownTimer_.reset(new KaaTimer<void()>("Thread pool shutdown timer"));
+        /*
+         * Runs on a timer thread, so it must not wait for the workers. They are joined on destruction.
+         */
+        shutdownTimer_->start(seconds, [this] () { interrupt(); } );
+    }
+}
+
+void WorkStealingThreadPool::shutdown()
+{
+    stop(false);
+}
+
+void WorkStealingThreadPool::shutdownNow()
+{
+    stop(true);
+}
+
+void WorkStealingThreadPool::start()
+{
+    for (std::size_t i = 0; i < workerCount_; ++i) {
+        workers_.push_back(std::thread(StealingWorker(*this, i)));
+    }
+
+    isStarted_ = true;
+}
+
+void WorkStealingThreadPool::interrupt()
+{
+    KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPoolGuard_);
+
+    isRun_ = false;
+
+    KAA_CONDITION_NOTIFY_ALL(onNewTask_);
+}
+
+void WorkStealingThreadPool::stop(bool force)
+{
+    KAA_MUTEX_UNIQUE_DECLARE(tasksLock, threadPoolGuard_);
+
+    if (!workers_.empty()) {
+        if (force) {
+            isRun_ = false;
+        } else {
+            isPendingShutdown_ = true;
+        }
+
+        KAA_CONDITION_NOTIFY_ALL(onNewTask_);
+
+        KAA_UNLOCK(tasksLock);
+
+        for (auto &worker : workers_) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+
+        if (force) {
+            ThreadPoolTask task;
+            for (auto& queue : queues_) {
+                while (queue->pop(task)) {}
+            }
+
+            KAA_LOCK(tasksLock);
+            overflowTasks_.clear();
+            overflowTaskCount_ = 0;
+        }
+    }
+}
+
+} /* namespace kaa */
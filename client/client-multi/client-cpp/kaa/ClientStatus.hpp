@@ -19,11 +19,13 @@
 
 #include <string>
 #include <map>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <boost/bimap.hpp>
 
 #include "kaa/KaaThread.hpp"
+#include "kaa/utils/KaaTimer.hpp"
 #include "kaa/gen/EndpointGen.hpp"
 #include "kaa/common/EndpointObjectHash.hpp"
 #include "kaa/IKaaClientStateStorage.hpp"
@@ -41,10 +43,22 @@ typedef boost::bimaps::bimap<
         , boost::bimaps::left_based
 > bimap;
 
+/**
+ * @brief Client state persisted to the state file.
+ *
+ * The state is stored in a compact binary format, only parameters changed since the last save are
+ * re-encoded. The file is written and synced to a temporary one which then replaces the state file,
+ * so a crash never leaves a partially written state. Text state files written by previous SDK versions are
+ * read as well and are replaced by the binary ones on the next save.
+ *
+ * If @c KaaClientProperties::getStateSavePeriod() is not zero, the file is written at most once per
+ * that period. A postponed write is completed on destruction, @c flush() also writes changes made
+ * since the last @c save().
+ */
 class ClientStatus : public IKaaClientStateStorage {
 public:
     ClientStatus(IKaaClientContext& context);
-    ~ClientStatus() { }
+    ~ClientStatus();
 
     std::int32_t getEventSequenceNumber() const;
     void setEventSequenceNumber(std::int32_t sequenceNumber);
@@ -84,9 +98,15 @@ public:
 
     void read();
     void save();
+    void flush();
 
 private:
     void checkSDKPropertiesForUpdates();
+
+    void readText(std::istream& stateFile);
+    bool readBinary(const std::string& image);
+    std::string encodeState();
+    void writeStateFile();
     /* Helpers */
     template< ClientParameterT Type, class ParameterData >
     void setParameterData(const ParameterData& data);
@@ -107,6 +127,12 @@ private:
 
     IKaaClientContext &context_;
 
+    const std::chrono::milliseconds          savePeriod_;
+    std::chrono::steady_clock::time_point    lastSaveTime_;
+    std::string                              pendingState_;
+    bool                                     hasPendingState_;
+    KAA_MUTEX_DECLARE(saveGuard_);
+
 
     static const bimap                      parameterToToken_;
     static const std::int32_t               eventSeqNumberDefault_;
@@ -118,6 +144,11 @@ private:
     static const bool                       endpointDefaultAttachStatus_;
     static const std::string                endpointKeyHashDefault_;
     static const bool                       isProfileResyncNeededDefault_;
+
+    /*
+     * Destroyed first, so the flush callback can't outlive the state it writes.
+     */
+    KaaTimer<void ()>                       saveTimer_;
 };
 
 }
@@ -18,6 +18,7 @@
 #define IKAACLIENT_HPP_
 
 #include <future>
+#include <vector>
 
 #include "kaa/profile/IProfileContainer.hpp"
 #include "kaa/notification/INotificationTopicListListener.hpp"
@@ -87,6 +88,9 @@ public:
 
     /**
      * @brief Notifies server about profile changes.
+     *
+     * The serialized profile is cached, so changes made inside the profile container are sent
+     * to the server only after this call.
      */
     virtual void updateProfile() = 0;
 
@@ -370,6 +374,30 @@ public:
      */
     virtual RecordFuture addLogRecord(const KaaUserLogRecord& record) = 0;
 
+    /**
+     * @brief Adds a batch of log records to the log storage.
+     *
+     * The whole batch is encoded and persisted in a single task.
+     *
+     * The default implementation calls @link addLogRecord() @endlink for each record.
+     *
+     * @param[in] records    The log records to be added.
+     *
+     * @return The futures of each record, in the order of @c records.
+     *
+     * @see KaaUserLogRecord
+     * @see ILogStorage
+     */
+    virtual std::vector<RecordFuture> addLogRecords(const std::vector<KaaUserLogRecord>& records)
+    {
+        std::vector<RecordFuture> futures;
+        futures.reserve(records.size());
+        for (const auto& record : records) {
+            futures.push_back(addLogRecord(record));
+        }
+        return futures;
+    }
+
     /**
      * @brief Set a listener which receives a delivery status of each log bucket.
      *
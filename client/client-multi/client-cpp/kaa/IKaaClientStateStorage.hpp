@@ -74,6 +74,11 @@ public:
 
     virtual void read() = 0;
     virtual void save() = 0;
+
+    /**
+     * @brief Writes the state to the storage immediately, even if the storage postpones writes made by @c save().
+     */
+    virtual void flush() = 0;
 };
 
 typedef std::shared_ptr<IKaaClientStateStorage> IKaaClientStateStoragePtr;
@@ -65,6 +65,7 @@ public:
     virtual EventFamilyFactory&                 getEventFamilyFactory();
 
     virtual RecordFuture                        addLogRecord(const KaaUserLogRecord& record);
+    virtual std::vector<RecordFuture>           addLogRecords(const std::vector<KaaUserLogRecord>& records);
     virtual void                                setLogDeliveryListener(ILogDeliveryListenerPtr listener);
     virtual void                                setLogStorage(ILogStoragePtr storage);
     virtual void                                setLogUploadStrategy(ILogUploadStrategyPtr strategy);
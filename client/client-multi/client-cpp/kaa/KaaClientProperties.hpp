@@ -116,6 +116,44 @@ public:
         return getWorkingDirectoryPath() + getProperty(PROP_STATE_FILE, DEFAULT_STATE_FILE);
     }
 
+    /**
+     * @brief Sets the minimal period between writes of the state file.
+     *
+     * @param[in] period The period in milliseconds. If zero - the state file is written
+     * each time the state is saved. Otherwise - writes made within the period are coalesced
+     * into a single one.
+     */
+    void setStateSavePeriod(std::size_t period);
+
+    /**
+     * @brief Returns the minimal period between writes of the state file.
+     *
+     * @return The period in milliseconds.
+     */
+    std::size_t getStateSavePeriod() const
+    {
+        return std::stoul(getProperty(PROP_STATE_SAVE_PERIOD, DEFAULT_STATE_SAVE_PERIOD));
+    }
+
+    /**
+     * @brief Sets the sync coalescing window.
+     *
+     * @param[in] window The window in milliseconds. If zero - each sync is sent to the server
+     * immediately. Otherwise - syncs requested for the same channel within the window are merged
+     * into a single request.
+     */
+    void setSyncCoalescingWindow(std::size_t window);
+
+    /**
+     * @brief Returns the sync coalescing window.
+     *
+     * @return The window in milliseconds.
+     */
+    std::size_t getSyncCoalescingWindow() const
+    {
+        return std::stoul(getProperty(PROP_SYNC_COALESCING_WINDOW, DEFAULT_SYNC_COALESCING_WINDOW));
+    }
+
     /**
      * @brief Sets public key file name.
      *
@@ -207,6 +245,8 @@ public:
 public:
     static const std::string PROP_WORKING_DIR;
     static const std::string PROP_STATE_FILE;
+    static const std::string PROP_STATE_SAVE_PERIOD;
+    static const std::string PROP_SYNC_COALESCING_WINDOW;
     static const std::string PROP_PUB_KEY_FILE;
     static const std::string PROP_PRIV_KEY_FILE;
     static const std::string PROP_LOGS_DB;
@@ -216,6 +256,8 @@ public:
 
     static const std::string DEFAULT_WORKING_DIR;
     static const std::string DEFAULT_STATE_FILE;
+    static const std::string DEFAULT_STATE_SAVE_PERIOD;
+    static const std::string DEFAULT_SYNC_COALESCING_WINDOW;
     static const std::string DEFAULT_PUB_KEY_FILE;
     static const std::string DEFAULT_PRIV_KEY_FILE;
     static const std::string DEFAULT_LOGS_DB;
@@ -46,6 +46,7 @@ private:
 
     OperationsServers getOPSByAccessPointId(std::int32_t id);
     void              notifyChannelManangerAboutServer(const OperationsServers& servers);
+    void              retryOperationsServerList();
 
 private:
     std::map<TransportProtocolId, OperationsServers > operationServers_;
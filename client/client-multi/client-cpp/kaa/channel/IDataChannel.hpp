@@ -19,6 +19,7 @@
 
 #include <vector>
 #include <map>
+#include <set>
 
 #include "kaa/failover/IFailoverStrategy.hpp"
 #include "kaa/channel/ServerType.hpp"
@@ -51,6 +52,21 @@ public:
      */
     virtual void sync(TransportType type) = 0;
 
+    /**
+     * Updates the channel's state of several services with a single request.
+     * By default each service is synced separately.
+     *
+     * @param types transport types of the services.
+     * @see TransportType
+     *
+     */
+    virtual void sync(const std::set<TransportType>& types)
+    {
+        for (auto type : types) {
+            sync(type);
+        }
+    }
+
     /**
      * Updates the channel's state of all supported services.
      */
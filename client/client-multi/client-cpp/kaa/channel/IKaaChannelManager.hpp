@@ -105,6 +105,18 @@ public:
      */
     virtual IDataChannelPtr getChannel(const std::string& channelId) = 0;
 
+    /**
+     * Syncs the specific transport type using the channel mapped to it.
+     * The manager may merge syncs requested within a short period into a single request.
+     *
+     * @param type the transport's type.
+     * @throw KaaException no channel is mapped to the transport type.
+     *
+     * @see TransportType
+     *
+     */
+    virtual void sync(TransportType type) = 0;
+
     /**
      * Reports to Channel Manager in case link with server was not established.
      *
@@ -20,6 +20,8 @@
 #include <cstdint>
 #include <vector>
 
+#include "kaa/common/ByteArrayView.hpp"
+
 namespace kaa {
 
 enum class DemultiplexerReturnCode {
@@ -41,10 +43,13 @@ public:
     /**
      * Processes the given response bytes.
      *
+     * The response is passed as a view, so a channel may hand over its receive buffer without copying it.
+     * The viewed data is valid only until the call returns.
+     *
      * @param response buffer which to be processed.
      *
      */
-    virtual DemultiplexerReturnCode processResponse(const std::vector<std::uint8_t> &response) = 0;
+    virtual DemultiplexerReturnCode processResponse(const ByteArrayView& response) = 0;
 
     virtual ~IKaaDataDemultiplexer() {}
 };
@@ -20,6 +20,7 @@
 #include <map>
 #include <set>
 #include <list>
+#include <chrono>
 
 #include "kaa/KaaThread.hpp"
 #include "kaa/KaaDefaults.hpp"
@@ -33,6 +34,12 @@ namespace kaa {
 
 class IBootstrapManager;
 
+/**
+ * Syncs of the same channel requested within the coalescing window
+ * (see @c KaaClientProperties::getSyncCoalescingWindow()) are sent as a single request covering
+ * all requested transport types. Latency-critical types bypass the window and take the types
+ * waiting for the same channel with them.
+ */
 class KaaChannelManager: public IKaaChannelManager, public IPingServerStorage
 {
 public:
@@ -50,6 +57,14 @@ public:
     virtual IDataChannelPtr getChannelByTransportType(TransportType type);
     virtual IDataChannelPtr getChannel(const std::string& channelId);
 
+    virtual void sync(TransportType type);
+
+    /**
+     * Sets transport types which are synced immediately regardless of the coalescing window.
+     * @c TransportType::BOOTSTRAP is latency-critical by default.
+     */
+    void setLatencyCriticalTypes(const std::set<TransportType>& types);
+
     virtual void onServerFailed(ITransportConnectionInfoPtr connectionInfo);
     virtual void onTransportConnectionInfoUpdated(ITransportConnectionInfoPtr connectionInfo);
 
@@ -73,6 +88,8 @@ private:
 
     void doShutdown();
 
+    void syncPendingTypes();
+
     ITransportConnectionInfoPtr getCurrentBootstrapServer(const TransportProtocolId& protocolId);
     ITransportConnectionInfoPtr getNextBootstrapServer(const TransportProtocolId& protocolId, bool forceFirstElement);
 
@@ -100,6 +117,14 @@ private:
 
     ConnectivityCheckerPtr connectivityChecker_;
 
+    const std::chrono::milliseconds    syncWindow_;
+
+    KAA_MUTEX_DECLARE(pendingSyncGuard_);
+    std::set<TransportType>    latencyCriticalTypes_;
+    std::set<TransportType>    pendingSyncTypes_;
+
+    KaaTimer<void ()>    syncTimer_;
+
     TransportProtocolId bsTransportId_;
 
     IKaaClientContext &context_;
@@ -59,9 +59,8 @@ public:
                     , IKaaClientContext&);
 
     virtual std::vector<std::uint8_t> compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes);
-    virtual DemultiplexerReturnCode processResponse(const std::vector<std::uint8_t> &response);
+    virtual DemultiplexerReturnCode processResponse(const ByteArrayView& response);
 private:
-    AvroByteArrayConverter<SyncRequest>     requestConverter_;
     AvroByteArrayConverter<SyncResponse>    responseConverter_;
 
     IMetaDataTransportPtr       metaDataTransport_;
@@ -51,6 +51,7 @@ public:
     virtual ~AbstractHttpChannel() { }
 
     virtual void sync(TransportType type);
+    virtual void sync(const std::set<TransportType>& types);
     virtual void syncAll();
     virtual void syncAck(TransportType type);
     virtual void setMultiplexer(IKaaDataMultiplexer *multiplexer);
@@ -32,6 +32,9 @@
 #include "kaa/security/RsaEncoderDecoder.hpp"
 #include "kaa/channel/IKaaChannelManager.hpp"
 #include "kaa/kaatcp/KaaTcpResponseProcessor.hpp"
+#ifdef KAA_USE_TCP_COMPRESSION
+#include "kaa/kaatcp/KaaSyncCompressor.hpp"
+#endif
 #include "kaa/channel/IPTransportInfo.hpp"
 #include "kaa/channel/ITransportConnectionInfo.hpp"
 #include "kaa/channel/TransportProtocolIdConstants.hpp"
@@ -51,6 +54,7 @@ public:
     virtual ~DefaultOperationTcpChannel();
 
     virtual void sync(TransportType type);
+    virtual void sync(const std::set<TransportType>& types);
     virtual void syncAll();
     virtual void syncAck(TransportType type);
 
@@ -92,6 +96,13 @@ public:
     void onPingTimeout(const boost::system::error_code& err);
     void onConnAckTimeout(const boost::system::error_code& err);
 
+    void onResolve(const boost::system::error_code& err, boost::asio::ip::tcp::resolver::iterator endpoints,
+                   std::size_t connectionId);
+    void onConnect(const boost::system::error_code& err, boost::asio::ip::tcp::resolver::iterator endpoint,
+                   std::size_t connectionId);
+    void onConnectSent(const boost::system::error_code& err, std::size_t connectionId);
+    void onConnectTimeout(const boost::system::error_code& err, std::size_t connectionId);
+
     void onConnack(const ConnackMessage& message);
     void onDisconnect(const DisconnectMessage& message);
     void onKaaSync(const KaaSyncResponse& message);
@@ -106,9 +117,10 @@ private:
     static const std::uint16_t CHANNEL_TIMEOUT;
     static const std::uint16_t CONN_ACK_TIMEOUT;
     static const std::uint16_t RECONNECT_TIMEOUT;
+    static const std::uint16_t CONNECT_TIMEOUT;
 
     boost::system::error_code sendKaaSync(const std::map<TransportType, ChannelDirection>& transportTypes);
-    boost::system::error_code sendConnect();
+    void sendConnect(std::size_t connectionId);
     boost::system::error_code sendDisconnect();
     boost::system::error_code sendPingRequest();
     boost::system::error_code sendData(const IKaaTcpRequest& request);
@@ -117,6 +129,10 @@ private:
     void setTimer();
     void setConnAckTimer();
 
+    void resolveServer(std::size_t connectionId);
+    bool isConnectionPending(std::size_t connectionId);
+    void onConnectionFailed(std::size_t connectionId, const std::string& reason);
+
     void createThreads();
 
     void doShutdown();
@@ -139,27 +155,37 @@ private:
     std::unique_ptr<boost::asio::ip::tcp::socket> sock_;
     boost::asio::deadline_timer pingTimer_;
     boost::asio::deadline_timer connAckTimer_;
+    boost::asio::deadline_timer connectTimer_;
+    boost::asio::ip::tcp::resolver resolver_;
     //boost::asio::deadline_timer reconnectTimer_;
     KaaTimer<void ()> retryTimer_;
 
     std::unique_ptr<boost::asio::streambuf> responseBuffer_;
+    std::vector<std::uint8_t> connectRequest_;
     std::array<std::thread, TIMER_THREADPOOL_SIZE> timerThreads_;
     std::array<std::thread, SOCKET_THREADPOOL_SIZE> channelThreads_;
 
     bool firstStart_;
     bool isConnected_;
+    bool isConnecting_;
+    std::size_t connectionId_;
     bool isFirstResponseReceived_;
     bool isPendingSyncRequest_;
     bool isShutdown_;
     bool isPaused_;
     bool isFailoverInProgress_;
+    bool isCompressionEnabled_;
 
     IKaaDataMultiplexer *multiplexer_;
     IKaaDataDemultiplexer *demultiplexer_;
     IKaaChannelManager *channelManager_;
     std::shared_ptr<IPTransportInfo> currentServer_;
     KaaTcpResponseProcessor responsePorcessor;
-    std::unique_ptr<RsaEncoderDecoder> encDec_;
+    std::shared_ptr<RsaEncoderDecoder> encDec_;
+    CipherBuffer encodeBuffer_;
+#ifdef KAA_USE_TCP_COMPRESSION
+    KaaSyncCompressor compressor_;
+#endif
 
     KAA_MUTEX_DECLARE(channelGuard_);
 
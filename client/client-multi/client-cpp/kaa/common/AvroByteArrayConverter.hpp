@@ -19,7 +19,9 @@
 
 #include <string>
 #include <memory>
-#include <sstream>
+#include <vector>
+#include <ostream>
+#include <cstring>
 #include <cstdint>
 
 #include <avro/Compiler.hh>
@@ -28,7 +30,9 @@
 #include <avro/Encoder.hh>
 #include <avro/Decoder.hh>
 
+#include "kaa/KaaThread.hpp"
 #include "kaa/common/EndpointObjectHash.hpp"
+#include "kaa/common/AvroByteArrayOutputStream.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
@@ -47,6 +51,16 @@ public:
      */
     AvroByteArrayConverter();
 
+    /**
+     * Returns the binary converter owned by the calling thread.
+     * Lets the encoder and its buffer be reused without any synchronization.
+     * Don't switch it to JSON.
+     */
+    static AvroByteArrayConverter& getThreadLocalConverter()
+    {
+        static kaa_thread_local AvroByteArrayConverter converter;
+        return converter;
+    }
 
     /*
      * Copy operator
@@ -80,12 +94,31 @@ public:
 
     /**
      * Converts object to byte array
+     * The buffer keeps its capacity, which may exceed the size of encoded data
      * @param datum the encoding avro object
      * @param dest the buffer that encoded data will be put in
      * @return serialized bytes
      */
     void toByteArray(const T& datum, std::vector<std::uint8_t>& dest);
 
+    /**
+     * Converts object to byte array in the caller-provided buffer
+     * Throws \ref KaaException when the buffer is too small
+     * @param datum the encoding avro object
+     * @param dest the buffer that encoded data will be put in
+     * @param destSize size of the buffer
+     * @return size of encoded data
+     */
+    std::size_t toByteArray(const T& datum, std::uint8_t* dest, std::size_t destSize);
+
+    /**
+     * Converts object to byte array in the converter's own buffer
+     * The buffer is reused by the next conversion, so the result is valid until then
+     * @param datum the encoding avro object
+     * @return serialized bytes
+     */
+    const std::vector<std::uint8_t>& toPooledByteArray(const T& datum);
+
     /**
      * Converts object to stream
      * @param datum the encoding avro object
@@ -109,6 +142,8 @@ public:
 private:
     avro::EncoderPtr   encoder_;
     avro::DecoderPtr   decoder_;
+
+    std::vector<std::uint8_t>    buffer_;
 };
 
 template<typename T>
@@ -149,24 +184,12 @@ void AvroByteArrayConverter<T>::fromByteArray(const std::uint8_t* data, const st
 template<typename T>
 SharedDataBuffer AvroByteArrayConverter<T>::toByteArray(const T& datum)
 {
-    std::stringstream ostream;
-    std::unique_ptr<avro::OutputStream> out = avro::ostreamOutputStream(ostream);
-
-    encoder_->init(*out);
-    avro::encode(*encoder_, datum);
-    encoder_->flush();
+    toPooledByteArray(datum);
 
     SharedDataBuffer buffer;
-
-    std::streampos beg = ostream.tellg();
-    ostream.seekg(0, std::ios_base::end);
-
-    std::streampos end = ostream.tellg();
-    ostream.seekg(0, std::ios_base::beg);
-
-    buffer.second = end - beg;
+    buffer.second = buffer_.size();
     buffer.first.reset(new uint8_t[buffer.second]);
-    std::copy(std::istreambuf_iterator<char>(ostream), std::istreambuf_iterator<char>(), buffer.first.get());
+    std::memcpy(buffer.first.get(), buffer_.data(), buffer.second);
 
     return buffer;
 }
@@ -174,21 +197,34 @@ SharedDataBuffer AvroByteArrayConverter<T>::toByteArray(const T& datum)
 template<typename T>
 void AvroByteArrayConverter<T>::toByteArray(const T& datum, std::vector<std::uint8_t>& dest)
 {
-    std::stringstream ostream;
-    std::unique_ptr<avro::OutputStream> out = avro::ostreamOutputStream(ostream);
+    AvroByteArrayOutputStream out(dest);
 
-    encoder_->init(*out);
+    encoder_->init(out);
     avro::encode(*encoder_, datum);
     encoder_->flush();
+}
 
-    std::streampos beg = ostream.tellg();
-    ostream.seekg(0, std::ios_base::end);
+template<typename T>
+std::size_t AvroByteArrayConverter<T>::toByteArray(const T& datum, std::uint8_t* dest, std::size_t destSize)
+{
+    AvroFixedBufferOutputStream out(dest, destSize);
+
+    try {
+        encoder_->init(out);
+        avro::encode(*encoder_, datum);
+        encoder_->flush();
+    } catch (const avro::Exception& e) {
+        throw KaaException(boost::format("Failed to encode data into %1% bytes buffer: %2%") % destSize % e.what());
+    }
 
-    std::streampos end = ostream.tellg();
-    ostream.seekg(0, std::ios_base::beg);
+    return out.byteCount();
+}
 
-    dest.reserve(end - beg);
-    dest.assign(std::istreambuf_iterator<char>(ostream), std::istreambuf_iterator<char>());
+template<typename T>
+const std::vector<std::uint8_t>& AvroByteArrayConverter<T>::toPooledByteArray(const T& datum)
+{
+    toByteArray(datum, buffer_);
+    return buffer_;
 }
 
 template<typename T>
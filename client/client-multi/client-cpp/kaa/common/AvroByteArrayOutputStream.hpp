@@ -0,0 +1,136 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef AVROBYTEARRAYOUTPUTSTREAM_HPP_
+#define AVROBYTEARRAYOUTPUTSTREAM_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+#include <avro/Stream.hh>
+
+namespace kaa {
+
+/**
+ * The avro output stream which writes encoded data directly into a byte vector.
+ *
+ * The vector grows on demand, its capacity is never shrunk. So encoding into the same
+ * vector again doesn't allocate memory once the vector is big enough.
+ * The size of the vector grows from zero by doubling within its capacity, so only bytes
+ * about to be written to are initialized, not the whole capacity left from earlier encodings.
+ * The vector is resized to the size of encoded data on @c flush().
+ */
+class AvroByteArrayOutputStream : public avro::OutputStream {
+public:
+    static const std::size_t DEFAULT_CHUNK_SIZE = 256;
+
+    /**
+     * Clears the vector and starts writing into it.
+     * @param buffer the vector encoded data will be put in
+     * @param chunkSize the minimal number of bytes the vector grows by
+     */
+    AvroByteArrayOutputStream(std::vector<std::uint8_t>& buffer, std::size_t chunkSize = DEFAULT_CHUNK_SIZE)
+        : buffer_(buffer), chunkSize_(chunkSize > 0 ? chunkSize : 1)
+    {
+        buffer_.clear();
+    }
+
+    virtual bool next(std::uint8_t** data, std::size_t* len)
+    {
+        if (byteCount_ == buffer_.size()) {
+            buffer_.resize(byteCount_ + std::max(byteCount_, chunkSize_));
+        }
+
+        *data = buffer_.data() + byteCount_;
+        *len = buffer_.size() - byteCount_;
+
+        byteCount_ = buffer_.size();
+
+        return true;
+    }
+
+    virtual void backup(std::size_t len)
+    {
+        byteCount_ -= std::min<std::size_t>(len, byteCount_);
+    }
+
+    virtual std::uint64_t byteCount() const
+    {
+        return byteCount_;
+    }
+
+    virtual void flush()
+    {
+        buffer_.resize(byteCount_);
+    }
+
+private:
+    std::vector<std::uint8_t>&    buffer_;
+    const std::size_t             chunkSize_;
+    std::size_t                   byteCount_ = 0;
+};
+
+/**
+ * The avro output stream which writes encoded data into a caller-provided memory region.
+ *
+ * The region is never reallocated. If encoded data doesn't fit, @c next() reports the end
+ * of the stream and the encoder throws @c avro::Exception.
+ */
+class AvroFixedBufferOutputStream : public avro::OutputStream {
+public:
+    /**
+     * @param buffer the memory region encoded data will be put in
+     * @param size the size of the region
+     */
+    AvroFixedBufferOutputStream(std::uint8_t* buffer, std::size_t size)
+        : buffer_(buffer), size_(buffer ? size : 0) {}
+
+    virtual bool next(std::uint8_t** data, std::size_t* len)
+    {
+        if (byteCount_ == size_) {
+            return false;
+        }
+
+        *data = buffer_ + byteCount_;
+        *len = size_ - byteCount_;
+
+        byteCount_ = size_;
+
+        return true;
+    }
+
+    virtual void backup(std::size_t len)
+    {
+        byteCount_ -= std::min<std::size_t>(len, byteCount_);
+    }
+
+    virtual std::uint64_t byteCount() const
+    {
+        return byteCount_;
+    }
+
+    virtual void flush() {}
+
+private:
+    std::uint8_t*        buffer_;
+    const std::size_t    size_;
+    std::size_t          byteCount_ = 0;
+};
+
+}  // namespace kaa
+
+#endif /* AVROBYTEARRAYOUTPUTSTREAM_HPP_ */
@@ -0,0 +1,68 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BYTEARRAYVIEW_HPP_
+#define BYTEARRAYVIEW_HPP_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace kaa {
+
+/**
+ * @brief Non-owning read-only view of a contiguous byte sequence.
+ *
+ * Lets received data be passed along without copying it. The viewed memory must outlive the view.
+ */
+class ByteArrayView {
+public:
+    typedef const std::uint8_t* const_iterator;
+
+    ByteArrayView()
+        : data_(nullptr), size_(0) {}
+
+    ByteArrayView(const std::uint8_t *data, std::size_t size)
+        : data_(data), size_(size) {}
+
+    ByteArrayView(const char *data, std::size_t size)
+        : data_(reinterpret_cast<const std::uint8_t *>(data)), size_(size) {}
+
+    template<class Allocator>
+    ByteArrayView(const std::vector<std::uint8_t, Allocator>& data)
+        : data_(data.data()), size_(data.size()) {}
+
+    ByteArrayView(const std::string& data)
+        : data_(reinterpret_cast<const std::uint8_t *>(data.data())), size_(data.size()) {}
+
+    const std::uint8_t *data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return !size_; }
+
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+    std::uint8_t operator[](std::size_t index) const { return data_[index]; }
+
+private:
+    const std::uint8_t *data_;
+    std::size_t         size_;
+};
+
+} /* namespace kaa */
+
+#endif /* BYTEARRAYVIEW_HPP_ */
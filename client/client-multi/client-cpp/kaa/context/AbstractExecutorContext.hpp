@@ -21,14 +21,23 @@
 
 #include "kaa/KaaThread.hpp"
 #include "kaa/utils/ThreadPool.hpp"
+#include "kaa/utils/WorkStealingThreadPool.hpp"
 #include "kaa/context/IExecutorContext.hpp"
 
 namespace kaa {
 
+/**
+ * @brief The type of thread pools an executor context creates.
+ */
+enum class ExecutorType {
+    THREAD_POOL,                /**< @c ThreadPool, one task queue shared by all workers. */
+    WORK_STEALING_THREAD_POOL   /**< @c WorkStealingThreadPool, a lock-free task queue per worker. */
+};
+
 class AbstractExecutorContext : public IExecutorContext {
 public:
     AbstractExecutorContext()
-        : useCount_(0), awaitTerminationTimeout_(5)
+        : useCount_(0), awaitTerminationTimeout_(5), executorType_(ExecutorType::THREAD_POOL)
     {}
 
     virtual void init();
@@ -44,9 +53,25 @@ public:
         return awaitTerminationTimeout_;
     }
 
+    /**
+     * @brief Sets the type of thread pools to be created. Takes effect on the next @link init() @endlink.
+     */
+    void setExecutorType(ExecutorType executorType)
+    {
+        executorType_ = executorType;
+    }
+
+    ExecutorType getExecutorType()
+    {
+        return executorType_;
+    }
+
 protected:
     IThreadPoolPtr createExecutor(std::size_t threadCount)
     {
+        if (executorType_ == ExecutorType::WORK_STEALING_THREAD_POOL) {
+            return std::make_shared<WorkStealingThreadPool>(threadCount);
+        }
         return std::make_shared<ThreadPool>(threadCount);
     }
 
@@ -66,6 +91,8 @@ private:
     KAA_MUTEX_DECLARE(useCountGuard_);
 
     std::size_t awaitTerminationTimeout_; // in seconds
+
+    ExecutorType executorType_;
 };
 
 } /* namespace kaa */
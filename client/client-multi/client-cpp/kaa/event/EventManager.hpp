@@ -20,6 +20,8 @@
 
 #include <set>
 #include <list>
+#include <vector>
+#include <unordered_map>
 
 #include <cstdint>
 #include <memory>
@@ -87,9 +89,9 @@ private:
         IFetchEventListenersPtr listener_;
     };
 
-    void onEventFromServer(const std::string& eventClassFQN
-                         , const std::vector<std::uint8_t>& data
-                         , const std::string& source);
+    void onEventFromServer(const Event& event);
+
+    void rebuildEventFamilyIndex();
 
     void generateUniqueRequestId(std::string& requstId);
 
@@ -99,6 +101,12 @@ private:
     IKaaClientContext &context_;
 
     std::set<IEventFamily*>   eventFamilies_;
+
+    /*
+     * Event families supporting each incoming event FQN, rebuilt whenever a family is registered.
+     */
+    std::unordered_map<std::string, std::vector<IEventFamily*> > eventFamilyIndex_;
+
     std::map<std::int32_t, Event>          pendingEvents_;
     KAA_MUTEX_MUTABLE_DECLARE(pendingEventsGuard_);
 
@@ -22,31 +22,73 @@
 #include "kaa/http/IHttpClient.hpp"
 #include <boost/asio.hpp>
 
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+
 #include "kaa/KaaThread.hpp"
 
 #include "kaa/IKaaClientContext.hpp"
 
 namespace kaa {
 
+/**
+ * Sends HTTP requests over persistent (keep-alive) connections.
+ *
+ * After a response is read, its connection is kept in the pool by the server host and port
+ * and reused by the next request to the same server. Pooled connections idle longer than
+ * the idle timeout are closed. If the server has closed a pooled connection, the request
+ * is transparently resent over a new one.
+ */
 class HttpClient : public IHttpClient
 {
 public:
-    HttpClient(IKaaClientContext &context) : io_(), sock_(io_), context_(context) { }
+    static const std::uint32_t DEFAULT_IDLE_TIMEOUT_MS = 30000;
+
+    HttpClient(IKaaClientContext &context, std::chrono::milliseconds idleTimeout = std::chrono::milliseconds(DEFAULT_IDLE_TIMEOUT_MS))
+        : io_(), idleTimeout_(idleTimeout), isAborted_(false), context_(context) { }
     ~HttpClient() { }
 
     virtual std::shared_ptr<IHttpResponse> sendRequest(const IHttpRequest& request);
+
+    /**
+     * Aborts the request in progress, if any, and closes the pooled connections.
+     * May be called from a thread other than the one sending the request.
+     */
     virtual void closeConnection();
 
 private:
-    void checkError(const boost::system::error_code& code);
-    void doSocketClose();
+    typedef boost::asio::ip::tcp::socket    Socket;
+    typedef std::shared_ptr<Socket>         SocketPtr;
+
+    struct IdleConnection {
+        SocketPtr                                 socket_;
+        std::chrono::steady_clock::time_point     lastUsed_;
+    };
+
+    SocketPtr takeIdleConnection(const std::string& server);
+    SocketPtr openConnection(const IHttpRequest& request);
+    void releaseConnection(const std::string& server, SocketPtr socket, bool isReusable);
+
+    void checkError(const boost::system::error_code& code, Socket& socket);
+    void doSocketClose(Socket& socket);
 
 private:
     boost::asio::io_service io_;
-    boost::asio::ip::tcp::socket sock_;
+    const std::chrono::milliseconds idleTimeout_;
 
     KAA_MUTEX_DECLARE(httpClientGuard_);
 
+    /*
+     * Guards the connections below, is held only for a short time, so closeConnection()
+     * doesn't wait for the request in progress.
+     */
+    KAA_MUTEX_DECLARE(connectionsGuard_);
+    SocketPtr activeConnection_;
+    bool isAborted_;
+    std::map<std::string, IdleConnection> idleConnections_;
+
     IKaaClientContext &context_;
 };
 
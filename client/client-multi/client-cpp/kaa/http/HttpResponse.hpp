@@ -29,6 +29,12 @@ class HttpResponse : public IHttpResponse {
 public:
     HttpResponse(const char *data, std::size_t len);
     HttpResponse(const std::string& data);
+
+    /**
+     * Creates the response from the already separated header (the status line and the fields,
+     * up to and including the empty line) and body.
+     */
+    HttpResponse(const std::string& header, const SharedBody& body);
     ~HttpResponse() { }
 
     virtual std::string getHeaderField(const std::string& name) const;
@@ -39,6 +45,7 @@ private:
     static const std::uint8_t  HTTP_VERSION_OFFSET = 9;
 
     void parseResponse(const char *data, size_t len);
+    const char *parseHeader(const char *data);
 
 private:
     SharedBody body_;
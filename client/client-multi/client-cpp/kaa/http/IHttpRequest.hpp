@@ -20,8 +20,11 @@
 #include "kaa/KaaDefaults.hpp"
 
 #include <string>
+#include <vector>
 #include <cstdint>
 
+#include <boost/asio/buffer.hpp>
+
 namespace kaa {
 
 class IHttpRequest {
@@ -29,6 +32,12 @@ public:
     virtual std::string getHost() const = 0;
     virtual std::uint16_t getPort() const = 0;
     virtual std::string getRequestData() const = 0;
+
+    /**
+     * Returns the request as a sequence of buffers to be written at once (gathered).
+     * The buffers refer to the request data, so they are valid until the request is changed.
+     */
+    virtual std::vector<boost::asio::const_buffer> getRequestBuffers() const = 0;
     virtual void setHeaderField(const std::string& name, const std::string& value) = 0;
     virtual void removeHeaderField(const std::string& name) = 0;
     virtual ~IHttpRequest() { }
@@ -24,6 +24,8 @@
 #include "kaa/IKaaClientContext.hpp"
 
 #include <map>
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace kaa {
@@ -36,19 +38,51 @@ public:
     virtual std::string getHost() const;
     virtual std::uint16_t getPort() const;
     virtual std::string getRequestData() const;
+    virtual std::vector<boost::asio::const_buffer> getRequestBuffers() const;
     virtual void setHeaderField(const std::string& name, const std::string& value);
     virtual void removeHeaderField(const std::string& name);
 
     void setBodyField(const std::string& name, const std::vector<std::uint8_t>& value);
+
+    /**
+     * Sets the body field without copying its value: the request shares the container
+     * (any one with contiguous data(), e.g. a vector or a string) and writes its data as is.
+     */
+    template<typename Container>
+    void setBodyField(const std::string& name, std::shared_ptr<Container> value)
+    {
+        BodyField field = { value, reinterpret_cast<const std::uint8_t *>(value->data()), value->size(),
+                            makeBodyFieldHeader(name) };
+        bodyFields_.insert(std::make_pair(name, std::move(field)));
+        updateHeader();
+    }
+
     void removeBodyField(const std::string& name);
 
 private:
+    struct BodyField {
+        std::shared_ptr<const void>    owner_;
+        const std::uint8_t            *data_;
+        std::size_t                    size_;
+        std::string                    header_;
+    };
+
+    static std::string makeBodyFieldHeader(const std::string& name);
+    void updateHeader();
+
     static const std::string BOUNDARY;
+    static const std::string BODY_END;
+    static const std::string LINE_END;
 
 private:
     HttpUrl url_;
     std::map<std::string, std::string> headerFields_;
-    std::map<std::string, std::vector<std::uint8_t>> bodyFields_;
+    std::map<std::string, BodyField> bodyFields_;
+
+    /*
+     * Rebuilt whenever fields change, so getRequestBuffers() only refers to it.
+     */
+    std::string header_;
 
     IKaaClientContext &context_;
 };
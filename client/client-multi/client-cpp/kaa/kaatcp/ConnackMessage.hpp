@@ -44,11 +44,17 @@ public:
     std::string getMessage() const;
     ConnackReturnCode getReturnCode() const { return returnCode_; }
 
+    /**
+     * Whether the server accepts compressed KAASYNC payloads during this session.
+     */
+    bool isCompressionSupported() const { return isCompressionSupported_; }
+
 private:
     void parseMessage(const char *payload, std::uint16_t size);
 
 private:
     ConnackReturnCode returnCode_;
+    bool isCompressionSupported_;
 };
 
 }
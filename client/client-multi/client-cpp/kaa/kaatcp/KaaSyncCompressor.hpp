@@ -0,0 +1,71 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef KAASYNCCOMPRESSOR_HPP_
+#define KAASYNCCOMPRESSOR_HPP_
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include <boost/noncopyable.hpp>
+
+#include "kaa/common/ByteArrayView.hpp"
+
+namespace kaa {
+
+struct ZlibStreams;
+
+/**
+ * @brief Compresses and decompresses KAASYNC payloads.
+ *
+ * Payloads are compressed into the zlib format (RFC 1950). The compression is applied before
+ * encryption, the message carries @c KaaTcpCommon::KAA_SYNC_ZIPPED_BIT.
+ *
+ * The zlib streams and the output buffers are reused. Compression and decompression may be called
+ * from different threads, but each of them must not be called concurrently with itself.
+ */
+class KaaSyncCompressor : boost::noncopyable {
+public:
+    KaaSyncCompressor();
+    ~KaaSyncCompressor();
+
+    /**
+     * @brief Compresses the payload.
+     *
+     * @return The compressed payload or an empty view if it isn't smaller than the original one,
+     * in which case the payload should be sent uncompressed. The view is valid until the next call.
+     */
+    ByteArrayView compress(const std::uint8_t *data, std::size_t size);
+
+    /**
+     * @brief Decompresses the payload.
+     *
+     * @return The decompressed payload. The view is valid until the next call.
+     * @throw KaaException The payload is corrupted or too big.
+     */
+    ByteArrayView decompress(const std::uint8_t *data, std::size_t size);
+
+private:
+    std::unique_ptr<ZlibStreams>    streams_;
+
+    std::vector<std::uint8_t>       compressBuffer_;
+    std::vector<std::uint8_t>       decompressBuffer_;
+};
+
+} /* namespace kaa */
+
+#endif /* KAASYNCCOMPRESSOR_HPP_ */
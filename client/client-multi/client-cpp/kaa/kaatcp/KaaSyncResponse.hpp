@@ -18,7 +18,7 @@
 #define KAASYNCRESPONSE_HPP_
 
 #include "kaa/kaatcp/KaaTcpCommon.hpp"
-#include <vector>
+#include "kaa/common/ByteArrayView.hpp"
 
 namespace kaa {
 
@@ -28,7 +28,10 @@ class KaaSyncResponse
 public:
     KaaSyncResponse(const char * payload, std::uint32_t size);
 
-    const std::vector<std::uint8_t>& getPayload() const { return payload_; }
+    /**
+     * The payload refers to the received data and is valid only while the response is being processed.
+     */
+    const ByteArrayView& getPayload() const { return payload_; }
     bool isZipped() const { return isZipped_; }
     bool isEncrypted() const { return isEncrypted_; }
     std::uint16_t getMessageId() const { return messageId_; }
@@ -41,7 +44,7 @@ private:
     bool isEncrypted_;
     std::uint16_t messageId_;
 
-    std::vector<std::uint8_t> payload_;
+    ByteArrayView payload_;
 };
 
 }
@@ -45,6 +45,16 @@ public:
     static const std::uint8_t KAA_SYNC_ENCRYPTED_BIT = 0x04;
     static const std::uint8_t KAA_SYNC_REQUEST_BIT = 0x01;
 
+    /*
+     * Payloads smaller than the threshold are sent uncompressed.
+     */
+    static const std::uint32_t KAA_SYNC_COMPRESSION_THRESHOLD = 256;
+
+    /*
+     * Set by the server in CONNACK if it accepts compressed KAASYNC payloads.
+     */
+    static const std::uint8_t KAA_CONNACK_COMPRESSION_FLAG = 0x01;
+
     static const std::uint8_t KAA_CONNECT_HEADER_LENGTH = 18;
     static const std::uint8_t KAA_CONNECT_SESSION_KEY_FLAGS = 0x11;
     static const std::uint8_t KAA_CONNECT_SIGNATURE_FLAGS = 0x01;
@@ -23,12 +23,19 @@
 #include "kaa/kaatcp/KaaTcpCommon.hpp"
 #include "kaa/IKaaClientContext.hpp"
 #include <list>
+#include <vector>
+#include <functional>
 
 namespace kaa {
 
 typedef std::pair<KaaTcpMessageType, std::pair<boost::shared_array<char>, std::uint32_t>> MessageRecord;
 typedef std::list<MessageRecord> MessageRecordList;
 
+/**
+ * Receives a parsed message. The payload is valid only until the handler returns.
+ */
+typedef std::function<void (KaaTcpMessageType, const char *, std::uint32_t)> MessageHandler;
+
 enum class KaaTcpParserState : std::uint8_t
 {
     NONE = 0x00,
@@ -46,7 +53,14 @@ public:
 
     void parseBuffer(const char *buffer, std::uint32_t size);
 
-    boost::shared_array<char> getCurrentPayload() const { return messagePayload_; }
+    /**
+     * Makes the parser pass each message to the handler as soon as it is parsed instead of
+     * collecting it for @link releaseMessages() @endlink. A payload which is entirely contained
+     * in the parsed buffer is passed without copying.
+     */
+    void setMessageHandler(const MessageHandler& handler) { messageHandler_ = handler; }
+
+    const char *getCurrentPayload() const { return payloadBuffer_.empty() ? nullptr : payloadBuffer_.data(); }
     std::uint32_t getCurrentPayloadLength() const { return messageLength_; }
     KaaTcpMessageType getCurrentMessageType() const { return messageType_; }
 
@@ -57,7 +71,7 @@ public:
 private:
     void processByte(char byte);
     void retrieveMessageType(char byte);
-    void onMessageDone();
+    void onMessageDone(const char *payload);
 
 private:
 
@@ -66,8 +80,9 @@ private:
     std::uint32_t processedPayloadLength_;
     std::uint32_t lenghtMultiplier_;
     KaaTcpMessageType messageType_;
-    boost::shared_array<char> messagePayload_;
+    std::vector<char> payloadBuffer_;
     MessageRecordList messages_;
+    MessageHandler messageHandler_;
     IKaaClientContext &context_;
 };
 
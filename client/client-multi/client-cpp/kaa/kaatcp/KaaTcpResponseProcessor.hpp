@@ -24,6 +24,7 @@
 #include "kaa/kaatcp/KaaTcpParser.hpp"
 #include "kaa/IKaaClientContext.hpp"
 #include <functional>
+#include <boost/asio/buffer.hpp>
 
 namespace kaa
 {
@@ -31,11 +32,24 @@ namespace kaa
 class KaaTcpResponseProcessor
 {
 public:
-    KaaTcpResponseProcessor(IKaaClientContext &context): parser_(context), context_(context) { }
+    KaaTcpResponseProcessor(IKaaClientContext &context);
     ~KaaTcpResponseProcessor() { }
 
     void processResponseBuffer(const char *buf, std::uint32_t size);
 
+    /**
+     * Parses the data right out of the buffer sequence (e.g. boost::asio::streambuf::data()),
+     * received messages are passed to receivers without copying their payload when possible.
+     */
+    template<class ConstBufferSequence>
+    void processResponseBuffers(const ConstBufferSequence& buffers)
+    {
+        for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+            boost::asio::const_buffer buffer(*it);
+            parser_.parseBuffer(boost::asio::buffer_cast<const char *>(buffer), boost::asio::buffer_size(buffer));
+        }
+    }
+
     void registerConnackReceiver(std::function<void (const ConnackMessage&)> onConnack) { onConnack_ = onConnack; }
     void registerKaaSyncReceiver(std::function<void (const KaaSyncResponse&)> onKaaSync) { onKaaSyncResponse_ = onKaaSync; }
     void registerDisconnectReceiver(std::function<void (const DisconnectMessage&)> onDisconnect) { onDisconnect_ = onDisconnect; }
@@ -43,6 +57,9 @@ public:
 
     void flush() { parser_.resetParser(); }
 
+private:
+    void onMessage(KaaTcpMessageType type, const char *payload, std::uint32_t size);
+
 private:
     std::function<void (const ConnackMessage&)> onConnack_;
     std::function<void (const KaaSyncResponse&)> onKaaSyncResponse_;
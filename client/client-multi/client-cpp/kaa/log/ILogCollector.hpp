@@ -18,6 +18,7 @@
 #define ILOGCOLLECTOR_HPP_
 
 #include <future>
+#include <vector>
 
 #include "kaa/log/gen/LogDefinitions.hpp"
 #include "kaa/log/ILogStorage.hpp"
@@ -66,6 +67,31 @@ public:
      */
     virtual RecordFuture addLogRecord(const KaaUserLogRecord& record) = 0;
 
+    /**
+     * @brief Adds a batch of log records to the log storage.
+     *
+     * Unlike calling @link addLogRecord() @endlink for each record, the whole batch is encoded and persisted
+     * in a single task and the upload strategy is asked once per batch.
+     *
+     * The default implementation calls @link addLogRecord() @endlink for each record.
+     *
+     * @param[in] records    The log records to be added.
+     *
+     * @return The futures of each record, in the order of @c records.
+     *
+     * @see KaaUserLogRecord
+     * @see ILogStorage
+     */
+    virtual std::vector<RecordFuture> addLogRecords(const std::vector<KaaUserLogRecord>& records)
+    {
+        std::vector<RecordFuture> futures;
+        futures.reserve(records.size());
+        for (const auto& record : records) {
+            futures.push_back(addLogRecord(record));
+        }
+        return futures;
+    }
+
     /**
      * @brief Sets the new log storage.
      *
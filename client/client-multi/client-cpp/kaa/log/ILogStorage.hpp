@@ -17,7 +17,9 @@
 #ifndef ILOGSTORAGE_HPP_
 #define ILOGSTORAGE_HPP_
 
+#include <list>
 #include <memory>
+#include <vector>
 #include <cstdint>
 
 #include "kaa/log/BucketInfo.hpp"
@@ -49,6 +51,29 @@ public:
      */
     virtual BucketInfo addLogRecord(LogRecord&& record) = 0;
 
+    /**
+     * @brief Persists several log records at once.
+     *
+     * Records are persisted in order, each one is removed from @c records as soon as it is persisted. If a record
+     * can't be persisted, the exception is propagated and the record is left the first in @c records.
+     * An implementation which persists records atomically may leave the records preceding it in @c records too.
+     *
+     * The default implementation calls @link addLogRecord() @endlink for each record. Override it to persist
+     * the whole batch under a single lock or transaction.
+     *
+     * @param records        The @c LogRecord objects.
+     * @param bucketInfos    The @c BucketInfo object of each persisted record is appended to.
+     * @see LogRecord
+     * @see BucketInfo
+     */
+    virtual void addLogRecords(std::list<LogRecord>& records, std::vector<BucketInfo>& bucketInfos)
+    {
+        while (!records.empty()) {
+            bucketInfos.push_back(addLogRecord(std::move(records.front())));
+            records.pop_front();
+        }
+    }
+
     /**
      * @brief Returns a log storage status.
      *
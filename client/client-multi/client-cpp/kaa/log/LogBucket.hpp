@@ -18,13 +18,38 @@
 #define LOGBUCKET_HPP_
 
 #include <list>
+#include <vector>
+#include <memory>
 #include <cstdint>
+#include <cstring>
 #include <utility>
 
 #include "kaa/log/LogRecord.hpp"
+#include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
 
+/**
+ * @typedef The shared pointer to a block of log records.
+ *
+ * The block is shared between a log storage and an in-flight @c LogBucket, so a bucket is handed over
+ * without copying the record list. The storage keeps the block for a possible rollback.
+ */
+typedef std::shared_ptr<std::list<LogRecord>> LogRecordBlockPtr;
+
+/**
+ * @typedef The length prefix of a packed log record.
+ */
+typedef std::uint32_t PackedLogRecordLength;
+
+/**
+ * @typedef The shared pointer to encoded log records packed back-to-back in one buffer.
+ *
+ * Each record is prefixed with its @c PackedLogRecordLength in the host byte order, so a storage keeping
+ * records this way hands a bucket over in a single allocation rather than in one per record.
+ */
+typedef std::shared_ptr<const std::vector<std::uint8_t>> PackedLogRecordsPtr;
+
 /**
  * @brief The helper class which is used to transfer logs from @c LogStorage to @c LogCollector.
  *
@@ -45,7 +70,7 @@ public:
      * @param[in] records Log records.
      */
     LogBucket(std::int32_t id, std::list<LogRecord>&& records)
-        : id_(id), logRecords_(std::move(records)) { }
+        : id_(id), logRecords_(std::make_shared<std::list<LogRecord>>(std::move(records))) { }
 
     /**
      * @brief Constructs @c LogBucket object.
@@ -54,8 +79,27 @@ public:
      * @param[in] records Log records.
      */
     LogBucket(std::int32_t id, const std::list<LogRecord>& records)
+        : id_(id), logRecords_(std::make_shared<std::list<LogRecord>>(records)) { }
+
+    /**
+     * @brief Constructs @c LogBucket object which shares log records with their owner (e.g. a log storage).
+     *
+     * @param[in] id      The unique log bucket id.
+     * @param[in] records The shared block of log records.
+     */
+    LogBucket(std::int32_t id, const LogRecordBlockPtr& records)
         : id_(id), logRecords_(records) { }
 
+    /**
+     * @brief Constructs @c LogBucket object from packed log records.
+     *
+     * @param[in] id             The unique log bucket id.
+     * @param[in] records        The buffer of packed log records.
+     * @param[in] recordCount    The number of records in the buffer.
+     */
+    LogBucket(std::int32_t id, const PackedLogRecordsPtr& records, std::size_t recordCount)
+        : id_(id), packedRecords_(records), packedRecordCount_(recordCount) { }
+
     /**
      * @brief Returns a log bucket id.
      *
@@ -67,18 +111,107 @@ public:
         return id_;
     }
 
+    /**
+     * @brief Returns the number of log records in the bucket.
+     */
+    std::size_t getRecordCount() const {
+        return packedRecords_ ? packedRecordCount_ : (logRecords_ ? logRecords_->size() : 0);
+    }
+
     /**
      * @brief Returns log records of the bucket.
      *
      * @return The list of log records.
+     *
+     * @throw KaaException The bucket holds packed records, see @link isPacked() @endlink.
+     */
+    const std::list<LogRecord>& getRecords() const {
+        if (packedRecords_) {
+            throw KaaException("Log bucket holds packed records");
+        }
+
+        static const std::list<LogRecord> emptyRecords;
+        return logRecords_ ? *logRecords_ : emptyRecords;
+    }
+
+    /**
+     * @brief Calls the visitor with the encoded data of each log record in the bucket, in order.
+     *
+     * Works for both list and packed buckets.
+     *
+     * @param[in] visitor    The callable taking <tt>(const std::uint8_t *data, std::size_t size)</tt>.
+     */
+    template <typename Visitor>
+    void forEachRecord(Visitor&& visitor) const {
+        if (packedRecords_) {
+            const std::uint8_t *data = packedRecords_->data();
+            const std::uint8_t *end = data + packedRecords_->size();
+            while (data < end) {
+                PackedLogRecordLength size = 0;
+                std::memcpy(&size, data, sizeof(size));
+                data += sizeof(size);
+                visitor(data, static_cast<std::size_t>(size));
+                data += size;
+            }
+        } else if (logRecords_) {
+            for (const auto& record : *logRecords_) {
+                visitor(record.getData().data(), record.getSize());
+            }
+        }
+    }
+
+    /**
+     * @brief Takes log records out of the bucket, leaving it empty.
+     *
+     * @note Records shared with their owner or packed are copied, so the owner's records stay intact.
+     * Use @link isShared() @endlink and @link isPacked() @endlink to avoid the copy.
+     *
+     * @return The list of log records.
+     */
+    std::list<LogRecord> takeRecords() {
+        std::list<LogRecord> records;
+        if (packedRecords_) {
+            forEachRecord([&records] (const std::uint8_t *data, std::size_t size)
+                    {
+                        records.emplace_back(data, size);
+                    });
+            packedRecords_.reset();
+            packedRecordCount_ = 0;
+        } else if (logRecords_) {
+            if (isShared()) {
+                records = *logRecords_;
+            } else {
+                records = std::move(*logRecords_);
+            }
+            logRecords_.reset();
+        }
+        return records;
+    }
+
+    /**
+     * @brief Checks whether log records are shared with their owner.
+     *
+     * @return @c true if records are still referenced by someone else (e.g. a log storage keeps them
+     * for a possible rollback), @c false if the bucket is the only owner of records.
+     */
+    bool isShared() const {
+        return logRecords_ && logRecords_.use_count() != 1;
+    }
+
+    /**
+     * @brief Checks whether log records are packed in one buffer instead of kept as @c LogRecord objects.
+     *
+     * Packed records are read with @link forEachRecord() @endlink.
      */
-    std::list<LogRecord>& getRecords() {
-        return logRecords_;
+    bool isPacked() const {
+        return static_cast<bool>(packedRecords_);
     }
 
 private:
-    std::int32_t            id_ = 0;
-    std::list<LogRecord>    logRecords_;
+    std::int32_t           id_ = 0;
+    LogRecordBlockPtr      logRecords_;
+    PackedLogRecordsPtr    packedRecords_;
+    std::size_t            packedRecordCount_ = 0;
 };
 
 } /* namespace kaa */
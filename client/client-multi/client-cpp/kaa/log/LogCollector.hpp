@@ -70,6 +70,7 @@ public:
     LogCollector(IKaaChannelManagerPtr manager, IKaaClientContext &context);
 
     virtual RecordFuture addLogRecord(const KaaUserLogRecord& record);
+    virtual std::vector<RecordFuture> addLogRecords(const std::vector<KaaUserLogRecord>& records);
 
     virtual void setStorage(ILogStoragePtr storage);
     virtual void setUploadStrategy(ILogUploadStrategyPtr strategy);
@@ -30,8 +30,13 @@ class LogRecord {
 public:
     LogRecord(const KaaUserLogRecord& record)
     {
-        AvroByteArrayConverter<KaaUserLogRecord> converter;  // TODO: make converter thread local when it would be possible
-        converter.toByteArray(record, encodedRecord_);
+        /*
+         * Records are kept in a log storage, whose limits count their size. So the record is encoded
+         * into the converter's pooled buffer and copied out, leaving no spare capacity behind.
+         */
+        const auto& encodedRecord = AvroByteArrayConverter<KaaUserLogRecord>::getThreadLocalConverter()
+                                                                                .toPooledByteArray(record);
+        encodedRecord_.assign(encodedRecord.begin(), encodedRecord.end());
     }
 
     LogRecord(const std::uint8_t *data, size_t size)
@@ -45,6 +50,8 @@ public:
 
     std::vector<std::uint8_t>& getData() { return encodedRecord_; }
 
+    const std::vector<std::uint8_t>& getData() const { return encodedRecord_; }
+
     std::vector<std::uint8_t>&& getRvalueData(){ return std::move(encodedRecord_); }
 
     std::size_t getSize() const { return encodedRecord_.size(); }
@@ -24,6 +24,7 @@
 #include "kaa/log/ILogStorage.hpp"
 #include "kaa/log/ILogStorageStatus.hpp"
 #include "kaa/log/LogStorageConstants.hpp"
+#include "kaa/log/LogBucket.hpp"
 
 namespace kaa {
 
@@ -68,6 +69,7 @@ public:
                      std::size_t bucketRecordCount = LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
 
     virtual BucketInfo addLogRecord(LogRecord&& record);
+    virtual void addLogRecords(std::list<LogRecord>& records, std::vector<BucketInfo>& bucketInfos);
     virtual ILogStorageStatus& getStatus() { return *this; }
 
     virtual LogBucket getNextBucket();
@@ -87,9 +89,10 @@ private:
     bool checkBucketOverflow(const LogRecord& record) {
         const auto& currentBucket = buckets_.back();
         return (currentBucket.occupiedSize_ + record.getSize() > maxBucketSize_) ||
-               (currentBucket.logs_.size() + 1 > maxBucketRecordCount_);
+               (currentBucket.logs_->size() + 1 > maxBucketRecordCount_);
     }
 
+    BucketInfo storeLogRecord(LogRecord&& record);
     void internalAddLogRecord(LogRecord&& record);
 
 private:
@@ -98,14 +101,28 @@ private:
         IN_USE
     };
 
+    /*
+     * Records are kept in a shared block, so an in-use bucket is handed over to the log collector
+     * without copying. The block is released when both the storage and the collector drop it.
+     */
     struct InternalBucket {
         InternalBucket(std::int32_t bucketId)
-            : bucketId_(bucketId) {}
-
-        BucketState             state_ = BucketState::FREE;
-        std::int32_t            bucketId_ = 0;
-        std::size_t             occupiedSize_ = 0;
-        std::list<LogRecord>    logs_;
+            : bucketId_(bucketId), logs_(std::make_shared<std::list<LogRecord>>()) {}
+
+        /*
+         * The in-use block may still be read by the log collector, so it is copied before modification.
+         */
+        std::list<LogRecord>& getWritableLogs() {
+            if (logs_.use_count() != 1) {
+                logs_ = std::make_shared<std::list<LogRecord>>(*logs_);
+            }
+            return *logs_;
+        }
+
+        BucketState          state_ = BucketState::FREE;
+        std::int32_t         bucketId_ = 0;
+        std::size_t          occupiedSize_ = 0;
+        LogRecordBlockPtr    logs_;
     };
 
 private:
@@ -19,7 +19,9 @@
 
 #include <memory>
 #include <list>
+#include <chrono>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <unordered_map>
 
@@ -29,6 +31,7 @@
 #include "kaa/log/ILogStorage.hpp"
 #include "kaa/log/ILogStorageStatus.hpp"
 #include "kaa/log/LogStorageConstants.hpp"
+#include "kaa/utils/KaaTimer.hpp"
 
 
 
@@ -46,6 +49,7 @@ enum SQLiteOptimizationOptions
     SQLITE_MEMORY_JOURNAL_MODE = 0x2,
     SQLITE_MEMORY_TEMP_STORE   = 0x4,
     SQLITE_COUNT_CHANGES_OFF   = 0x8,
+    SQLITE_WAL_JOURNAL_MODE    = 0x10,
 
     SQLITE_ALL_OPTIMIZATIONS   = SQLITE_SYNCHRONOUS_OFF |
                                  SQLITE_MEMORY_JOURNAL_MODE |
@@ -53,6 +57,25 @@ enum SQLiteOptimizationOptions
                                  SQLITE_COUNT_CHANGES_OFF
 };
 
+/**
+ * @brief Limits of the transaction log records are written in.
+ *
+ * The transaction is committed as soon as one of the limits is reached. A zero limit is not taken into account.
+ * Records of the transaction which is not committed yet are lost if the application crashes, so the default
+ * limits commit each record on its own.
+ */
+struct SQLiteTransactionOptions {
+    SQLiteTransactionOptions(std::size_t maxRecordCount = 1, std::size_t maxSize = 0, std::size_t maxDurationMs = 0)
+        : maxRecordCount_(maxRecordCount), maxSize_(maxSize), maxDurationMs_(maxDurationMs) {}
+
+    std::size_t maxRecordCount_;  /**< Max number of records in the transaction. */
+    std::size_t maxSize_;         /**< Max total size of records in the transaction, in bytes. */
+    std::size_t maxDurationMs_;   /**< Max time since the first record in the transaction, in milliseconds.
+                                       Enforced by a timer, so it holds even if the storage isn't used meanwhile. */
+};
+
+class SQLiteStatement;
+
 class SQLiteDBLogStorage : public ILogStorage, public ILogStorageStatus {
 public:
     SQLiteDBLogStorage(IKaaClientContext &context,
@@ -63,11 +86,13 @@ public:
                        const std::string& dbName,
                        int optimizationMask = (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
                        std::size_t bucketSize = LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
-                       std::size_t bucketRecordCount = LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+                       std::size_t bucketRecordCount = LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT,
+                       const SQLiteTransactionOptions& transactionOptions = SQLiteTransactionOptions());
 
     ~SQLiteDBLogStorage();
 
     virtual BucketInfo addLogRecord(LogRecord&& record);
+    virtual void addLogRecords(std::list<LogRecord>& records, std::vector<BucketInfo>& bucketInfos);
     virtual ILogStorageStatus& getStatus() { return *this; }
 
     virtual LogBucket getNextBucket();
@@ -90,6 +115,10 @@ private:
 
     void addNextBucket();
 
+    void checkRecordSize(const LogRecord& record) const;
+    BucketInfo storeLogRecord(const LogRecord& record);
+    void storeInSavepoint(const std::function<void ()>& store);
+
     bool checkBucketOverflow(const LogRecord& record) {
         return (currentBucketSize_ + record.getSize() > maxBucketSize_) ||
                (currentBucketRecordCount_ + 1 > maxBucketRecordCount_);
@@ -99,6 +128,15 @@ private:
 
     bool truncateIfBucketSizeIncompatible();
 
+    void prepareStatements();
+    void finalizeStatements();
+
+    void beginTransactionIfNeeded();
+    void commitTransaction();
+    void commitTransactionIfLimitsReached();
+    void commitExpiredTransaction();
+    void onCommitTimer();
+
 private:
     struct InnerBucketInfo {
         InnerBucketInfo(std::size_t sizeInBytes, std::size_t sizeInLogs)
@@ -126,8 +164,35 @@ private:
     std::size_t consumedMemory_ = 0;
     std::unordered_map<std::int32_t/*Bucket id*/, InnerBucketInfo> consumedMemoryStorage_;
 
+    const SQLiteTransactionOptions transactionOptions_;
+
+    bool isTransactionActive_ = false;
+    std::size_t transactionRecordCount_ = 0;
+    std::size_t transactionSize_ = 0;
+    std::chrono::steady_clock::time_point transactionStartTime_;
+
+    /*
+     * Statements used on each log record or bucket, prepared once per connection.
+     */
+    std::unique_ptr<SQLiteStatement> beginTransactionStmt_;
+    std::unique_ptr<SQLiteStatement> commitTransactionStmt_;
+    std::unique_ptr<SQLiteStatement> savepointStmt_;
+    std::unique_ptr<SQLiteStatement> rollbackToSavepointStmt_;
+    std::unique_ptr<SQLiteStatement> releaseSavepointStmt_;
+    std::unique_ptr<SQLiteStatement> insertRecordStmt_;
+    std::unique_ptr<SQLiteStatement> updateBucketInfoStmt_;
+    std::unique_ptr<SQLiteStatement> insertBucketStmt_;
+    std::unique_ptr<SQLiteStatement> getOldestBucketStmt_;
+    std::unique_ptr<SQLiteStatement> selectBucketRecordsStmt_;
+    std::unique_ptr<SQLiteStatement> markBucketAsInUseStmt_;
+    std::unique_ptr<SQLiteStatement> markBucketAsFreeStmt_;
+    std::unique_ptr<SQLiteStatement> deleteBucketStmt_;
+    std::unique_ptr<SQLiteStatement> deleteBucketRecordsStmt_;
+
     KAA_MUTEX_DECLARE(sqliteLogStorageGuard_);
 
+    std::unique_ptr<KaaTimer<void ()>> commitTimer_;
+
     IKaaClientContext &context_;
 };
 
@@ -0,0 +1,101 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#ifndef ASYNCLOGGER_HPP_
+#define ASYNCLOGGER_HPP_
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <cstddef>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/logging/ILogger.hpp"
+#include "kaa/utils/BoundedQueue.hpp"
+
+namespace kaa {
+
+/**
+ * @brief Logger which writes messages to the target logger in a background thread.
+ *
+ * Messages are put into a bounded lock-free queue, so the logging thread neither formats nor writes
+ * the message and doesn't take any lock unless the background writer sleeps. The overflow policy
+ * tells what to do with a message when the queue is full.
+ */
+class AsyncLogger : public ILogger {
+public:
+    enum class OverflowPolicy {
+        DROP,   /**< The message is dropped and counted in @c getDroppedCount(). */
+        BLOCK   /**< The logging thread waits until the writer frees a place in the queue. */
+    };
+
+    AsyncLogger(LoggerPtr logger,
+                std::size_t capacity = DEFAULT_CAPACITY,
+                OverflowPolicy policy = OverflowPolicy::DROP);
+
+    /**
+     * Writes all queued messages and stops the writer.
+     */
+    ~AsyncLogger();
+
+    virtual void log(LogLevel level, const char *message) const;
+
+    virtual bool isEnabled(LogLevel level) const;
+
+    /**
+     * Waits until all messages logged before the call are written to the target logger.
+     */
+    void flush();
+
+    std::size_t getDroppedCount() const { return droppedCount_; }
+
+public:
+    static const std::size_t DEFAULT_CAPACITY = 4096;
+
+private:
+    struct Record {
+        LogLevel       level_;
+        std::string    message_;
+    };
+
+    void processRecords();
+    bool writeRecords();
+    void notifyWriter() const;
+
+private:
+    LoggerPtr               logger_;
+    const OverflowPolicy    policy_;
+
+    mutable BoundedQueue<Record>    records_;
+
+    mutable std::atomic_size_t    pushedCount_;
+    mutable std::atomic_size_t    droppedCount_;
+    std::atomic_size_t            writtenCount_;
+
+    std::atomic_bool    isRun_;
+    std::atomic_bool    isWriterSleeping_;
+
+    KAA_MUTEX_MUTABLE_DECLARE(writerGuard_);
+    mutable KAA_CONDITION_VARIABLE    onNewRecord_;
+    KAA_CONDITION_VARIABLE            onRecordsWritten_;
+
+    std::thread    writer_;
+};
+
+} /* namespace kaa */
+
+#endif /* ASYNCLOGGER_HPP_ */
@@ -17,6 +17,7 @@
 #ifndef DEFAULTLOGGER_HPP_
 #define DEFAULTLOGGER_HPP_
 
+#include <atomic>
 #include <string>
 #include <boost/log/sinks/sync_frontend.hpp>
 #include <boost/log/sinks/text_ostream_backend.hpp>
@@ -33,8 +34,16 @@ public:
 
   void log(LogLevel level, const char *message) const;
 
+  /**
+   * Messages below the given level are skipped. All messages are logged by default.
+   */
+  void setLevel(LogLevel level) { level_ = level; }
+
+  virtual bool isEnabled(LogLevel level) const { return level >= level_; }
+
 private:
     std::string clientId_;
+    std::atomic<LogLevel> level_;
     using text_sink = boost::log::sinks::synchronous_sink< boost::log::sinks::text_ostream_backend >;
     boost::shared_ptr< text_sink > pSink_;
 };
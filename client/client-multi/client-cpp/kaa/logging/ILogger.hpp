@@ -17,6 +17,7 @@
 #ifndef ILOGGER_HPP_
 #define ILOGGER_HPP_
 
+#include <memory>
 #include <string>
 
 namespace kaa {
@@ -35,6 +36,12 @@ public:
     virtual ~ILogger() {}
 
     virtual void log(LogLevel level, const char *message) const = 0;
+
+    /**
+     * Tells whether messages of the given level are logged. Log macros check it before the message
+     * is built, so the message arguments aren't evaluated for disabled levels.
+     */
+    virtual bool isEnabled(LogLevel level) const { return true; }
 };
 
 typedef std::shared_ptr<ILogger> LoggerPtr;
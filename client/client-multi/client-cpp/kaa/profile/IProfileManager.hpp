@@ -42,6 +42,7 @@ public:
 
     /**
      * Notifies server that profile has been updated.
+     * Changes made inside the profile container are picked up only by this call.
      */
     virtual void updateProfile() = 0;
 
@@ -55,6 +56,11 @@ public:
      */
     virtual SharedDataBuffer getSerializedProfile() = 0;
 
+    /**
+     * Returns serialized profile together with its hash, both of the same profile version
+     */
+    virtual std::pair<SharedDataBuffer, HashDigest> getSerializedProfileWithHash() = 0;
+
     virtual ~IProfileManager() {}
 };
 
@@ -18,6 +18,7 @@
 #define DEFAULTPROFILEMANAGER_HPP_
 
 #include <memory>
+#include <utility>
 
 #include "kaa/profile/IProfileManager.hpp"
 #include "kaa/profile/IProfileContainer.hpp"
@@ -26,16 +27,21 @@
 #include "kaa/channel/transport/IProfileTransport.hpp"
 #include "kaa/profile/gen/ProfileDefinitions.hpp"
 #include "kaa/IKaaClientContext.hpp"
+#include "kaa/KaaThread.hpp"
 
 namespace kaa {
 
 /**
  * Default profile manager
  * Responsible for the profile container management and ProfileListener creation
+ *
+ * The serialized profile and its hash are cached, they are recomputed only after the container
+ * is changed or updateProfile() is called.
  */
 class ProfileManager : public IProfileManager {
 public:
-    ProfileManager(IKaaClientContext &context) : profileContainer_(std::make_shared<DefaultProfileContainer>()), context_(context) { }
+    ProfileManager(IKaaClientContext &context)
+        : profileContainer_(std::make_shared<DefaultProfileContainer>()), isProfileDirty_(true), context_(context) { }
 
     /**
      * Sets profile container implemented by the user
@@ -44,7 +50,9 @@ public:
     virtual void setProfileContainer(IProfileContainerPtr container)
     {
         if (container) {
+            KAA_MUTEX_UNIQUE_DECLARE(lock, profileGuard_);
             profileContainer_ = container;
+            isProfileDirty_ = true;
         }
     }
 
@@ -56,18 +64,20 @@ public:
      */
     SharedDataBuffer getSerializedProfile()
     {
-        static AvroByteArrayConverter<KaaProfile> avroConverter;
-
-        if (profileContainer_) {
-            return avroConverter.toByteArray(profileContainer_->getProfile());
-        }
-#if KAA_PROFILE_SCHEMA_VERSION > 0
-        else {
-            throw KaaException("Profile container is not set!");
-        }
-#endif
+        KAA_MUTEX_UNIQUE_DECLARE(lock, profileGuard_);
+        refreshProfile();
+        return serializedProfile_;
+    }
 
-        return avroConverter.toByteArray(KaaProfile());
+    /**
+     * Retrieves serialized profile and its hash under one lock,
+     * so they can't belong to different profile versions
+     */
+    std::pair<SharedDataBuffer, HashDigest> getSerializedProfileWithHash()
+    {
+        KAA_MUTEX_UNIQUE_DECLARE(lock, profileGuard_);
+        refreshProfile();
+        return std::make_pair(serializedProfile_, profileHash_);
     }
 
     /**
@@ -75,7 +85,12 @@ public:
      */
     void updateProfile()
     {
-        SharedDataBuffer serializedProfile = getSerializedProfile();
+        KAA_MUTEX_UNIQUE_DECLARE(lock, profileGuard_);
+        isProfileDirty_ = true;
+        refreshProfile();
+        SharedDataBuffer serializedProfile = serializedProfile_;
+        KAA_UNLOCK(lock);
+
         if (serializedProfile.first.get() && serializedProfile.second > 0) {
             transport_->sync();
         }
@@ -101,9 +116,41 @@ public:
         }
     }
 
+private:
+    void refreshProfile()
+    {
+        if (!isProfileDirty_) {
+            return;
+        }
+
+        auto& avroConverter = AvroByteArrayConverter<KaaProfile>::getThreadLocalConverter();
+
+        if (profileContainer_) {
+            serializedProfile_ = avroConverter.toByteArray(profileContainer_->getProfile());
+        }
+#if KAA_PROFILE_SCHEMA_VERSION > 0
+        else {
+            throw KaaException("Profile container is not set!");
+        }
+#else
+        else {
+            serializedProfile_ = avroConverter.toByteArray(KaaProfile());
+        }
+#endif
+
+        profileHash_ = EndpointObjectHash(serializedProfile_).getHashDigest();
+        isProfileDirty_ = false;
+    }
+
 private:
     IProfileTransportPtr            transport_;
     IProfileContainerPtr     profileContainer_;
+
+    SharedDataBuffer        serializedProfile_;
+    HashDigest                    profileHash_;
+    bool                       isProfileDirty_;
+    KAA_MUTEX_DECLARE(profileGuard_);
+
     IKaaClientContext                &context_;
 };
 
@@ -18,6 +18,7 @@
 #define IENCODERDECODER_HPP_
 
 #include <cstdint>
+#include "kaa/common/ByteArrayView.hpp"
 #include "kaa/security/SecurityDefinitions.hpp"
 
 namespace kaa {
@@ -27,8 +28,27 @@ public:
     virtual ~IEncoderDecoder() {}
 
     virtual EncodedSessionKey                   getEncodedSessionKey() = 0;
+
+    /**
+     * Returns the signature of the encoded session key, i.e. of the result of getEncodedSessionKey().
+     */
+    virtual Signature                           getSessionKeySignature() = 0;
+
     virtual std::string                         encodeData(const std::uint8_t *data, std::size_t size) = 0;
     virtual std::string                         decodeData(const std::uint8_t *data, std::size_t size) = 0;
+
+    /**
+     * Encodes/decodes data into the caller-provided buffer, the buffer is resized to the result size.
+     * The buffer keeps its capacity, so reusing it between calls avoids memory allocations.
+     */
+    virtual void                                encodeData(const std::uint8_t *data, std::size_t size, CipherBuffer& dest) = 0;
+    virtual void                                decodeData(const std::uint8_t *data, std::size_t size, CipherBuffer& dest) = 0;
+
+    /**
+     * Decodes data into an internal buffer which is reused between calls.
+     * The returned view is valid until the next call.
+     */
+    virtual ByteArrayView                       decodeDataToBuffer(const std::uint8_t *data, std::size_t size) = 0;
     virtual Signature                           signData(const std::uint8_t *data, std::size_t size) = 0;
     virtual bool                                verifySignature(const std::uint8_t *data, std::size_t len, const std::uint8_t *sig, std::size_t sigLen) = 0;
 };
@@ -20,13 +20,25 @@
 #include "kaa/security/KeyUtils.hpp"
 #include "kaa/security/IEncoderDecoder.hpp"
 #include "kaa/IKaaClientContext.hpp"
+#include "kaa/KaaThread.hpp"
 #include <botan/rsa.h>
+#include <botan/pubkey.h>
 #include <botan/cipher_mode.h>
 #include <cstdint>
 #include <memory>
 
 namespace kaa {
 
+/**
+ * Encrypts data with the AES session key and signs/verifies it with the RSA keys.
+ *
+ * The cipher, signer and verifier objects are created once and live as long as the session does.
+ * Each of them is guarded by its own lock, so encoding, decoding, signing and verification
+ * may be done concurrently.
+ *
+ * The session key is fixed for the object lifetime, so it is RSA-encrypted and signed only once,
+ * at the first request. Every request of the session reuses the result.
+ */
 class RsaEncoderDecoder : public IEncoderDecoder {
 public:
     RsaEncoderDecoder(const PublicKey& pubKey,
@@ -36,13 +48,18 @@ public:
     ~RsaEncoderDecoder() { }
 
     virtual EncodedSessionKey getEncodedSessionKey();
+    virtual Signature getSessionKeySignature();
     virtual std::string encodeData(const std::uint8_t *data, std::size_t size);
     virtual std::string decodeData(const std::uint8_t *data, std::size_t size);
+    virtual void encodeData(const std::uint8_t *data, std::size_t size, CipherBuffer& dest);
+    virtual void decodeData(const std::uint8_t *data, std::size_t size, CipherBuffer& dest);
+    virtual ByteArrayView decodeDataToBuffer(const std::uint8_t *data, std::size_t size);
     virtual Signature signData(const std::uint8_t *data, std::size_t size);
     virtual bool verifySignature(const std::uint8_t *data, std::size_t len, const std::uint8_t *sig, std::size_t sigLen);
 
 private:
-    std::string cipherPipe(const std::uint8_t *data, std::size_t size, Botan::Cipher_Dir dir);
+    const EncodedSessionKey& encodeSessionKey();
+    static void processData(Botan::Cipher_Mode& cipher, const std::uint8_t *data, std::size_t size, CipherBuffer& dest);
 
 private:
     Botan::AutoSeeded_RNG rng_;
@@ -52,6 +69,24 @@ private:
 
     SessionKey sessionKey_;
 
+    EncodedSessionKey                      encodedSessionKey_;
+    Signature                              sessionKeySignature_;
+    KAA_MUTEX_DECLARE(sessionKeyGuard_);
+
+    std::unique_ptr<Botan::Cipher_Mode>    encryptor_;
+    CipherBuffer                           encodeBuffer_;
+    KAA_MUTEX_DECLARE(encryptorGuard_);
+
+    std::unique_ptr<Botan::Cipher_Mode>    decryptor_;
+    CipherBuffer                           decodeBuffer_;
+    KAA_MUTEX_DECLARE(decryptorGuard_);
+
+    std::unique_ptr<Botan::PK_Signer>      signer_;
+    KAA_MUTEX_DECLARE(signerGuard_);
+
+    std::unique_ptr<Botan::PK_Verifier>    verifier_;
+    KAA_MUTEX_DECLARE(verifierGuard_);
+
     IKaaClientContext &context_;
 };
 
@@ -30,6 +30,8 @@ typedef Botan::secure_vector<std::uint8_t> EncodedSessionKey;
 
 typedef Botan::secure_vector<std::uint8_t> Signature;
 
+typedef Botan::secure_vector<std::uint8_t> CipherBuffer;
+
 class KeyPair
 {
 public:
@@ -0,0 +1,147 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef BOUNDEDQUEUE_HPP_
+#define BOUNDEDQUEUE_HPP_
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace kaa {
+
+/**
+ * @brief Bounded lock-free multi-producer multi-consumer queue.
+ *
+ * Each cell has a sequence number telling whether the cell is ready to be written or read at the given
+ * position, so producers and consumers only need a single CAS on the position counter.
+ * The capacity is rounded up to a power of two.
+ */
+template<class T>
+class BoundedQueue {
+public:
+    BoundedQueue(std::size_t capacity) : capacity_(1), enqueuePosition_(0), dequeuePosition_(0)
+    {
+        while (capacity_ < capacity) {
+            capacity_ <<= 1;
+        }
+
+        cells_.reset(new Cell[capacity_]);
+        for (std::size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence_.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @return False if the queue is full.
+     */
+    bool push(const T& value)
+    {
+        T copy(value);
+        return push(std::move(copy));
+    }
+
+    /**
+     * @return False if the queue is full, the value isn't moved from then.
+     */
+    bool push(T&& value)
+    {
+        Cell *cell = nullptr;
+        std::size_t position = enqueuePosition_.load(std::memory_order_relaxed);
+
+        for (;;) {
+            cell = &cells_[position & (capacity_ - 1)];
+            std::size_t sequence = cell->sequence_.load(std::memory_order_acquire);
+            std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+
+            if (!difference) {
+                if (enqueuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = enqueuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value_ = std::move(value);
+        cell->sequence_.store(position + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * @return False if the queue is empty.
+     */
+    bool pop(T& value)
+    {
+        Cell *cell = nullptr;
+        std::size_t position = dequeuePosition_.load(std::memory_order_relaxed);
+
+        for (;;) {
+            cell = &cells_[position & (capacity_ - 1)];
+            std::size_t sequence = cell->sequence_.load(std::memory_order_acquire);
+            std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+
+            if (!difference) {
+                if (dequeuePosition_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false;
+            } else {
+                position = dequeuePosition_.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->value_);
+        cell->value_ = T();
+        cell->sequence_.store(position + capacity_, std::memory_order_release);
+
+        return true;
+    }
+
+    std::size_t getCapacity() const
+    {
+        return capacity_;
+    }
+
+private:
+    static const std::size_t CACHE_LINE_SIZE = 64;
+
+    struct Cell {
+        std::atomic_size_t    sequence_;
+        T                     value_;
+    };
+
+    std::size_t                capacity_;
+    std::unique_ptr<Cell[]>    cells_;
+
+    /*
+     * Producers and consumers update different counters, keep them in different cache lines.
+     */
+    char                  enqueuePadding_[CACHE_LINE_SIZE];
+    std::atomic_size_t    enqueuePosition_;
+    char                  dequeuePadding_[CACHE_LINE_SIZE];
+    std::atomic_size_t    dequeuePosition_;
+};
+
+} /* namespace kaa */
+
+#endif /* BOUNDEDQUEUE_HPP_ */
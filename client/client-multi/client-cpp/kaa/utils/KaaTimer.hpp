@@ -18,6 +18,7 @@
 #define KAATIMER_HPP_
 
 #include <chrono>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <functional>
@@ -25,16 +26,22 @@
 
 #include "kaa/KaaThread.hpp"
 #include "kaa/logging/Log.hpp"
+#include "kaa/utils/TimerWheel.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 
 namespace kaa {
 
+/**
+ * @brief One-shot timer.
+ *
+ * Timers don't own threads, all of them are registered with the process-wide @c TimerWheel.
+ * Callbacks are executed on the timer wheel dispatcher threads.
+ */
 template<class Signature, class Function = std::function<Signature>>
 class KaaTimer {
-    typedef std::chrono::system_clock TimerClock;
 public:
     KaaTimer(const std::string& timerName) :
-        timerName_(timerName), isThreadRun_(false), isTimerRun_(false), callback_([]{})
+        timerName_(timerName), timerWheel_(TimerWheel::getInstance()), state_(std::make_shared<TimerState>())
     {
     }
 
@@ -43,89 +50,116 @@ public:
         /*
          * Do not add the mutex logging it may cause crashes.
          */
-        if (isThreadRun_ && timerThread_.joinable()) {
-            std::unique_lock<std::mutex> timerLock(timerGuard_);
+        std::unique_lock<std::mutex> timerLock(state_->timerGuard_);
 
-            isThreadRun_ = false;
-            condition_.notify_one();
+        state_->isAlive_ = false;
 
-            timerLock.unlock();
+        if (state_->timerId_ != TimerWheel::INVALID_TIMER_ID) {
+            timerWheel_.cancel(state_->timerId_);
+            state_->timerId_ = TimerWheel::INVALID_TIMER_ID;
+        }
 
-            timerThread_.join();
+        /*
+         * Wait for the callback which is being executed, unless the timer is destroyed from within it.
+         */
+        while (state_->isCallbackRun_ && state_->callbackThreadId_ != std::this_thread::get_id()) {
+            state_->onCallbackComplete_.wait(timerLock);
         }
     }
 
     void start(std::size_t seconds, const Function& callback)
+    {
+        start(std::chrono::seconds(seconds), callback);
+    }
+
+    void start(std::chrono::milliseconds timeout, const Function& callback)
     {
         if (!callback) {
             throw KaaException("Bad timer callback");
         }
-        std::unique_lock<std::mutex> timerLock(timerGuard_);
+        std::unique_lock<std::mutex> timerLock(state_->timerGuard_);
 
-        if (!isThreadRun_) {
-            isThreadRun_ = true;
-            timerThread_ = std::thread([&] { run(); });
-        }
+        if (!state_->isTimerRun_) {
+            state_->isTimerRun_ = true;
+            state_->callback_ = callback;
+
+            std::weak_ptr<TimerState> weakState = state_;
+            std::size_t generation = ++state_->generation_;
 
-        if (!isTimerRun_) {
-            endTS_ = TimerClock::now() + std::chrono::seconds(seconds);
-            isTimerRun_ = true;
-            callback_ = callback;
-            condition_.notify_one();
+            state_->timerId_ = timerWheel_.schedule(timeout, [weakState, generation] { onExpire(weakState, generation); });
         }
     }
 
     void stop()
     {
-        std::unique_lock<std::mutex> timerLock(timerGuard_);
+        std::unique_lock<std::mutex> timerLock(state_->timerGuard_);
 
-        if (isTimerRun_) {
-            isTimerRun_ = false;
-            condition_.notify_one();
+        if (state_->isTimerRun_) {
+            state_->isTimerRun_ = false;
+            timerWheel_.cancel(state_->timerId_);
+            state_->timerId_ = TimerWheel::INVALID_TIMER_ID;
         }
     }
 
 private:
-    void run()
-    {
-        std::unique_lock<std::mutex> timerLock(timerGuard_);
+    struct TimerState {
+        bool isAlive_ = true;
+        bool isTimerRun_ = false;
+        bool isCallbackRun_ = false;
 
-        while (isThreadRun_) {
-            if (isTimerRun_) {
-                auto now = TimerClock::now();
-                if (now >= endTS_) {
-                    isTimerRun_ = false;
+        std::size_t generation_ = 0;
+        TimerWheel::TimerId timerId_ = TimerWheel::INVALID_TIMER_ID;
 
-                    auto currentCallback = callback_;
+        std::thread::id callbackThreadId_;
 
-                    timerLock.unlock();
+        std::mutex timerGuard_;
+        std::condition_variable onCallbackComplete_;
 
-                    currentCallback();
+        Function callback_;
+    };
 
-                    timerLock.lock();
-                } else {
-                    condition_.wait_for(timerLock, (endTS_ - now));
-                }
-            } else {
-                condition_.wait(timerLock);
-            }
+    static void onExpire(const std::weak_ptr<TimerState>& weakState, std::size_t generation)
+    {
+        auto state = weakState.lock();
+        if (!state) {
+            return;
         }
-    }
 
-private:
-    const std::string timerName_;
+        std::unique_lock<std::mutex> timerLock(state->timerGuard_);
+
+        /*
+         * The timer may have been stopped and restarted while the expired callback was queued.
+         */
+        if (!state->isAlive_ || !state->isTimerRun_ || state->generation_ != generation) {
+            return;
+        }
+
+        state->isTimerRun_ = false;
+        state->isCallbackRun_ = true;
+        state->timerId_ = TimerWheel::INVALID_TIMER_ID;
+        state->callbackThreadId_ = std::this_thread::get_id();
 
-    bool isThreadRun_;
-    bool isTimerRun_;
+        auto currentCallback = state->callback_;
 
-    std::thread timerThread_;
-    std::condition_variable condition_;
+        timerLock.unlock();
 
-    std::mutex timerGuard_;
+        try {
+            currentCallback();
+        } catch (...) {}
+
+        timerLock.lock();
+
+        state->isCallbackRun_ = false;
+        state->callbackThreadId_ = std::thread::id();
+        state->onCallbackComplete_.notify_all();
+    }
+
+private:
+    const std::string timerName_;
 
-    std::chrono::time_point<TimerClock> endTS_;
+    TimerWheel& timerWheel_;
 
-    Function callback_;
+    std::shared_ptr<TimerState> state_;
 };
 
 } /* namespace kaa */
@@ -48,6 +48,7 @@ public:
 private:
     void start();
     void stop(bool force);
+    void interrupt();
 
 private:
     bool isRun_ = true;
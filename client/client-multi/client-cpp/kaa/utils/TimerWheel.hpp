@@ -0,0 +1,179 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef TIMERWHEEL_HPP_
+#define TIMERWHEEL_HPP_
+
+#include <list>
+#include <array>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <condition_variable>
+
+namespace kaa {
+
+typedef std::function<void()> TimerCallback;
+
+/**
+ * @brief Hierarchical timer wheel shared by all SDK timers.
+ *
+ * Timeouts are rounded up to @link TICK_DURATION_MS @endlink and are kept in @link LEVEL_COUNT @endlink
+ * wheels of @link SLOT_COUNT @endlink slots each, so scheduling and cancellation cost O(1) regardless of
+ * the number of pending timers.
+ *
+ * The wheel is driven by a single timer thread. Expired callbacks are handed over to a fixed number of
+ * dispatcher threads. The number of threads doesn't depend on the number of timers or @c KaaClient
+ * instances, so callbacks must not block: a callback which waits for the network or for other threads
+ * delays every other timer and should post its work to an executor instead. Threads are started on the
+ * first @link schedule() @endlink call.
+ *
+ * The wheel may be destroyed from one of its own callbacks. The dispatcher thread is detached then
+ * and exits once the callback returns.
+ */
+class TimerWheel {
+public:
+    typedef std::uint64_t TimerId;
+
+    static const TimerId INVALID_TIMER_ID = 0;
+
+    static const std::size_t TICK_DURATION_MS = 10;
+    static const std::size_t SLOT_BITS = 6;
+    static const std::size_t SLOT_COUNT = 1 << SLOT_BITS;
+    static const std::size_t LEVEL_COUNT = 4;
+
+    static const std::size_t DEFAULT_DISPATCHER_COUNT = 2;
+
+public:
+    /**
+     * @brief Creates a standalone timer wheel.
+     *
+     * SDK timers use the process-wide instance returned by @link getInstance() @endlink.
+     *
+     * @param dispatcherCount The number of threads callbacks are executed on.
+     */
+    TimerWheel(std::size_t dispatcherCount = DEFAULT_DISPATCHER_COUNT);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    /**
+     * @brief Returns the process-wide timer wheel.
+     *
+     * The instance is never destroyed, so it outlives timers of static and global objects.
+     */
+    static TimerWheel& getInstance();
+
+    /**
+     * @brief Schedules a one-shot callback.
+     *
+     * @param delay       The time after which the callback is executed.
+     * @param callback    The callback.
+     * @return The id to cancel the timer with.
+     *
+     * @throw KaaException The callback is empty.
+     */
+    TimerId schedule(std::chrono::milliseconds delay, const TimerCallback& callback);
+
+    /**
+     * @brief Cancels a pending timer.
+     *
+     * @return @c true if the timer was pending, @c false if it has already expired or has been cancelled.
+     */
+    bool cancel(TimerId timerId);
+
+    /**
+     * @brief Returns the number of timers which haven't expired yet.
+     */
+    std::size_t getPendingTimerCount();
+
+    /**
+     * @brief Returns the number of threads owned by the wheel.
+     */
+    std::size_t getThreadCount();
+
+private:
+    struct TimerEntry {
+        TimerId          id_;
+        std::uint64_t    expiryTick_;
+        TimerCallback    callback_;
+    };
+
+    typedef std::list<TimerEntry> TimerSlot;
+
+    /*
+     * The part of the wheel dispatcher threads work with. It is shared with them,
+     * so a detached dispatcher can finish after the wheel is destroyed.
+     */
+    struct DispatcherState {
+        bool isRun_ = false;
+
+        std::deque<TimerCallback>    expiredCallbacks_;
+
+        std::mutex                 wheelGuard_;
+        std::condition_variable    onExpiredCallback_;
+    };
+
+    struct TimerLocation {
+        std::size_t             level_;
+        std::size_t             slot_;
+        TimerSlot::iterator     entry_;
+    };
+
+private:
+    void startThreads();
+    void stopThreads();
+
+    void runTimer();
+    static void runDispatcher(const std::shared_ptr<DispatcherState>& state);
+
+    std::uint64_t getCurrentTick() const;
+    std::uint64_t toTick(std::chrono::steady_clock::time_point timePoint, bool isRoundUp) const;
+
+    void place(TimerSlot& source, TimerSlot::iterator entry);
+    void cascade(std::size_t level);
+    void processTick();
+    std::uint64_t getNextWakeupTick() const;
+
+private:
+    const std::size_t    dispatcherCount_;
+
+    const std::chrono::steady_clock::time_point    startTime_;
+
+    std::uint64_t    currentTick_ = 0;
+    TimerId          lastTimerId_ = INVALID_TIMER_ID;
+
+    std::array<std::array<TimerSlot, SLOT_COUNT>, LEVEL_COUNT>    wheel_;
+    std::unordered_map<TimerId, TimerLocation>                      timers_;
+
+    std::shared_ptr<DispatcherState>    state_;
+
+    std::thread                 timerThread_;
+    std::vector<std::thread>    dispatcherThreads_;
+
+    std::condition_variable    onWheelChange_;
+};
+
+} /* namespace kaa */
+
+#endif /* TIMERWHEEL_HPP_ */
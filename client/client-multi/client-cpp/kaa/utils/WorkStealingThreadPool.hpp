@@ -0,0 +1,104 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef WORKSTEALINGTHREADPOOL_HPP_
+#define WORKSTEALINGTHREADPOOL_HPP_
+
+#include <list>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "kaa/KaaThread.hpp"
+#include "kaa/utils/KaaTimer.hpp"
+#include "kaa/utils/IThreadPool.hpp"
+#include "kaa/utils/BoundedQueue.hpp"
+
+namespace kaa {
+
+typedef BoundedQueue<ThreadPoolTask> TaskQueue;
+
+/**
+ * @brief Thread pool with a lock-free task queue per worker.
+ *
+ * Tasks added from outside the pool are distributed among worker queues in a round-robin manner, tasks added
+ * by a worker go to its own queue. A worker that runs out of tasks steals them from queues of other workers.
+ * Adding and taking tasks doesn't take any lock, the lock is used only to put idle workers to sleep and to
+ * wake them up.
+ *
+ * Tasks from a single queue are executed in the order they were added, so a pool with one worker behaves
+ * exactly as @c ThreadPool with one worker.
+ */
+class WorkStealingThreadPool : public IThreadPool {
+    friend class StealingWorker;
+
+public:
+    WorkStealingThreadPool(std::size_t workerCount = DEFAULT_WORKER_NUMBER,
+                           std::size_t queueCapacity = DEFAULT_QUEUE_CAPACITY);
+    ~WorkStealingThreadPool();
+
+    virtual void add(const ThreadPoolTask& task);
+
+    virtual void awaitTermination(std::size_t seconds);
+
+    virtual void shutdown();
+    virtual void shutdownNow();
+
+public:
+    static const std::size_t DEFAULT_WORKER_NUMBER = 1;
+
+    /**
+     * The capacity of each worker queue. Tasks which don't fit in any queue are kept in an overflow list.
+     */
+    static const std::size_t DEFAULT_QUEUE_CAPACITY = 1024;
+
+private:
+    void start();
+    void stop(bool force);
+    void interrupt();
+
+    bool takeTask(std::size_t workerIndex, ThreadPoolTask& task);
+    void onTaskAdded();
+
+private:
+    const std::size_t    workerCount_;
+
+    std::vector<std::unique_ptr<TaskQueue>>    queues_;
+
+    std::atomic_bool             isStarted_;
+    std::atomic_bool             isRun_;
+    std::atomic_bool             isPendingShutdown_;
+
+    std::atomic<std::int64_t>    pendingTaskCount_;
+    std::atomic_size_t           idleWorkerCount_;
+    std::atomic_size_t           nextQueueIndex_;
+
+    std::list<std::thread>    workers_;
+
+    std::list<ThreadPoolTask>    overflowTasks_;
+    std::atomic_size_t           overflowTaskCount_;
+
+    KAA_MUTEX_DECLARE(threadPoolGuard_);
+    KAA_CONDITION_VARIABLE    onNewTask_;
+
+    std::unique_ptr<KaaTimer<void()>>    shutdownTimer_;
+};
+
+} /* namespace kaa */
+
+#endif /* WORKSTEALINGTHREADPOOL_HPP_ */
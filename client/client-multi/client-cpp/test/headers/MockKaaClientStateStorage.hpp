@@ -93,6 +93,7 @@ public:
 
     virtual void read() {}
     virtual void save() {}
+    virtual void flush() {}
 
 public:
     std::int32_t eventSequenceNumber_ = 0;
@@ -48,6 +48,10 @@ public:
         return channel;
     }
 
+    virtual void sync(TransportType type) {
+        getChannelByTransportType(type)->sync(type);
+    }
+
     virtual void onTransportConnectionInfoUpdated(ITransportConnectionInfoPtr server) { ++onGetChannelByTransportType_; }
     virtual void onServerFailed(ITransportConnectionInfoPtr server) { ++onServerFailed_; }
     virtual void setFailoverStrategy(IFailoverStrategyPtr strategy) { ++onFailOverStrategyChange_;}
@@ -28,6 +28,11 @@ namespace kaa {
 class MockLogStorage: public ILogStorage {
 public:
     virtual BucketInfo addLogRecord(LogRecord&& record) { ++onAddLogRecord_;  return bucketInfo_;  }
+    virtual void addLogRecords(std::list<LogRecord>& records, std::vector<BucketInfo>& bucketInfos)
+    {
+        ++onAddLogRecords_;
+        ILogStorage::addLogRecords(records, bucketInfos);
+    }
     virtual ILogStorageStatus& getStatus() { ++onGetStatus_; return storageStatus_; }
     virtual LogBucket getNextBucket() { ++onGetRecordBucket_; return recordPack_; }
     virtual void removeBucket(std::int32_t bucketId) { ++onRemoveBucket_; }
@@ -39,6 +44,7 @@ public:
     MockLogStorageStatus storageStatus_;
 
     std::size_t onAddLogRecord_ = 0;
+    std::size_t onAddLogRecords_ = 0;
     std::size_t onGetStatus_ = 0;
     std::size_t onGetRecordBucket_ = 0;
     std::size_t onRemoveBucket_ = 0;
@@ -0,0 +1,40 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef MOCKPROFILECONTAINER_HPP_
+#define MOCKPROFILECONTAINER_HPP_
+
+#include <cstddef>
+
+#include "kaa/profile/IProfileContainer.hpp"
+
+namespace kaa {
+
+class MockProfileContainer: public IProfileContainer {
+public:
+    virtual KaaProfile getProfile() {
+        ++onGetProfile_;
+        return profile_;
+    }
+
+public:
+    KaaProfile profile_;
+    std::size_t onGetProfile_ = 0;
+};
+
+} /* namespace kaa */
+
+#endif /* MOCKPROFILECONTAINER_HPP_ */
@@ -44,6 +44,10 @@ public:
         data_.assign(reinterpret_cast<const char *>(data), size);
         return data_;
     }
+    void encodeData(const std::uint8_t *data, size_t size, CipherBuffer& dest) {
+        data_.assign(reinterpret_cast<const char *>(data), size);
+        dest.assign(data, data + size);
+    }
     void setEncodeData(const std::string& data) {
         data_ = data;
     }
@@ -52,10 +56,22 @@ public:
         data_.assign(reinterpret_cast<const char *>(data), size);
         return data_;
     }
+    void decodeData(const std::uint8_t *data, size_t size, CipherBuffer& dest) {
+        data_.assign(reinterpret_cast<const char *>(data), size);
+        dest.assign(data, data + size);
+    }
+    ByteArrayView decodeDataToBuffer(const std::uint8_t *data, size_t size) {
+        data_.assign(reinterpret_cast<const char *>(data), size);
+        return ByteArrayView(data_);
+    }
     void setDecodeData(const std::string& data) {
         data_ = data;
     }
 
+    Signature getSessionKeySignature() {
+        return signData_;
+    }
+
     Signature signData(const std::uint8_t *data, size_t size) {
         return signData_;
     }
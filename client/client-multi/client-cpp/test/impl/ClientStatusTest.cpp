@@ -26,6 +26,8 @@
 #include "headers/MockKaaClientStateStorage.hpp"
 
 #include <map>
+#include <chrono>
+#include <thread>
 #include <cstdlib>
 #include <fstream>
 #include <sstream>
@@ -171,6 +173,176 @@ BOOST_AUTO_TEST_CASE(checkSetAndSaveParameters)
     cleanfile();
 }
 
+static std::string readStateFile()
+{
+    std::ifstream stateFile(std::string(directory) + "/" + filename, std::ios::binary);
+    std::stringstream content;
+    content << stateFile.rdbuf();
+    return content.str();
+}
+
+BOOST_AUTO_TEST_CASE(checkTextStateMigration)
+{
+    cleanfile();
+    {
+        std::ofstream stateFile(std::string(directory) + "/" + filename);
+        stateFile << "topic_states=1 5 2 7 " << std::endl
+                  << "app_seq_number=42" << std::endl
+                  << "topic_list=[1,6e 61 6d 65 31,m],[2,6e 61 6d 65 32,v]" << std::endl
+                  << "profile_hash=0102030405" << std::endl
+                  << "ep_key_hash=thisEndpointKeyHash" << std::endl;
+    }
+
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    properties.setStateFileName(filename);
+    properties.setWorkingDirectoryPath(directory);
+    KaaClientContext clientContext(properties, tmp_logger, context, stateMock);
+
+    auto checkState = [] (ClientStatus& cs)
+        {
+            BOOST_CHECK_EQUAL(cs.getEventSequenceNumber(), 42);
+            BOOST_CHECK_EQUAL(cs.getEndpointKeyHash(), "thisEndpointKeyHash");
+
+            auto topicStates = cs.getTopicStates();
+            BOOST_CHECK_EQUAL(topicStates.size(), 2);
+            BOOST_CHECK_EQUAL(topicStates[1], 5);
+            BOOST_CHECK_EQUAL(topicStates[2], 7);
+
+            auto topicList = cs.getTopicList();
+            BOOST_REQUIRE_EQUAL(topicList.size(), 2);
+            BOOST_CHECK_EQUAL(topicList[0].id, 1);
+            BOOST_CHECK_EQUAL(topicList[0].name, "name1");
+            BOOST_CHECK_EQUAL(topicList[0].subscriptionType, SubscriptionType::MANDATORY_SUBSCRIPTION);
+            BOOST_CHECK_EQUAL(topicList[1].id, 2);
+            BOOST_CHECK_EQUAL(topicList[1].name, "name2");
+            BOOST_CHECK_EQUAL(topicList[1].subscriptionType, SubscriptionType::OPTIONAL_SUBSCRIPTION);
+
+            HashDigest expectedHash = { 1, 2, 3, 4, 5 };
+            auto profileHash = cs.getProfileHash();
+            BOOST_CHECK_EQUAL_COLLECTIONS(profileHash.begin(), profileHash.end(), expectedHash.begin(), expectedHash.end());
+        };
+
+    {
+        ClientStatus cs(clientContext);
+        checkState(cs);
+        cs.save();
+    }
+
+    BOOST_CHECK_EQUAL(readStateFile().compare(0, 4, "KAAS"), 0);
+
+    ClientStatus cs_restored(clientContext);
+    checkState(cs_restored);
+
+    cleanfile();
+}
+
+BOOST_AUTO_TEST_CASE(checkCorruptedBinaryState)
+{
+    cleanfile();
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    properties.setStateFileName(filename);
+    properties.setWorkingDirectoryPath(directory);
+    KaaClientContext clientContext(properties, tmp_logger, context, stateMock);
+
+    {
+        ClientStatus cs(clientContext);
+        cs.setEventSequenceNumber(42);
+        cs.setEndpointKeyHash("thisEndpointKeyHash");
+        cs.save();
+    }
+
+    std::string state = readStateFile();
+    {
+        std::ofstream stateFile(std::string(directory) + "/" + filename, std::ios::binary | std::ios::trunc);
+        stateFile.write(state.data(), state.size() - 3);
+    }
+
+    /*
+     * The truncated record is ignored, the preceding ones are read.
+     */
+    ClientStatus cs_restored(clientContext);
+    BOOST_CHECK_EQUAL(cs_restored.getEventSequenceNumber(), 42);
+
+    cleanfile();
+}
+
+BOOST_AUTO_TEST_CASE(checkSaveCoalescing)
+{
+    cleanfile();
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    properties.setStateFileName(filename);
+    properties.setWorkingDirectoryPath(directory);
+
+    /*
+     * The period is long enough for the postponed write never to happen within the test.
+     */
+    properties.setStateSavePeriod(3600 * 1000);
+    KaaClientContext clientContext(properties, tmp_logger, context, stateMock);
+
+    auto readKeyHash = [&clientContext] () { return ClientStatus(clientContext).getEndpointKeyHash(); };
+
+    {
+        ClientStatus cs(clientContext);
+
+        cs.setEndpointKeyHash("first");
+        cs.save();
+        BOOST_CHECK_EQUAL(readKeyHash(), "first");
+
+        cs.setEndpointKeyHash("second");
+        cs.save();
+        BOOST_CHECK_EQUAL(readKeyHash(), "first");
+
+        cs.flush();
+        BOOST_CHECK_EQUAL(readKeyHash(), "second");
+
+        cs.setEndpointKeyHash("third");
+        cs.save();
+        BOOST_CHECK_EQUAL(readKeyHash(), "second");
+
+        cs.setEndpointKeyHash("fourth");
+    }
+
+    /*
+     * The postponed write is completed on destruction, unsaved changes are not.
+     */
+    BOOST_CHECK_EQUAL(readKeyHash(), "third");
+
+    properties.setStateSavePeriod(0);
+    cleanfile();
+}
+
+BOOST_AUTO_TEST_CASE(checkPostponedSave)
+{
+    cleanfile();
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    properties.setStateFileName(filename);
+    properties.setWorkingDirectoryPath(directory);
+    properties.setStateSavePeriod(50);
+    KaaClientContext clientContext(properties, tmp_logger, context, stateMock);
+
+    auto readKeyHash = [&clientContext] () { return ClientStatus(clientContext).getEndpointKeyHash(); };
+
+    ClientStatus cs(clientContext);
+
+    cs.setEndpointKeyHash("first");
+    cs.save();
+    cs.setEndpointKeyHash("second");
+    cs.save();
+
+    /*
+     * Wait for the timer instead of sleeping for a fixed time, so a loaded machine can't fail the test.
+     */
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (readKeyHash() != "second" && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    BOOST_CHECK_EQUAL(readKeyHash(), "second");
+
+    properties.setStateSavePeriod(0);
+    cleanfile();
+}
+
 }  // namespace kaa
 
 BOOST_AUTO_TEST_SUITE_END()
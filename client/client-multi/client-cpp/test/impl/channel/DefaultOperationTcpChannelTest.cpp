@@ -0,0 +1,376 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/asio/detail/socket_ops.hpp>
+
+#include <botan/botan.h>
+#include <botan/pkcs8.h>
+#include <botan/pubkey.h>
+
+#include <zlib.h>
+
+#include "kaa/channel/impl/DefaultOperationTcpChannel.hpp"
+#include "kaa/channel/IKaaDataMultiplexer.hpp"
+#include "kaa/channel/IKaaDataDemultiplexer.hpp"
+#include "kaa/channel/GenericTransportInfo.hpp"
+#include "kaa/channel/TransportProtocolIdConstants.hpp"
+#include "kaa/kaatcp/KaaTcpCommon.hpp"
+#include "kaa/kaatcp/ConnackMessage.hpp"
+#include "kaa/kaatcp/KaaSyncRequest.hpp"
+#include "kaa/security/KeyUtils.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+
+#include "headers/channel/MockChannelManager.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+#include "headers/MockKaaClientStateStorage.hpp"
+
+namespace kaa {
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+static MockExecutorContext tmpExecContext;
+static KaaClientContext clientContext(properties, tmp_logger, tmpExecContext, tmp_state);
+
+static const std::size_t KEY_LENGTH = 2048;
+static const char * const SESSION_CIPHER = "AES-128/ECB/PKCS7";
+static const std::size_t MAX_PAYLOAD_SIZE = 64 * 1024;
+static const std::chrono::seconds WAIT_TIMEOUT(30);
+
+static std::vector<std::uint8_t> createPayload(const std::string& text, std::size_t size)
+{
+    std::vector<std::uint8_t> payload(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        payload[i] = text[i % text.size()];
+    }
+    return payload;
+}
+
+static std::vector<std::uint8_t> serializeConnectionInfo(const PublicKey& publicKey, const std::string& host, std::int32_t port)
+{
+    std::vector<std::uint8_t> serializedData(3 * sizeof(std::int32_t) + publicKey.size() + host.size());
+    auto *data = serializedData.data();
+
+    std::int32_t networkOrder32 = boost::asio::detail::socket_ops::host_to_network_long(publicKey.size());
+    std::memcpy(data, &networkOrder32, sizeof(std::int32_t));
+    data += sizeof(std::int32_t);
+    std::memcpy(data, publicKey.data(), publicKey.size());
+    data += publicKey.size();
+
+    networkOrder32 = boost::asio::detail::socket_ops::host_to_network_long(host.size());
+    std::memcpy(data, &networkOrder32, sizeof(std::int32_t));
+    data += sizeof(std::int32_t);
+    std::memcpy(data, host.data(), host.size());
+    data += host.size();
+
+    networkOrder32 = boost::asio::detail::socket_ops::host_to_network_long(port);
+    std::memcpy(data, &networkOrder32, sizeof(std::int32_t));
+
+    return serializedData;
+}
+
+class TestMultiplexer : public IKaaDataMultiplexer {
+public:
+    TestMultiplexer(const std::vector<std::uint8_t>& request) : request_(request) {}
+
+    virtual std::vector<std::uint8_t> compileRequest(const std::map<TransportType, ChannelDirection>& transportTypes)
+    {
+        return request_;
+    }
+
+private:
+    const std::vector<std::uint8_t> request_;
+};
+
+class TestDemultiplexer : public IKaaDataDemultiplexer {
+public:
+    virtual DemultiplexerReturnCode processResponse(const ByteArrayView& response)
+    {
+        std::lock_guard<std::mutex> lock(guard_);
+        responses_.emplace_back(response.begin(), response.end());
+        onResponse_.notify_all();
+        return DemultiplexerReturnCode::SUCCESS;
+    }
+
+    bool waitForResponses(std::size_t count)
+    {
+        std::unique_lock<std::mutex> lock(guard_);
+        return onResponse_.wait_for(lock, WAIT_TIMEOUT, [this, count] { return responses_.size() >= count; });
+    }
+
+    std::vector<std::vector<std::uint8_t>> getResponses()
+    {
+        std::lock_guard<std::mutex> lock(guard_);
+        return responses_;
+    }
+
+private:
+    std::mutex guard_;
+    std::condition_variable onResponse_;
+    std::vector<std::vector<std::uint8_t>> responses_;
+};
+
+/*
+ * Stand-in Kaa TCP server. Serves a single connection: accepts CONNECT with a CONNACK which enables
+ * compression and the first KAASYNC response, then answers one KAASYNC request with a compressed response.
+ */
+class TestKaaTcpServer {
+public:
+    TestKaaTcpServer(const KeyPair& serverKeys, const std::vector<std::uint8_t>& firstResponse,
+                     const std::vector<std::uint8_t>& syncResponse)
+        : acceptor_(io_, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0))
+        , socket_(io_), serverKeys_(serverKeys), firstResponse_(firstResponse), syncResponse_(syncResponse)
+        , isSyncRequestZipped_(false)
+    {
+        serverThread_ = std::thread([this] () { serve(); });
+    }
+
+    ~TestKaaTcpServer()
+    {
+        /*
+         * Wakes up the blocked accept() if the client never connected.
+         */
+        boost::system::error_code errorCode;
+        boost::asio::ip::tcp::socket waker(io_);
+        waker.connect(acceptor_.local_endpoint(), errorCode);
+
+        socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, errorCode);
+        serverThread_.join();
+    }
+
+    std::uint16_t getPort() const { return acceptor_.local_endpoint().port(); }
+
+    bool waitForSyncRequest(std::vector<std::uint8_t>& request, bool& isZipped)
+    {
+        std::unique_lock<std::mutex> lock(guard_);
+        if (!onSyncRequest_.wait_for(lock, WAIT_TIMEOUT, [this] { return !syncRequest_.empty(); })) {
+            return false;
+        }
+        request = syncRequest_;
+        isZipped = isSyncRequestZipped_;
+        return true;
+    }
+
+private:
+    bool readFrame(std::uint8_t& type, std::vector<std::uint8_t>& body)
+    {
+        boost::system::error_code errorCode;
+        std::uint8_t byte = 0;
+        if (!boost::asio::read(socket_, boost::asio::buffer(&byte, 1), errorCode)) {
+            return false;
+        }
+        type = byte >> 4;
+
+        std::size_t length = 0;
+        std::size_t multiplier = 1;
+        do {
+            if (!boost::asio::read(socket_, boost::asio::buffer(&byte, 1), errorCode)) {
+                return false;
+            }
+            length += (byte & ~KaaTcpCommon::FIRST_BIT) * multiplier;
+            multiplier *= KaaTcpCommon::FIRST_BIT;
+        } while (byte & KaaTcpCommon::FIRST_BIT);
+
+        body.resize(length);
+        return !length || boost::asio::read(socket_, boost::asio::buffer(body), errorCode) == length;
+    }
+
+    Botan::secure_vector<std::uint8_t> processData(Botan::Cipher_Dir direction, const std::uint8_t *data, std::size_t size)
+    {
+        std::unique_ptr<Botan::Cipher_Mode> cipher(Botan::get_cipher_mode(SESSION_CIPHER, direction));
+        cipher->set_key(Botan::SymmetricKey(sessionKey_.data(), sessionKey_.size()));
+        Botan::secure_vector<std::uint8_t> buffer(data, data + size);
+        cipher->start();
+        cipher->finish(buffer);
+        return buffer;
+    }
+
+    void sendKaaSync(const std::vector<std::uint8_t>& payload, bool zipped)
+    {
+        std::vector<std::uint8_t> data(payload);
+        if (zipped) {
+            uLongf compressedSize = compressBound(payload.size());
+            data.resize(compressedSize);
+            if (compress(data.data(), &compressedSize, payload.data(), payload.size()) != Z_OK) {
+                return;
+            }
+            data.resize(compressedSize);
+        }
+
+        const auto& encrypted = processData(Botan::ENCRYPTION, data.data(), data.size());
+        std::vector<std::uint8_t> frame = KaaSyncRequest(zipped, true, 0, encrypted, KaaSyncMessageType::SYNC).getRawMessage();
+
+        /*
+         * Responses are KAASYNC frames without the request bit.
+         */
+        frame[frame.size() - encrypted.size() - 1] &= ~KaaTcpCommon::KAA_SYNC_REQUEST_BIT;
+
+        boost::system::error_code errorCode;
+        boost::asio::write(socket_, boost::asio::buffer(frame), errorCode);
+    }
+
+    void serve()
+    {
+        boost::system::error_code errorCode;
+        acceptor_.accept(socket_, errorCode);
+        if (errorCode) {
+            return;
+        }
+
+        std::uint8_t type = 0;
+        std::vector<std::uint8_t> body;
+        if (!readFrame(type, body) || type != static_cast<std::uint8_t>(KaaTcpMessageType::MESSAGE_CONNECT)) {
+            return;
+        }
+
+        /*
+         * The session key follows the variable header and is encrypted with the server public key.
+         */
+        Botan::AutoSeeded_RNG rng;
+        Botan::DataSource_Memory privateKeyMem(serverKeys_.getPrivateKey());
+        std::unique_ptr<Botan::Private_Key> privateKey(Botan::PKCS8::load_key(privateKeyMem, rng));
+        Botan::PK_Decryptor_EME decryptor(*privateKey, "EME-PKCS1-v1_5");
+        sessionKey_ = decryptor.decrypt(body.data() + KaaTcpCommon::KAA_CONNECT_HEADER_LENGTH, KEY_LENGTH / 8);
+
+        const std::uint8_t connack[] = { 0x20, 0x02, KaaTcpCommon::KAA_CONNACK_COMPRESSION_FLAG,
+                                         static_cast<std::uint8_t>(ConnackReturnCode::ACCEPTED) };
+        boost::asio::write(socket_, boost::asio::buffer(connack), errorCode);
+        sendKaaSync(firstResponse_, false);
+
+        while (readFrame(type, body)) {
+            if (type != static_cast<std::uint8_t>(KaaTcpMessageType::MESSAGE_KAASYNC)) {
+                continue;
+            }
+
+            const std::uint8_t flags = body[KaaTcpCommon::KAA_SYNC_HEADER_LENGTH - 1];
+            const auto& decrypted = processData(Botan::DECRYPTION, body.data() + KaaTcpCommon::KAA_SYNC_HEADER_LENGTH,
+                                                body.size() - KaaTcpCommon::KAA_SYNC_HEADER_LENGTH);
+
+            std::vector<std::uint8_t> request(decrypted.begin(), decrypted.end());
+            if (flags & KaaTcpCommon::KAA_SYNC_ZIPPED_BIT) {
+                uLongf inflatedSize = MAX_PAYLOAD_SIZE;
+                std::vector<std::uint8_t> inflated(inflatedSize);
+                if (uncompress(inflated.data(), &inflatedSize, request.data(), request.size()) == Z_OK) {
+                    inflated.resize(inflatedSize);
+                } else {
+                    inflated.clear();
+                }
+                request.swap(inflated);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(guard_);
+                syncRequest_ = request;
+                isSyncRequestZipped_ = flags & KaaTcpCommon::KAA_SYNC_ZIPPED_BIT;
+                onSyncRequest_.notify_all();
+            }
+
+            sendKaaSync(syncResponse_, true);
+            break;
+        }
+
+        /*
+         * Waits for the client to disconnect.
+         */
+        while (readFrame(type, body));
+    }
+
+private:
+    boost::asio::io_service io_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    boost::asio::ip::tcp::socket socket_;
+
+    const KeyPair serverKeys_;
+    const std::vector<std::uint8_t> firstResponse_;
+    const std::vector<std::uint8_t> syncResponse_;
+    Botan::secure_vector<std::uint8_t> sessionKey_;
+
+    std::mutex guard_;
+    std::condition_variable onSyncRequest_;
+    std::vector<std::uint8_t> syncRequest_;
+    bool isSyncRequestZipped_;
+
+    std::thread serverThread_;
+};
+
+BOOST_AUTO_TEST_SUITE(DefaultOperationTcpChannelTestSuite)
+
+BOOST_AUTO_TEST_CASE(CompressedKaaSyncTest)
+{
+    const KeyPair clientKeys = KeyUtils().generateKeyPair(KEY_LENGTH);
+    const KeyPair serverKeys = KeyUtils().generateKeyPair(KEY_LENGTH);
+
+    const auto& request = createPayload("compressible request ", 1024);
+    const auto& firstResponse = createPayload("first response ", 64);
+    const auto& syncResponse = createPayload("compressible response ", 2048);
+
+    TestKaaTcpServer server(serverKeys, firstResponse, syncResponse);
+    MockChannelManager channelManager;
+    TestMultiplexer multiplexer(request);
+    TestDemultiplexer demultiplexer;
+
+    DefaultOperationTcpChannel channel(&channelManager, clientKeys, clientContext);
+    channel.setMultiplexer(&multiplexer);
+    channel.setDemultiplexer(&demultiplexer);
+
+    ProtocolMetaData metaData;
+    metaData.accessPointId = 0x111;
+    metaData.protocolVersionInfo.id = TransportProtocolIdConstants::TCP_TRANSPORT_ID.getId();
+    metaData.protocolVersionInfo.version = TransportProtocolIdConstants::TCP_TRANSPORT_ID.getVersion();
+    metaData.connectionInfo = serializeConnectionInfo(serverKeys.getPublicKey(), "127.0.0.1", server.getPort());
+    channel.setServer(std::make_shared<GenericTransportInfo>(ServerType::OPERATIONS, metaData));
+
+    /*
+     * The CONNACK is processed before the first response, so compression is already negotiated here.
+     */
+    BOOST_REQUIRE(demultiplexer.waitForResponses(1));
+    channel.sync(TransportType::LOGGING);
+
+    std::vector<std::uint8_t> receivedRequest;
+    bool isZipped = false;
+    BOOST_REQUIRE(server.waitForSyncRequest(receivedRequest, isZipped));
+    BOOST_CHECK(isZipped);
+    BOOST_CHECK_EQUAL_COLLECTIONS(receivedRequest.begin(), receivedRequest.end(), request.begin(), request.end());
+
+    BOOST_REQUIRE(demultiplexer.waitForResponses(2));
+    const auto& responses = demultiplexer.getResponses();
+    BOOST_CHECK_EQUAL_COLLECTIONS(responses[0].begin(), responses[0].end(), firstResponse.begin(), firstResponse.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(responses[1].begin(), responses[1].end(), syncResponse.begin(), syncResponse.end());
+
+    BOOST_CHECK_EQUAL(channelManager.onServerFailed_, 0);
+
+    channel.shutdown();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -15,6 +15,12 @@
  */
 
 #include <boost/test/unit_test.hpp>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
 #include <boost/asio/detail/socket_ops.hpp>
 
 #include "kaa/KaaDefaults.hpp"
@@ -383,7 +389,9 @@ BOOST_AUTO_TEST_CASE(ServerFailedTest)
                                                                                      , 443))
                                 };
     MockBootstrapManager BootstrapManager;
-    KaaClientContext clientContext(properties, tmp_logger, context, state);
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, state);
     KaaChannelManager channelManager(BootstrapManager, servers, clientContext);
 
     IFailoverStrategyPtr failoverStrategy(std::make_shared<DefaultFailoverStrategy>());
@@ -589,6 +597,219 @@ BOOST_AUTO_TEST_CASE(ResumetTest)
     BOOST_CHECK(!userCh1->isPaused());
 }
 
+/*
+ * Stands in for the server: counts sync requests (frames) and the transport types they carry.
+ */
+class SyncCountingDataChannel : public UserDataChannel {
+public:
+    virtual const std::map<TransportType, ChannelDirection>& getSupportedTransportTypes() const {
+        return SUPPORTED_TYPES;
+    }
+
+    virtual void sync(TransportType type)
+    {
+        sync(std::set<TransportType>({ type }));
+    }
+
+    virtual void sync(const std::set<TransportType>& types)
+    {
+        ++frameCount_;
+        if (isRecordingRequests_) {
+            std::lock_guard<std::mutex> lock(guard_);
+            requests_.push_back(types);
+        }
+    }
+
+    std::vector<std::set<TransportType>> getRequests()
+    {
+        std::lock_guard<std::mutex> lock(guard_);
+        return requests_;
+    }
+
+public:
+    std::atomic_size_t    frameCount_{0};
+    bool                  isRecordingRequests_ = true;
+
+private:
+    static const std::map<TransportType, ChannelDirection> SUPPORTED_TYPES;
+
+    std::mutex                              guard_;
+    std::vector<std::set<TransportType>>    requests_;
+};
+
+const std::map<TransportType, ChannelDirection> SyncCountingDataChannel::SUPPORTED_TYPES =
+{
+        { TransportType::PROFILE, ChannelDirection::BIDIRECTIONAL },
+        { TransportType::USER, ChannelDirection::BIDIRECTIONAL },
+        { TransportType::EVENT, ChannelDirection::BIDIRECTIONAL },
+        { TransportType::LOGGING, ChannelDirection::BIDIRECTIONAL }
+};
+
+static void initSyncCountingChannel(SyncCountingDataChannel& channel)
+{
+    channel.id_ = "sync_counting_channel";
+    channel.protocolId_ = TransportProtocolIdConstants::TCP_TRANSPORT_ID;
+    channel.serverType_ = ServerType::OPERATIONS;
+}
+
+BOOST_AUTO_TEST_CASE(SyncWithoutWindowTest)
+{
+    SyncCountingDataChannel channel;
+    initSyncCountingChannel(channel);
+
+    MockBootstrapManager BootstrapManager;
+    KaaClientContext clientContext(properties, tmp_logger, context, state);
+    KaaChannelManager channelManager(BootstrapManager, getBootstrapServers(), clientContext);
+
+    BOOST_CHECK_THROW(channelManager.sync(TransportType::EVENT), KaaException);
+
+    channelManager.addChannel(&channel);
+    channelManager.sync(TransportType::EVENT);
+    channelManager.sync(TransportType::EVENT);
+    channelManager.sync(TransportType::LOGGING);
+
+    auto requests = channel.getRequests();
+    BOOST_REQUIRE_EQUAL(requests.size(), 3);
+    BOOST_CHECK(requests[2] == std::set<TransportType>({ TransportType::LOGGING }));
+}
+
+BOOST_AUTO_TEST_CASE(SyncCoalescingTest)
+{
+    const std::size_t syncWindow = 50;
+
+    SyncCountingDataChannel channel;
+    initSyncCountingChannel(channel);
+
+    KaaClientProperties windowProperties;
+    windowProperties.setSyncCoalescingWindow(syncWindow);
+
+    MockBootstrapManager BootstrapManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(windowProperties, tmp_logger, executor, state);
+    KaaChannelManager channelManager(BootstrapManager, getBootstrapServers(), clientContext);
+    channelManager.addChannel(&channel);
+
+    for (std::size_t i = 0; i < 100; ++i) {
+        channelManager.sync(TransportType::EVENT);
+    }
+    channelManager.sync(TransportType::LOGGING);
+    channelManager.sync(TransportType::PROFILE);
+
+    BOOST_CHECK(channel.getRequests().empty());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(syncWindow * 4));
+
+    auto requests = channel.getRequests();
+    BOOST_REQUIRE_EQUAL(requests.size(), 1);
+    BOOST_CHECK(requests.front() == std::set<TransportType>({ TransportType::EVENT,
+                                                              TransportType::LOGGING,
+                                                              TransportType::PROFILE }));
+
+    channelManager.sync(TransportType::EVENT);
+    std::this_thread::sleep_for(std::chrono::milliseconds(syncWindow * 4));
+    BOOST_CHECK_EQUAL(channel.getRequests().size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(LatencyCriticalSyncTest)
+{
+    const std::size_t syncWindow = 50;
+
+    SyncCountingDataChannel channel;
+    initSyncCountingChannel(channel);
+
+    KaaClientProperties windowProperties;
+    windowProperties.setSyncCoalescingWindow(syncWindow);
+
+    MockBootstrapManager BootstrapManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(windowProperties, tmp_logger, executor, state);
+    KaaChannelManager channelManager(BootstrapManager, getBootstrapServers(), clientContext);
+    channelManager.setLatencyCriticalTypes({ TransportType::USER });
+    channelManager.addChannel(&channel);
+
+    channelManager.sync(TransportType::EVENT);
+    channelManager.sync(TransportType::USER);
+
+    auto requests = channel.getRequests();
+    BOOST_REQUIRE_EQUAL(requests.size(), 1);
+    BOOST_CHECK(requests.front() == std::set<TransportType>({ TransportType::EVENT, TransportType::USER }));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(syncWindow * 4));
+    BOOST_CHECK_EQUAL(channel.getRequests().size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ShutdownWithPendingSyncTest)
+{
+    const std::size_t syncWindow = 50;
+
+    SyncCountingDataChannel channel;
+    initSyncCountingChannel(channel);
+
+    KaaClientProperties windowProperties;
+    windowProperties.setSyncCoalescingWindow(syncWindow);
+
+    MockBootstrapManager BootstrapManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(windowProperties, tmp_logger, executor, state);
+    KaaChannelManager channelManager(BootstrapManager, getBootstrapServers(), clientContext);
+    channelManager.addChannel(&channel);
+
+    channelManager.sync(TransportType::EVENT);
+    channelManager.shutdown();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(syncWindow * 4));
+    BOOST_CHECK(channel.getRequests().empty());
+
+    channelManager.sync(TransportType::EVENT);
+    channelManager.sync(TransportType::LOGGING);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(syncWindow * 4));
+    BOOST_CHECK(channel.getRequests().empty());
+}
+
+static void measureSyncRate(std::size_t syncWindow)
+{
+    const std::chrono::milliseconds duration(500);
+
+    SyncCountingDataChannel channel;
+    initSyncCountingChannel(channel);
+    channel.isRecordingRequests_ = false;
+
+    KaaClientProperties windowProperties;
+    windowProperties.setSyncCoalescingWindow(syncWindow);
+
+    MockBootstrapManager BootstrapManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(windowProperties, tmp_logger, executor, state);
+    KaaChannelManager channelManager(BootstrapManager, getBootstrapServers(), clientContext);
+    channelManager.addChannel(&channel);
+
+    std::size_t syncCount = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    while (std::chrono::steady_clock::now() - start < duration) {
+        channelManager.sync(TransportType::EVENT);
+        channelManager.sync(TransportType::LOGGING);
+        syncCount += 2;
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(syncWindow * 4));
+
+    double seconds = std::chrono::duration_cast<std::chrono::duration<double>>(duration).count();
+    BOOST_TEST_MESSAGE("Window: " << syncWindow << " ms, sync calls: " << (syncCount / seconds)
+                       << "/sec, frames: " << (channel.frameCount_ / seconds) << "/sec");
+}
+
+BOOST_AUTO_TEST_CASE(SyncCoalescingBenchmarkTest)
+{
+    for (std::size_t syncWindow : { 0, 10, 50 }) {
+        measureSyncRate(syncWindow);
+    }
+}
 
 BOOST_AUTO_TEST_SUITE_END()
 
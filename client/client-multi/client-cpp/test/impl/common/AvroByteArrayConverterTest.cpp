@@ -17,8 +17,10 @@
 #include <boost/test/unit_test.hpp>
 
 #include <memory>
+#include <chrono>
 #include <fstream>
 #include <sstream>
+#include <iterator>
 #include <cstring>
 #include <algorithm>
 
@@ -29,6 +31,7 @@
 #include <avro/Compiler.hh>
 
 #include "kaa/common/AvroByteArrayConverter.hpp"
+#include "kaa/common/AvroByteArrayOutputStream.hpp"
 
 #include "headers/gen/EndpointGen.hpp"
 
@@ -119,6 +122,174 @@ BOOST_AUTO_TEST_CASE(AvroBinaryEncodingToStream)
     BOOST_CHECK_MESSAGE (res == 0, "Encoded datas aren't equal");
 }
 
+BOOST_AUTO_TEST_CASE(AvroBinaryEncodingToVector)
+{
+    BasicEndpointProfile encodingProfile;
+    encodingProfile.profileBody = std::string(1000, 'a');
+
+    std::ostringstream stream;
+    binaryEncodeDataTo(stream, encodingProfile);
+    const std::string& expectedData = stream.str();
+
+    AvroByteArrayConverter<BasicEndpointProfile> converter;
+    std::vector<std::uint8_t> encodedData;
+
+    converter.toByteArray(encodingProfile, encodedData);
+    BOOST_CHECK_EQUAL_COLLECTIONS(encodedData.begin(), encodedData.end(), expectedData.begin(), expectedData.end());
+
+    auto capacity = encodedData.capacity();
+    auto data = encodedData.data();
+
+    converter.toByteArray(encodingProfile, encodedData);
+    BOOST_CHECK_EQUAL_COLLECTIONS(encodedData.begin(), encodedData.end(), expectedData.begin(), expectedData.end());
+
+    BOOST_CHECK_EQUAL(encodedData.capacity(), capacity);
+    BOOST_CHECK(encodedData.data() == data);
+}
+
+BOOST_AUTO_TEST_CASE(AvroByteArrayOutputStreamGrowth)
+{
+    BasicEndpointProfile encodingProfile;
+    encodingProfile.profileBody = "Really big body...";
+
+    std::ostringstream stream;
+    binaryEncodeDataTo(stream, encodingProfile);
+    const std::string& expectedData = stream.str();
+
+    std::vector<std::uint8_t> encodedData(100500, 0xFF);
+    encodedData.shrink_to_fit();
+
+    AvroByteArrayOutputStream out(encodedData, 1);
+    avro::EncoderPtr e = avro::binaryEncoder();
+    e->init(out);
+    avro::encode(*e, encodingProfile);
+    e->flush();
+
+    BOOST_CHECK_EQUAL(out.byteCount(), expectedData.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(encodedData.begin(), encodedData.end(), expectedData.begin(), expectedData.end());
+}
+
+BOOST_AUTO_TEST_CASE(AvroByteArrayOutputStreamReuseAfterBigEncoding)
+{
+    const std::size_t chunkSize = 16;
+
+    std::vector<std::uint8_t> encodedData(100500, 0xFF);
+    auto capacity = encodedData.capacity();
+    auto data = encodedData.data();
+
+    /*
+     * A small encoding into the vector left big by an earlier one initializes only what it writes.
+     */
+    AvroByteArrayOutputStream out(encodedData, chunkSize);
+
+    std::uint8_t *chunk = nullptr;
+    std::size_t chunkLength = 0;
+    BOOST_REQUIRE(out.next(&chunk, &chunkLength));
+
+    BOOST_CHECK_EQUAL(chunkLength, chunkSize);
+    BOOST_CHECK_EQUAL(encodedData.size(), chunkSize);
+
+    BOOST_REQUIRE(out.next(&chunk, &chunkLength));
+    BOOST_CHECK_EQUAL(chunkLength, chunkSize);
+    BOOST_CHECK_EQUAL(encodedData.size(), 2 * chunkSize);
+
+    out.backup(chunkSize / 2);
+    out.flush();
+
+    BOOST_CHECK_EQUAL(encodedData.size(), chunkSize + chunkSize / 2);
+    BOOST_CHECK_EQUAL(encodedData.capacity(), capacity);
+    BOOST_CHECK(encodedData.data() == data);
+}
+
+BOOST_AUTO_TEST_CASE(AvroBinaryEncodingToFixedBuffer)
+{
+    BasicEndpointProfile encodingProfile;
+    encodingProfile.profileBody = "Really big body...";
+
+    std::ostringstream stream;
+    binaryEncodeDataTo(stream, encodingProfile);
+    const std::string& expectedData = stream.str();
+
+    AvroByteArrayConverter<BasicEndpointProfile> converter;
+
+    std::vector<std::uint8_t> buffer(expectedData.size() + 10);
+    std::size_t encodedSize = converter.toByteArray(encodingProfile, buffer.data(), buffer.size());
+
+    BOOST_CHECK_EQUAL(encodedSize, expectedData.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(buffer.begin(), buffer.begin() + encodedSize, expectedData.begin(), expectedData.end());
+
+    encodedSize = converter.toByteArray(encodingProfile, buffer.data(), expectedData.size());
+    BOOST_CHECK_EQUAL(encodedSize, expectedData.size());
+
+    BOOST_CHECK_THROW(converter.toByteArray(encodingProfile, buffer.data(), expectedData.size() - 1), KaaException);
+    BOOST_CHECK_THROW(converter.toByteArray(encodingProfile, nullptr, buffer.size()), KaaException);
+
+    /*
+     * The converter stays usable after the failure.
+     */
+    const auto& pooledData = converter.toPooledByteArray(encodingProfile);
+    BOOST_CHECK_EQUAL_COLLECTIONS(pooledData.begin(), pooledData.end(), expectedData.begin(), expectedData.end());
+}
+
+BOOST_AUTO_TEST_CASE(AvroBinaryEncodingToPooledBuffer)
+{
+    BasicEndpointProfile encodingProfile;
+    encodingProfile.profileBody = std::string(1000, 'a');
+
+    AvroByteArrayConverter<BasicEndpointProfile> converter;
+
+    const auto& encodedData1 = converter.toPooledByteArray(encodingProfile);
+    auto data = encodedData1.data();
+    auto size = encodedData1.size();
+
+    encodingProfile.profileBody = std::string(500, 'b');
+    const auto& encodedData2 = converter.toPooledByteArray(encodingProfile);
+
+    BOOST_CHECK(encodedData2.data() == data);
+    BOOST_CHECK_LT(encodedData2.size(), size);
+
+    BasicEndpointProfile decodedProfile = decodeBinaryData<BasicEndpointProfile>(encodedData2.data(), encodedData2.size());
+    BOOST_CHECK_EQUAL(decodedProfile.profileBody, encodingProfile.profileBody);
+}
+
+BOOST_AUTO_TEST_CASE(ThreadLocalConverterEncodingCost)
+{
+    const std::size_t recordCount = 100000;
+
+    BasicEndpointProfile encodingProfile;
+    encodingProfile.profileBody = "Sensor 42: temperature 21.5C, humidity 40%";
+
+    std::size_t encodedSize = 0;
+
+    /*
+     * The way records used to be encoded: a new converter (encoder) per record
+     * and the data copied through a string stream.
+     */
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        std::stringstream stream;
+        binaryEncodeDataTo(stream, encodingProfile);
+
+        std::vector<std::uint8_t> encodedData;
+        encodedData.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+        encodedSize += encodedData.size();
+    }
+    std::chrono::duration<double, std::nano> streamElapsed = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        std::vector<std::uint8_t> encodedData;
+        AvroByteArrayConverter<BasicEndpointProfile>::getThreadLocalConverter().toByteArray(encodingProfile, encodedData);
+        encodedSize -= encodedData.size();
+    }
+    std::chrono::duration<double, std::nano> threadLocalElapsed = std::chrono::steady_clock::now() - start;
+
+    BOOST_TEST_MESSAGE(boost::format("Encoding cost per record: string stream %1% ns, thread local converter %2% ns")
+                                % (streamElapsed.count() / recordCount) % (threadLocalElapsed.count() / recordCount));
+
+    BOOST_CHECK_EQUAL(encodedSize, 0);
+}
+
 BOOST_AUTO_TEST_CASE(SimpleAvroBinaryDecoding)
 {
     BasicEndpointProfile encodingProfile;
@@ -0,0 +1,139 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "kaa/event/EventManager.hpp"
+#include "kaa/event/IEventFamily.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+
+#include "headers/context/MockExecutorContext.hpp"
+#include "headers/MockKaaClientStateStorage.hpp"
+
+namespace kaa {
+
+class TestEventFamily : public IEventFamily {
+public:
+    TestEventFamily(const FQNList& fqns) : fqns_(fqns) {}
+
+    virtual const FQNList& getSupportedEventClassFQNs()
+    {
+        return fqns_;
+    }
+
+    virtual void onGenericEvent(const std::string& fqn, const std::vector<std::uint8_t>& data, const std::string& source)
+    {
+        receivedEvents_.push_back(std::make_pair(fqn, source));
+    }
+
+public:
+    std::vector<std::pair<std::string, std::string> > receivedEvents_;
+
+private:
+    FQNList fqns_;
+};
+
+static Event createEvent(std::int32_t seqNum, const std::string& fqn, const std::string& source = std::string())
+{
+    Event event;
+    event.seqNum = seqNum;
+    event.eventClassFQN = fqn;
+
+    if (source.empty()) {
+        event.source.set_null();
+    } else {
+        event.source.set_string(source);
+    }
+
+    event.target.set_null();
+    return event;
+}
+
+BOOST_AUTO_TEST_SUITE(EventManagerTestSuite)
+
+BOOST_AUTO_TEST_CASE(DispatchByFQNTest)
+{
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    MockExecutorContext executorContext;
+    KaaClientProperties properties;
+    DefaultLogger logger(properties.getClientId());
+    KaaClientContext clientContext(properties, logger, executorContext, stateMock);
+    EventManager eventManager(clientContext);
+
+    TestEventFamily firstFamily({ "org.kaa.A", "org.kaa.B" });
+    TestEventFamily secondFamily({ "org.kaa.B", "org.kaa.C" });
+
+    eventManager.registerEventFamily(&firstFamily);
+    eventManager.registerEventFamily(&secondFamily);
+    eventManager.registerEventFamily(&secondFamily);
+
+    EventSyncResponse::events_t events;
+    events.set_array({ createEvent(3, "org.kaa.C")
+                     , createEvent(1, "org.kaa.A", "source")
+                     , createEvent(4, "org.kaa.Unknown")
+                     , createEvent(2, "org.kaa.B") });
+
+    eventManager.onEventsReceived(events);
+
+    BOOST_REQUIRE_EQUAL(firstFamily.receivedEvents_.size(), 2);
+    BOOST_CHECK_EQUAL(firstFamily.receivedEvents_[0].first, "org.kaa.A");
+    BOOST_CHECK_EQUAL(firstFamily.receivedEvents_[0].second, "source");
+    BOOST_CHECK_EQUAL(firstFamily.receivedEvents_[1].first, "org.kaa.B");
+
+    BOOST_REQUIRE_EQUAL(secondFamily.receivedEvents_.size(), 2);
+    BOOST_CHECK_EQUAL(secondFamily.receivedEvents_[0].first, "org.kaa.B");
+    BOOST_CHECK_EQUAL(secondFamily.receivedEvents_[1].first, "org.kaa.C");
+    BOOST_CHECK(secondFamily.receivedEvents_[1].second.empty());
+}
+
+BOOST_AUTO_TEST_CASE(DispatchOrderedEventsTest)
+{
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    MockExecutorContext executorContext;
+    KaaClientProperties properties;
+    DefaultLogger logger(properties.getClientId());
+    KaaClientContext clientContext(properties, logger, executorContext, stateMock);
+    EventManager eventManager(clientContext);
+
+    TestEventFamily family({ "org.kaa.A" });
+    eventManager.registerEventFamily(&family);
+
+    const std::size_t eventCount = 1000;
+    std::vector<Event> eventArray;
+    for (std::size_t i = 0; i < eventCount; ++i) {
+        eventArray.push_back(createEvent(i, "org.kaa.A", std::to_string(i)));
+    }
+
+    EventSyncResponse::events_t events;
+    events.set_array(eventArray);
+
+    eventManager.onEventsReceived(events);
+
+    BOOST_REQUIRE_EQUAL(family.receivedEvents_.size(), eventCount);
+    for (std::size_t i = 0; i < eventCount; ++i) {
+        BOOST_CHECK_EQUAL(family.receivedEvents_[i].second, std::to_string(i));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
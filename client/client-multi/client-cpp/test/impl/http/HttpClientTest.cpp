@@ -0,0 +1,300 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+
+#include "kaa/http/HttpClient.hpp"
+#include "kaa/http/MultipartPostHttpRequest.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+#include "kaa/transport/TransportException.hpp"
+
+#include "headers/context/MockExecutorContext.hpp"
+#include "headers/MockKaaClientStateStorage.hpp"
+
+namespace kaa {
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+static MockExecutorContext tmpExecContext;
+static KaaClientContext clientContext(properties, tmp_logger, tmpExecContext, tmp_state);
+
+static const std::string RESPONSE_BODY = "0123456789";
+
+static const std::string CONTENT_LENGTH_RESPONSE =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/x-kaa\r\n"
+    "Content-Length: 10\r\n\r\n"
+    "0123456789";
+
+static const std::string CHUNKED_RESPONSE =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/x-kaa\r\n"
+    "Transfer-Encoding: chunked\r\n\r\n"
+    "4\r\n0123\r\n"
+    "6;ext=1\r\n456789\r\n"
+    "0\r\n"
+    "X-Trailer: value\r\n\r\n";
+
+static const std::string CONNECTION_CLOSE_RESPONSE =
+    "HTTP/1.1 200 OK\r\n"
+    "Connection: close\r\n"
+    "Content-Length: 10\r\n\r\n"
+    "0123456789";
+
+/*
+ * Stand-in HTTP server. Answers every request with the same response,
+ * each connection is served by its own thread.
+ */
+class TestHttpServer {
+public:
+    TestHttpServer(const std::string& response, bool closeAfterResponse = false)
+        : acceptor_(io_, boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), 0))
+        , response_(response), closeAfterResponse_(closeAfterResponse)
+        , isStopped_(false), isDropNextRequest_(false), acceptedConnections_(0), servedRequests_(0)
+    {
+        acceptThread_ = std::thread([this] () { accept(); });
+    }
+
+    ~TestHttpServer()
+    {
+        isStopped_ = true;
+
+        /*
+         * Wakes up the blocked accept().
+         */
+        boost::system::error_code errorCode;
+        boost::asio::ip::tcp::socket waker(io_);
+        waker.connect(acceptor_.local_endpoint(), errorCode);
+        acceptThread_.join();
+
+        for (auto& socket : sockets_) {
+            socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, errorCode);
+        }
+        for (auto& thread : connectionThreads_) {
+            thread.join();
+        }
+    }
+
+    std::uint16_t getPort() const { return acceptor_.local_endpoint().port(); }
+    std::size_t getAcceptedConnections() const { return acceptedConnections_; }
+    std::size_t getServedRequests() const { return servedRequests_; }
+
+    /*
+     * The next request is read, but the connection is closed without a response.
+     */
+    void dropNextRequest() { isDropNextRequest_ = true; }
+
+private:
+    typedef std::shared_ptr<boost::asio::ip::tcp::socket> SocketPtr;
+
+    void accept()
+    {
+        for (;;) {
+            SocketPtr socket(new boost::asio::ip::tcp::socket(io_));
+            boost::system::error_code errorCode;
+            acceptor_.accept(*socket, errorCode);
+            if (isStopped_ || errorCode) {
+                return;
+            }
+            ++acceptedConnections_;
+            sockets_.push_back(socket);
+            connectionThreads_.push_back(std::thread([this, socket] () { serve(*socket); }));
+        }
+    }
+
+    void serve(boost::asio::ip::tcp::socket& socket)
+    {
+        boost::asio::streambuf buffer;
+        boost::system::error_code errorCode;
+        for (;;) {
+            std::size_t headerSize = boost::asio::read_until(socket, buffer, "\r\n\r\n", errorCode);
+            if (errorCode) {
+                break;
+            }
+
+            std::string header(boost::asio::buffer_cast<const char *>(buffer.data()), headerSize);
+            buffer.consume(headerSize);
+
+            std::size_t bodySize = 0;
+            auto lengthPos = header.find("Content-Length: ");
+            if (lengthPos != std::string::npos) {
+                bodySize = std::strtoul(header.c_str() + lengthPos + 16, nullptr, 10);
+            }
+            if (buffer.size() < bodySize) {
+                boost::asio::read(socket, buffer, boost::asio::transfer_exactly(bodySize - buffer.size()), errorCode);
+                if (errorCode) {
+                    break;
+                }
+            }
+            buffer.consume(bodySize);
+
+            ++servedRequests_;
+            if (isDropNextRequest_.exchange(false)) {
+                break;
+            }
+            boost::asio::write(socket, boost::asio::buffer(response_), errorCode);
+            if (errorCode || closeAfterResponse_) {
+                break;
+            }
+        }
+        socket.close(errorCode);
+    }
+
+private:
+    boost::asio::io_service io_;
+    boost::asio::ip::tcp::acceptor acceptor_;
+    const std::string response_;
+    const bool closeAfterResponse_;
+
+    std::atomic_bool isStopped_;
+    std::atomic_bool isDropNextRequest_;
+    std::atomic<std::size_t> acceptedConnections_;
+    std::atomic<std::size_t> servedRequests_;
+
+    std::thread acceptThread_;
+    std::vector<SocketPtr> sockets_;
+    std::vector<std::thread> connectionThreads_;
+};
+
+static void sendRequests(HttpClient& client, std::uint16_t port, std::size_t count)
+{
+    HttpUrl url("http://127.0.0.1:" + std::to_string(port) + "/test");
+    MultipartPostHttpRequest request(url, clientContext);
+    request.setBodyField("requestData", std::vector<std::uint8_t>(100, 'x'));
+
+    for (std::size_t i = 0; i < count; ++i) {
+        auto response = client.sendRequest(request);
+        BOOST_CHECK_EQUAL(response->getStatusCode(), 200);
+
+        SharedBody body = response->getBody();
+        BOOST_REQUIRE_EQUAL(body.second, RESPONSE_BODY.size());
+        BOOST_CHECK_EQUAL_COLLECTIONS(body.first.get(), body.first.get() + body.second,
+                                      RESPONSE_BODY.begin(), RESPONSE_BODY.end());
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(HttpClientSuite)
+
+BOOST_AUTO_TEST_CASE(ReuseConnectionTest)
+{
+    const std::size_t requestCount = 5;
+    TestHttpServer server(CONTENT_LENGTH_RESPONSE);
+    HttpClient client(clientContext);
+
+    sendRequests(client, server.getPort(), requestCount);
+
+    BOOST_CHECK_EQUAL(server.getServedRequests(), requestCount);
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ChunkedResponseTest)
+{
+    const std::size_t requestCount = 3;
+    TestHttpServer server(CHUNKED_RESPONSE);
+    HttpClient client(clientContext);
+
+    sendRequests(client, server.getPort(), requestCount);
+
+    BOOST_CHECK_EQUAL(server.getServedRequests(), requestCount);
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ConnectionCloseResponseTest)
+{
+    const std::size_t requestCount = 3;
+    TestHttpServer server(CONNECTION_CLOSE_RESPONSE);
+    HttpClient client(clientContext);
+
+    sendRequests(client, server.getPort(), requestCount);
+
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), requestCount);
+}
+
+BOOST_AUTO_TEST_CASE(ServerClosedConnectionTest)
+{
+    /*
+     * The server closes the connection it has promised to keep alive.
+     */
+    const std::size_t requestCount = 3;
+    TestHttpServer server(CONTENT_LENGTH_RESPONSE, true);
+    HttpClient client(clientContext);
+
+    sendRequests(client, server.getPort(), requestCount);
+
+    BOOST_CHECK_EQUAL(server.getServedRequests(), requestCount);
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), requestCount);
+}
+
+BOOST_AUTO_TEST_CASE(DeliveredRequestIsNotRetriedTest)
+{
+    TestHttpServer server(CONTENT_LENGTH_RESPONSE);
+    HttpClient client(clientContext);
+
+    sendRequests(client, server.getPort(), 1);
+
+    /*
+     * The server got the request on the reused connection, so it mustn't be sent again.
+     */
+    HttpUrl url("http://127.0.0.1:" + std::to_string(server.getPort()) + "/test");
+    MultipartPostHttpRequest request(url, clientContext);
+    request.setBodyField("requestData", std::vector<std::uint8_t>(100, 'x'));
+
+    server.dropNextRequest();
+    BOOST_CHECK_THROW(client.sendRequest(request), TransportException);
+
+    BOOST_CHECK_EQUAL(server.getServedRequests(), 2);
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(IdleConnectionEvictionTest)
+{
+    const std::size_t requestCount = 3;
+    TestHttpServer server(CONTENT_LENGTH_RESPONSE);
+    HttpClient client(clientContext, std::chrono::milliseconds(0));
+
+    sendRequests(client, server.getPort(), requestCount);
+
+    BOOST_CHECK_EQUAL(server.getServedRequests(), requestCount);
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), requestCount);
+}
+
+BOOST_AUTO_TEST_CASE(CloseConnectionTest)
+{
+    TestHttpServer server(CONTENT_LENGTH_RESPONSE);
+    HttpClient client(clientContext);
+
+    sendRequests(client, server.getPort(), 1);
+    client.closeConnection();
+    sendRequests(client, server.getPort(), 1);
+
+    BOOST_CHECK_EQUAL(server.getAcceptedConnections(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}  // namespace kaa
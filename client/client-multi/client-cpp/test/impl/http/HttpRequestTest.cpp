@@ -25,6 +25,7 @@
 #include "headers/MockKaaClientStateStorage.hpp"
 
 
+#include <memory>
 #include <vector>
 
 namespace kaa {
@@ -43,36 +44,33 @@ static std::string request_body =
     "Content-Type: multipart/form-data; boundary=----Sanj56fD843koI0\r\n"
     "Host: test.com\r\n"
     "MyHttpHeader: MyHttpHeaderValue\r\n"
-    "Connection: Close\r\n"
+    "Connection: keep-alive\r\n"
     "Content-Length: 115\r\n\r\n"
     "------Sanj56fD843koI0\r\n"
     "Content-Disposition: form-data; name=\"SimpleBody\"\r\n\r\n"
     "0123456789\r\n"
-    "------Sanj56fD843koI0--\r\n\r\n"
-    "\r\n\r\n";
+    "------Sanj56fD843koI0--\r\n\r\n";
 
 static std::string request_body_wo_header =
     "POST /path?par1=val1&par2=val2 HTTP/1.1\r\n"
     "Accept: */*\r\n"
     "Content-Type: multipart/form-data; boundary=----Sanj56fD843koI0\r\n"
     "Host: test.com\r\n"
-    "Connection: Close\r\n"
+    "Connection: keep-alive\r\n"
     "Content-Length: 115\r\n\r\n"
     "------Sanj56fD843koI0\r\n"
     "Content-Disposition: form-data; name=\"SimpleBody\"\r\n\r\n"
     "0123456789\r\n"
-    "------Sanj56fD843koI0--\r\n\r\n"
-    "\r\n\r\n";
+    "------Sanj56fD843koI0--\r\n\r\n";
 
 static std::string request_body_wo_body =
     "POST /path?par1=val1&par2=val2 HTTP/1.1\r\n"
     "Accept: */*\r\n"
     "Content-Type: multipart/form-data; boundary=----Sanj56fD843koI0\r\n"
     "Host: test.com\r\n"
-    "Connection: Close\r\n"
+    "Connection: keep-alive\r\n"
     "Content-Length: 27\r\n\r\n"
-    "------Sanj56fD843koI0--\r\n\r\n"
-    "\r\n\r\n";
+    "------Sanj56fD843koI0--\r\n\r\n";
 
 BOOST_AUTO_TEST_SUITE(HttpRequestSuite)
 
@@ -102,6 +100,50 @@ BOOST_AUTO_TEST_CASE(httpMultipartRequestTest)
     BOOST_CHECK_EQUAL(req.getRequestData(), request_body_wo_body);
 }
 
+BOOST_AUTO_TEST_CASE(httpMultipartRequestBuffersTest)
+{
+    IKaaClientStateStoragePtr stateMock(new MockKaaClientStateStorage);
+    MockExecutorContext context;
+    KaaClientProperties properties;
+    DefaultLogger tmp_logger(properties.getClientId());
+    KaaClientContext clientContext(properties, tmp_logger, context, stateMock);
+
+    HttpUrl url(test_url0);
+    MultipartPostHttpRequest req(url, clientContext);
+
+    auto sharedBody = std::make_shared<std::vector<std::uint8_t>>(body_data);
+    req.setHeaderField(header_name, header_value);
+    req.setBodyField(body_name, sharedBody);
+
+    const auto& buffers = req.getRequestBuffers();
+
+    /*
+     * The shared field is written from its own storage, not from a copy.
+     */
+    bool isFieldShared = false;
+    std::string data;
+    for (const auto& buffer : buffers) {
+        const char *bufferData = boost::asio::buffer_cast<const char *>(buffer);
+        isFieldShared = isFieldShared || (bufferData == reinterpret_cast<const char *>(sharedBody->data()));
+        data.append(bufferData, boost::asio::buffer_size(buffer));
+    }
+
+    BOOST_CHECK(isFieldShared);
+    BOOST_CHECK_EQUAL(data, request_body);
+    BOOST_CHECK_EQUAL(req.getRequestData(), request_body);
+
+    /*
+     * Getting the request again leaves earlier buffers valid, they refer to the same data.
+     */
+    const auto& sameBuffers = req.getRequestBuffers();
+    BOOST_REQUIRE_EQUAL(sameBuffers.size(), buffers.size());
+    for (std::size_t i = 0; i < buffers.size(); ++i) {
+        BOOST_CHECK(boost::asio::buffer_cast<const char *>(sameBuffers[i]) ==
+                    boost::asio::buffer_cast<const char *>(buffers[i]));
+        BOOST_CHECK_EQUAL(boost::asio::buffer_size(sameBuffers[i]), boost::asio::buffer_size(buffers[i]));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }  // namespace kaa
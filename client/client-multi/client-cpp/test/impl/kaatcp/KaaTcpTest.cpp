@@ -22,6 +22,10 @@
 #include "kaa/kaatcp/ConnectMessage.hpp"
 #include "kaa/kaatcp/PingRequest.hpp"
 #include "kaa/kaatcp/DisconnectMessage.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+#ifdef KAA_USE_TCP_COMPRESSION
+#include "kaa/kaatcp/KaaSyncCompressor.hpp"
+#endif
 #include "kaa/logging/Log.hpp"
 #include "kaa/logging/LoggingUtils.hpp"
 #include "kaa/context/SimpleExecutorContext.hpp"
@@ -106,6 +110,68 @@ BOOST_AUTO_TEST_CASE(testTcpParser)
     BOOST_CHECK_EQUAL(0x02, message4.begin()->second.first[1]);
 }
 
+BOOST_AUTO_TEST_CASE(testTcpParserMessageHandler)
+{
+    KaaTcpParser parser(clientContext);
+
+    std::size_t messageCount = 0;
+    const char *lastPayload = nullptr;
+    std::vector<char> lastPayloadData;
+    parser.setMessageHandler([&](KaaTcpMessageType type, const char *payload, std::uint32_t size)
+        {
+            BOOST_CHECK_EQUAL((std::uint8_t) KaaTcpMessageType::MESSAGE_DISCONNECT, (std::uint8_t) type);
+            ++messageCount;
+            lastPayload = payload;
+            lastPayloadData.assign(payload, payload + size);
+        });
+
+    /*
+     * The payload is entirely in the buffer, it is passed without copying.
+     */
+    char wholeMessage[] = { (char) 0xE0, 0x02, 0x00, 0x02 };
+    parser.parseBuffer(wholeMessage, sizeof(wholeMessage));
+    BOOST_CHECK_EQUAL(1, messageCount);
+    BOOST_CHECK_EQUAL((const void *) (wholeMessage + 2), (const void *) lastPayload);
+    BOOST_CHECK(parser.releaseMessages().empty());
+
+    /*
+     * The payload is split between buffers, it is assembled in the parser.
+     */
+    char firstPart[] = { (char) 0xE0, 0x02, 0x00 };
+    char secondPart[] = { 0x01 };
+    parser.parseBuffer(firstPart, sizeof(firstPart));
+    BOOST_CHECK_EQUAL(1, messageCount);
+    parser.parseBuffer(secondPart, sizeof(secondPart));
+    BOOST_CHECK_EQUAL(2, messageCount);
+    BOOST_REQUIRE_EQUAL(2, lastPayloadData.size());
+    BOOST_CHECK_EQUAL(0x00, lastPayloadData[0]);
+    BOOST_CHECK_EQUAL(0x01, lastPayloadData[1]);
+}
+
+BOOST_AUTO_TEST_CASE(testProcessResponseBuffers)
+{
+    KaaTcpResponseProcessor processor(clientContext);
+
+    std::size_t kaaSyncCount = 0;
+    processor.registerKaaSyncReceiver([&kaaSyncCount](const KaaSyncResponse& response)
+        {
+            BOOST_CHECK_EQUAL(0x05, response.getMessageId());
+            BOOST_REQUIRE_EQUAL(1, response.getPayload().size());
+            BOOST_CHECK_EQUAL(0xFF, response.getPayload()[0]);
+            ++kaaSyncCount;
+        });
+
+    unsigned char kaaSyncMessage[] = { 0xF0, 0x0D, 0x00, 0x06, 'K', 'a', 'a', 't', 'c', 'p', 0x01, 0x00, 0x05, 0x04, 0xFF };
+
+    std::vector<boost::asio::const_buffer> buffers;
+    buffers.push_back(boost::asio::buffer(kaaSyncMessage, 7));
+    buffers.push_back(boost::asio::buffer(kaaSyncMessage + 7, sizeof(kaaSyncMessage) - 7));
+    buffers.push_back(boost::asio::buffer(kaaSyncMessage, sizeof(kaaSyncMessage)));
+
+    processor.processResponseBuffers(buffers);
+    BOOST_CHECK_EQUAL(2, kaaSyncCount);
+}
+
 class ResponseChecker
 {
 public:
@@ -192,6 +258,57 @@ BOOST_AUTO_TEST_CASE(testResponseProcessor)
     BOOST_CHECK_EQUAL(true, checker.isDisconnectReceived());
 }
 
+BOOST_AUTO_TEST_CASE(testConnackCompressionFlag)
+{
+    KaaTcpResponseProcessor processor(clientContext);
+
+    bool isCompressionSupported = true;
+    processor.registerConnackReceiver(
+            [&isCompressionSupported](const ConnackMessage& message)
+            {
+                BOOST_CHECK_EQUAL((std::uint8_t)ConnackReturnCode::ACCEPTED, (std::uint8_t)message.getReturnCode());
+                isCompressionSupported = message.isCompressionSupported();
+            });
+
+    unsigned char connackWithoutCompression[] = { 0x20, 0x02, 0x00, 0x01 };
+    processor.processResponseBuffer((const char *)connackWithoutCompression, 4);
+    BOOST_CHECK_EQUAL(false, isCompressionSupported);
+
+    unsigned char connackWithCompression[] = { 0x20, 0x02, KaaTcpCommon::KAA_CONNACK_COMPRESSION_FLAG, 0x01 };
+    processor.processResponseBuffer((const char *)connackWithCompression, 4);
+    BOOST_CHECK_EQUAL(true, isCompressionSupported);
+}
+
+#ifdef KAA_USE_TCP_COMPRESSION
+BOOST_AUTO_TEST_CASE(testKaaSyncCompressor)
+{
+    KaaSyncCompressor compressor;
+
+    std::string payload;
+    while (payload.size() < 4 * KaaTcpCommon::KAA_SYNC_COMPRESSION_THRESHOLD) {
+        payload += "{\"endpointKeyHash\":\"aGVsbG8=\",\"profileSync\":null},";
+    }
+
+    ByteArrayView compressed = compressor.compress(reinterpret_cast<const std::uint8_t *>(payload.data()), payload.size());
+    BOOST_REQUIRE(!compressed.empty());
+    BOOST_CHECK(compressed.size() < payload.size());
+
+    std::vector<std::uint8_t> compressedCopy(compressed.begin(), compressed.end());
+    ByteArrayView decompressed = compressor.decompress(compressedCopy.data(), compressedCopy.size());
+    BOOST_CHECK_EQUAL_COLLECTIONS(payload.begin(), payload.end(), decompressed.begin(), decompressed.end());
+
+    /*
+     * Short random-looking data can't be made smaller.
+     */
+    std::uint8_t incompressible[] = { 0x8F, 0x12, 0xA7, 0x3C, 0xD9, 0x04, 0x6B, 0xE1 };
+    BOOST_CHECK(compressor.compress(incompressible, sizeof(incompressible)).empty());
+
+    compressedCopy[compressedCopy.size() / 2] ^= 0xFF;
+    compressedCopy.resize(compressedCopy.size() - 4);
+    BOOST_CHECK_THROW(compressor.decompress(compressedCopy.data(), compressedCopy.size()), KaaException);
+}
+#endif
+
 BOOST_AUTO_TEST_CASE(testKaaSyncRequest)
 {
     KaaSyncRequest request(false, true, 0x07, std::vector<std::uint8_t>({ 0xFF }), KaaSyncMessageType::SYNC);
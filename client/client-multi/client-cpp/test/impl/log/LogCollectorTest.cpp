@@ -21,6 +21,7 @@
 #include <chrono>
 #include <cstdlib>
 #include <list>
+#include <vector>
 
 #include "kaa/log/LogRecord.hpp"
 #include "kaa/log/LogCollector.hpp"
@@ -630,6 +631,69 @@ BOOST_AUTO_TEST_CASE(RecordFuturesResult)
     executor.stop();
 }
 
+BOOST_AUTO_TEST_CASE(AddLogRecordBatchTest)
+{
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+    LogCollector logCollector(&channelManager, clientContext);
+    CustomLoggingTransport transport(channelManager, logCollector, clientContext);
+
+    logCollector.setTransport(&transport);
+
+    std::int32_t bucketId = rand();
+    std::size_t recordCount = 5;
+
+    std::shared_ptr<MockLogStorage> logStorage(new MockLogStorage);
+    logStorage->recordPack_ = LogBucket(bucketId, { createSerializedLogRecord() });
+    logStorage->bucketInfo_ = BucketInfo(bucketId, recordCount);
+
+    std::shared_ptr<MockLogUploadStrategy> uploadStrategy(new MockLogUploadStrategy);
+    uploadStrategy->timeout_ = USHRT_MAX;
+    uploadStrategy->logUploadCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->timeoutCheckPeriod_ = USHRT_MAX;
+    uploadStrategy->maxParallelUploads_ = USHRT_MAX;
+    uploadStrategy->decision_ = LogUploadStrategyDecision::NOOP;
+
+    logCollector.setStorage(logStorage);
+    logCollector.setUploadStrategy(uploadStrategy);
+
+    std::vector<KaaUserLogRecord> records(recordCount, createLogRecord());
+    auto recordFutures = logCollector.addLogRecords(records);
+
+    BOOST_CHECK_EQUAL(recordFutures.size(), recordCount);
+
+    while (logStorage->onAddLogRecord_ < recordCount) {
+        testSleep(1);
+    }
+
+    BOOST_CHECK_EQUAL(logStorage->onAddLogRecords_, 1);
+    BOOST_CHECK_EQUAL(uploadStrategy->onIsUploadNeeded_, 1);
+
+    auto request = logCollector.getLogUploadRequest();
+
+    LogSyncResponse response;
+    LogDeliveryStatus status;
+    status.requestId = bucketId;
+    status.result = SyncResponseResultType::SUCCESS;
+    response.deliveryStatuses.set_array({ status });
+    logCollector.onLogUploadResponse(response);
+
+    for (auto &f : recordFutures) {
+        try {
+            auto bucketInfo = f.get().getBucketInfo();
+            BOOST_CHECK_EQUAL(bucketInfo.getBucketId(), bucketId);
+            BOOST_CHECK_EQUAL(bucketInfo.getLogCount(), recordCount);
+        } catch (...) {
+            BOOST_CHECK(false);
+        }
+    }
+
+    executor.stop();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
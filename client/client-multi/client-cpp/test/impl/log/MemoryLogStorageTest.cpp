@@ -16,11 +16,20 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <boost/mpl/list.hpp>
+
+#include <list>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
 #include <string>
+#include <vector>
 #include <cmath>
 
 #include "kaa/log/LogRecord.hpp"
 #include "kaa/log/MemoryLogStorage.hpp"
+#include "kaa/log/ArenaLogStorage.hpp"
 #include "kaa/common/exception/KaaException.hpp"
 #include "kaa/log/LogStorageConstants.hpp"
 #include "kaa/context/SimpleExecutorContext.hpp"
@@ -31,6 +40,37 @@
 #include "headers/MockKaaClientStateStorage.hpp"
 #include "headers/context/MockExecutorContext.hpp"
 
+/*
+ * Counts heap allocations, so that the storages can be compared by allocations per record.
+ * All forms are replaced, so that memory is never freed by an allocator which didn't allocate it.
+ */
+static std::atomic<std::size_t> allocationCount(0);
+
+void *operator new(std::size_t size)
+{
+    ++allocationCount;
+    if (void *memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    ++allocationCount;
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+void *operator new[](std::size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void *memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
 namespace kaa {
 
 static KaaClientProperties properties;
@@ -43,41 +83,112 @@ static KaaClientContext clientContext(properties, tmp_logger, tmpExecContext, tm
 
 static std::int32_t mockBlocksCount = 10000;
 
-static LogRecord createSerializedLogRecord()
+static LogRecord createSerializedLogRecord(const std::string& data = LOG_TEST_DATA)
 {
     KaaUserLogRecord logRecord;
-    logRecord.logdata = LOG_TEST_DATA;
+    logRecord.logdata = data;
 
     return LogRecord(logRecord);
 }
 
+/*
+ * In-memory storages share the behaviour, so common test cases are run for each of them.
+ */
+typedef boost::mpl::list<MemoryLogStorage, ArenaLogStorage> InMemoryLogStorageTypes;
+
+static std::vector<std::vector<std::uint8_t>> getRecordData(const LogBucket& bucket)
+{
+    std::vector<std::vector<std::uint8_t>> records;
+    bucket.forEachRecord([&records] (const std::uint8_t *data, std::size_t size)
+            {
+                records.emplace_back(data, data + size);
+            });
+    return records;
+}
+
+struct Throughput {
+    double recordsPerSecond_ = 0;
+    double allocationsPerRecord_ = 0;
+};
+
+/*
+ * Adds records and uploads them bucket by bucket, checking every record comes out intact and in order.
+ */
+template<typename Storage>
+static Throughput measureThroughput(Storage& logStorage, std::size_t recordCount)
+{
+    const LogRecord sample = createSerializedLogRecord();
+
+    std::size_t startAllocationCount = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < recordCount; ++i) {
+        logStorage.addLogRecord(LogRecord(sample));
+    }
+
+    std::size_t uploadedCount = 0;
+    std::size_t corruptedCount = 0;
+
+    LogBucket bucket = logStorage.getNextBucket();
+    while (bucket.getRecordCount()) {
+        bucket.forEachRecord([&] (const std::uint8_t *data, std::size_t size)
+                {
+                    ++uploadedCount;
+                    if (size != sample.getSize() || !std::equal(data, data + size, sample.getData().begin())) {
+                        ++corruptedCount;
+                    }
+                });
+        logStorage.removeBucket(bucket.getBucketId());
+        bucket = logStorage.getNextBucket();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::size_t recordAllocationCount = allocationCount - startAllocationCount;
+
+    BOOST_CHECK_EQUAL(uploadedCount, recordCount);
+    BOOST_CHECK_EQUAL(corruptedCount, 0);
+    BOOST_CHECK_EQUAL(logStorage.getRecordsCount(), 0);
+    BOOST_CHECK_EQUAL(logStorage.getConsumedVolume(), 0);
+
+    Throughput throughput;
+    throughput.recordsPerSecond_ = recordCount / elapsed.count();
+    throughput.allocationsPerRecord_ = static_cast<double>(recordAllocationCount) / recordCount;
+    return throughput;
+}
+
 BOOST_AUTO_TEST_SUITE(MemoryLogStorageTestSuite)
 
-BOOST_AUTO_TEST_CASE(BadInitializationParamsTest)
+BOOST_AUTO_TEST_CASE_TEMPLATE(BadInitializationParamsTest, LogStorage, InMemoryLogStorageTypes)
 {
     BOOST_CHECK_THROW(
             {
-                MemoryLogStorage logStorage(clientContext, 100500, (float)-1.0);
+                LogStorage logStorage(clientContext, 100500, (float)-1.0);
             }, KaaException);
 
     BOOST_CHECK_THROW(
             {
-                MemoryLogStorage logStorage(clientContext, 100500, (float)100.1);
+                LogStorage logStorage(clientContext, 100500, (float)100.1);
             }, KaaException);
 }
 
-BOOST_AUTO_TEST_CASE(BucketizeIsLessThanLogRecordSizeTest)
+BOOST_AUTO_TEST_CASE(LogRecordCapacityTest)
 {
     auto serializedLogRecord = createSerializedLogRecord();
+    BOOST_CHECK_EQUAL(serializedLogRecord.getData().capacity(), serializedLogRecord.getSize());
+}
 
-    MemoryLogStorage logStorage(clientContext, serializedLogRecord.getSize() / 2);
+BOOST_AUTO_TEST_CASE_TEMPLATE(BucketizeIsLessThanLogRecordSizeTest, LogStorage, InMemoryLogStorageTypes)
+{
+    auto serializedLogRecord = createSerializedLogRecord();
+
+    LogStorage logStorage(clientContext, serializedLogRecord.getSize() / 2);
 
     BOOST_CHECK_THROW(logStorage.addLogRecord(std::move(serializedLogRecord)), KaaException);
 }
 
-BOOST_AUTO_TEST_CASE(AddRecordsAndCheckStatusTest)
+BOOST_AUTO_TEST_CASE_TEMPLATE(AddRecordsAndCheckStatusTest, LogStorage, InMemoryLogStorageTypes)
 {
-    MemoryLogStorage logStorage(clientContext);
+    LogStorage logStorage(clientContext);
     std::size_t serializedLogSize = createSerializedLogRecord().getSize();
 
     std::srand(std::time(nullptr));
@@ -94,10 +205,10 @@ BOOST_AUTO_TEST_CASE(AddRecordsAndCheckStatusTest)
     BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), logRecordCount * serializedLogSize);
 }
 
-BOOST_AUTO_TEST_CASE(BucketSizeInRecordsConstraint)
+BOOST_AUTO_TEST_CASE_TEMPLATE(BucketSizeInRecordsConstraint, LogStorage, InMemoryLogStorageTypes)
 {
     const size_t recordInBucket = 2;
-    MemoryLogStorage logStorage(clientContext, LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, recordInBucket);
+    LogStorage logStorage(clientContext, LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, recordInBucket);
 
     /*
      * At least 1 records.
@@ -110,21 +221,21 @@ BOOST_AUTO_TEST_CASE(BucketSizeInRecordsConstraint)
 
     for (std::size_t i = 0; i < std::ceil((float)logRecordCount / recordInBucket); ++i) {
         LogBucket bucket = logStorage.getNextBucket();
-        BOOST_CHECK(!bucket.getRecords().empty());
+        BOOST_CHECK(bucket.getRecordCount());
     }
 
     LogBucket bucket = logStorage.getNextBucket();
-    BOOST_CHECK(bucket.getRecords().empty());
+    BOOST_CHECK(!bucket.getRecordCount());
 }
 
-BOOST_AUTO_TEST_CASE(BucketSizeInBytesConstraint)
+BOOST_AUTO_TEST_CASE_TEMPLATE(BucketSizeInBytesConstraint, LogStorage, InMemoryLogStorageTypes)
 {
     std::srand(std::time(nullptr));
 
     std::size_t serializedLogSize = createSerializedLogRecord().getSize();
     std::size_t bucketSizeInBytes = serializedLogSize * (1 + rand() % 2);
     std::size_t recordsInBucket = bucketSizeInBytes / serializedLogSize;
-    MemoryLogStorage logStorage(clientContext, bucketSizeInBytes, LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
+    LogStorage logStorage(clientContext, bucketSizeInBytes, LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT);
 
     /*
      * At least 1 records.
@@ -137,14 +248,14 @@ BOOST_AUTO_TEST_CASE(BucketSizeInBytesConstraint)
 
     for (std::size_t i = 0; i < std::ceil((float)logRecordCount / recordsInBucket); ++i) {
         LogBucket bucket = logStorage.getNextBucket();
-        BOOST_CHECK(!bucket.getRecords().empty());
+        BOOST_CHECK(bucket.getRecordCount());
     }
 
     LogBucket bucket = logStorage.getNextBucket();
-    BOOST_CHECK(bucket.getRecords().empty());
+    BOOST_CHECK(!bucket.getRecordCount());
 }
 
-BOOST_AUTO_TEST_CASE(GetStatusAfterLogBlockTest)
+BOOST_AUTO_TEST_CASE_TEMPLATE(GetStatusAfterLogBlockTest, LogStorage, InMemoryLogStorageTypes)
 {
     /*
      * At least 2 records.
@@ -153,7 +264,7 @@ BOOST_AUTO_TEST_CASE(GetStatusAfterLogBlockTest)
     std::size_t serializedLogSize = createSerializedLogRecord().getSize();
     std::size_t recordBucketSize = (logRecordCount * serializedLogSize) / 2;
 
-    MemoryLogStorage logStorage(clientContext, recordBucketSize);
+    LogStorage logStorage(clientContext, recordBucketSize);
 
     for (std::size_t i = 1; i <= logRecordCount; ++i) {
         logStorage.addLogRecord(createSerializedLogRecord());
@@ -161,11 +272,11 @@ BOOST_AUTO_TEST_CASE(GetStatusAfterLogBlockTest)
 
     auto bucket = logStorage.getNextBucket();
 
-    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), (logRecordCount - bucket.getRecords().size()));
-    BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), ((logRecordCount - bucket.getRecords().size()) * serializedLogSize));
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), (logRecordCount - bucket.getRecordCount()));
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), ((logRecordCount - bucket.getRecordCount()) * serializedLogSize));
 }
 
-BOOST_AUTO_TEST_CASE(RemoveLogBlockAndGetStatusTest)
+BOOST_AUTO_TEST_CASE_TEMPLATE(RemoveLogBlockAndGetStatusTest, LogStorage, InMemoryLogStorageTypes)
 {
     /*
      * At least 2 records.
@@ -174,7 +285,7 @@ BOOST_AUTO_TEST_CASE(RemoveLogBlockAndGetStatusTest)
     std::size_t serializedLogSize = createSerializedLogRecord().getSize();
     std::size_t recordBucketSize1 = (logRecordCount * serializedLogSize) / 2;
 
-    MemoryLogStorage logStorage(clientContext, recordBucketSize1);
+    LogStorage logStorage(clientContext, recordBucketSize1);
     for (std::size_t i = 1; i <= logRecordCount; ++i) {
         logStorage.addLogRecord(createSerializedLogRecord());
     }
@@ -183,9 +294,9 @@ BOOST_AUTO_TEST_CASE(RemoveLogBlockAndGetStatusTest)
 
     logStorage.removeBucket(bucket1.getBucketId());
 
-    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), (logRecordCount - bucket1.getRecords().size()));
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), (logRecordCount - bucket1.getRecordCount()));
     BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(),
-                     ((logRecordCount - bucket1.getRecords().size()) * serializedLogSize));
+                     ((logRecordCount - bucket1.getRecordCount()) * serializedLogSize));
 
     auto bucket2 = logStorage.getNextBucket();
 
@@ -195,7 +306,7 @@ BOOST_AUTO_TEST_CASE(RemoveLogBlockAndGetStatusTest)
     BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), (logRecordCount * serializedLogSize - (recordBucketSize1 / serializedLogSize * 2) * serializedLogSize));
 }
 
-BOOST_AUTO_TEST_CASE(NotifyUploadFailedAndGetStatusTest)
+BOOST_AUTO_TEST_CASE_TEMPLATE(NotifyUploadFailedAndGetStatusTest, LogStorage, InMemoryLogStorageTypes)
 {
     /*
      * At least 2 records.
@@ -204,7 +315,7 @@ BOOST_AUTO_TEST_CASE(NotifyUploadFailedAndGetStatusTest)
     std::size_t serializedLogSize = createSerializedLogRecord().getSize();
     std::size_t recordBucketSize1 = (logRecordCount * serializedLogSize) / 2;
 
-    MemoryLogStorage logStorage(clientContext, recordBucketSize1, (std::size_t)mockBlocksCount);
+    LogStorage logStorage(clientContext, recordBucketSize1, (std::size_t)mockBlocksCount);
 
     for (std::size_t i = 1; i <= logRecordCount; ++i) {
         logStorage.addLogRecord(createSerializedLogRecord());
@@ -212,24 +323,29 @@ BOOST_AUTO_TEST_CASE(NotifyUploadFailedAndGetStatusTest)
 
     auto bucket1 = logStorage.getNextBucket();
 
-    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), (logRecordCount - bucket1.getRecords().size()));
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), (logRecordCount - bucket1.getRecordCount()));
     BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(),
-                     ((logRecordCount - bucket1.getRecords().size()) * serializedLogSize));
+                     ((logRecordCount - bucket1.getRecordCount()) * serializedLogSize));
 
     logStorage.rollbackBucket(bucket1.getBucketId());
 
     BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), logRecordCount);
     BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), (logRecordCount * serializedLogSize));
+
+    auto sameBucket = logStorage.getNextBucket();
+
+    BOOST_CHECK_EQUAL(sameBucket.getBucketId(), bucket1.getBucketId());
+    BOOST_CHECK(getRecordData(sameBucket) == getRecordData(bucket1));
 }
 
-BOOST_AUTO_TEST_CASE(ForceRemovalOfAllLogsTest)
+BOOST_AUTO_TEST_CASE_TEMPLATE(ForceRemovalOfAllLogsTest, LogStorage, InMemoryLogStorageTypes)
 {
     std::size_t logRecordCount = 5;
     std::size_t serializedLogSize = createSerializedLogRecord().getSize();
     std::size_t maxLogStorageSize = logRecordCount * serializedLogSize;
     float percentToDelete = 100.0;
 
-    MemoryLogStorage logStorage(clientContext, maxLogStorageSize, percentToDelete);
+    LogStorage logStorage(clientContext, maxLogStorageSize, percentToDelete);
     for (std::size_t i = 1; i <= logRecordCount; ++i) {
         logStorage.addLogRecord(createSerializedLogRecord());
     }
@@ -243,14 +359,14 @@ BOOST_AUTO_TEST_CASE(ForceRemovalOfAllLogsTest)
     BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), serializedLogSize);
 }
 
-BOOST_AUTO_TEST_CASE(ForceRemovalOfSpecifiedPercentOfLogsTest)
+BOOST_AUTO_TEST_CASE_TEMPLATE(ForceRemovalOfSpecifiedPercentOfLogsTest, LogStorage, InMemoryLogStorageTypes)
 {
     std::size_t logRecordCount = 10;
     std::size_t serializedLogSize = createSerializedLogRecord().getSize();
     std::size_t maxLogStorageSize = logRecordCount * serializedLogSize;
     float percentToDelete = 51.1;
 
-    MemoryLogStorage logStorage(clientContext, maxLogStorageSize, percentToDelete, LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, logRecordCount / 2);
+    LogStorage logStorage(clientContext, maxLogStorageSize, percentToDelete, LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE, logRecordCount / 2);
 
     for (std::size_t i = 1; i <= logRecordCount; ++i) {
         logStorage.addLogRecord(createSerializedLogRecord());
@@ -270,6 +386,124 @@ BOOST_AUTO_TEST_CASE(ForceRemovalOfSpecifiedPercentOfLogsTest)
     BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), sizeAfterRemoval);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(AddRecordBatchTest, LogStorage, InMemoryLogStorageTypes)
+{
+    std::size_t recordsInBucket = 3;
+    std::size_t serializedLogSize = createSerializedLogRecord().getSize();
+
+    LogStorage logStorage(clientContext, 2 * serializedLogSize, recordsInBucket);
+
+    std::list<LogRecord> records;
+    records.push_back(createSerializedLogRecord());
+    records.push_back(createSerializedLogRecord());
+    std::vector<std::uint8_t> tooBigRecordData(3 * serializedLogSize);
+    records.emplace_back(tooBigRecordData.data(), tooBigRecordData.size());
+    records.push_back(createSerializedLogRecord());
+
+    std::vector<BucketInfo> bucketInfos;
+    BOOST_CHECK_THROW(logStorage.addLogRecords(records, bucketInfos), KaaException);
+
+    BOOST_CHECK_EQUAL(bucketInfos.size(), 2);
+    BOOST_CHECK_EQUAL(records.size(), 2);
+    BOOST_CHECK_EQUAL(records.front().getSize(), 3 * serializedLogSize);
+
+    records.pop_front();
+    logStorage.addLogRecords(records, bucketInfos);
+
+    BOOST_CHECK(records.empty());
+    BOOST_CHECK_EQUAL(bucketInfos.size(), 3);
+    BOOST_CHECK_EQUAL(bucketInfos[0].getBucketId(), bucketInfos[1].getBucketId());
+    BOOST_CHECK_NE(bucketInfos[1].getBucketId(), bucketInfos[2].getBucketId());
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 3);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getConsumedVolume(), 3 * serializedLogSize);
+}
+
+BOOST_AUTO_TEST_CASE(InUseBucketIsSharedWithoutCopyingTest)
+{
+    std::size_t logRecordCount = 1 + rand() % 10;
+
+    MemoryLogStorage logStorage(clientContext);
+    for (std::size_t i = 1; i <= logRecordCount; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    auto bucket = logStorage.getNextBucket();
+    const auto& records = bucket.getRecords();
+
+    BOOST_CHECK(bucket.isShared());
+    BOOST_CHECK_EQUAL(records.size(), logRecordCount);
+
+    logStorage.rollbackBucket(bucket.getBucketId());
+
+    auto sameBucket = logStorage.getNextBucket();
+    BOOST_CHECK_EQUAL(sameBucket.getBucketId(), bucket.getBucketId());
+    BOOST_CHECK(&sameBucket.getRecords() == &records);
+
+    logStorage.removeBucket(bucket.getBucketId());
+
+    BOOST_CHECK(bucket.isShared());
+    BOOST_CHECK_EQUAL(records.size(), logRecordCount);
+}
+
+BOOST_AUTO_TEST_CASE(ArenaRecordsSpanSeveralChunksTest)
+{
+    std::size_t logRecordCount = 100;
+    std::size_t serializedLogSize = createSerializedLogRecord().getSize();
+
+    /*
+     * Chunk fits only two records, the last record in a bucket takes the new chunk.
+     */
+    ArenaLogStorage logStorage(clientContext, LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                               logRecordCount, 2 * (serializedLogSize + sizeof(PackedLogRecordLength)));
+
+    for (std::size_t i = 0; i < logRecordCount; ++i) {
+        logStorage.addLogRecord(createSerializedLogRecord(std::to_string(i % 10)));
+    }
+
+    auto bucket = logStorage.getNextBucket();
+
+    BOOST_CHECK(bucket.isPacked());
+    BOOST_CHECK_THROW(bucket.getRecords(), KaaException);
+
+    auto records = getRecordData(bucket);
+    BOOST_REQUIRE_EQUAL(records.size(), logRecordCount);
+    BOOST_REQUIRE_EQUAL(bucket.getRecordCount(), logRecordCount);
+
+    for (std::size_t i = 0; i < logRecordCount; ++i) {
+        BOOST_CHECK(records[i] == createSerializedLogRecord(std::to_string(i % 10)).getData());
+    }
+
+    auto takenRecords = bucket.takeRecords();
+    BOOST_CHECK_EQUAL(takenRecords.size(), logRecordCount);
+    BOOST_CHECK(takenRecords.back().getData() == records.back());
+    BOOST_CHECK_EQUAL(bucket.getRecordCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ThroughputTest)
+{
+    const std::size_t recordCount = 100000;
+
+    MemoryLogStorage memoryLogStorage(clientContext);
+    ArenaLogStorage arenaLogStorage(clientContext);
+
+    /*
+     * Otherwise trace messages would take most of the time and allocations.
+     */
+    tmp_logger.setLevel(LogLevel::KAA_WARNING);
+
+    auto memoryThroughput = measureThroughput(memoryLogStorage, recordCount);
+    auto arenaThroughput = measureThroughput(arenaLogStorage, recordCount);
+
+    tmp_logger.setLevel(LogLevel::KAA_TRACE);
+
+    BOOST_TEST_MESSAGE(boost::format("Log storage throughput (%1% records): memory %2% rec/s, arena %3% rec/s")
+                    % recordCount % memoryThroughput.recordsPerSecond_ % arenaThroughput.recordsPerSecond_);
+    BOOST_TEST_MESSAGE(boost::format("Log storage allocations per record: memory %1%, arena %2%")
+                    % memoryThroughput.allocationsPerRecord_ % arenaThroughput.allocationsPerRecord_);
+
+    BOOST_CHECK_LT(arenaThroughput.allocationsPerRecord_, memoryThroughput.allocationsPerRecord_);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -16,9 +16,15 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <list>
 #include <string>
+#include <vector>
 #include <cstdio>
 #include <fstream>
+#include <thread>
+#include <chrono>
+
+#include <sqlite3.h>
 
 #include "kaa/log/SQLiteDBLogStorage.hpp"
 #include "kaa/log/LogRecord.hpp"
@@ -339,6 +345,178 @@ BOOST_AUTO_TEST_CASE(TruncateTest)
     removeDatabase(clientContext.getProperties().getLogsDatabaseFileName());
 }
 
+static std::size_t countCommittedRecords(const std::string& dbName)
+{
+    sqlite3 *db = nullptr;
+    sqlite3_open(dbName.c_str(), &db);
+
+    sqlite3_stmt *stmt = nullptr;
+    sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM KAA_LOGS;", -1, &stmt, nullptr);
+
+    std::size_t count = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        count = sqlite3_column_int64(stmt, 0);
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    return count;
+}
+
+static void executeSql(const std::string& dbName, const std::string& sql)
+{
+    sqlite3 *db = nullptr;
+    sqlite3_open(dbName.c_str(), &db);
+    BOOST_REQUIRE_EQUAL(sqlite3_exec(db, sql.c_str(), nullptr, nullptr, nullptr), SQLITE_OK);
+    sqlite3_close(db);
+}
+
+BOOST_AUTO_TEST_CASE(BatchedTransactionByRecordCountTest)
+{
+    std::size_t recordsInTransaction = 4;
+    std::size_t recordCount = 2 * recordsInTransaction + 1;
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    {
+        SQLiteDBLogStorage logStorage(clientContext, testLogStorageName,
+                                      (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                      LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                      LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT,
+                                      SQLiteTransactionOptions(recordsInTransaction));
+
+        for (std::size_t i = 0; i < recordCount; ++i) {
+            logStorage.addLogRecord(createSerializedLogRecord());
+        }
+
+        BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), recordCount);
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 2 * recordsInTransaction);
+
+        auto bucket = logStorage.getNextBucket();
+        BOOST_CHECK_EQUAL(bucket.getRecords().size(), recordCount);
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), recordCount);
+
+        logStorage.rollbackBucket(bucket.getBucketId());
+    }
+
+    SQLiteDBLogStorage logStorage(clientContext, testLogStorageName);
+    BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), recordCount);
+
+    removeDatabase(testLogStorageName);
+}
+
+BOOST_AUTO_TEST_CASE(BatchedTransactionBySizeAndTimeTest)
+{
+    std::size_t sizeOfOneRecord = createSerializedLogRecord().getSize();
+    std::size_t transactionDurationMs = 50;
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    {
+        SQLiteDBLogStorage logStorage(clientContext, testLogStorageName,
+                                      (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                      LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                      LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT,
+                                      SQLiteTransactionOptions(0, 2 * sizeOfOneRecord, transactionDurationMs));
+
+        logStorage.addLogRecord(createSerializedLogRecord());
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 0);
+
+        logStorage.addLogRecord(createSerializedLogRecord());
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 2);
+
+        logStorage.addLogRecord(createSerializedLogRecord());
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 2);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(2 * transactionDurationMs));
+
+        BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 3);
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 3);
+
+        logStorage.addLogRecord(createSerializedLogRecord());
+    }
+
+    BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 4);
+
+    removeDatabase(testLogStorageName);
+}
+
+BOOST_AUTO_TEST_CASE(TransactionCommittedByTimerTest)
+{
+    std::size_t transactionDurationMs = 50;
+
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    {
+        SQLiteDBLogStorage logStorage(clientContext, testLogStorageName,
+                                      (int)SQLiteOptimizationOptions::SQLITE_NO_OPTIMIZATIONS,
+                                      LogStorageConstants::DEFAULT_MAX_BUCKET_SIZE,
+                                      LogStorageConstants::DEFAULT_MAX_BUCKET_RECORD_COUNT,
+                                      SQLiteTransactionOptions(0, 0, transactionDurationMs));
+
+        logStorage.addLogRecord(createSerializedLogRecord());
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 0);
+
+        /*
+         * The storage isn't used meanwhile.
+         */
+        std::this_thread::sleep_for(std::chrono::milliseconds(4 * transactionDurationMs));
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 1);
+
+        logStorage.addLogRecord(createSerializedLogRecord());
+        std::this_thread::sleep_for(std::chrono::milliseconds(4 * transactionDurationMs));
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 2);
+    }
+
+    removeDatabase(testLogStorageName);
+}
+
+BOOST_AUTO_TEST_CASE(FailedAddLeavesNoRecordsTest)
+{
+    auto clientContext = getClientContext();
+    removeDatabase(testLogStorageName);
+
+    {
+        SQLiteDBLogStorage logStorage(clientContext, testLogStorageName);
+
+        /*
+         * The third record of a bucket is inserted, but the bucket can't be updated.
+         */
+        executeSql(testLogStorageName,
+                   "CREATE TRIGGER FAIL_THIRD_RECORD BEFORE UPDATE ON KAA_BUCKETS "
+                   "WHEN NEW.SIZE_IN_RECORDS > 2 BEGIN SELECT RAISE(ABORT, 'test'); END;");
+
+        std::list<LogRecord> records;
+        for (std::size_t i = 0; i < 3; ++i) {
+            records.push_back(createSerializedLogRecord());
+        }
+
+        std::vector<BucketInfo> bucketInfos;
+        BOOST_CHECK_THROW(logStorage.addLogRecords(records, bucketInfos), KaaException);
+        BOOST_CHECK_EQUAL(records.size(), 3);
+        BOOST_CHECK(bucketInfos.empty());
+        BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 0);
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 0);
+
+        logStorage.addLogRecord(createSerializedLogRecord());
+        logStorage.addLogRecord(createSerializedLogRecord());
+        BOOST_CHECK_THROW(logStorage.addLogRecord(createSerializedLogRecord()), KaaException);
+        BOOST_CHECK_EQUAL(logStorage.getStatus().getRecordsCount(), 2);
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 2);
+
+        auto bucket = logStorage.getNextBucket();
+        BOOST_CHECK_EQUAL(bucket.getRecords().size(), 2);
+        logStorage.removeBucket(bucket.getBucketId());
+        BOOST_CHECK_EQUAL(countCommittedRecords(testLogStorageName), 0);
+    }
+
+    removeDatabase(testLogStorageName);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
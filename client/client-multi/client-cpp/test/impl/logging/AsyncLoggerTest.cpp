@@ -0,0 +1,285 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include "kaa/logging/Log.hpp"
+#include "kaa/logging/AsyncLogger.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+class CollectingLogger : public ILogger {
+public:
+    CollectingLogger(LogLevel level = LogLevel::KAA_TRACE, std::size_t delayUs = 0)
+        : level_(level), delayUs_(delayUs) {}
+
+    virtual void log(LogLevel level, const char *message) const
+    {
+        if (delayUs_) {
+            std::this_thread::sleep_for(std::chrono::microseconds(delayUs_));
+        }
+
+        std::lock_guard<std::mutex> lock(guard_);
+        messages_.push_back(message);
+    }
+
+    virtual bool isEnabled(LogLevel level) const { return level >= level_; }
+
+    std::vector<std::string> getMessages() const
+    {
+        std::lock_guard<std::mutex> lock(guard_);
+        return messages_;
+    }
+
+private:
+    const LogLevel       level_;
+    const std::size_t    delayUs_;
+
+    mutable std::mutex                  guard_;
+    mutable std::vector<std::string>    messages_;
+};
+
+class FileLogger : public ILogger {
+public:
+    FileLogger(const std::string& fileName) : stream_(fileName) {}
+
+    virtual void log(LogLevel level, const char *message) const
+    {
+        std::lock_guard<std::mutex> lock(guard_);
+        stream_ << message << std::endl;
+    }
+
+private:
+    mutable std::mutex       guard_;
+    mutable std::ofstream    stream_;
+};
+
+/*
+ * Log macros take the logger from the context_ variable.
+ */
+class LoggingContext {
+public:
+    LoggingContext(const ILogger& logger) : logger_(logger) {}
+    const ILogger& getLogger() const { return logger_; }
+
+private:
+    const ILogger& logger_;
+};
+
+static std::string countEvaluation(std::size_t& evaluationCount)
+{
+    ++evaluationCount;
+    return "message";
+}
+
+BOOST_AUTO_TEST_SUITE(AsyncLoggerTestSuite)
+
+BOOST_AUTO_TEST_CASE(AsyncLoggerCreationTest)
+{
+    BOOST_CHECK_THROW({ AsyncLogger logger((LoggerPtr())); }, KaaException);
+    BOOST_CHECK_THROW({ AsyncLogger logger(std::make_shared<CollectingLogger>(), 0); }, KaaException);
+    BOOST_CHECK_NO_THROW({ AsyncLogger logger(std::make_shared<CollectingLogger>()); });
+}
+
+BOOST_AUTO_TEST_CASE(MessageOrderTest)
+{
+    const std::size_t messageCount = 1000;
+    auto target = std::make_shared<CollectingLogger>();
+
+    {
+        AsyncLogger logger(target, messageCount, AsyncLogger::OverflowPolicy::BLOCK);
+        for (std::size_t i = 0; i < messageCount; ++i) {
+            logger.log(LogLevel::KAA_INFO, std::to_string(i).c_str());
+        }
+    }
+
+    auto messages = target->getMessages();
+    BOOST_REQUIRE_EQUAL(messages.size(), messageCount);
+    for (std::size_t i = 0; i < messageCount; ++i) {
+        BOOST_CHECK_EQUAL(messages[i], std::to_string(i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(FlushTest)
+{
+    const std::size_t messageCount = 100;
+    auto target = std::make_shared<CollectingLogger>(LogLevel::KAA_TRACE, 100);
+    AsyncLogger logger(target);
+
+    for (std::size_t i = 0; i < messageCount; ++i) {
+        logger.log(LogLevel::KAA_INFO, "message");
+    }
+
+    logger.flush();
+    BOOST_CHECK_EQUAL(target->getMessages().size(), messageCount);
+}
+
+BOOST_AUTO_TEST_CASE(DropPolicyTest)
+{
+    const std::size_t capacity = 16;
+    const std::size_t messageCount = 1000;
+    auto target = std::make_shared<CollectingLogger>(LogLevel::KAA_TRACE, 1000);
+
+    std::size_t droppedCount = 0;
+
+    {
+        AsyncLogger logger(target, capacity, AsyncLogger::OverflowPolicy::DROP);
+        for (std::size_t i = 0; i < messageCount; ++i) {
+            logger.log(LogLevel::KAA_INFO, "message");
+        }
+        droppedCount = logger.getDroppedCount();
+    }
+
+    BOOST_CHECK(droppedCount > 0);
+    BOOST_CHECK_EQUAL(target->getMessages().size() + droppedCount, messageCount);
+}
+
+BOOST_AUTO_TEST_CASE(BlockPolicyTest)
+{
+    const std::size_t capacity = 16;
+    const std::size_t threadCount = 4;
+    const std::size_t messageCount = 500;
+    auto target = std::make_shared<CollectingLogger>(LogLevel::KAA_TRACE, 10);
+
+    {
+        AsyncLogger logger(target, capacity, AsyncLogger::OverflowPolicy::BLOCK);
+
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back([&logger, messageCount] {
+                for (std::size_t j = 0; j < messageCount; ++j) {
+                    logger.log(LogLevel::KAA_INFO, "message");
+                }
+            });
+        }
+
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        BOOST_CHECK_EQUAL(logger.getDroppedCount(), 0);
+    }
+
+    BOOST_CHECK_EQUAL(target->getMessages().size(), threadCount * messageCount);
+}
+
+BOOST_AUTO_TEST_CASE(DisabledLevelTest)
+{
+    CollectingLogger target(LogLevel::KAA_WARNING);
+    LoggingContext context_(target);
+    std::size_t evaluationCount = 0;
+
+    KAA_LOG_INFO(countEvaluation(evaluationCount));
+    KAA_LOG_ERROR(countEvaluation(evaluationCount));
+
+    auto messages = target.getMessages();
+    BOOST_CHECK_EQUAL(evaluationCount, 1);
+    BOOST_REQUIRE_EQUAL(messages.size(), 1);
+    BOOST_CHECK(messages.front().find("message") != std::string::npos);
+
+    AsyncLogger logger(std::make_shared<CollectingLogger>(LogLevel::KAA_WARNING));
+    BOOST_CHECK(!logger.isEnabled(LogLevel::KAA_INFO));
+    BOOST_CHECK(logger.isEnabled(LogLevel::KAA_ERROR));
+}
+
+BOOST_AUTO_TEST_CASE(DefaultLoggerLevelTest)
+{
+    const std::string logFile = "default_logger_level.log";
+
+    {
+        DefaultLogger logger("level_test_client", logFile);
+        logger.setLevel(LogLevel::KAA_WARNING);
+
+        BOOST_CHECK(!logger.isEnabled(LogLevel::KAA_INFO));
+        BOOST_CHECK(logger.isEnabled(LogLevel::KAA_ERROR));
+
+        logger.log(LogLevel::KAA_INFO, "skipped message");
+        logger.log(LogLevel::KAA_ERROR, "written message");
+    }
+
+    std::ifstream logStream(logFile);
+    std::string logs((std::istreambuf_iterator<char>(logStream)), std::istreambuf_iterator<char>());
+
+    BOOST_CHECK(logs.find("skipped message") == std::string::npos);
+    BOOST_CHECK(logs.find("written message") != std::string::npos);
+
+    std::remove(logFile.c_str());
+}
+
+static double measureLogRate(const ILogger& logger, std::size_t threadCount, std::size_t messageCount)
+{
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back([&logger, messageCount] {
+            for (std::size_t j = 0; j < messageCount; ++j) {
+                logger.log(LogLevel::KAA_INFO, "Benchmark message with some payload to write");
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start).count();
+
+    return (threadCount * messageCount) * 1000000.0 / (elapsed ? elapsed : 1);
+}
+
+BOOST_AUTO_TEST_CASE(ThroughputBenchmarkTest)
+{
+    const std::size_t threadCount = 4;
+    const std::size_t messageCount = 2000;
+    const std::string logFile = "async_logger_benchmark.log";
+
+    auto target = std::make_shared<FileLogger>(logFile);
+
+    double syncRate = measureLogRate(*target, threadCount, messageCount);
+    double asyncRate = 0;
+    std::size_t droppedCount = 0;
+
+    {
+        AsyncLogger logger(target, threadCount * messageCount);
+        asyncRate = measureLogRate(logger, threadCount, messageCount);
+        droppedCount = logger.getDroppedCount();
+        logger.flush();
+    }
+
+    BOOST_TEST_MESSAGE("Log calls per second: sync " << syncRate << ", async " << asyncRate
+                       << " (" << droppedCount << " dropped)");
+
+    std::remove(logFile.c_str());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
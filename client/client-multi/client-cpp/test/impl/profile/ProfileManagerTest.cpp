@@ -28,6 +28,8 @@
 #include "headers/channel/MockChannelManager.hpp"
 #include "kaa/context/SimpleExecutorContext.hpp"
 #include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/profile/MockProfileContainer.hpp"
+#include "headers/channel/transport/MockProfileTransport.hpp"
 
 namespace kaa {
 
@@ -56,6 +58,52 @@ BOOST_AUTO_TEST_CASE(ProfileManagerIsInitializedTest)
 #endif
 }
 
+BOOST_AUTO_TEST_CASE(ProfileManagerCachesSerializedProfileTest)
+{
+    KaaClientProperties properties;
+    DefaultLogger tmp_logger(properties.getClientId());
+    IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+    SimpleExecutorContext executor;
+    executor.init();
+    KaaClientContext clientContext(properties, tmp_logger, executor, tmp_state);
+
+    auto container = std::make_shared<MockProfileContainer>();
+    auto transport = std::make_shared<MockProfileTransport>();
+
+    ProfileManager profileManager(clientContext);
+    profileManager.setTransport(transport);
+    profileManager.setProfileContainer(container);
+
+    auto profileWithHash = profileManager.getSerializedProfileWithHash();
+    auto serializedProfile = profileWithHash.first;
+    auto profileHash = profileWithHash.second;
+
+    BOOST_CHECK_EQUAL(container->onGetProfile_, 1);
+    BOOST_CHECK(profileHash == EndpointObjectHash(serializedProfile).getHashDigest());
+
+    /*
+     * The profile is clean, nothing is serialized.
+     */
+    BOOST_CHECK(profileManager.getSerializedProfile().first == serializedProfile.first);
+    BOOST_CHECK(profileManager.getSerializedProfileWithHash().second == profileHash);
+    BOOST_CHECK_EQUAL(container->onGetProfile_, 1);
+
+    profileManager.updateProfile();
+    BOOST_CHECK_EQUAL(container->onGetProfile_, 2);
+
+    profileManager.getSerializedProfile();
+    profileManager.getSerializedProfileWithHash();
+    BOOST_CHECK_EQUAL(container->onGetProfile_, 2);
+
+    auto newContainer = std::make_shared<MockProfileContainer>();
+    profileManager.setProfileContainer(newContainer);
+    profileManager.getSerializedProfileWithHash();
+    BOOST_CHECK_EQUAL(newContainer->onGetProfile_, 1);
+    BOOST_CHECK_EQUAL(container->onGetProfile_, 2);
+
+    executor.stop();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
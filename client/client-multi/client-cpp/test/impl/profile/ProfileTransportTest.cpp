@@ -31,6 +31,7 @@
 #include "headers/channel/MockChannelManager.hpp"
 #include "headers/context/MockExecutorContext.hpp"
 #include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/profile/MockProfileContainer.hpp"
 
 namespace kaa {
 
@@ -86,6 +87,66 @@ BOOST_AUTO_TEST_CASE(CreateClientSyncWhenEndpointIsUnregistered)
     BOOST_CHECK(profileTransport.createProfileRequest());
 }
 
+BOOST_AUTO_TEST_CASE(CreateClientSyncWhenProfileIsClean)
+{
+    DefaultLogger logger("client_id");
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    auto statePtr = std::make_shared<MockKaaClientStateStorage>();
+    MockExecutorContext executor;
+    KaaClientContext clientContext(properties, logger, executor, statePtr);
+    PublicKey publicKey;
+
+    auto profileContainer = std::make_shared<MockProfileContainer>();
+    ProfileManager profileManager(clientContext);
+    profileManager.setProfileContainer(profileContainer);
+
+    ProfileTransport profileTransport(channelManager, publicKey, clientContext);
+    profileTransport.setProfileManager(&profileManager);
+
+    statePtr->isRegistered_ = true;
+    statePtr->isProfileResyncNeeded_ = false;
+    statePtr->profileHash_ = profileManager.getSerializedProfileWithHash().second;
+
+    /*
+     * The profile isn't serialized again until it is updated.
+     */
+    for (std::size_t i = 0; i < 3; ++i) {
+        BOOST_CHECK(!profileTransport.createProfileRequest());
+    }
+    BOOST_CHECK_EQUAL(profileContainer->onGetProfile_, 1);
+}
+
+BOOST_AUTO_TEST_CASE(RequestBodyMatchesStoredHashTest)
+{
+    DefaultLogger logger("client_id");
+    KaaClientProperties properties;
+    MockChannelManager channelManager;
+    auto statePtr = std::make_shared<MockKaaClientStateStorage>();
+    MockExecutorContext executor;
+    KaaClientContext clientContext(properties, logger, executor, statePtr);
+    PublicKey publicKey;
+
+    ProfileManager profileManager(clientContext);
+    profileManager.setProfileContainer(std::make_shared<MockProfileContainer>());
+
+    ProfileTransport profileTransport(channelManager, publicKey, clientContext);
+    profileTransport.setProfileManager(&profileManager);
+
+    statePtr->isRegistered_ = true;
+    statePtr->isProfileResyncNeeded_ = true;
+
+    auto request = profileTransport.createProfileRequest();
+    BOOST_REQUIRE(request);
+
+    auto serializedProfile = profileManager.getSerializedProfile();
+    std::vector<std::uint8_t> expectedBody(serializedProfile.first.get(),
+                                           serializedProfile.first.get() + serializedProfile.second);
+
+    BOOST_CHECK(request->profileBody == expectedBody);
+    BOOST_CHECK(statePtr->profileHash_ == EndpointObjectHash(serializedProfile).getHashDigest());
+}
+
 BOOST_AUTO_TEST_CASE(ResyncResponseTest)
 {
     DefaultLogger logger("client_id");
@@ -0,0 +1,242 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <memory>
+
+#include <botan/pkcs8.h>
+
+#include "kaa/security/KeyUtils.hpp"
+#include "kaa/security/RsaEncoderDecoder.hpp"
+#include "kaa/KaaClientContext.hpp"
+#include "kaa/KaaClientProperties.hpp"
+#include "kaa/logging/DefaultLogger.hpp"
+
+#include "headers/MockKaaClientStateStorage.hpp"
+#include "headers/context/MockExecutorContext.hpp"
+
+namespace kaa {
+
+static KaaClientProperties properties;
+static DefaultLogger tmp_logger(properties.getClientId());
+static IKaaClientStateStoragePtr tmp_state(new MockKaaClientStateStorage);
+static MockExecutorContext tmpExecContext;
+static KaaClientContext clientContext(properties, tmp_logger, tmpExecContext, tmp_state);
+
+static const std::size_t KEY_LENGTH = 2048;
+static const std::size_t AES_BLOCK_SIZE = 16;
+
+struct RsaEncoderDecoderFixture
+{
+    RsaEncoderDecoderFixture()
+        : clientKeys(KeyUtils().generateKeyPair(KEY_LENGTH))
+        , serverKeys(KeyUtils().generateKeyPair(KEY_LENGTH))
+        , client(clientKeys.getPublicKey(), clientKeys.getPrivateKey(), serverKeys.getPublicKey(), clientContext)
+        , server(serverKeys.getPublicKey(), serverKeys.getPrivateKey(), clientKeys.getPublicKey(), clientContext)
+    {
+
+    }
+
+    KeyPair clientKeys;
+    KeyPair serverKeys;
+
+    RsaEncoderDecoder client;
+    RsaEncoderDecoder server;
+};
+
+static std::vector<std::uint8_t> createPayload(std::size_t size)
+{
+    std::vector<std::uint8_t> payload(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        payload[i] = static_cast<std::uint8_t>(i * 31 + 7);
+    }
+    return payload;
+}
+
+BOOST_AUTO_TEST_SUITE(RsaEncoderDecoderTestSuite)
+
+BOOST_FIXTURE_TEST_CASE(EncodeDecodeTest, RsaEncoderDecoderFixture)
+{
+    CipherBuffer encoded;
+    CipherBuffer decoded;
+
+    for (std::size_t size : { 0, 1, 15, 16, 17, 1000 }) {
+        const auto& payload = createPayload(size);
+
+        client.encodeData(payload.data(), payload.size(), encoded);
+        BOOST_CHECK_EQUAL(encoded.size(), (size / AES_BLOCK_SIZE + 1) * AES_BLOCK_SIZE);
+
+        /*
+         * The buffered and the copying methods must give the same result.
+         */
+        const std::string& encodedCopy = client.encodeData(payload.data(), payload.size());
+        BOOST_CHECK_EQUAL_COLLECTIONS(encoded.begin(), encoded.end(), encodedCopy.begin(), encodedCopy.end());
+
+        client.decodeData(encoded.data(), encoded.size(), decoded);
+        BOOST_CHECK_EQUAL_COLLECTIONS(payload.begin(), payload.end(), decoded.begin(), decoded.end());
+
+        const std::string& decodedCopy = client.decodeData(encoded.data(), encoded.size());
+        BOOST_CHECK_EQUAL_COLLECTIONS(payload.begin(), payload.end(), decodedCopy.begin(), decodedCopy.end());
+
+        const ByteArrayView& decodedView = client.decodeDataToBuffer(encoded.data(), encoded.size());
+        BOOST_CHECK_EQUAL_COLLECTIONS(payload.begin(), payload.end(), decodedView.begin(), decodedView.end());
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(SignVerifyTest, RsaEncoderDecoderFixture)
+{
+    const auto& payload = createPayload(100);
+
+    for (std::size_t i = 0; i < 3; ++i) {
+        const Signature& signature = client.signData(payload.data(), payload.size());
+        BOOST_CHECK(server.verifySignature(payload.data(), payload.size(), signature.data(), signature.size()));
+
+        auto corruptedPayload = payload;
+        corruptedPayload[i] ^= 0xFF;
+        BOOST_CHECK(!server.verifySignature(corruptedPayload.data(), corruptedPayload.size(), signature.data(), signature.size()));
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(SessionKeySignatureTest, RsaEncoderDecoderFixture)
+{
+    const EncodedSessionKey& encodedSessionKey = client.getEncodedSessionKey();
+    const Signature& signature = client.getSessionKeySignature();
+
+    BOOST_CHECK(!encodedSessionKey.empty());
+    BOOST_CHECK(server.verifySignature(encodedSessionKey.data(), encodedSessionKey.size(), signature.data(), signature.size()));
+
+    /*
+     * RSA encryption is randomized, so equal results mean the envelope is reused.
+     */
+    for (std::size_t i = 0; i < 3; ++i) {
+        const EncodedSessionKey& sameSessionKey = client.getEncodedSessionKey();
+        BOOST_CHECK_EQUAL_COLLECTIONS(encodedSessionKey.begin(), encodedSessionKey.end(), sameSessionKey.begin(), sameSessionKey.end());
+
+        const Signature& sameSignature = client.getSessionKeySignature();
+        BOOST_CHECK_EQUAL_COLLECTIONS(signature.begin(), signature.end(), sameSignature.begin(), sameSignature.end());
+    }
+
+    /*
+     * Another session has its own key.
+     */
+    RsaEncoderDecoder otherClient(clientKeys.getPublicKey(), clientKeys.getPrivateKey(), serverKeys.getPublicKey(), clientContext);
+    const EncodedSessionKey& otherSessionKey = otherClient.getEncodedSessionKey();
+    BOOST_CHECK(otherSessionKey != encodedSessionKey);
+}
+
+BOOST_FIXTURE_TEST_CASE(SessionKeyBenchmarkTest, RsaEncoderDecoderFixture)
+{
+    const std::chrono::milliseconds measureTime(200);
+
+    Botan::AutoSeeded_RNG rng;
+    Botan::DataSource_Memory serverKeyMem(serverKeys.getPublicKey());
+    std::unique_ptr<Botan::X509_PublicKey> serverKey(Botan::X509::load_key(serverKeyMem));
+    const auto& sessionKey = createPayload(AES_BLOCK_SIZE);
+
+    /*
+     * Request envelope built per request: the session key is RSA-encrypted and signed every time.
+     */
+    std::size_t requestCount = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::duration elapsed;
+
+    do {
+        Botan::PK_Encryptor_EME enc(*serverKey, "EME-PKCS1-v1_5");
+        const auto& encodedSessionKey = enc.encrypt(sessionKey, rng);
+        const Signature& signature = client.signData(encodedSessionKey.data(), encodedSessionKey.size());
+        BOOST_CHECK(!signature.empty());
+        ++requestCount;
+        elapsed = std::chrono::steady_clock::now() - startTime;
+    } while (elapsed < measureTime);
+
+    auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    BOOST_TEST_MESSAGE("Session key envelope per request: "
+                       << static_cast<std::uint64_t>((1000000.0 * requestCount) / (elapsedUs ? elapsedUs : 1))
+                       << " requests/sec");
+
+    /*
+     * Request envelope cached for the session.
+     */
+    requestCount = 0;
+    startTime = std::chrono::steady_clock::now();
+
+    do {
+        const EncodedSessionKey& encodedSessionKey = client.getEncodedSessionKey();
+        const Signature& signature = client.getSessionKeySignature();
+        BOOST_CHECK(!encodedSessionKey.empty() && !signature.empty());
+        ++requestCount;
+        elapsed = std::chrono::steady_clock::now() - startTime;
+    } while (elapsed < measureTime);
+
+    elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    BOOST_TEST_MESSAGE("Session key envelope cached: "
+                       << static_cast<std::uint64_t>((1000000.0 * requestCount) / (elapsedUs ? elapsedUs : 1))
+                       << " requests/sec");
+}
+
+BOOST_FIXTURE_TEST_CASE(ThroughputBenchmarkTest, RsaEncoderDecoderFixture)
+{
+    const std::chrono::milliseconds measureTime(200);
+
+    CipherBuffer encoded;
+    CipherBuffer decoded;
+
+    for (std::size_t size : { 64, 1024, 64 * 1024 }) {
+        const auto& payload = createPayload(size);
+
+        std::size_t messageCount = 0;
+        auto startTime = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::duration elapsed;
+
+        do {
+            client.encodeData(payload.data(), payload.size(), encoded);
+            client.decodeData(encoded.data(), encoded.size(), decoded);
+            ++messageCount;
+            elapsed = std::chrono::steady_clock::now() - startTime;
+        } while (elapsed < measureTime);
+
+        BOOST_CHECK_EQUAL_COLLECTIONS(payload.begin(), payload.end(), decoded.begin(), decoded.end());
+
+        auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        BOOST_TEST_MESSAGE("Payload: " << size << " bytes, encode + decode: "
+                           << static_cast<std::uint64_t>((1000000.0 * messageCount) / (elapsedUs ? elapsedUs : 1))
+                           << " messages/sec");
+
+        messageCount = 0;
+        startTime = std::chrono::steady_clock::now();
+
+        do {
+            const Signature& signature = client.signData(payload.data(), payload.size());
+            BOOST_CHECK(server.verifySignature(payload.data(), payload.size(), signature.data(), signature.size()));
+            ++messageCount;
+            elapsed = std::chrono::steady_clock::now() - startTime;
+        } while (elapsed < measureTime);
+
+        elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        BOOST_TEST_MESSAGE("Payload: " << size << " bytes, sign + verify: "
+                           << static_cast<std::uint64_t>((1000000.0 * messageCount) / (elapsedUs ? elapsedUs : 1))
+                           << " messages/sec");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -63,6 +63,40 @@ BOOST_AUTO_TEST_CASE(StopTimerTest)
     resetCounter();
 }
 
+BOOST_AUTO_TEST_CASE(MillisecondTimerTest)
+{
+    std::chrono::milliseconds timeToWait(200);
+    KaaTimer<void (void)> timer { "Kaa Timer" };
+    timer.start(timeToWait, [] { increment(); });
+
+    std::this_thread::sleep_for(timeToWait / 2);
+
+    BOOST_CHECK_EQUAL(counter, 0);
+
+    std::this_thread::sleep_for(timeToWait);
+
+    BOOST_CHECK_EQUAL(counter, 1);
+    resetCounter();
+}
+
+BOOST_AUTO_TEST_CASE(RestartTimerTest)
+{
+    std::chrono::milliseconds timeToWait(200);
+    KaaTimer<void (void)> timer { "Kaa Timer" };
+    timer.start(timeToWait, [] { increment(); });
+    timer.stop();
+    timer.start(timeToWait * 2, [] { increment(); });
+
+    std::this_thread::sleep_for(timeToWait + timeToWait / 2);
+
+    BOOST_CHECK_EQUAL(counter, 0);
+
+    std::this_thread::sleep_for(timeToWait);
+
+    BOOST_CHECK_EQUAL(counter, 1);
+    resetCounter();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
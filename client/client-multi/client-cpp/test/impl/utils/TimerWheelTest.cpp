@@ -0,0 +1,177 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "kaa/utils/KaaTimer.hpp"
+#include "kaa/utils/TimerWheel.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+BOOST_AUTO_TEST_SUITE(TimerWheelTestSuite)
+
+BOOST_AUTO_TEST_CASE(BadTimerTest)
+{
+    BOOST_CHECK_THROW({ TimerWheel wheel(0); }, KaaException);
+
+    TimerWheel wheel;
+    BOOST_CHECK_THROW(wheel.schedule(std::chrono::milliseconds(10), TimerCallback()), KaaException);
+}
+
+BOOST_AUTO_TEST_CASE(SubSecondTimerTest)
+{
+    TimerWheel wheel;
+    std::atomic_int counter(0);
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::atomic<std::int64_t> elapsedMs(0);
+
+    wheel.schedule(std::chrono::milliseconds(150), [&]
+        {
+            elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                std::chrono::steady_clock::now() - startTime).count();
+            ++counter;
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    BOOST_CHECK_EQUAL(counter, 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+    BOOST_CHECK_EQUAL(counter, 1);
+    BOOST_CHECK(elapsedMs >= 150);
+    BOOST_CHECK_EQUAL(wheel.getPendingTimerCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(CancelTimerTest)
+{
+    TimerWheel wheel;
+    std::atomic_int counter(0);
+
+    auto timerId = wheel.schedule(std::chrono::milliseconds(100), [&counter] { ++counter; });
+    BOOST_CHECK_EQUAL(wheel.getPendingTimerCount(), 1);
+
+    BOOST_CHECK(wheel.cancel(timerId));
+    BOOST_CHECK(!wheel.cancel(timerId));
+    BOOST_CHECK(!wheel.cancel(TimerWheel::INVALID_TIMER_ID));
+    BOOST_CHECK_EQUAL(wheel.getPendingTimerCount(), 0);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    BOOST_CHECK_EQUAL(counter, 0);
+}
+
+BOOST_AUTO_TEST_CASE(TimerOrderTest)
+{
+    /*
+     * A single dispatcher thread executes callbacks in the order timers expire.
+     */
+    TimerWheel wheel(1);
+
+    std::mutex guard;
+    std::vector<int> order;
+
+    auto scheduleMarker = [&] (int marker, std::size_t delayMs)
+        {
+            wheel.schedule(std::chrono::milliseconds(delayMs), [&guard, &order, marker]
+                {
+                    std::lock_guard<std::mutex> lock(guard);
+                    order.push_back(marker);
+                });
+        };
+
+    /*
+     * Delays which exceed the lowest wheel level must be cascaded down.
+     */
+    scheduleMarker(3, 900);
+    scheduleMarker(1, 100);
+    scheduleMarker(2, 300);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(1300));
+
+    std::lock_guard<std::mutex> lock(guard);
+    BOOST_REQUIRE_EQUAL(order.size(), 3);
+    BOOST_CHECK_EQUAL(order[0], 1);
+    BOOST_CHECK_EQUAL(order[1], 2);
+    BOOST_CHECK_EQUAL(order[2], 3);
+}
+
+BOOST_AUTO_TEST_CASE(ConstantThreadCountTest)
+{
+    std::size_t dispatcherCount = 2;
+    TimerWheel wheel(dispatcherCount);
+
+    BOOST_CHECK_EQUAL(wheel.getThreadCount(), 0);
+
+    std::size_t timerCount = 1000;
+    std::atomic_size_t counter(0);
+
+    for (std::size_t i = 0; i < timerCount; ++i) {
+        wheel.schedule(std::chrono::milliseconds(50 + i % 200), [&counter] { ++counter; });
+    }
+
+    BOOST_CHECK_EQUAL(wheel.getThreadCount(), dispatcherCount + 1);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(600));
+
+    BOOST_CHECK_EQUAL(counter, timerCount);
+    BOOST_CHECK_EQUAL(wheel.getThreadCount(), dispatcherCount + 1);
+}
+
+BOOST_AUTO_TEST_CASE(SharedTimerWheelTest)
+{
+    std::atomic_int counter(0);
+
+    {
+        std::vector<std::unique_ptr<KaaTimer<void ()>>> timers;
+        for (std::size_t i = 0; i < 50; ++i) {
+            timers.emplace_back(new KaaTimer<void ()>("Kaa Timer"));
+            timers.back()->start(std::chrono::milliseconds(100), [&counter] { ++counter; });
+        }
+
+        BOOST_CHECK_EQUAL(TimerWheel::getInstance().getThreadCount(), TimerWheel::DEFAULT_DISPATCHER_COUNT + 1);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+        BOOST_CHECK_EQUAL(counter, 50);
+    }
+
+    BOOST_CHECK_EQUAL(TimerWheel::getInstance().getThreadCount(), TimerWheel::DEFAULT_DISPATCHER_COUNT + 1);
+}
+
+BOOST_AUTO_TEST_CASE(DestroyFromCallbackTest)
+{
+    std::atomic_bool isDestroyed(false);
+    std::unique_ptr<TimerWheel> wheel(new TimerWheel(1));
+
+    wheel->schedule(std::chrono::milliseconds(10), [&wheel, &isDestroyed]
+        {
+            wheel.reset();
+            isDestroyed = true;
+        });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    BOOST_CHECK(isDestroyed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
@@ -0,0 +1,233 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+
+#include "kaa/utils/ThreadPool.hpp"
+#include "kaa/utils/WorkStealingThreadPool.hpp"
+#include "kaa/context/SimpleExecutorContext.hpp"
+#include "kaa/common/exception/KaaException.hpp"
+
+namespace kaa {
+
+static void waitForTasks(const std::atomic_size_t& actualTaskCount, std::size_t expectedTaskCount)
+{
+    while (actualTaskCount.load() != expectedTaskCount) {
+        std::this_thread::yield();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE(WorkStealingThreadPoolTestSuite)
+
+BOOST_AUTO_TEST_CASE(ThreadPoolCreationTest)
+{
+    BOOST_CHECK_NO_THROW({ WorkStealingThreadPool pool; });
+    BOOST_CHECK_NO_THROW({ WorkStealingThreadPool pool(10); });
+
+    BOOST_CHECK_THROW({ WorkStealingThreadPool pool(0); }, KaaException);
+    BOOST_CHECK_THROW({ WorkStealingThreadPool pool(1, 0); }, KaaException);
+}
+
+BOOST_AUTO_TEST_CASE(BadTaskTest)
+{
+    WorkStealingThreadPool pool;
+    ThreadPoolTask task;
+
+    BOOST_CHECK_THROW(pool.add(task), KaaException);
+}
+
+BOOST_AUTO_TEST_CASE(TaskWithExceptionTest)
+{
+    std::atomic_size_t executedTaskCounter(0);
+
+    WorkStealingThreadPool pool;
+    pool.add([&executedTaskCounter] () { executedTaskCounter++; throw 1; });
+    pool.add([&executedTaskCounter] () { executedTaskCounter++; throw std::runtime_error("this is a test exception"); });
+    pool.add([&executedTaskCounter] () { executedTaskCounter++; });
+
+    waitForTasks(executedTaskCounter, 3);
+}
+
+BOOST_AUTO_TEST_CASE(SingleWorkerOrderTest)
+{
+    /*
+     * The small queue makes tasks overflow, the order must be kept anyway.
+     */
+    WorkStealingThreadPool pool(1, 4);
+
+    std::mutex guard;
+    std::vector<std::size_t> order;
+    std::atomic_size_t executedTaskCounter(0);
+
+    const std::size_t taskCount = 100;
+    for (std::size_t i = 0; i < taskCount; ++i) {
+        pool.add([&guard, &order, &executedTaskCounter, i] ()
+            {
+                std::lock_guard<std::mutex> lock(guard);
+                order.push_back(i);
+                executedTaskCounter++;
+            });
+    }
+
+    waitForTasks(executedTaskCounter, taskCount);
+
+    std::lock_guard<std::mutex> lock(guard);
+    for (std::size_t i = 0; i < taskCount; ++i) {
+        BOOST_CHECK_EQUAL(order[i], i);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(AddTaskFromWorkerTest)
+{
+    const std::size_t workerCount = 4;
+    const std::size_t taskCount = 1000;
+
+    WorkStealingThreadPool pool(workerCount, 16);
+    std::atomic_size_t executedTaskCounter(0);
+
+    /*
+     * Tasks added by a worker go to its own queue, idle workers must steal them.
+     */
+    pool.add([&pool, &executedTaskCounter, taskCount] ()
+        {
+            for (std::size_t i = 0; i < taskCount; ++i) {
+                pool.add([&executedTaskCounter] () { executedTaskCounter++; });
+            }
+        });
+
+    waitForTasks(executedTaskCounter, taskCount);
+}
+
+BOOST_AUTO_TEST_CASE(ShutdownNowTest)
+{
+    WorkStealingThreadPool threadPool;
+    std::atomic_size_t actualTaskCount(0);
+    std::chrono::milliseconds timeToWait(400);
+
+    ThreadPoolTask task = [&actualTaskCount, &timeToWait] ()
+                              {
+                                    std::this_thread::sleep_for(timeToWait);
+                                    actualTaskCount++;
+                              };
+    threadPool.add(task);
+    threadPool.add(task);
+
+    std::this_thread::sleep_for(timeToWait / 2);
+
+    threadPool.shutdownNow();
+
+    std::this_thread::sleep_for(timeToWait);
+
+    BOOST_CHECK_EQUAL(actualTaskCount.load(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(PendingAllTaskShutdownTest)
+{
+    WorkStealingThreadPool threadPool(2);
+    std::atomic_size_t actualTaskCount(0);
+
+    const std::size_t taskCount = 10;
+    for (std::size_t i = 0; i < taskCount; ++i) {
+        threadPool.add([&actualTaskCount] ()
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                actualTaskCount++;
+            });
+    }
+
+    threadPool.shutdown();
+
+    BOOST_CHECK_EQUAL(actualTaskCount.load(), taskCount);
+    BOOST_CHECK_THROW(threadPool.add([] () {}), KaaException);
+}
+
+BOOST_AUTO_TEST_CASE(ExecutorTypeTest)
+{
+    SimpleExecutorContext context;
+    BOOST_CHECK(context.getExecutorType() == ExecutorType::THREAD_POOL);
+
+    context.setExecutorType(ExecutorType::WORK_STEALING_THREAD_POOL);
+    context.init();
+
+    BOOST_CHECK(dynamic_cast<WorkStealingThreadPool *>(&context.getApiExecutor()));
+    BOOST_CHECK(dynamic_cast<WorkStealingThreadPool *>(&context.getCallbackExecutor()));
+    BOOST_CHECK(dynamic_cast<WorkStealingThreadPool *>(&context.getLifeCycleExecutor()));
+
+    std::atomic_size_t executedTaskCounter(0);
+    context.getApiExecutor().add([&executedTaskCounter] () { executedTaskCounter++; });
+    waitForTasks(executedTaskCounter, 1);
+
+    context.stop();
+}
+
+static double measureThroughput(IThreadPool& pool, std::size_t producerCount, std::size_t taskCount)
+{
+    std::atomic_size_t executedTaskCounter(0);
+    ThreadPoolTask task = [&executedTaskCounter] () { executedTaskCounter.fetch_add(1, std::memory_order_relaxed); };
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> producers;
+    for (std::size_t i = 0; i < producerCount; ++i) {
+        producers.push_back(std::thread([&pool, &task, producerCount, taskCount] ()
+            {
+                for (std::size_t j = 0; j < taskCount / producerCount; ++j) {
+                    pool.add(task);
+                }
+            }));
+    }
+
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    waitForTasks(executedTaskCounter, (taskCount / producerCount) * producerCount);
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+    pool.shutdown();
+
+    return (1000000.0 * executedTaskCounter.load()) / (elapsed.count() ? elapsed.count() : 1);
+}
+
+BOOST_AUTO_TEST_CASE(ThroughputBenchmarkTest)
+{
+    const std::size_t producerCount = 4;
+    const std::size_t taskCount = 100000;
+
+    for (std::size_t workerCount : { 1, 2, 4, 8, 16 }) {
+        ThreadPool threadPool(workerCount);
+        double threadPoolThroughput = measureThroughput(threadPool, producerCount, taskCount);
+
+        WorkStealingThreadPool workStealingThreadPool(workerCount);
+        double workStealingThroughput = measureThroughput(workStealingThreadPool, producerCount, taskCount);
+
+        BOOST_TEST_MESSAGE("Workers: " << workerCount
+                           << ", ThreadPool: " << static_cast<std::uint64_t>(threadPoolThroughput) << " tasks/sec"
+                           << ", WorkStealingThreadPool: " << static_cast<std::uint64_t>(workStealingThroughput) << " tasks/sec");
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+}
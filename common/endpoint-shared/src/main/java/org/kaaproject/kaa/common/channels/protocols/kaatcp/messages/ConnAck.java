@@ -20,7 +20,7 @@ package org.kaaproject.kaa.common.channels.protocols.kaatcp.messages;
  * ConnAck message Class.
  * The CONNACK message is a message sent by the server in response to a CONNECT request from a client.
  * Variable header
- * byte 1  reserved (0)
+ * byte 1  Connect Acknowledge Flags, bit 0 set if compressed KAASYNC payloads are accepted
  * byte 2 Return Code see enum ReturnCode
  * @author Andrey Panasenko
  *
@@ -29,6 +29,9 @@ public class ConnAck extends MqttFrame {
 
     public static final int CONNACK_REMAINING_LEGTH_V1 = 2;
 
+    /** Set in the Connect Acknowledge Flags if compressed KAASYNC payloads are accepted. */
+    public static final byte CONNACK_COMPRESSION_FLAG = 0x01;
+
     /**
      * CONNACK return code enum
      *  ACCEPTED                    0x01    Connection Accepted
@@ -65,13 +68,25 @@ public class ConnAck extends MqttFrame {
 
     private ReturnCode returnCode;
 
+    private boolean compressionSupported;
+
     /**
      * Default constructor.
      * @param returnCode the return code
      */
     public ConnAck(ReturnCode returnCode) {
+        this(returnCode, false);
+    }
+
+    /**
+     * Constructor.
+     * @param returnCode the return code
+     * @param compressionSupported whether compressed KAASYNC payloads are accepted
+     */
+    public ConnAck(ReturnCode returnCode, boolean compressionSupported) {
         setMessageType(MessageType.CONNACK);
         this.setReturnCode(returnCode);
+        this.setCompressionSupported(compressionSupported);
         this.remainingLength = CONNACK_REMAINING_LEGTH_V1;
     }
 
@@ -89,7 +104,7 @@ public class ConnAck extends MqttFrame {
      */
     @Override
     protected void pack() {
-        buffer.put((byte) 0);
+        buffer.put(compressionSupported ? CONNACK_COMPRESSION_FLAG : (byte) 0);
         buffer.put(returnCode.getReturnCode());
     }
 
@@ -109,11 +124,28 @@ public class ConnAck extends MqttFrame {
         this.returnCode = returnCode;
     }
 
+    /**
+     * Return whether compressed KAASYNC payloads are accepted
+     * @return boolean compressionSupported
+     */
+    public boolean isCompressionSupported() {
+        return compressionSupported;
+    }
+
+    /**
+     * Set whether compressed KAASYNC payloads are accepted
+     * @param compressionSupported - boolean
+     */
+    public void setCompressionSupported(boolean compressionSupported) {
+        this.compressionSupported = compressionSupported;
+    }
+
     /* (non-Javadoc)
      * @see org.kaaproject.kaa.common.channels.protocols.kaatcp.messages.mqttFrame#decode(int)
      */
     @Override
     protected void decode() {
+        compressionSupported = (buffer.get(0) & CONNACK_COMPRESSION_FLAG) != 0;
         byte code = buffer.get(1);
         if (code == ReturnCode.ACCEPTED.getReturnCode()) {
             returnCode = ReturnCode.ACCEPTED;
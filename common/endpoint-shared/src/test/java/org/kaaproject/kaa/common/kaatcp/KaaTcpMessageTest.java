@@ -84,6 +84,13 @@ public class KaaTcpMessageTest {
         Assert.assertArrayEquals(rawConnack, message.getFrame().array());
     }
 
+    @Test
+    public void testConnackWithCompression() {
+        byte [] rawConnack = new byte[] { 0x20, 0x02, 0x01, 0x01 };
+        ConnAck message = new ConnAck(ReturnCode.ACCEPTED, true);
+        Assert.assertArrayEquals(rawConnack, message.getFrame().array());
+    }
+
     @Test
     public void testPingRequest() {
         byte [] pingRequest = new byte[] { (byte) 0xC0, 0x00 };
@@ -47,6 +47,7 @@ import org.kaaproject.kaa.common.endpoint.gen.SyncRequestMetaData;
 import org.kaaproject.kaa.common.endpoint.security.KeyUtil;
 import org.kaaproject.kaa.common.endpoint.security.MessageEncoderDecoder;
 import org.kaaproject.kaa.common.hash.SHA1HashUtils;
+import org.mockito.ArgumentCaptor;
 import org.mockito.Mockito;
 
 public class MessageFactoryTest {
@@ -129,6 +130,23 @@ public class MessageFactoryTest {
     }
 
 
+    @Test
+    public void testConnackCompressionFlag() throws KaaTcpProtocolException {
+        MessageFactory factory = new MessageFactory();
+        ConnAckListener listener = Mockito.mock(ConnAckListener.class);
+        factory.registerMessageListener(listener);
+
+        factory.getFramer().pushBytes(new byte[] { 0x20, 0x02, 0x01, 0x01 });
+        factory.getFramer().pushBytes(new byte[] { 0x20, 0x02, 0x00, 0x01 });
+
+        ArgumentCaptor<ConnAck> captor = ArgumentCaptor.forClass(ConnAck.class);
+        Mockito.verify(listener, Mockito.times(2)).onMessage(captor.capture());
+        Assert.assertEquals(ReturnCode.ACCEPTED, captor.getAllValues().get(0).getReturnCode());
+        Assert.assertTrue(captor.getAllValues().get(0).isCompressionSupported());
+        Assert.assertEquals(ReturnCode.ACCEPTED, captor.getAllValues().get(1).getReturnCode());
+        Assert.assertFalse(captor.getAllValues().get(1).isCompressionSupported());
+    }
+
     @Test
     public void testConnectMessage() throws KaaTcpProtocolException, IOException, GeneralSecurityException {
         KeyPair clientPair = KeyUtil.generateKeyPair();
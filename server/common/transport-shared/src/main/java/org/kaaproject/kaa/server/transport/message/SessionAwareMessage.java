@@ -32,4 +32,10 @@ public interface SessionAwareMessage extends Message, SessionAware{
      */
     byte[] getEncodedMessageData();
 
+    /**
+     * Return whether encoded message data is compressed
+     * @return true if encoded message data is compressed
+     */
+    boolean isZipped();
+
 }
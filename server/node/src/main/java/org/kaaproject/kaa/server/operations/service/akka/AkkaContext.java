@@ -45,6 +45,8 @@ public class AkkaContext {
 
     private static final String IO_WORKER_COUNT_PROP_NAME = "io_worker_count";
 
+    private static final String MAX_INFLATED_REQUEST_SIZE = "max_inflated_request_size";
+
     private static final String AKKA_CONF_FILE_NAME = "akka.conf";
 
     @Autowired
@@ -112,6 +114,10 @@ public class AkkaContext {
     public long getEventTimeout() {
         return config.getLong(ENDPOINT_EVENT_TIMEOUT);
     }
+
+    public int getMaxInflatedRequestSize() {
+        return config.getInt(MAX_INFLATED_REQUEST_SIZE);
+    }
     
     public ClusterService getClusterService() {
         return clusterService;
@@ -16,11 +16,14 @@
 
 package org.kaaproject.kaa.server.operations.service.akka.actors.io;
 
+import java.io.ByteArrayOutputStream;
 import java.security.GeneralSecurityException;
 import java.security.PublicKey;
 import java.text.MessageFormat;
 import java.util.Map;
 import java.util.Set;
+import java.util.zip.DataFormatException;
+import java.util.zip.Inflater;
 
 import org.kaaproject.kaa.common.endpoint.security.KeyUtil;
 import org.kaaproject.kaa.common.endpoint.security.MessageEncoderDecoder;
@@ -61,6 +64,8 @@ public class EncDecActorMessageProcessor {
     /** The Constant LOG. */
     private static final Logger LOG = LoggerFactory.getLogger(EncDecActorMessageProcessor.class);
 
+    private static final int INFLATE_BUFFER_SIZE = 4096;
+
     private final CacheService cacheService;
 
     private final MessageEncoderDecoder crypt;
@@ -69,6 +74,8 @@ public class EncDecActorMessageProcessor {
 
     private final Boolean supportUnencryptedConnection;
 
+    private final int maxInflatedRequestSize;
+
     /** The eps actor. */
     private final ActorRef opsActor;
 
@@ -83,6 +90,7 @@ public class EncDecActorMessageProcessor {
         this.opsActor = epsActor;
         this.cacheService = context.getCacheService();
         this.supportUnencryptedConnection = context.getSupportUnencryptedConnection();
+        this.maxInflatedRequestSize = context.getMaxInflatedRequestSize();
         this.crypt = new MessageEncoderDecoder(context.getKeyStoreService().getPrivateKey(), context.getKeyStoreService().getPublicKey());
         this.platformEncDecMap = PlatformLookup.initPlatformProtocolMap(platformProtocols);
         MetricsService metricsService = context.getMetricsService();
@@ -287,6 +295,9 @@ public class EncDecActorMessageProcessor {
         crypt.setSessionCipherPair(session.getCipherPair());
         byte[] requestRaw = crypt.decodeData(message.getEncodedMessageData());
         LOG.trace("Request data decrypted");
+        if (message.isZipped()) {
+            requestRaw = inflate(requestRaw, maxInflatedRequestSize);
+        }
         ClientSync request = decodePlatformLevelData(message.getPlatformId(), requestRaw);
         LOG.trace("Request data deserialized");
         return request;
@@ -294,11 +305,47 @@ public class EncDecActorMessageProcessor {
 
     private ClientSync decodeUnencryptedRequest(SessionAwareMessage message) throws PlatformEncDecException {
         byte[] requestRaw = message.getEncodedMessageData();
+        if (message.isZipped()) {
+            requestRaw = inflate(requestRaw, maxInflatedRequestSize);
+        }
         ClientSync request = decodePlatformLevelData(message.getPlatformId(), requestRaw);
         LOG.trace("Request data deserialized");
         return request;
     }
 
+    /**
+     * Inflates zlib compressed request data.
+     *
+     * @param data the compressed data
+     * @param maxSize the max size of inflated data, so that a small request can't exhaust memory
+     * @return the inflated data
+     * @throws PlatformEncDecException if the data is broken or inflates to more than maxSize bytes
+     */
+    static byte[] inflate(byte[] data, int maxSize) throws PlatformEncDecException {
+        Inflater inflater = new Inflater();
+        try {
+            inflater.setInput(data);
+            ByteArrayOutputStream out = new ByteArrayOutputStream(Math.min(data.length * 2, maxSize));
+            byte[] buffer = new byte[INFLATE_BUFFER_SIZE];
+            while (!inflater.finished()) {
+                int count = inflater.inflate(buffer);
+                if (count == 0 && (inflater.needsInput() || inflater.needsDictionary())) {
+                    throw new PlatformEncDecException("Compressed request data is truncated");
+                }
+                if (out.size() + count > maxSize) {
+                    throw new PlatformEncDecException(MessageFormat.format("Inflated request data exceeds {0,number,#} bytes", maxSize));
+                }
+                out.write(buffer, 0, count);
+            }
+            LOG.trace("Request data inflated from {} to {} bytes", data.length, out.size());
+            return out.toByteArray();
+        } catch (DataFormatException e) {
+            throw new PlatformEncDecException(e);
+        } finally {
+            inflater.end();
+        }
+    }
+
     private byte[] encodePlatformLevelData(int platformID, SessionResponse message) throws PlatformEncDecException {
         PlatformEncDec encDec = platformEncDecMap.get(platformID);
         if (encDec != null) {
@@ -924,6 +924,11 @@ public class DefaultAkkaServiceTest {
             public byte[] getEncodedMessageData() {
                 return kaaSync.getAvroObject();
             }
+
+            @Override
+            public boolean isZipped() {
+                return kaaSync.isZipped();
+            }
         };
         akkaService.process(message);
 
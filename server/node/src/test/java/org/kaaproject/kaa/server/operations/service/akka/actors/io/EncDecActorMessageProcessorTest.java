@@ -0,0 +1,73 @@
+/**
+ *  Copyright 2014-2016 CyberVision, Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+package org.kaaproject.kaa.server.operations.service.akka.actors.io;
+
+import java.io.ByteArrayOutputStream;
+import java.util.Arrays;
+import java.util.zip.Deflater;
+
+import org.junit.Assert;
+import org.junit.Test;
+import org.kaaproject.kaa.server.sync.platform.PlatformEncDecException;
+
+public class EncDecActorMessageProcessorTest {
+
+    private static final int MAX_INFLATED_SIZE = 1024 * 1024;
+
+    private static byte[] deflate(byte[] data) {
+        Deflater deflater = new Deflater();
+        try {
+            deflater.setInput(data);
+            deflater.finish();
+            ByteArrayOutputStream out = new ByteArrayOutputStream();
+            byte[] buffer = new byte[4096];
+            while (!deflater.finished()) {
+                int count = deflater.deflate(buffer);
+                out.write(buffer, 0, count);
+            }
+            return out.toByteArray();
+        } finally {
+            deflater.end();
+        }
+    }
+
+    @Test
+    public void testInflate() throws PlatformEncDecException {
+        byte[] data = new byte[MAX_INFLATED_SIZE];
+        Arrays.fill(data, (byte) 'a');
+
+        Assert.assertArrayEquals(data, EncDecActorMessageProcessor.inflate(deflate(data), MAX_INFLATED_SIZE));
+    }
+
+    @Test(expected = PlatformEncDecException.class)
+    public void testInflateBomb() throws PlatformEncDecException {
+        /*
+         * A few kilobytes which inflate to a hundred megabytes.
+         */
+        byte[] bomb = deflate(new byte[100 * MAX_INFLATED_SIZE]);
+        Assert.assertTrue(bomb.length < MAX_INFLATED_SIZE);
+
+        EncDecActorMessageProcessor.inflate(bomb, MAX_INFLATED_SIZE);
+    }
+
+    @Test(expected = PlatformEncDecException.class)
+    public void testInflateTruncatedData() throws PlatformEncDecException {
+        byte[] compressed = deflate(new byte[MAX_INFLATED_SIZE]);
+
+        EncDecActorMessageProcessor.inflate(Arrays.copyOf(compressed, compressed.length / 2), MAX_INFLATED_SIZE);
+    }
+}
@@ -123,7 +123,7 @@ public class TcpHandler extends SimpleChannelInboundHandler<AbstractKaaTcpComman
                         if (!connAckSent) {
                             connAckSent = true;
                             Object[] responses = new Object[2];
-                            responses[0] = new ConnAck(ReturnCode.ACCEPTED);
+                            responses[0] = new ConnAck(ReturnCode.ACCEPTED, true);
                             responses[1] = new org.kaaproject.kaa.common.channels.protocols.kaatcp.messages.SyncResponse(
                                     encriptedResponseData, NOT_ZIPPED, isEncrypted);
                             LOG.debug("Sending {} response objects", responses.length);
@@ -50,6 +50,11 @@ public class NettyTcpSyncMessage extends AbstractMessage implements SessionAware
         return command.isEncrypted();
     }
 
+    @Override
+    public boolean isZipped() {
+        return command.isZipped();
+    }
+
     @Override
     public String toString() {
         StringBuilder builder = new StringBuilder();
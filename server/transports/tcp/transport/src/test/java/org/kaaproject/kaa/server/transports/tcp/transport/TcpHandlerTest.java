@@ -62,6 +62,7 @@ public class TcpHandlerTest {
             Object[] response = message.getMessageBuilder().build("response".getBytes(), false);
             assertEquals(2, response.length);
             Assert.assertTrue(response[0] instanceof ConnAck);
+            Assert.assertTrue(((ConnAck) response[0]).isCompressionSupported());
             Assert.assertTrue(response[1] instanceof KaaSync);
             response = message.getErrorBuilder().build(Mockito.mock(GeneralSecurityException.class));
             Assert.assertTrue(response[0] instanceof ConnAck);